@@ -0,0 +1,100 @@
+#pragma once
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <boost/program_options.hpp>
+#include <seastar/core/app-template.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/thread.hh>
+
+/**
+ * Define a micro benchmark, the body runs inside seastar thread
+ * so futures can be waited by calling get().
+ */
+#define CPV_BENCHMARK(caseName, benchmarkName) \
+	static void caseName##_##benchmarkName##_BenchmarkBody(); \
+	static const cpv::benchmark::BenchmarkRegistration \
+		caseName##_##benchmarkName##_BenchmarkRegistration( \
+			#caseName "." #benchmarkName, caseName##_##benchmarkName##_BenchmarkBody); \
+	static void caseName##_##benchmarkName##_BenchmarkBody()
+
+namespace cpv::benchmark {
+	/** Registered micro benchmark */
+	struct BenchmarkEntry {
+		std::string_view name;
+		void(*body)();
+	};
+
+	/** Get all registered micro benchmarks */
+	static inline std::vector<BenchmarkEntry>& getBenchmarkEntries() {
+		static std::vector<BenchmarkEntry> entries;
+		return entries;
+	}
+
+	/** Register micro benchmark on construction */
+	struct BenchmarkRegistration {
+		BenchmarkRegistration(std::string_view name, void(*body)()) {
+			getBenchmarkEntries().push_back({ name, body });
+		}
+	};
+
+	/** Prevent compiler from optimizing out the computation of value */
+	template <class T>
+	static inline void doNotOptimize(const T& value) {
+		asm volatile("" : : "r,m"(value) : "memory");
+	}
+
+	/**
+	 * Run func for given iterations (after a short warmup) and print time per iteration.
+	 * Func will receive the index of iteration.
+	 */
+	template <class Func>
+	static inline void measure(std::string_view name, std::size_t iterations, Func&& func) {
+		std::size_t warmup = iterations / 10;
+		for (std::size_t i = 0; i < warmup; ++i) {
+			func(i);
+		}
+		auto start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < iterations; ++i) {
+			func(i);
+		}
+		auto end = std::chrono::steady_clock::now();
+		double nanoseconds = static_cast<double>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+		std::cout << "  " << std::left << std::setw(48) << name << std::right <<
+			std::setw(12) << std::fixed << std::setprecision(2) <<
+			(nanoseconds / static_cast<double>(iterations)) << " ns/op" <<
+			std::setw(12) << iterations << " iterations" << std::endl;
+	}
+
+	/** Print a custom metric (e.g. memory usage or number of fragments) */
+	template <class T>
+	static inline void report(std::string_view name, const T& value, std::string_view unit) {
+		std::cout << "  " << std::left << std::setw(48) << name << std::right <<
+			std::setw(12) << value << " " << unit << std::endl;
+	}
+
+	/** The main function of micro benchmark executable */
+	static inline int runAllBenchmarks(int argc, char** argv) {
+		seastar::app_template app;
+		app.add_options()
+			("filter", boost::program_options::value<std::string>()->default_value(""),
+				"only run benchmarks which name contains this string");
+		app.run(argc, argv, [&app] {
+			std::string filter = app.configuration()["filter"].as<std::string>();
+			return seastar::async([filter=std::move(filter)] {
+				for (auto& entry : getBenchmarkEntries()) {
+					if (entry.name.find(filter) == std::string_view::npos) {
+						continue;
+					}
+					std::cout << entry.name << ":" << std::endl;
+					entry.body();
+				}
+			});
+		});
+		return 0;
+	}
+}
@@ -0,0 +1,54 @@
+#include <seastar/core/memory.hh>
+#include <CPVFramework/Allocators/ArenaAllocator.hpp>
+#include <CPVFramework/Allocators/StackAllocator.hpp>
+#include <CPVFramework/Utility/SharedString.hpp>
+#include "../../Benchmark.hpp"
+
+namespace {
+	static const constexpr std::size_t HeaderCount = 16;
+	static const constexpr std::size_t StringCount = 8;
+
+	/** Simulate the temporary allocations of a request: header list overflow and small strings */
+	template <class Allocator, class MakeString>
+	void simulateRequest(const Allocator& allocator, const MakeString& makeString) {
+		cpv::StackAllocatedVector<std::pair<cpv::SharedString, cpv::SharedString>, 3, Allocator> headers(allocator);
+		for (std::size_t i = 0; i < HeaderCount; ++i) {
+			headers.emplace_back(makeString("X-Header-Name"), makeString("header value"));
+		}
+		for (std::size_t i = 0; i < StringCount; ++i) {
+			cpv::SharedString str = makeString("temporary string for response");
+			cpv::benchmark::doNotOptimize(str);
+		}
+		cpv::benchmark::doNotOptimize(headers);
+	}
+
+	/** Report mallocs per request and time per request */
+	template <class Func>
+	void benchmarkRequest(const std::string& name, const Func& func) {
+		static const constexpr std::size_t Iterations = 100000;
+		std::size_t mallocsBefore = seastar::memory::stats().mallocs();
+		for (std::size_t i = 0; i < Iterations; ++i) {
+			func();
+		}
+		std::size_t mallocsAfter = seastar::memory::stats().mallocs();
+		cpv::benchmark::report(name + " mallocs per request",
+			static_cast<double>(mallocsAfter - mallocsBefore) / Iterations, "");
+		cpv::benchmark::measure(name + " request", Iterations, [&func] (std::size_t) { func(); });
+	}
+}
+
+CPV_BENCHMARK(ArenaAllocator, perRequestAllocations) {
+	using PairType = std::pair<cpv::SharedString, cpv::SharedString>;
+	benchmarkRequest("global allocator", [] {
+		simulateRequest(std::allocator<PairType>(), [] (std::string_view str) {
+			return cpv::SharedString(str);
+		});
+	});
+	cpv::Arena arena;
+	benchmarkRequest("arena", [&arena] {
+		simulateRequest(cpv::ArenaAllocator<PairType>(arena), [&arena] (std::string_view str) {
+			return arena.copyString(str);
+		});
+		arena.reset();
+	});
+}
@@ -0,0 +1,39 @@
+#include <string_view>
+#include <seastar/core/memory.hh>
+#include <CPVFramework/Utility/SharedString.hpp>
+#include "../../Benchmark.hpp"
+
+namespace {
+	static const std::string_view SmallString("header value");
+	static const std::string_view MediumString(
+		"a medium size string that copied from request body or serialized from model, "
+		"it's larger than most header values");
+
+	/** Report mallocs per iteration and time per iteration */
+	template <class Func>
+	void benchmarkAllocation(const std::string& name, const Func& func) {
+		static const constexpr std::size_t Iterations = 100000;
+		std::size_t mallocsBefore = seastar::memory::stats().mallocs();
+		for (std::size_t i = 0; i < Iterations; ++i) {
+			func();
+		}
+		std::size_t mallocsAfter = seastar::memory::stats().mallocs();
+		cpv::benchmark::report(name + " mallocs per iteration",
+			static_cast<double>(mallocsAfter - mallocsBefore) / Iterations, "");
+		cpv::benchmark::measure(name, Iterations, [&func] (std::size_t) { func(); });
+	}
+}
+
+CPV_BENCHMARK(SlabAllocator, copyString) {
+	for (std::string_view str : { SmallString, MediumString }) {
+		std::string suffix = " (" + std::to_string(str.size()) + " bytes)";
+		benchmarkAllocation("temporary_buffer" + suffix, [str] {
+			seastar::temporary_buffer<char> buf(str.data(), str.size());
+			cpv::benchmark::doNotOptimize(buf);
+		});
+		benchmarkAllocation("SharedString" + suffix, [str] {
+			cpv::SharedString buf(str);
+			cpv::benchmark::doNotOptimize(buf);
+		});
+	}
+}
@@ -0,0 +1,40 @@
+#include <CPVFramework/Http/HttpForm.hpp>
+#include <CPVFramework/Utility/SharedStringBuilder.hpp>
+#include "../../Benchmark.hpp"
+
+namespace {
+	/** Generate url encoded form body, encodedEvery controls how often a value requires decoding */
+	cpv::SharedString makeFormBody(std::size_t fields, std::size_t encodedEvery) {
+		cpv::SharedStringBuilder builder;
+		for (std::size_t i = 0; i < fields; ++i) {
+			if (i != 0) {
+				builder.append("&");
+			}
+			builder.append("field_").append(i).append("=");
+			if (encodedEvery != 0 && i % encodedEvery == 0) {
+				builder.append("value+with+spaces+%E4%B8%80%E4%BA%8C%E4%B8%89");
+			} else {
+				builder.append("plain_value_").append(i * 7919);
+			}
+		}
+		return builder.build();
+	}
+
+	void benchmarkParse(std::size_t fields, std::size_t encodedEvery) {
+		cpv::SharedString body = makeFormBody(fields, encodedEvery);
+		std::string name(std::to_string(fields));
+		name.append(" fields, encoded every ").append(std::to_string(encodedEvery)).append(" parse");
+		cpv::benchmark::measure(name, 200000, [&] (std::size_t) {
+			cpv::HttpForm form(body);
+			cpv::benchmark::doNotOptimize(form);
+		});
+	}
+}
+
+CPV_BENCHMARK(HttpForm, parseUrlEncoded) {
+	for (std::size_t fields : { 5, 20, 50 }) {
+		benchmarkParse(fields, 0);
+		benchmarkParse(fields, 4);
+	}
+}
+
@@ -0,0 +1,111 @@
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <seastar/core/memory.hh>
+#include <CPVFramework/HttpServer/Handlers/HttpServerRequestStaticFileHandler.hpp>
+#include <CPVFramework/HttpServer/Handlers/HttpServerRequest404Handler.hpp>
+#include <CPVFramework/Stream/StringOutputStream.hpp>
+#include <CPVFramework/Utility/SharedStringBuilder.hpp>
+#include "../../Benchmark.hpp"
+
+namespace {
+	static const constexpr char PathBase[] = "/tmp/cpv-framework-static-file-handler-benchmark";
+	static const constexpr std::size_t FileCount = 64;
+	static const constexpr std::size_t FileSize = 64 * 1024;
+	/** Number of handlers, simulate the same handler constructed on each cpu core */
+	static const constexpr std::size_t HandlerCount = 4;
+
+	/** Make handlers serve the benchmark directory, with or without memory mapped files */
+	cpv::HttpServerRequestHandlerCollection makeHandlers(bool useMemoryMappedFiles) {
+		cpv::HttpServerRequestHandlerCollection handlers;
+		for (std::size_t i = 0; i < HandlerCount; ++i) {
+			handlers.emplace_back(
+				seastar::make_shared<cpv::HttpServerRequestStaticFileHandler>(
+				"/static", PathBase, "",
+				cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileEntities,
+				cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileSize,
+				cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileMetadataEntities,
+				cpv::HttpServerRequestStaticFileHandler::DefaultFileMetadataCacheTime,
+				false,
+				useMemoryMappedFiles));
+		}
+		handlers.emplace_back(seastar::make_shared<cpv::HttpServerRequest404Handler>());
+		return handlers;
+	}
+
+	/** Count memory mappings of files under the benchmark directory in this process */
+	std::size_t countMemoryMappings() {
+		std::ifstream maps("/proc/self/maps");
+		std::string line;
+		std::size_t count = 0;
+		while (std::getline(maps, line)) {
+			if (line.find(PathBase) != std::string::npos) {
+				++count;
+			}
+		}
+		return count;
+	}
+
+	/** Send a request for given file to given handler and wait for the response */
+	void request(
+		cpv::HttpServerRequestHandlerCollection& handlers,
+		std::size_t handlerIndex,
+		const cpv::SharedString& url,
+		cpv::HttpContext& context,
+		seastar::lw_shared_ptr<cpv::SharedStringBuilder>& str) {
+		str->clear();
+		context.setRequestResponse(cpv::HttpRequest(), cpv::HttpResponse());
+		context.getResponse().setBodyStream(
+			cpv::makeReusable<cpv::StringOutputStream>(str).template cast<cpv::OutputStreamBase>());
+		context.getRequest().setUrl(url.share());
+		handlers.at(handlerIndex)->handle(context, handlers.begin() + HandlerCount).get();
+	}
+
+	void benchmarkHandlers(std::string_view name, bool useMemoryMappedFiles) {
+		std::vector<cpv::SharedString> urls;
+		for (std::size_t i = 0; i < FileCount; ++i) {
+			urls.emplace_back(cpv::SharedStringBuilder()
+				.append("/static/file-").append(i).append(".txt").build());
+		}
+		cpv::HttpContext context;
+		auto str = seastar::make_lw_shared<cpv::SharedStringBuilder>();
+		std::size_t allocatedBefore = seastar::memory::stats().allocated_memory();
+		auto handlers = makeHandlers(useMemoryMappedFiles);
+		// fill the cache of every handler
+		for (std::size_t i = 0; i < HandlerCount; ++i) {
+			for (auto& url : urls) {
+				request(handlers, i, url, context, str);
+			}
+		}
+		str->clear();
+		std::size_t allocatedAfter = seastar::memory::stats().allocated_memory();
+		// make sure the memory mapped mode is actually measured, files are shared by handlers
+		std::size_t mappings = countMemoryMappings();
+		if (mappings != (useMemoryMappedFiles ? FileCount : 0)) {
+			throw std::runtime_error(std::string(name) + ": unexpected number of memory mapped files: " +
+				std::to_string(mappings) + ", files must have no write permission to be mapped");
+		}
+		std::string prefix(name);
+		prefix.append(" ");
+		cpv::benchmark::report(prefix + "cache memory", (allocatedAfter - allocatedBefore) / 1024, "KiB");
+		cpv::benchmark::measure(prefix + "cached request", 100000, [&] (std::size_t i) {
+			request(handlers, i % HandlerCount, urls[i % FileCount], context, str);
+			cpv::benchmark::doNotOptimize(str->size());
+		});
+	}
+}
+
+CPV_BENCHMARK(StaticFileHandler, copyVsMemoryMapped) {
+	// only files without write permission are mapped
+	std::string command("mkdir -p ");
+	command.append(PathBase).append(" && cd ").append(PathBase)
+		.append(" && for i in $(seq 0 ").append(std::to_string(FileCount - 1))
+		.append("); do head -c ").append(std::to_string(FileSize))
+		.append(" /dev/urandom > file-$i.txt; done && chmod a-w file-*.txt");
+	::system(command.c_str());
+	benchmarkHandlers("copy per handler", false);
+	benchmarkHandlers("memory mapped", true);
+	::system((std::string("chmod -R u+w ") + PathBase + " && rm -rf " + PathBase).c_str());
+}
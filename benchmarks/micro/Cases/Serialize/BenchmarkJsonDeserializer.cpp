@@ -0,0 +1,121 @@
+#include <cstring>
+#include <string>
+#include <vector>
+#include <CPVFramework/Serialize/JsonDeserializer.hpp>
+#include <CPVFramework/Serialize/JsonSerializer.hpp>
+#include "../../Benchmark.hpp"
+
+namespace {
+	/** Typical api record, contains short and long strings */
+	class RecordModel {
+	public:
+		int id = 0;
+		double price = 0;
+		bool enabled = false;
+		cpv::SharedString name;
+		cpv::SharedString description;
+		std::vector<int> tags;
+
+		void dumpJson(cpv::JsonBuilder& builder) const {
+			builder.startObject()
+				.addMember(CPV_JSONKEY("id"), id)
+				.addMember(CPV_JSONKEY("price"), price)
+				.addMember(CPV_JSONKEY("enabled"), enabled)
+				.addMember(CPV_JSONKEY("name"), name)
+				.addMember(CPV_JSONKEY("description"), description)
+				.addMember(CPV_JSONKEY("tags"), tags)
+				.endObject();
+		}
+
+		bool loadJson(const cpv::JsonValue& value) {
+			id << value["id"];
+			price << value["price"];
+			enabled << value["enabled"];
+			name << value["name"];
+			description << value["description"];
+			tags << value["tags"];
+			return true;
+		}
+	};
+
+	/** Make json array of records with approximately the given size */
+	std::string makeRecordsJson(std::size_t size) {
+		std::vector<RecordModel> records;
+		std::size_t estimatedSize = 2;
+		while (estimatedSize < size) {
+			RecordModel record;
+			record.id = static_cast<int>(records.size());
+			record.price = 0.5 * static_cast<double>(records.size());
+			record.enabled = (records.size() % 2 == 0);
+			record.name = cpv::SharedStringBuilder().append("record-").append(records.size()).build();
+			record.description = cpv::SharedString(std::string_view(
+				"A longer description of the record, with \"quotes\", a\ttab and some "
+				"non-ascii text: \xE4\xB8\x80\xE4\xBA\x8C\xE4\xB8\x89, it's usually the largest field."));
+			record.tags = { 1, 2, 3 };
+			estimatedSize += cpv::serializeJson(record).size() + 1;
+			records.emplace_back(std::move(record));
+		}
+		return std::string(cpv::serializeJson(records).toString().view());
+	}
+
+	/** Indent json by tabs like most formatters */
+	std::string formatJson(const std::string& json) {
+		std::string result;
+		std::size_t indent = 0;
+		bool inString = false;
+		for (std::size_t i = 0; i < json.size(); ++i) {
+			char c = json[i];
+			if (inString) {
+				result.append(1, c);
+				if (c == '\\') {
+					result.append(1, json[++i]);
+				} else if (c == '"') {
+					inString = false;
+				}
+			} else if (c == '{' || c == '[') {
+				result.append(1, c).append("\n").append(++indent, '\t');
+			} else if (c == '}' || c == ']') {
+				result.append("\n").append(--indent, '\t').append(1, c);
+			} else if (c == ',') {
+				result.append(",\n").append(indent, '\t');
+			} else if (c == ':') {
+				result.append(": ");
+			} else {
+				result.append(1, c);
+				inString = (c == '"');
+			}
+		}
+		return result;
+	}
+
+	void benchmarkDeserialize(const std::string& name, const std::string& json) {
+		// sajson is an in-situ parser, so copy json to mutable buffer before each deserialize
+		cpv::SharedString buffer(json.size());
+		std::size_t iterations = std::max<std::size_t>(10, 1000000 / json.size());
+		cpv::benchmark::report(name + " size", json.size(), "bytes");
+		cpv::benchmark::measure(name + " parse", iterations, [&] (std::size_t) {
+			std::memcpy(buffer.data(), json.data(), json.size());
+			std::optional<cpv::JsonDocument> document;
+			auto error = cpv::deserializeJson(document, buffer);
+			cpv::benchmark::doNotOptimize(error);
+			cpv::benchmark::doNotOptimize(document);
+		});
+		cpv::benchmark::measure(name + " deserialize", iterations, [&] (std::size_t) {
+			std::memcpy(buffer.data(), json.data(), json.size());
+			std::vector<RecordModel> records;
+			auto error = cpv::deserializeJson(records, buffer);
+			cpv::benchmark::doNotOptimize(error);
+			cpv::benchmark::doNotOptimize(records);
+		});
+	}
+}
+
+CPV_BENCHMARK(JsonDeserializer, apiPayloads) {
+	for (std::size_t size : { 1024, 16384, 262144, 1048576 }) {
+		std::string json = makeRecordsJson(size);
+		std::string prefix = std::to_string(size / 1024) + "KB ";
+		benchmarkDeserialize(prefix + "minified", json);
+		benchmarkDeserialize(prefix + "formatted", formatJson(json));
+	}
+}
+
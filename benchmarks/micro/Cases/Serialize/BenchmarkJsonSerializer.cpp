@@ -0,0 +1,119 @@
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include <CPVFramework/Serialize/JsonSerializer.hpp>
+#include "../../Benchmark.hpp"
+
+namespace {
+	/** Model with common member types, each item contains 6 members */
+	class ItemModel {
+	public:
+		int id = 0;
+		double price = 0;
+		bool enabled = false;
+		cpv::SharedString name;
+		cpv::SharedString description;
+		std::vector<int> tags;
+
+		void dumpJson(cpv::JsonBuilder& builder) const {
+			builder.startObject()
+				.addMember(CPV_JSONKEY("id"), id)
+				.addMember(CPV_JSONKEY("price"), price)
+				.addMember(CPV_JSONKEY("enabled"), enabled)
+				.addMember(CPV_JSONKEY("name"), name)
+				.addMember(CPV_JSONKEY("description"), description)
+				.addMember(CPV_JSONKEY("tags"), tags)
+				.endObject();
+		}
+	};
+
+	std::vector<ItemModel> makeItems(std::size_t count) {
+		std::vector<ItemModel> items(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			auto& item = items[i];
+			item.id = static_cast<int>(i);
+			item.price = 0.5 * static_cast<double>(i);
+			item.enabled = (i % 2 == 0);
+			item.name = cpv::SharedStringBuilder().append("item-").append(i).build();
+			item.description = cpv::SharedString(std::string_view("description of the item"));
+			item.tags = { 1, 2, 3 };
+		}
+		return items;
+	}
+
+	/** Write packet to fd by writev, the same way as socket layer sends fragments */
+	void writePacket(int fd, cpv::Packet& packet) {
+		std::vector<struct ::iovec> iov;
+		if (auto ptr = packet.getIfSingle()) {
+			iov.push_back({ ptr->fragment.base, ptr->fragment.size });
+		} else if (auto ptr = packet.getIfMultiple()) {
+			iov.reserve(ptr->fragments.size());
+			for (auto& fragment : ptr->fragments) {
+				iov.push_back({ fragment.base, fragment.size });
+			}
+		}
+		for (std::size_t i = 0; i < iov.size(); i += IOV_MAX) {
+			std::size_t count = std::min<std::size_t>(IOV_MAX, iov.size() - i);
+			cpv::benchmark::doNotOptimize(::writev(fd, iov.data() + i, static_cast<int>(count)));
+		}
+	}
+
+	void benchmarkSerialize(std::size_t count) {
+		auto items = makeItems(count);
+		int fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+		std::string prefix(std::to_string(count));
+		prefix.append(" items ");
+		for (auto [name, sizeHint] : {
+			std::make_pair("fragments", cpv::JsonSerializer<decltype(items)>::MaxContiguousBufferSizeHint + 1),
+			std::make_pair("contiguous", cpv::JsonSerializer<decltype(items)>::DefaultSizeHint) }) {
+			std::size_t iterations = 1000000 / count;
+			cpv::Packet sample = cpv::serializeJson(items, sizeHint);
+			cpv::benchmark::report(prefix + name + " segments", sample.segments(), "");
+			cpv::benchmark::measure(prefix + name + " serialize", iterations, [&] (std::size_t) {
+				cpv::Packet packet = cpv::serializeJson(items, sizeHint);
+				cpv::benchmark::doNotOptimize(packet);
+			});
+			cpv::benchmark::measure(prefix + name + " writev", iterations, [&] (std::size_t) {
+				writePacket(fd, sample);
+			});
+		}
+		::close(fd);
+	}
+
+	/** Time series like model, contains only numbers */
+	class PointModel {
+	public:
+		std::int64_t time = 0;
+		double value = 0;
+
+		void dumpJson(cpv::JsonBuilder& builder) const {
+			builder.startArray().addItem(time).addItem(value).endArray();
+		}
+	};
+}
+
+CPV_BENCHMARK(JsonSerializer, numbers) {
+	// about 100k numbers per response
+	std::vector<PointModel> points(50000);
+	for (std::size_t i = 0; i < points.size(); ++i) {
+		points[i].time = 1577836800000 + static_cast<std::int64_t>(i) * 1000;
+		points[i].value = static_cast<double>(i) / 7;
+	}
+	for (auto [name, sizeHint] : {
+		std::make_pair("fragments", cpv::JsonSerializer<decltype(points)>::MaxContiguousBufferSizeHint + 1),
+		std::make_pair("contiguous", cpv::JsonSerializer<decltype(points)>::DefaultSizeHint) }) {
+		cpv::benchmark::measure(std::string("100k numbers ") + name + " serialize", 10, [&] (std::size_t) {
+			cpv::Packet packet = cpv::serializeJson(points, sizeHint);
+			cpv::benchmark::doNotOptimize(packet);
+		});
+	}
+}
+
+CPV_BENCHMARK(JsonSerializer, fragmentsVsContiguous) {
+	for (std::size_t count : { 1, 10, 100, 1000 }) {
+		benchmarkSerialize(count);
+	}
+}
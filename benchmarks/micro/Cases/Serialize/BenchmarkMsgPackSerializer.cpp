@@ -0,0 +1,79 @@
+#include <cstring>
+#include <string>
+#include <vector>
+#include <CPVFramework/Serialize/JsonFields.hpp>
+#include <CPVFramework/Serialize/MsgPackFields.hpp>
+#include "../../Benchmark.hpp"
+
+namespace {
+	/** Typical api record, the same fields are used for json and msgpack */
+	class RecordModel {
+	public:
+		int id = 0;
+		double price = 0;
+		bool enabled = false;
+		cpv::SharedString name;
+		cpv::SharedString description;
+		std::vector<int> tags;
+		CPV_JSON_FIELDS(id, price, enabled, name, description, tags)
+		CPV_MSGPACK_FIELDS(id, price, enabled, name, description, tags)
+	};
+
+	std::vector<RecordModel> makeRecords(std::size_t count) {
+		std::vector<RecordModel> records(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			auto& record = records[i];
+			record.id = static_cast<int>(i * 7919);
+			record.price = 0.5 * static_cast<double>(i) + 0.01;
+			record.enabled = (i % 2 == 0);
+			record.name = cpv::SharedStringBuilder().append("record-").append(i).build();
+			record.description = cpv::SharedString(std::string_view(
+				"A longer description of the record, with \"quotes\", a\ttab and some "
+				"non-ascii text: \xE4\xB8\x80\xE4\xBA\x8C\xE4\xB8\x89."));
+			record.tags = { 1, 200, 30000 };
+		}
+		return records;
+	}
+
+	void benchmarkFormats(std::size_t count) {
+		auto records = makeRecords(count);
+		std::string prefix(std::to_string(count));
+		prefix.append(" records ");
+		std::size_t iterations = std::max<std::size_t>(10, 100000 / count);
+		std::string json(cpv::serializeJson(records).toString().view());
+		cpv::SharedString msgpack = cpv::serializeMsgPack(records).toString();
+		cpv::benchmark::report(prefix + "json size", json.size(), "bytes");
+		cpv::benchmark::report(prefix + "msgpack size", msgpack.size(), "bytes");
+		cpv::benchmark::measure(prefix + "json serialize", iterations, [&] (std::size_t) {
+			cpv::Packet packet = cpv::serializeJson(records);
+			cpv::benchmark::doNotOptimize(packet);
+		});
+		cpv::benchmark::measure(prefix + "msgpack serialize", iterations, [&] (std::size_t) {
+			cpv::Packet packet = cpv::serializeMsgPack(records);
+			cpv::benchmark::doNotOptimize(packet);
+		});
+		// json is parsed in situ so it needs a mutable copy for each iteration,
+		// the copy is included to match how request body is handled
+		cpv::SharedString buffer(json.size());
+		cpv::benchmark::measure(prefix + "json deserialize", iterations, [&] (std::size_t) {
+			std::memcpy(buffer.data(), json.data(), json.size());
+			std::vector<RecordModel> loaded;
+			auto error = cpv::deserializeJson(loaded, buffer);
+			cpv::benchmark::doNotOptimize(error);
+			cpv::benchmark::doNotOptimize(loaded);
+		});
+		cpv::benchmark::measure(prefix + "msgpack deserialize", iterations, [&] (std::size_t) {
+			std::vector<RecordModel> loaded;
+			auto error = cpv::deserializeMsgPack(loaded, msgpack);
+			cpv::benchmark::doNotOptimize(error);
+			cpv::benchmark::doNotOptimize(loaded);
+		});
+	}
+}
+
+CPV_BENCHMARK(MsgPackSerializer, compareWithJson) {
+	for (std::size_t count : { 1, 100, 10000 }) {
+		benchmarkFormats(count);
+	}
+}
+
@@ -0,0 +1,58 @@
+#include <any>
+#include <array>
+#include <CPVFramework/Allocators/StackAllocator.hpp>
+#include <CPVFramework/Container/ServiceStorage.hpp>
+#include <CPVFramework/Utility/FlatHashMap.hpp>
+#include "../../Benchmark.hpp"
+
+namespace {
+	static const constexpr std::size_t ServiceCount = 8;
+
+	/** Keys of ServiceStorage are addresses of service descriptors */
+	std::array<std::uintptr_t, ServiceCount> makeKeys() {
+		static std::array<std::uint64_t, ServiceCount * 4> descriptors;
+		std::array<std::uintptr_t, ServiceCount> keys;
+		for (std::size_t i = 0; i < ServiceCount; ++i) {
+			keys[i] = reinterpret_cast<std::uintptr_t>(&descriptors[i * 4]);
+		}
+		return keys;
+	}
+
+	/** Simulate a request: set persistent services, get them several times, then clear */
+	template <class Map>
+	void benchmarkMap(const std::string& name) {
+		auto keys = makeKeys();
+		Map map;
+		cpv::benchmark::measure(name, 1000000, [&] (std::size_t i) {
+			for (std::uintptr_t key : keys) {
+				map.insert_or_assign(key, std::any(i));
+			}
+			for (std::size_t j = 0; j < 4; ++j) {
+				for (std::uintptr_t key : keys) {
+					cpv::benchmark::doNotOptimize(map.find(key)->second);
+				}
+			}
+			map.clear();
+		});
+	}
+}
+
+CPV_BENCHMARK(FlatHashMap, serviceStorage) {
+	benchmarkMap<cpv::StackAllocatedUnorderedMap<std::uintptr_t, std::any, 16>>(
+		"8 services StackAllocatedUnorderedMap");
+	benchmarkMap<cpv::FlatHashMap<std::uintptr_t, std::any>>(
+		"8 services FlatHashMap");
+	auto keys = makeKeys();
+	cpv::ServiceStorage storage;
+	cpv::benchmark::measure("8 services ServiceStorage", 1000000, [&] (std::size_t i) {
+		for (std::uintptr_t key : keys) {
+			storage.set(key, std::any(i));
+		}
+		for (std::size_t j = 0; j < 4; ++j) {
+			for (std::uintptr_t key : keys) {
+				cpv::benchmark::doNotOptimize(storage.get(key));
+			}
+		}
+		storage.clear();
+	});
+}
@@ -0,0 +1,94 @@
+#include <list>
+#include <map>
+#include <CPVFramework/Utility/LRUCache.hpp>
+#include <CPVFramework/Utility/SharedString.hpp>
+#include <CPVFramework/Utility/SharedStringBuilder.hpp>
+#include "../../Benchmark.hpp"
+
+namespace {
+	/** The previous implementation of LRUCache (std::map + std::list), used as baseline */
+	template <
+		class Key,
+		class Value,
+		class List = std::list<std::pair<Key, Value>>,
+		class Map = std::map<Key, typename List::iterator, std::less<>>>
+	class MapListLRUCache {
+	public:
+		void set(Key&& keyForMap, Key&& keyForList, Value&& value) {
+			auto it = map_.find(keyForMap);
+			if (it != map_.end()) {
+				list_.erase(it->second);
+				map_.erase(it);
+			}
+			list_.emplace_front(std::move(keyForList), std::move(value));
+			map_.emplace(std::move(keyForMap), list_.begin());
+			if (map_.size() > maxSize_) {
+				map_.erase(list_.back().first);
+				list_.pop_back();
+			}
+		}
+
+		template <class TKey>
+		Value* get(TKey&& key) & {
+			auto it = map_.find(std::forward<TKey>(key));
+			if (it == map_.end()) {
+				return nullptr;
+			} else {
+				list_.splice(list_.begin(), list_, it->second);
+				return &it->second->second;
+			}
+		}
+
+		explicit MapListLRUCache(std::size_t maxSize) :
+			list_(), map_(), maxSize_(maxSize) { }
+
+	private:
+		List list_;
+		Map map_;
+		std::size_t maxSize_;
+	};
+
+	/** Generate file path like keys */
+	std::vector<cpv::SharedString> makeKeys(std::size_t count) {
+		std::vector<cpv::SharedString> keys;
+		for (std::size_t i = 0; i < count; ++i) {
+			keys.emplace_back(cpv::SharedStringBuilder()
+				.append("/var/www/static/assets/js/chunk-").append(i).append(".js").build());
+		}
+		return keys;
+	}
+
+	template <class Cache>
+	void benchmarkCache(std::string_view name, std::size_t count) {
+		auto keys = makeKeys(count * 2);
+		Cache cache(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			cache.set(keys[i].share(), keys[i].share(), cpv::SharedString::fromInt(i));
+		}
+		std::string prefix(name);
+		prefix.append(" (").append(std::to_string(count)).append(" entries) ");
+		cpv::benchmark::measure(prefix + "get hit", 1000000, [&] (std::size_t i) {
+			auto* value = cache.get(keys[i % count].view());
+			cpv::benchmark::doNotOptimize(value);
+		});
+		cpv::benchmark::measure(prefix + "get miss", 1000000, [&] (std::size_t i) {
+			auto* value = cache.get(keys[count + i % count].view());
+			cpv::benchmark::doNotOptimize(value);
+		});
+		cpv::benchmark::measure(prefix + "overwrite", 1000000, [&] (std::size_t i) {
+			auto& key = keys[i % count];
+			cache.set(key.share(), key.share(), cpv::SharedString::fromInt(i % 100));
+		});
+		cpv::benchmark::measure(prefix + "set with eviction", 1000000, [&] (std::size_t i) {
+			auto& key = keys[i % keys.size()];
+			cache.set(key.share(), key.share(), cpv::SharedString::fromInt(i % 100));
+		});
+	}
+}
+
+CPV_BENCHMARK(LRUCache, sharedStringKey) {
+	for (std::size_t count : { 16, 256, 4096 }) {
+		benchmarkCache<MapListLRUCache<cpv::SharedString, cpv::SharedString>>("map+list", count);
+		benchmarkCache<cpv::LRUCache<cpv::SharedString, cpv::SharedString>>("hashed", count);
+	}
+}
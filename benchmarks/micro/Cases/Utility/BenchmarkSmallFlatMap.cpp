@@ -0,0 +1,100 @@
+#include <string>
+#include <vector>
+#include <CPVFramework/Allocators/StackAllocator.hpp>
+#include <CPVFramework/Http/HttpRequest.hpp>
+#include <CPVFramework/Utility/SmallFlatMap.hpp>
+#include <CPVFramework/Utility/Uri.hpp>
+#include "../../Benchmark.hpp"
+
+namespace {
+	using EntriesType = std::vector<std::pair<cpv::SharedString, cpv::SharedString>>;
+
+	/** Copy entries to SharedString so they have reference counted buffers like parsed ones */
+	EntriesType makeEntries(std::initializer_list<std::pair<std::string_view, std::string_view>> items) {
+		EntriesType entries;
+		for (auto& item : items) {
+			entries.emplace_back(cpv::SharedString(item.first), cpv::SharedString(item.second));
+		}
+		return entries;
+	}
+
+	/** Insert entries then lookup every key (and a missing key), the map is reused after clear */
+	template <class Map>
+	void benchmarkMap(const std::string& name, std::size_t iterations, const EntriesType& entries) {
+		Map map;
+		cpv::SharedString missingKey("missing-key");
+		cpv::benchmark::measure(name, iterations, [&] (std::size_t) {
+			for (auto& entry : entries) {
+				map.insert_or_assign(entry.first.share(), entry.second.share());
+			}
+			for (auto& entry : entries) {
+				cpv::benchmark::doNotOptimize(map.find(entry.first)->second);
+			}
+			cpv::benchmark::doNotOptimize(map.find(missingKey) == map.end());
+			map.clear();
+		});
+	}
+
+	/** Compare the previous node based map with SmallFlatMap */
+	template <std::size_t InitialSize>
+	void benchmarkMaps(const std::string& name,
+		std::initializer_list<std::pair<std::string_view, std::string_view>> items) {
+		EntriesType entries = makeEntries(items);
+		benchmarkMap<cpv::StackAllocatedMap<cpv::SharedString, cpv::SharedString, InitialSize>>(
+			name + " StackAllocatedMap", 1000000, entries);
+		benchmarkMap<cpv::SmallFlatMap<cpv::SharedString, cpv::SharedString, InitialSize>>(
+			name + " SmallFlatMap", 1000000, entries);
+	}
+}
+
+CPV_BENCHMARK(SmallFlatMap, remainHeaders) {
+	// headers not in HttpRequestHeaders::FixedMembers
+	benchmarkMaps<3>("5 headers", {
+		{ "Cache-Control", "max-age=0" },
+		{ "Sec-Fetch-Site", "none" },
+		{ "Sec-Fetch-Mode", "navigate" },
+		{ "Sec-Fetch-User", "?1" },
+		{ "Sec-Fetch-Dest", "document" },
+	});
+}
+
+CPV_BENCHMARK(SmallFlatMap, queryParameters) {
+	benchmarkMaps<6>("4 query parameters", {
+		{ "page", "3" },
+		{ "sort", "comments" },
+		{ "order", "desc" },
+		{ "keyword", "seastar" },
+	});
+	cpv::SharedString uriString("/articles/today?page=3&sort=comments&order=desc&keyword=seastar");
+	cpv::Uri uri;
+	cpv::benchmark::measure("Uri::parse with 4 query parameters", 1000000, [&] (std::size_t) {
+		uri.parse(uriString);
+		cpv::benchmark::doNotOptimize(uri.getQueryParameter("sort"));
+		uri.clear();
+	});
+	// parameters from input are sorted at once, large count should not be quadratic
+	std::string manyParameters("/articles/today?");
+	for (std::size_t i = 0; i < 1000; ++i) {
+		manyParameters.append("key").append(std::to_string(1000 - i)).append("=").append(std::to_string(i)).append("&");
+	}
+	cpv::SharedString manyParametersUriString(manyParameters);
+	cpv::benchmark::measure("Uri::parse with 1000 query parameters", 2000, [&] (std::size_t) {
+		uri.parse(manyParametersUriString);
+		cpv::benchmark::doNotOptimize(uri.getQueryParameter("key1"));
+		uri.clear();
+	});
+}
+
+CPV_BENCHMARK(SmallFlatMap, cookies) {
+	benchmarkMaps<3>("3 cookies", {
+		{ "session_id", "5a0bba5a-a9a4-4ec0-8d8b-2b3a2d4a53f1" },
+		{ "theme", "dark" },
+		{ "lang", "en" },
+	});
+	cpv::SharedString cookieHeader("session_id=5a0bba5a-a9a4-4ec0-8d8b-2b3a2d4a53f1; theme=dark; lang=en");
+	cpv::benchmark::measure("HttpRequest::getCookies with 3 cookies", 1000000, [&] (std::size_t) {
+		cpv::HttpRequest request;
+		request.setHeader(cpv::constants::Cookie, cookieHeader.share());
+		cpv::benchmark::doNotOptimize(request.getCookies().get("theme"));
+	});
+}
@@ -0,0 +1,18 @@
+#!/usr/bin/env bash
+set -e
+
+BUILDDIR=../../build/cpvframework-micro-benchmarks
+
+mkdir -p ${BUILDDIR}
+cd ${BUILDDIR}
+cmake -DCMAKE_BUILD_TYPE=Release \
+	-DCMAKE_C_COMPILER=gcc-9 \
+	-DCMAKE_CXX_COMPILER=g++-9 \
+	../../benchmarks/micro
+make V=1 --jobs=$(printf "%d\n4" $(nproc) | sort -n | head -1)
+
+./CPVFrameworkMicroBenchmarks \
+	--task-quota-ms=20 \
+	--reactor-backend epoll \
+	--smp 1 \
+	"$@"
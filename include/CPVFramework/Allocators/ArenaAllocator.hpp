@@ -0,0 +1,169 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include "../Utility/Macros.hpp"
+#include "../Utility/SharedString.hpp"
+
+namespace cpv {
+	/**
+	 * Bump pointer memory arena, memory allocated from it is released all at once by reset().
+	 *
+	 * It's designed for per request allocations (see HttpContext::getArena), the first block is
+	 * kept after reset so the following requests on the same connection don't touch the global
+	 * allocator unless they need more than one block.
+	 *
+	 * Notice:
+	 * Destructors of objects placed in arena memory are not invoked by reset(),
+	 * and memory from arena must not be used after reset() or destruction,
+	 * except strings from allocateString and copyString, see allocateString.
+	 */
+	class Arena {
+	public:
+		/** The default size of each memory block */
+		static const constexpr std::size_t DefaultBlockSize = 4096;
+
+		/** Allocate memory with given size and alignment */
+		CPV_INLINE void* allocate(std::size_t size, std::size_t alignment) {
+			void* ptr = ptr_;
+			std::size_t space = end_ - ptr_;
+			if (CPV_LIKELY(ptr != nullptr && std::align(alignment, size, ptr, space) != nullptr)) {
+				ptr_ = static_cast<char*>(ptr) + size;
+				return ptr;
+			}
+			return allocateFromNewBlock(size, alignment);
+		}
+
+		/** Allocate memory for n objects of T, the objects are not constructed */
+		template <class T>
+		CPV_INLINE T* allocate(std::size_t n) {
+			return static_cast<T*>(allocate(sizeof(T) * n, alignof(T)));
+		}
+
+		/**
+		 * Allocate string from arena, the string holds a reference to the memory blocks,
+		 * if any string (include shared ones) is alive when reset() or destruction,
+		 * the blocks are handed over and released after the last string is released,
+		 * so the string can be used as response body which may be kept by network stack
+		 * until it's acknowledged.
+		 */
+		SharedString allocateString(std::size_t size) {
+			char* ptr = allocate<char>(size);
+			return SharedString(ptr, size, shareBlocks());
+		}
+
+		/** Copy string to arena, see allocateString */
+		SharedString copyString(std::string_view str) {
+			SharedString result = allocateString(str.size());
+			std::memcpy(result.data(), str.data(), str.size());
+			return result;
+		}
+
+		/** Release all allocated memory, the first block is kept for reuse */
+		void reset();
+
+		/** Get the number of memory blocks allocated from global allocator */
+		std::size_t blockCount() const { return blockCount_; }
+
+		/** Constructor, no memory is allocated until first allocation */
+		explicit Arena(std::size_t blockSize = DefaultBlockSize);
+
+		/** Destructor */
+		~Arena();
+
+		/** Move constructor */
+		Arena(Arena&& other) noexcept;
+
+		/** Move assignment */
+		Arena& operator=(Arena&& other) noexcept;
+
+		/** Disallow copy */
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+	private:
+		/** Header of memory block, the usable memory follows it */
+		struct Block {
+			Block* previous;
+			std::size_t size;
+		};
+
+		/** Deleter shared by strings, owns the blocks handed over from arena */
+		class BlockOwner;
+
+		void* allocateFromNewBlock(std::size_t size, std::size_t alignment);
+		void freeBlocks(Block* until);
+		seastar::deleter shareBlocks();
+		void handOverBlocks();
+
+	private:
+		Block* block_;
+		char* ptr_;
+		char* end_;
+		std::size_t blockSize_;
+		std::size_t blockCount_;
+		BlockOwner* blockOwner_;
+		seastar::deleter blockOwnerDeleter_;
+	};
+
+	/**
+	 * Allocator that allocates memory from arena, deallocate is a no-op for arena memory.
+	 * Default constructed allocator doesn't bind to any arena and forwards to std::allocator.
+	 *
+	 * It can be used directly with STL containers, or as upstream allocator of
+	 * StackAllocatedVector and StackAllocatedMap, for example:
+	 * ```
+	 * using VectorType = StackAllocatedVector<int, 4, ArenaAllocator<int>>;
+	 * VectorType vec(ArenaAllocator<int>(context.getArena()));
+	 * ```
+	 */
+	template <class T>
+	class ArenaAllocator {
+	public:
+		using value_type = T;
+
+		/** Allocate memory */
+		T* allocate(std::size_t n) {
+			if (CPV_LIKELY(arena_ != nullptr)) {
+				return arena_->template allocate<T>(n);
+			}
+			return std::allocator<T>().allocate(n);
+		}
+
+		/** Deallocate memory, memory from arena is released by Arena::reset */
+		void deallocate(T* ptr, std::size_t n) {
+			if (CPV_UNLIKELY(arena_ == nullptr)) {
+				std::allocator<T>().deallocate(ptr, n);
+			}
+		}
+
+		/** Get the arena bound to this allocator, may return nullptr */
+		Arena* arena() const { return arena_; }
+
+		/** Copy constructor for rebind */
+		template <class U>
+		// cppcheck-suppress noExplicitConstructor
+		ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) { }
+
+		/** Constructor with arena */
+		explicit ArenaAllocator(Arena& arena) : arena_(&arena) { }
+
+		/** Constructor without arena */
+		ArenaAllocator() : arena_(nullptr) { }
+
+	private:
+		Arena* arena_;
+	};
+
+	/** Compare ArenaAllocator, equal if they bound to the same arena */
+	template <class T, class U>
+	bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+		return a.arena() == b.arena();
+	}
+	template <class T, class U>
+	bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+		return a.arena() != b.arena();
+	}
+}
+
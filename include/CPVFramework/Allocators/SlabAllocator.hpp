@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <seastar/core/temporary_buffer.hh>
+
+namespace cpv {
+	/**
+	 * Shard local slab allocator for string buffers (used by SharedString).
+	 *
+	 * Sizes from MinBlockSize to MaxBlockSize are rounded up to power of two size classes,
+	 * each block contains the reference counted deleter in its header, so no additional
+	 * allocation is required for the deleter, and the block is returned to the free list
+	 * of its size class when the last reference released.
+	 * Larger sizes are allocated from malloc directly.
+	 *
+	 * Notice:
+	 * Blocks released on other threads (shards) are freed instead of put to the free list,
+	 * the free list of each size class is limited by MaxFreeBytesPerSizeClass.
+	 */
+	class SlabAllocator {
+	public:
+		/** The size of the smallest size class */
+		static const constexpr std::size_t MinBlockSize = 16;
+		/** The size of the largest size class */
+		static const constexpr std::size_t MaxBlockSize = 4096;
+		/** The number of size classes (16, 32, ..., 4096) */
+		static const constexpr std::size_t SizeClassCount = 9;
+		/** The max total size of free blocks kept for each size class */
+		static const constexpr std::size_t MaxFreeBytesPerSizeClass = 262144;
+
+		/**
+		 * Allocate memory with given size in bytes, the memory is aligned to 16 bytes,
+		 * deleter is set to the deleter that releases the memory.
+		 */
+		static void* allocate(std::size_t size, seastar::deleter& deleter);
+
+		/** Get the number of free blocks of current thread, for diagnostic */
+		static std::size_t freeBlockCount();
+	};
+}
+
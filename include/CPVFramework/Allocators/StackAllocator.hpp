@@ -1,6 +1,7 @@
 #pragma once
 #include <memory>
 #include <array>
+#include <cstdint>
 #include <type_traits>
 #include <vector>
 #include <map>
@@ -117,6 +118,11 @@ namespace cpv {
 			}
 		}
 		
+		/** Get the upstream allocator, used to propagate it to copied containers */
+		const UpstreamAllocator& upstream() const {
+			return *this;
+		}
+		
 		/** Copy constructor for rebind */
 		template <class U, class UUpstreamAllocator>
 		StackAllocator(const StackAllocator<U, Size, UUpstreamAllocator>& other) :
@@ -133,6 +139,10 @@ namespace cpv {
 		explicit StackAllocator(StackAllocatorStorage<Size>& storage) :
 			storage_(storage) { }
 		
+		/** Constructor with stateful upstream allocator (e.g. ArenaAllocator) */
+		StackAllocator(StackAllocatorStorage<Size>& storage, const UpstreamAllocator& upstream) :
+			UpstreamAllocator(upstream), storage_(storage) { }
+		
 	private:
 		template <class U, std::size_t USize, class UUpstreamAllocator>
 		friend class StackAllocator;
@@ -170,21 +180,28 @@ namespace cpv {
 		public std::vector<T, Allocator> {
 	private:
 		using Storage = StackAllocatorStorage<Size>;
+		using UpstreamAllocatorTrait = std::allocator_traits<UpstreamAllocator>;
 		using Base = std::vector<T, Allocator>;
 	public:
 		StackAllocatedVector() :
 			Storage(), Base(Allocator(*this)) {
 			this->reserve(InitialSize);
 		}
+		explicit StackAllocatedVector(const UpstreamAllocator& upstream) :
+			Storage(), Base(Allocator(*this, upstream)) {
+			this->reserve(InitialSize);
+		}
 		StackAllocatedVector(const StackAllocatedVector& other) :
-			Storage(), Base(Allocator(*this)) {
+			Storage(), Base(Allocator(*this,
+				UpstreamAllocatorTrait::select_on_container_copy_construction(
+					other.get_allocator().upstream()))) {
 			this->reserve(std::max(InitialSize, other.size()));
 			for (auto& item : other) {
 				this->emplace_back(item);
 			}
 		}
 		StackAllocatedVector(StackAllocatedVector&& other) :
-			Storage(), Base(Allocator(*this)) {
+			Storage(), Base(Allocator(*this, other.get_allocator().upstream())) {
 			this->reserve(std::max(InitialSize, other.size()));
 			for (auto& item : other) {
 				this->emplace_back(std::move(item));
@@ -226,21 +243,28 @@ namespace cpv {
 		public std::unordered_map<Key, T, Hash, KeyEqual, Allocator> {
 	private:
 		using Storage = StackAllocatorStorage<Size>;
+		using UpstreamAllocatorTrait = std::allocator_traits<UpstreamAllocator>;
 		using Base = std::unordered_map<Key, T, Hash, KeyEqual, Allocator>;
 	public:
 		StackAllocatedUnorderedMap() :
 			Storage(), Base(Allocator(*this)) {
 			this->reserve(InitialSize);
 		}
+		explicit StackAllocatedUnorderedMap(const UpstreamAllocator& upstream) :
+			Storage(), Base(Allocator(*this, upstream)) {
+			this->reserve(InitialSize);
+		}
 		StackAllocatedUnorderedMap(const StackAllocatedUnorderedMap& other) :
-			Storage(), Base(Allocator(*this)) {
+			Storage(), Base(Allocator(*this,
+				UpstreamAllocatorTrait::select_on_container_copy_construction(
+					other.get_allocator().upstream()))) {
 			this->reserve(std::max(InitialSize, other.size()));
 			for (auto& item : other) {
 				this->emplace(item);
 			}
 		}
 		StackAllocatedUnorderedMap(StackAllocatedUnorderedMap&& other) :
-			Storage(), Base(Allocator(*this)) {
+			Storage(), Base(Allocator(*this, other.get_allocator().upstream())) {
 			this->reserve(std::max(InitialSize, other.size()));
 			for (auto& item : other) {
 				this->emplace(std::move(item));
@@ -269,7 +293,7 @@ namespace cpv {
 				return;
 			}
 			// release hashtable to make allocated count in storage reach 0
-			Base empty(Allocator(*this));
+			Base empty(Allocator(*this, this->get_allocator().upstream()));
 			Base::operator=(std::move(empty));
 			this->reserve(InitialSize);
 		}
@@ -291,18 +315,23 @@ namespace cpv {
 		public std::map<Key, T, Compare, Allocator> {
 	private:
 		using Storage = StackAllocatorStorage<Size>;
+		using UpstreamAllocatorTrait = std::allocator_traits<UpstreamAllocator>;
 		using Base = std::map<Key, T, Compare, Allocator>;
 	public:
 		StackAllocatedMap() :
 			Storage(), Base(Allocator(*this)) { }
+		explicit StackAllocatedMap(const UpstreamAllocator& upstream) :
+			Storage(), Base(Allocator(*this, upstream)) { }
 		StackAllocatedMap(const StackAllocatedMap& other) :
-			Storage(), Base(Allocator(*this)) {
+			Storage(), Base(Allocator(*this,
+				UpstreamAllocatorTrait::select_on_container_copy_construction(
+					other.get_allocator().upstream()))) {
 			for (auto& item : other) {
 				this->emplace(item);
 			}
 		}
 		StackAllocatedMap(StackAllocatedMap&& other) :
-			Storage(), Base(Allocator(*this)) {
+			Storage(), Base(Allocator(*this, other.get_allocator().upstream())) {
 			for (auto& item : other) {
 				this->emplace(std::move(item));
 			}
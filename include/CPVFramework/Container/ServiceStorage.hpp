@@ -1,6 +1,6 @@
 #pragma once
 #include <any>
-#include "../Allocators/StackAllocator.hpp"
+#include "../Utility/FlatHashMap.hpp"
 
 namespace cpv {
 	/** The storage used to store instance of services with ServiceLifetime::StoragePersistent */
@@ -16,8 +16,11 @@ namespace cpv {
 		void clear();
         
 	private:
-		/** Store service instances with lifetime StoragePersistent, key is pointer of descriptor */
-		StackAllocatedUnorderedMap<std::uintptr_t, std::any, 16> instances_;
+		/**
+		 * Store service instances with lifetime StoragePersistent, key is pointer of descriptor,
+		 * the memory is kept after clear so reused storage (e.g. per request) won't allocate again.
+		 */
+		FlatHashMap<std::uintptr_t, std::any> instances_;
 	};
 }
 
@@ -193,6 +193,9 @@ namespace cpv::constants {
 	static const constexpr char Close[] = "close";
 	static const constexpr char TextPlainUtf8[] = "text/plain;charset=utf-8";
 	static const constexpr char ApplicationJsonUtf8[] = "application/json;charset=utf-8";
+	static const constexpr char ApplicationJson[] = "application/json";
+	static const constexpr char ApplicationMsgPack[] = "application/msgpack";
+	static const constexpr char MultipartFormData[] = "multipart/form-data";
 
 	// reduce fragments for common headers
 	namespace with_crlf_colonspace {
@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include "../Allocators/StackAllocator.hpp"
 #include "../Utility/Packet.hpp"
 
@@ -16,13 +17,18 @@ namespace cpv {
 	 * Duplicated form parameter is supported, you can use getMany() to get all values,
 	 * or use get() to get the first value.
 	 * For performance reason, form parser will ignore all errors.
+	 * Parameters are stored in a vector sorted by key (values of the same key keep their order),
+	 * parsing a typical form with less than InitialParameters keys doesn't allocate memory
+	 * unless some keys or values require decoding.
 	 *
 	 * TODO: add parseMultipart and buildMultipart, may require layout change for files.
 	 */
 	class HttpForm {
 	public:
+		static const constexpr std::size_t InitialParameters = 24;
 		using ValuesType = StackAllocatedVector<SharedString, 1>;
-		using FormParametersType = StackAllocatedMap<SharedString, ValuesType, 8>;
+		using FormParameterType = std::pair<SharedString, ValuesType>;
+		using FormParametersType = StackAllocatedVector<FormParameterType, InitialParameters>;
 
 		/** Get all values */
 		const FormParametersType& getAll() const& { return formParameters_; }
@@ -33,7 +39,7 @@ namespace cpv {
 		 * return empty if key not exists.
 		 */
 		SharedString get(const SharedString& key) const {
-			auto it = formParameters_.find(key);
+			auto it = find(key);
 			if (it != formParameters_.end() && !it->second.empty()) {
 				return it->second.front().share();
 			}
@@ -45,7 +51,7 @@ namespace cpv {
 		 * return a static empty vector if key not exists.
 		 */
 		const ValuesType& getMany(const SharedString& key) const& {
-			auto it = formParameters_.find(key);
+			auto it = find(key);
 			return (it != formParameters_.end()) ? it->second : Empty;
 		}
 
@@ -54,12 +60,19 @@ namespace cpv {
 		 * Call it multiple times can associate multiple values with the same key.
 		 */
 		void add(SharedString&& key, SharedString&& value) {
-			formParameters_[std::move(key)].emplace_back(std::move(value));
+			auto it = lowerBound(formParameters_, key);
+			if (it == formParameters_.end() || it->first != key) {
+				it = formParameters_.emplace(it, std::move(key), ValuesType());
+			}
+			it->second.emplace_back(std::move(value));
 		}
 
 		/** Remove values associated with given key */
 		void remove(const SharedString& key) {
-			formParameters_.erase(key);
+			auto it = find(key);
+			if (it != formParameters_.end()) {
+				formParameters_.erase(it);
+			}
 		}
 
 		/** Remove all values */
@@ -81,6 +94,23 @@ namespace cpv {
 			parseUrlEncoded(body);
 		}
 
+	private:
+		/** Find the first parameter with key not less than given key */
+		template <class Parameters>
+		static auto lowerBound(Parameters& parameters, const SharedString& key) ->
+			decltype(parameters.begin()) {
+			return std::lower_bound(parameters.begin(), parameters.end(), key,
+				[] (const FormParameterType& parameter, const SharedString& key) {
+					return parameter.first < key;
+				});
+		}
+
+		/** Find the parameter with given key, return end if not exists */
+		FormParametersType::const_iterator find(const SharedString& key) const {
+			auto it = lowerBound(formParameters_, key);
+			return (it != formParameters_.end() && it->first == key) ? it : formParameters_.end();
+		}
+
 	private:
 		static const ValuesType Empty;
 
@@ -0,0 +1,121 @@
+#pragma once
+#include <functional>
+#include "../Utility/SharedString.hpp"
+#include "../Utility/SharedStringBuilder.hpp"
+
+namespace cpv {
+	/** Headers of a part in multipart/form-data body */
+	struct HttpMultipartPartHeaders {
+		/** The name parameter of Content-Disposition */
+		SharedString name;
+		/** The filename parameter of Content-Disposition */
+		SharedString filename;
+		/** The Content-Type header of part, empty if not provided */
+		SharedString contentType;
+		/** Whether filename parameter exists (it may be empty if no file selected) */
+		bool isFile = false;
+	};
+
+	/** Event returned by HttpMultipartParser::next() */
+	enum class HttpMultipartEvent {
+		/** All data fed is parsed, call feed() or finish() */
+		NeedMoreData,
+		/** Headers of next part are parsed, see part() */
+		PartBegin,
+		/** Part of data of current part is parsed, see data() */
+		PartData,
+		/** Current part is ended */
+		PartEnd,
+		/** The close delimiter is parsed and body is ended */
+		End
+	};
+
+	/**
+	 * Incremental (pull) parser for multipart/form-data body, body can be fed chunk by chunk.
+	 *
+	 * Delimiters are searched by boyer moore horspool algorithm, only the tail of chunk that
+	 * may be the beginning of a delimiter is buffered, other data of parts share the storage
+	 * of chunks, so the memory usage doesn't depend on the size of parts.
+	 * DeserializeException will be thrown if body is invalid or exceeds the limits.
+	 *
+	 * Example:
+	 * ```
+	 * HttpMultipartParser parser(boundary);
+	 * parser.feed(chunk);
+	 * for (auto event = parser.next(); event != HttpMultipartEvent::NeedMoreData; event = parser.next()) {
+	 *     // handle event
+	 * }
+	 * ```
+	 */
+	class HttpMultipartParser {
+	public:
+		/** The default max size of headers of a single part */
+		static const constexpr std::size_t DefaultMaxHeaderSize = 8192;
+		/** The max size of boundary defined by rfc 2046 */
+		static const constexpr std::size_t MaxBoundarySize = 70;
+
+		/** Append next chunk of body, should only call it after next() returns NeedMoreData */
+		void feed(SharedString&& chunk);
+
+		/** Notify the body is ended, next() will throw exception if body is incomplete */
+		void finish();
+
+		/** Parse until next event */
+		HttpMultipartEvent next();
+
+		/** Get headers of current part, available after PartBegin */
+		const HttpMultipartPartHeaders& part() const& { return part_; }
+
+		/** Get data of current part, available after PartData, move it out if you want to keep it */
+		SharedString& data() & { return data_; }
+
+		/**
+		 * Get boundary from Content-Type header,
+		 * return empty if it's not multipart/form-data or boundary is invalid.
+		 */
+		static SharedString getBoundary(const SharedString& contentType);
+
+		/** Constructor */
+		explicit HttpMultipartParser(
+			std::string_view boundary,
+			std::size_t maxHeaderSize = DefaultMaxHeaderSize);
+
+		/** Disallow copy and move, the searcher refers to the storage of delimiter */
+		HttpMultipartParser(const HttpMultipartParser&) = delete;
+		HttpMultipartParser& operator=(const HttpMultipartParser&) = delete;
+
+	private:
+		/** What the parser expects next */
+		enum class State {
+			Preamble,
+			Body,
+			DelimiterSuffix,
+			DelimiterLF,
+			CloseDelimiter,
+			Headers,
+			Epilogue
+		};
+
+		bool parseBody();
+		void parseDelimiterSuffix();
+		bool parseHeaders();
+		void parsePartHeaders(SharedString&& headers);
+		[[noreturn]] void throwError(const char* message) const;
+
+	private:
+		SharedString delimiter_;
+		std::boyer_moore_horspool_searcher<const char*> searcher_;
+		std::size_t maxHeaderSize_;
+		State state_;
+		bool isInPart_;
+		bool isFinished_;
+		std::size_t parsedSize_;
+		SharedString chunk_;
+		const char* ptr_;
+		SharedStringBuilder carry_;
+		SharedStringBuilder headers_;
+		HttpMultipartPartHeaders part_;
+		SharedString data_;
+	};
+}
+
@@ -0,0 +1,87 @@
+#pragma once
+#include <limits>
+#include <seastar/core/future-util.hh>
+#include "../Stream/InputStreamBase.hpp"
+#include "./HttpMultipartParser.hpp"
+
+namespace cpv {
+	/**
+	 * Read parts of multipart/form-data body from input stream one by one,
+	 * data of each part can be read from partStream() chunk by chunk without buffering the whole part.
+	 * DeserializeException will be thrown if body is invalid or the size of part exceeds maxPartSize.
+	 *
+	 * Notice:
+	 * Must keep the input stream alive until the reader destroyed,
+	 * the part stream is invalidated after calling nextPart().
+	 *
+	 * Example:
+	 * ```
+	 * seastar::repeat([&reader] {
+	 *     return reader.nextPart().then([&reader] (bool hasPart) {
+	 *         if (!hasPart) {
+	 *             return seastar::make_ready_future<seastar::stop_iteration>(seastar::stop_iteration::yes);
+	 *         }
+	 *         // read data from reader.partStream()
+	 *     });
+	 * });
+	 * ```
+	 */
+	class HttpMultipartReader {
+	public:
+		/**
+		 * Move to next part, remaining data of current part will be skipped,
+		 * return false if there are no more parts.
+		 */
+		seastar::future<bool> nextPart();
+
+		/** Get headers of current part */
+		const HttpMultipartPartHeaders& part() const& { return parser_.part(); }
+
+		/** Get the input stream for data of current part */
+		InputStreamBase& partStream() & { return partStream_; }
+
+		/** Set the max size of current part, it can be changed before reading data of part */
+		void setMaxPartSize(std::size_t maxPartSize) { maxPartSize_ = maxPartSize; }
+
+		/** Constructor */
+		HttpMultipartReader(
+			InputStreamBase& stream,
+			std::string_view boundary,
+			std::size_t maxPartSize = std::numeric_limits<std::size_t>::max(),
+			std::size_t maxHeaderSize = HttpMultipartParser::DefaultMaxHeaderSize);
+
+		/** Disallow copy and move, part stream refers to this reader */
+		HttpMultipartReader(const HttpMultipartReader&) = delete;
+		HttpMultipartReader& operator=(const HttpMultipartReader&) = delete;
+
+	private:
+		/** Input stream for data of current part */
+		class PartInputStream : public InputStreamBase {
+		public:
+			/** Read data of current part */
+			seastar::future<InputStreamReadResult> read() override;
+
+			/** Constructor */
+			explicit PartInputStream(HttpMultipartReader& reader) : reader_(reader) { }
+
+		private:
+			HttpMultipartReader& reader_;
+		};
+
+		/** Parse next event, read more data from stream if required */
+		seastar::future<HttpMultipartEvent> nextEvent();
+
+		/** Read data of current part, isEnd is true if part is ended */
+		seastar::future<InputStreamReadResult> readPart();
+
+	private:
+		InputStreamBase& stream_;
+		HttpMultipartParser parser_;
+		PartInputStream partStream_;
+		std::size_t maxPartSize_;
+		std::size_t partSize_;
+		bool isInPart_;
+		bool isEnd_;
+	};
+}
+
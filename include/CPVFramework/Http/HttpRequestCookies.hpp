@@ -1,6 +1,6 @@
 #pragma once
-#include "../Allocators/StackAllocator.hpp"
 #include "../Utility/SharedString.hpp"
+#include "../Utility/SmallFlatMap.hpp"
 
 namespace cpv {
 	/**
@@ -10,7 +10,7 @@ namespace cpv {
 	 */
 	class HttpRequestCookies {
 	public:
-		using CookiesType = StackAllocatedMap<SharedString, SharedString, 3>;
+		using CookiesType = SmallFlatMap<SharedString, SharedString, 3>;
 		
 		/** Get cookie value for given key, return empty string if key not exists */
 		SharedString get(const SharedString& key) const;
@@ -1,9 +1,14 @@
 #pragma once
+#include "./HttpConstantStrings.hpp"
+#include "./HttpMultipartReader.hpp"
 #include "./HttpRequest.hpp"
 #include "../Serialize/FormDeserializer.hpp"
 #include "../Serialize/JsonDeserializer.hpp"
+#include "../Serialize/JsonStreamParser.hpp"
+#include "../Serialize/MsgPackDeserializer.hpp"
 #include "../Stream/InputStreamExtensions.hpp"
 #include "../Utility/ObjectTrait.hpp"
+#include "../Utility/StringUtils.hpp"
 
 namespace cpv::extensions {
 	/** Read all data from request body stream and return as string */
@@ -25,11 +30,146 @@ namespace cpv::extensions {
 		});
 	}
 
-	/** Read form body from request body stream and convert to model */
+	/** Read msgpack from request body stream and convert to model */
+	template <class T>
+	seastar::future<T> readBodyStreamAsMsgPack(const HttpRequest& request) {
+		return readBodyStream(request).then([] (SharedString str) {
+			T model;
+			auto error = deserializeMsgPack(model, str);
+			if (CPV_UNLIKELY(error.has_value())) {
+				return seastar::make_exception_future<T>(*error);
+			}
+			return seastar::make_ready_future<T>(std::move(model));
+		});
+	}
+
+	/** Check whether the content type of request body is msgpack */
+	static inline bool isMsgPackContent(const HttpRequest& request) {
+		std::string_view contentType = request.getHeaders().getContentType().view();
+		// ignore parameters like "; charset=utf-8"
+		contentType = trimString(contentType.substr(0, contentType.find_first_of(';')));
+		return caseInsensitiveEquals(contentType, constants::ApplicationMsgPack) ||
+			caseInsensitiveEquals(contentType, "application/x-msgpack");
+	}
+
+	/**
+	 * Read request body and convert to model, the format is selected by Content-Type,
+	 * msgpack for application/msgpack (or application/x-msgpack), json for others.
+	 */
+	template <class T>
+	seastar::future<T> readBodyStreamAsModel(const HttpRequest& request) {
+		if (isMsgPackContent(request)) {
+			return readBodyStreamAsMsgPack<T>(request);
+		}
+		return readBodyStreamAsJson<T>(request);
+	}
+
+	/**
+	 * Read json array from request body stream and convert items to model one by one,
+	 * func will be invoked with each model and should return seastar::future<>,
+	 * the body is parsed chunk by chunk so it's suitable for large payloads.
+	 */
+	template <class T, class Func>
+	seastar::future<> readBodyStreamAsJsonItems(
+		const HttpRequest& request,
+		Func&& func,
+		std::size_t maxItemSize = JsonItemsCollector::DefaultMaxItemSize) {
+		auto& stream = request.getBodyStream();
+		if (CPV_UNLIKELY(stream.get() == nullptr)) {
+			return seastar::make_exception_future<>(
+				DeserializeException(CPV_CODEINFO, "request body stream is empty"));
+		}
+		return deserializeJsonItemsFromStream<T>(*stream.get(), std::forward<Func>(func), maxItemSize);
+	}
+
+	/** The default max size of a non-file field in multipart form */
+	static const constexpr std::size_t DefaultMaxMultipartFieldSize = 1048576;
+
+	/**
+	 * Read multipart/form-data body part by part, non-file fields are added to form,
+	 * fileFunc(const HttpMultipartPartHeaders&, InputStreamBase&) will be invoked for each file part
+	 * and should return seastar::future<>, data of file not read by fileFunc will be skipped.
+	 * The size of each field and each file are limited by maxFieldSize and maxFileSize,
+	 * DeserializeException will be thrown if body is invalid or exceeds the limits.
+	 * Must keep the form alive until future resolved.
+	 *
+	 * Example (save files to disk):
+	 * ```
+	 * readBodyStreamAsMultipartForm(request, form, [] (auto& part, auto& stream) {
+	 *     return writeAllToFile(stream, makeUploadPath(part.filename)).discard_result();
+	 * });
+	 * ```
+	 */
+	template <class Func>
+	seastar::future<> readBodyStreamAsMultipartForm(
+		const HttpRequest& request,
+		HttpForm& form,
+		Func&& fileFunc,
+		std::size_t maxFieldSize = DefaultMaxMultipartFieldSize,
+		std::size_t maxFileSize = std::numeric_limits<std::size_t>::max()) {
+		auto& stream = request.getBodyStream();
+		if (CPV_UNLIKELY(stream.get() == nullptr)) {
+			return seastar::make_exception_future<>(
+				DeserializeException(CPV_CODEINFO, "request body stream is empty"));
+		}
+		SharedString boundary = HttpMultipartParser::getBoundary(request.getHeaders().getContentType());
+		if (CPV_UNLIKELY(boundary.empty())) {
+			return seastar::make_exception_future<>(DeserializeException(CPV_CODEINFO,
+				"request content type isn't multipart/form-data or boundary is invalid"));
+		}
+		return seastar::do_with(
+			std::make_unique<HttpMultipartReader>(*stream.get(), boundary.view()),
+			std::forward<Func>(fileFunc),
+			[&form, maxFieldSize, maxFileSize] (auto& reader, auto& fileFunc) {
+			return seastar::repeat([&form, &reader, &fileFunc, maxFieldSize, maxFileSize] {
+				return reader->nextPart().then([&form, &reader, &fileFunc, maxFieldSize, maxFileSize]
+					(bool hasPart) {
+					if (!hasPart) {
+						return seastar::make_ready_future<seastar::stop_iteration>(
+							seastar::stop_iteration::yes);
+					}
+					if (reader->part().isFile) {
+						reader->setMaxPartSize(maxFileSize);
+						return fileFunc(reader->part(), reader->partStream()).then([] {
+							return seastar::stop_iteration::no;
+						});
+					}
+					reader->setMaxPartSize(maxFieldSize);
+					return readAll(reader->partStream()).then([&form, &reader] (SharedString value) {
+						form.add(reader->part().name.share(), std::move(value));
+						return seastar::stop_iteration::no;
+					});
+				});
+			});
+		});
+	}
+
+	/** Check whether the content type of request is multipart/form-data */
+	static inline bool isMultipartFormContent(const HttpRequest& request) {
+		std::string_view contentType = request.getHeaders().getContentType().view();
+		contentType = trimString(contentType.substr(0, contentType.find_first_of(';')));
+		return caseInsensitiveEquals(contentType, constants::MultipartFormData);
+	}
+
+	/**
+	 * Read form body from request body stream and convert to model,
+	 * both url encoded and multipart form are supported, files in multipart form are skipped,
+	 * use readBodyStreamAsMultipartForm if you want to handle files.
+	 */
 	template <class T>
 	seastar::future<T> readBodyStreamAsForm(const HttpRequest& request) {
+		if (isMultipartFormContent(request)) {
+			return seastar::do_with(HttpForm(), [&request] (auto& form) {
+				return readBodyStreamAsMultipartForm(request, form, [] (auto&, auto&) {
+					return seastar::make_ready_future<>();
+				}).then([&form] {
+					T model;
+					deserializeForm(model, form);
+					return model;
+				});
+			});
+		}
 		return readBodyStream(request).then([] (SharedString str) {
-			// TODO: support multiple part form
 			T model;
 			deserializeForm(model, str);
 			return model;
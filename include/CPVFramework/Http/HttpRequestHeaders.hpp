@@ -1,6 +1,6 @@
 #pragma once
-#include "../Allocators/StackAllocator.hpp"
 #include "../Utility/SharedString.hpp"
+#include "../Utility/SmallFlatMap.hpp"
 #include "../Utility/Packet.hpp"
 #include "./HttpConstantStrings.hpp"
 
@@ -66,6 +66,15 @@ namespace cpv {
 		/** Set header value */
 		void setHeader(SharedString&& key, SharedString&& value);
 		
+		/**
+		 * Append header value without checking duplicated key (for http parser),
+		 * sortHeaders must be called after all headers are appended.
+		 */
+		void appendHeader(SharedString&& key, SharedString&& value);
+		
+		/** Sort headers added by appendHeader, the last value is kept for duplicated keys */
+		void sortHeaders();
+		
 		/** Get header value, return empty string if key not exists */
 		SharedString getHeader(const SharedString& key) const;
 		
@@ -92,7 +101,7 @@ namespace cpv {
 		friend class HttpRequestData;
 		
 	private:
-		StackAllocatedMap<SharedString, SharedString, 3> remainHeaders_;
+		SmallFlatMap<SharedString, SharedString, 3> remainHeaders_;
 		SharedString host_;
 		SharedString contentType_;
 		SharedString contentLength_;
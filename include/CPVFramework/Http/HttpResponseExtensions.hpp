@@ -1,9 +1,14 @@
 #pragma once
 #include <ctime>
 #include <optional>
+#include "../Serialize/JsonStreamSerializer.hpp"
+#include "../Serialize/MsgPackSerializer.hpp"
+#include "../Stream/ChunkedOutputStream.hpp"
 #include "../Stream/OutputStreamExtensions.hpp"
+#include "../Utility/HttpUtils.hpp"
 #include "../Utility/StringUtils.hpp"
 #include "../Utility/SharedString.hpp"
+#include "./HttpRequest.hpp"
 #include "./HttpResponse.hpp"
 
 namespace cpv::extensions {
@@ -36,6 +41,57 @@ namespace cpv::extensions {
 		return reply(response, std::forward<T>(text), constants::TextPlainUtf8);
 	}
 
+	/**
+	 * Reply json serialized from model with chunked transfer encoding,
+	 * the json is written by parts (see JsonStreamSerializer) so the memory usage is bounded,
+	 * must keep model alive until future resolved.
+	 */
+	template <class T>
+	seastar::future<> replyJsonByChunks(
+		HttpResponse& response,
+		const T& model,
+		std::size_t flushThreshold = JsonStreamSerializer<T>::DefaultFlushThreshold) {
+		auto& headers = response.getHeaders();
+		response.setStatusCode(constants::_200);
+		response.setStatusMessage(constants::OK);
+		headers.setContentType(constants::ApplicationJsonUtf8);
+		headers.setTransferEncoding(constants::Chunked);
+		return seastar::do_with(
+			makeReusable<ChunkedOutputStream>(response.getBodyStream().get()),
+			[&model, flushThreshold] (auto& stream) {
+			return serializeJsonToStream(*stream, model, flushThreshold).then([&stream] {
+				return stream->writeEnd();
+			});
+		});
+	}
+
+	/** Reply json serialized from model to http response in once */
+	template <class T>
+	seastar::future<> replyJson(HttpResponse& response, const T& model) {
+		return reply(response, serializeJson(model), constants::ApplicationJsonUtf8);
+	}
+
+	/** Reply msgpack serialized from model to http response in once */
+	template <class T>
+	seastar::future<> replyMsgPack(HttpResponse& response, const T& model) {
+		return reply(response, serializeMsgPack(model), constants::ApplicationMsgPack);
+	}
+
+	/**
+	 * Reply model serialized by the format selected from Accept header of request,
+	 * msgpack if client prefers application/msgpack over application/json, otherwise json.
+	 */
+	template <class T>
+	seastar::future<> replyModel(const HttpRequest& request, HttpResponse& response, const T& model) {
+		std::string_view accept = request.getHeaders().getAccept().view();
+		if (!accept.empty() &&
+			getAcceptMimeTypeQuality(accept, constants::ApplicationMsgPack) >
+			getAcceptMimeTypeQuality(accept, constants::ApplicationJson)) {
+			return replyMsgPack(response, model);
+		}
+		return replyJson(response, model);
+	}
+
 	/** Reply 302 Found with given location to http response */
 	seastar::future<> redirectTo(HttpResponse& response, SharedString&& location);
 
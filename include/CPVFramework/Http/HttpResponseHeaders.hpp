@@ -1,7 +1,7 @@
 #pragma once
 #include <utility>
-#include "../Allocators/StackAllocator.hpp"
 #include "../Utility/SharedString.hpp"
+#include "../Utility/SmallFlatMap.hpp"
 #include "../Utility/Packet.hpp"
 #include "./HttpConstantStrings.hpp"
 
@@ -65,7 +65,30 @@ namespace cpv {
 		 * Append all headers to packet fragments for http 1.
 		 * notice it will append crlf to begin but not to end.
 		 */
-		void appendToHttp1Packet(Packet::MultipleFragments& fragments);
+		void appendToHttp1Packet(Packet::MultipleFragments& fragments) const;
+		
+		/**
+		 * Render all headers to a single block for http 1, the format is same as appendToHttp1Packet.
+		 * The block can be built once per route or per handler and set to each response by
+		 * setHttp1HeadersBlock, to avoid encoding the headers that never change for every response.
+		 * Notice the headers are moved into the block (merged with the existing block),
+		 * so calling it again returns the same block and won't duplicate headers.
+		 */
+		SharedString toHttp1HeadersBlock();
+		
+		/**
+		 * Set the pre-rendered headers block built by toHttp1HeadersBlock,
+		 * it will be appended after other headers as a single fragment for http 1.
+		 * Notice:
+		 * Headers in the block are invisible to getters, getHeader and foreach,
+		 * don't set them again by setters, and don't put Date, Content-Length,
+		 * Transfer-Encoding or Connection in the block because they are handled per request.
+		 * The default Server header is not added if the block is not empty.
+		 */
+		void setHttp1HeadersBlock(SharedString&& block) { http1HeadersBlock_ = std::move(block); }
+		
+		/** Get the pre-rendered headers block, return empty string if not set */
+		const SharedString& getHttp1HeadersBlock() const& { return http1HeadersBlock_; }
 		
 		/** Set header value */
 		void setHeader(SharedString&& key, SharedString&& value);
@@ -103,7 +126,7 @@ namespace cpv {
 		friend class HttpResponseData;
 		
 	private:
-		StackAllocatedMap<SharedString, SharedString, 3> remainHeaders_;
+		SmallFlatMap<SharedString, SharedString, 3> remainHeaders_;
 		AdditionHeadersType additionHeaders_; // mostly for Set-Cookie
 		SharedString date_;
 		SharedString contentType_;
@@ -117,6 +140,7 @@ namespace cpv {
 		SharedString cacheControl_;
 		SharedString expires_;
 		SharedString lastModified_;
+		SharedString http1HeadersBlock_;
 	};
 }
 
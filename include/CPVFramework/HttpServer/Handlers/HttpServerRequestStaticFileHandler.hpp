@@ -1,4 +1,5 @@
 #pragma once
+#include <chrono>
 #include "../../Utility/SharedString.hpp"
 #include "./HttpServerRequestHandlerBase.hpp"
 
@@ -18,26 +19,60 @@ namespace cpv {
 	 * It can use lru cache to cache file content in memory (per cpu core), if file size is less than
 	 * maxCacheFileSize and maxCacheFileEntities is not 0, it will put file content to cache for next use.
 	 * You should disable file caching for local development environment by setting maxCacheFileEntities to 0.
+	 *
+	 * It also caches file metadata (existence, size and modified time) for fileMetadataCacheTime,
+	 * includes negative entries for not exists files, so requests for recently checked paths
+	 * (including 404 requests) don't need to query file system. Set maxCacheFileMetadataEntities
+	 * or fileMetadataCacheTime to 0 to disable metadata caching.
+	 *
+	 * If watchPathBase is true, it will watch pathBase recursively by inotify (on cpu core 0),
+	 * and evict cached content and metadata of changed files on all cpu cores, so large cache
+	 * and long metadata cache time can be used without serving stale files after deploying.
+	 * Handlers with the same pathBase share one watcher.
+	 *
+	 * If useMemoryMappedFiles is true, cached files are mapped to memory (read only) instead of
+	 * copied to heap, the mapping is shared by handlers on all cpu cores and pages are shared with
+	 * os page cache, so memory usage won't grow with the number of cpu cores. Files are mapped
+	 * by a background thread so open and mmap won't block the reactor.
+	 * Notice truncating a mapped file makes access to the truncated pages raise SIGBUS,
+	 * so only files without write permission (e.g. chmod a-w) are mapped, other files are read
+	 * into memory as usual, mapped files should be replaced by rename instead of modified in place.
 	 * 
-	 * It supports pre-compressed gzip files, for example if file path is ./1.txt and client accept gzip
-	 * encoding, then it will also search for ./1.txt.gz and return it if exists.
+	 * It supports pre-compressed brotli, zstd and gzip files, for example if file path is ./1.txt
+	 * and client accept br and gzip encoding, then it will search for ./1.txt.br and ./1.txt.gz
+	 * (ordered by q-value of Accept-Encoding, br > zstd > gzip if equal) and return the first exists one,
+	 * each variant is cached separately, and Vary: Accept-Encoding is sent with file responses.
+	 *
+	 * If compressionLevel is not 0, original files with compressible mime type (text, json, svg, etc)
+	 * will be compressed by gzip on-the-fly when no pre-compressed variant exists and client accept gzip,
+	 * the compressed content is stored with original content in file cache, so each file is compressed
+	 * only once until it's evicted, files larger than maxCacheFileSize are not compressed.
+	 * Compression is executed in a background thread so it won't block the reactor.
+	 * Compressed content has it's own ETag (ETag of original file with "-gzip" suffix).
 	 *
-	 * It supports Range header, but it won't use cache and gzip files when range header is presented,
-	 * because usually range header is used for downloading large pre-compressed files.
+	 * It supports Range header with single or multiple ranges (multipart/byteranges) and If-Range header,
+	 * ranges are replied from cache if file is cached, but it won't use compressed files when range header
+	 * is presented, because usually range header is used for downloading large pre-compressed files.
 	 *
-	 * It supports If-Modified-Since header, if file not change then it will return 304 response.
+	 * It sends strong ETag built from inode, size and modified time (in nanoseconds) of file,
+	 * and supports If-None-Match (list of entity tags or "*", weak comparison) and If-Modified-Since
+	 * header, if file not change then it will return 304 response, If-Modified-Since is ignored
+	 * when If-None-Match is presented. If-Range accepts both entity tag and http date.
 	 */
 	class HttpServerRequestStaticFileHandler : public HttpServerRequestHandlerBase {
 	public:
 		static const std::size_t DefaultMaxCacheFileEntities = 16;
 		static const std::size_t DefaultMaxCacheFileSize = 1048576; // 1mb
+		static const std::size_t DefaultMaxCacheFileMetadataEntities = 1024;
+		static const constexpr std::chrono::milliseconds DefaultFileMetadataCacheTime =
+			std::chrono::milliseconds(1000);
 
 		/** Return content of request file */
 		seastar::future<> handle(
 			HttpContext& context,
 			HttpServerRequestHandlerIterator next) const override;
 
-		/** Clear cached file contents */
+		/** Clear cached file contents and metadata */
 		void clearCache();
 
 		/** Constructor */
@@ -49,7 +84,14 @@ namespace cpv {
 			// like "max-age=84600, public" or "" (not sending Cache-Control)
 			SharedString&& cacheControl = "",
 			std::size_t maxCacheFileEntities = DefaultMaxCacheFileEntities,
-			std::size_t maxCacheFileSize = DefaultMaxCacheFileSize);
+			std::size_t maxCacheFileSize = DefaultMaxCacheFileSize,
+			std::size_t maxCacheFileMetadataEntities = DefaultMaxCacheFileMetadataEntities,
+			std::chrono::milliseconds fileMetadataCacheTime = DefaultFileMetadataCacheTime,
+			bool watchPathBase = false,
+			// only files without write permission (chmod a-w) are mapped, others are read into memory
+			bool useMemoryMappedFiles = false,
+			// 0 ~ 9, 0 means disable on-the-fly compression
+			int compressionLevel = 0);
 
 		/** Move constructor (for incomplete member type) */
 		HttpServerRequestStaticFileHandler(HttpServerRequestStaticFileHandler&&);
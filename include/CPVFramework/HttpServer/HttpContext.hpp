@@ -1,5 +1,6 @@
 #pragma once
 #include <seastar/net/api.hh>
+#include "../Allocators/ArenaAllocator.hpp"
 #include "../Container/Container.hpp"
 #include "../Container/Container.hpp"
 #include "../Container/ServiceStorage.hpp"
@@ -33,6 +34,19 @@ namespace cpv {
 			return container_.getMany<T>(collection, serviceStorage_);
 		}
 
+		/**
+		 * Get the arena for allocations that only live during handling this request,
+		 * it's reset when the http server moves to the next request on the same connection.
+		 * Notice: don't keep memory or strings allocated from it in caches or other requests,
+		 * strings allocated from it can be used as response body, see Arena::allocateString.
+		 */
+		Arena& getArena() & { return arena_; }
+
+		/** Release all memory allocated from the arena, usually you should call it after setRequestResponse */
+		void resetArena() {
+			arena_.reset();
+		}
+
 		/** Update the request and the response in this context */
 		void setRequestResponse(HttpRequest&& request, HttpResponse&& response) {
 			request_ = std::move(request);
@@ -60,7 +74,8 @@ namespace cpv {
 			response_(),
 			clientAddress_(seastar::make_ipv4_address(0, 0)),
 			container_(),
-			serviceStorage_() { }
+			serviceStorage_(),
+			arena_() { }
 
 		/** Constructor for null context, should set members later */
 		explicit HttpContext(nullptr_t) :
@@ -68,7 +83,8 @@ namespace cpv {
 			response_(nullptr),
 			clientAddress_(),
 			container_(nullptr),
-			serviceStorage_() { }
+			serviceStorage_(),
+			arena_() { }
 
 	private:
 		HttpRequest request_;
@@ -76,6 +92,7 @@ namespace cpv {
 		seastar::socket_address clientAddress_;
 		Container container_;
 		mutable ServiceStorage serviceStorage_;
+		Arena arena_;
 	};
 }
 
@@ -13,6 +13,12 @@ namespace cpv {
 	public:
 		/** Deserialize form to model */
 		static void deserialize(T& model, const SharedString& formBody) {
+			HttpForm form(formBody);
+			deserialize(model, form);
+		}
+
+		/** Deserialize parsed form to model */
+		static void deserialize(T& model, const HttpForm& form) {
 			using Trait = ObjectTrait<T>;
 			if constexpr (Trait::IsPointerLike) {
 				// if model is pointer type, ensure it's not nullptr
@@ -20,7 +26,6 @@ namespace cpv {
 					model = Trait::create();
 				}
 			}
-			HttpForm form(formBody);
 			if constexpr (Trait::IsPointerLike) {
 				Trait::get(model)->loadForm(form);
 			} else {
@@ -34,5 +39,11 @@ namespace cpv {
 	static inline void deserializeForm(T& model, const SharedString& formBody) {
 		return FormDeserializer<T>::deserialize(model, formBody);
 	}
+
+	/** Convenient static function for FormDeserializer (for parsed form) */
+	template <class T>
+	static inline void deserializeForm(T& model, const HttpForm& form) {
+		return FormDeserializer<T>::deserialize(model, form);
+	}
 }
 
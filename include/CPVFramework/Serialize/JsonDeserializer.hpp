@@ -2,10 +2,13 @@
 #include <chrono>
 #include <memory>
 #include <optional>
+#include <utility>
+#include <variant>
 #include <seastar/core/shared_ptr.hh>
 #include "../Allocators/StackAllocator.hpp"
 #include "../Exceptions/DeserializeException.hpp"
 #include "../Utility/ObjectTrait.hpp"
+#include "../Utility/Reusable.hpp"
 #include "../Utility/SharedString.hpp"
 #include "./JsonDeserializer.sajson.hpp"
 
@@ -40,6 +43,38 @@ namespace cpv {
 		const SharedString& str_;
 	};
 
+	/**
+	 * Buffer used to store the ast of sajson, it's allocated from per thread free list
+	 * by makeReusable<JsonAstBuffer>(size in words), so deserialize doesn't allocate
+	 * a new ast buffer for each json. Large buffer won't be kept in free list.
+	 */
+	class JsonAstBuffer {
+	public:
+		/** The minimal capacity of buffer in words */
+		static const constexpr std::size_t MinCapacity = 512;
+		/** The max capacity of buffer in words that can be kept in free list (1MB) */
+		static const constexpr std::size_t MaxReservedCapacity = 131072;
+
+		/** Get the pointer of buffer */
+		std::size_t* data() const { return buffer_.get(); }
+
+		/** Get the capacity of buffer in words */
+		std::size_t capacity() const { return capacity_; }
+
+		/** For Reusable<> */
+		void freeResources();
+
+		/** For Reusable<>, ensure the capacity is not less than sizeInWords */
+		void reset(std::size_t sizeInWords);
+
+		/** Constructor */
+		JsonAstBuffer();
+
+	private:
+		std::unique_ptr<std::size_t[]> buffer_;
+		std::size_t capacity_;
+	};
+
 	/**
 	 * The class used to convert json value to model.
 	 *
@@ -157,6 +192,82 @@ namespace cpv {
 		}
 	};
 
+	/** Specialize for map like types with string key */
+	template <class T>
+	struct JsonValueConverter<T, std::enable_if_t<ObjectTrait<T>::IsMapLike>> {
+		/** Convert json object to map like object if type matched */
+		static bool convert(T& models, const JsonValue& value) {
+			using Trait = ObjectTrait<T>;
+			using KeyType = typename Trait::KeyType;
+			using UnderlyingType = typename Trait::UnderlyingType;
+			static_assert(std::is_same_v<KeyType, SharedString> || std::is_same_v<KeyType, std::string>,
+				"key of map should be SharedString or std::string");
+			if (CPV_LIKELY(value.get_type() == JsonType::TYPE_OBJECT)) {
+				std::size_t length = value.get_length();
+				Trait::reserve(models, Trait::size(models) + length);
+				bool result = true;
+				for (std::size_t i = 0; i < length; ++i) {
+					sajson::string key = value.get_object_key(i);
+					std::string_view keyView(key.data(), key.length());
+					JsonValue child(value.get_object_value(i), value.jsonStr());
+					UnderlyingType* model;
+					if constexpr (std::is_same_v<KeyType, SharedString>) {
+						// key is decoded in-situ, so it can share the storage of json string
+						model = &Trait::add(models, value.jsonStr().share(keyView));
+					} else {
+						model = &Trait::add(models, KeyType(keyView));
+					}
+					// reset existing value, the last one wins if key is duplicated
+					*model = UnderlyingType();
+					result = JsonValueConverter<UnderlyingType>::convert(*model, child) && result;
+				}
+				return result;
+			}
+			return false;
+		}
+	};
+
+	/** Specialize for std::monostate, it's the null alternative of std::variant */
+	template <>
+	struct JsonValueConverter<std::monostate> {
+		/** Convert json value to std::monostate if it's null */
+		static bool convert(std::monostate&, const JsonValue& value) {
+			return value.get_type() == JsonType::TYPE_NULL;
+		}
+	};
+
+	/**
+	 * Specialize for std::variant.
+	 * Alternatives are tried in order and the first alternative converted successfully
+	 * will be used, for tagged unions, let loadJson of models check the tag member and
+	 * return false if not matched.
+	 */
+	template <class... Types>
+	struct JsonValueConverter<std::variant<Types...>> {
+		/** Convert json value to the first matched alternative of std::variant */
+		static bool convert(std::variant<Types...>& target, const JsonValue& value) {
+			return convertAlternatives(target, value, std::index_sequence_for<Types...>());
+		}
+
+	private:
+		template <std::size_t... Indices>
+		static bool convertAlternatives(std::variant<Types...>& target,
+			const JsonValue& value, std::index_sequence<Indices...>) {
+			return (convertAlternative<Indices>(target, value) || ...);
+		}
+
+		template <std::size_t Index>
+		static bool convertAlternative(std::variant<Types...>& target, const JsonValue& value) {
+			// convert to temporary object to keep target unchanged if not matched
+			std::variant_alternative_t<Index, std::variant<Types...>> alternative;
+			if (JsonValueConverter<decltype(alternative)>::convert(alternative, value)) {
+				target.template emplace<Index>(std::move(alternative));
+				return true;
+			}
+			return false;
+		}
+	};
+
 	/** Specialize for pointer like types */
 	template <class T>
 	struct JsonValueConverter<T, std::enable_if_t<ObjectTrait<T>::IsPointerLike>> {
@@ -207,6 +318,7 @@ namespace cpv {
 	 * must be mutable so encoded strings can be replaced by decoded strings.
 	 * And since the contents of json string can be changed, the deserialize
 	 * operation can only perform once for the given json string.
+	 * The ast is stored in JsonAstBuffer reused across deserialize operations.
 	 */
 	template <class T, class = void /* for enable_if */>
 	class JsonDeserializer {
@@ -214,8 +326,12 @@ namespace cpv {
 		/** Deserialize json to model */
 		static std::optional<DeserializeException> deserialize(
 			T& model, SharedString& str) {
-			JsonDocument document = sajson::parse_single_allocation(
-				sajson::mutable_string_view(str.size(), str.data()));
+			// sajson needs at most one word per input byte,
+			// the ast buffer must be declared before document so it outlives document
+			Reusable<JsonAstBuffer> astBuffer = makeReusable<JsonAstBuffer>(str.size());
+			JsonDocument document = sajson::parse_bounded_allocation(
+				sajson::mutable_string_view(str.size(), str.data()),
+				astBuffer->data(), astBuffer->capacity());
 			if (CPV_UNLIKELY(!document.is_valid())) {
 				return DeserializeException(CPV_CODEINFO,
 					document.get_error_message_as_cstring());
@@ -0,0 +1,301 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "../Exceptions/LogicException.hpp"
+#include "./JsonDeserializer.hpp"
+#include "./JsonSerializer.hpp"
+
+// apply macro to each argument and join results by comma, supports up to 32 arguments
+#define CPV_JSON_FIELDS_MAP_1(m, x) m(x)
+#define CPV_JSON_FIELDS_MAP_2(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_1(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_3(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_2(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_4(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_3(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_5(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_4(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_6(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_5(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_7(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_6(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_8(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_7(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_9(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_8(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_10(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_9(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_11(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_10(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_12(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_11(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_13(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_12(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_14(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_13(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_15(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_14(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_16(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_15(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_17(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_16(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_18(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_17(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_19(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_18(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_20(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_19(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_21(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_20(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_22(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_21(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_23(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_22(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_24(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_23(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_25(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_24(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_26(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_25(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_27(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_26(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_28(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_27(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_29(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_28(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_30(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_29(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_31(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_30(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_MAP_32(m, x, ...) m(x), CPV_JSON_FIELDS_MAP_31(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_COUNT_IMPL( \
+	_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, \
+	_17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ...) N
+#define CPV_JSON_FIELDS_COUNT(...) CPV_JSON_FIELDS_COUNT_IMPL(__VA_ARGS__, \
+	32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, \
+	16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1)
+#define CPV_JSON_FIELDS_CONCAT_IMPL(a, b) a##b
+#define CPV_JSON_FIELDS_CONCAT(a, b) CPV_JSON_FIELDS_CONCAT_IMPL(a, b)
+#define CPV_JSON_FIELDS_MAP(m, ...) \
+	CPV_JSON_FIELDS_CONCAT(CPV_JSON_FIELDS_MAP_, CPV_JSON_FIELDS_COUNT(__VA_ARGS__))(m, __VA_ARGS__)
+#define CPV_JSON_FIELDS_TYPE(field) std::decay_t<decltype(field)>
+#define CPV_JSON_FIELDS_NAME(field) #field
+
+// generate dumpJson and loadJson for given members, member names are used as json keys
+#define CPV_JSON_FIELDS(...) \
+	void dumpJson(::cpv::JsonBuilder& builder) const { \
+		using Fields = ::cpv::JsonFields<CPV_JSON_FIELDS_MAP(CPV_JSON_FIELDS_TYPE, __VA_ARGS__)>; \
+		static const constexpr auto keys = Fields::makeKeys( \
+			CPV_JSON_FIELDS_MAP(CPV_JSON_FIELDS_NAME, __VA_ARGS__)); \
+		Fields::dump(builder, keys, __VA_ARGS__); \
+	} \
+	bool loadJson(const ::cpv::JsonValue& value) { \
+		using Fields = ::cpv::JsonFields<CPV_JSON_FIELDS_MAP(CPV_JSON_FIELDS_TYPE, __VA_ARGS__)>; \
+		static const constexpr auto index = Fields::makeIndex( \
+			CPV_JSON_FIELDS_MAP(CPV_JSON_FIELDS_NAME, __VA_ARGS__)); \
+		return Fields::load(value, index, __VA_ARGS__); \
+	}
+
+namespace cpv {
+	/**
+	 * Static parts of json object between member values, built at compile time.
+	 * Part i is written before value i, and part Count is written after the last value,
+	 * for example: {"a": 1 ,"b":" xxx "}
+	 */
+	template <std::size_t Count, std::size_t Capacity>
+	struct JsonFieldsKeys {
+		std::array<char, Capacity> buffer;
+		std::array<std::size_t, Count + 2> offsets;
+
+		/** Get the static part by index */
+		constexpr std::string_view get(std::size_t index) const {
+			return { buffer.data() + offsets[index], offsets[index + 1] - offsets[index] };
+		}
+	};
+
+	/** Hash function used to build and lookup JsonFieldsIndex */
+	constexpr std::uint32_t jsonFieldHash(const char* data, std::size_t size, std::uint32_t seed) {
+		std::uint32_t hash = 2166136261U ^ seed;
+		for (std::size_t i = 0; i < size; ++i) {
+			hash ^= static_cast<unsigned char>(data[i]);
+			hash *= 16777619U;
+		}
+		hash ^= hash >> 16;
+		hash *= 0x85ebca6bU;
+		hash ^= hash >> 13;
+		return hash;
+	}
+
+	/**
+	 * Perfect hash index from json key to field index, built at compile time.
+	 * The seed is chosen to make every key hashes to a different slot,
+	 * so lookup only needs one hash and one comparison.
+	 */
+	template <std::size_t Count, std::size_t TableSize, std::size_t NamesCapacity>
+	struct JsonFieldsIndex {
+		std::uint32_t seed;
+		/** Field index + 1 for each slot, 0 for empty */
+		std::array<std::uint8_t, TableSize> slots;
+		std::array<char, NamesCapacity> names;
+		std::array<std::size_t, Count + 1> offsets;
+
+		/** Get the name of field by index */
+		constexpr std::string_view getName(std::size_t index) const {
+			return { names.data() + offsets[index], offsets[index + 1] - offsets[index] };
+		}
+
+		/** Find field index by key, return Count if not found */
+		std::size_t find(std::string_view key) const {
+			std::size_t slot = slots[jsonFieldHash(key.data(), key.size(), seed) & (TableSize - 1)];
+			if (slot != 0 && getName(slot - 1) == key) {
+				return slot - 1;
+			}
+			return Count;
+		}
+	};
+
+	/** Whether value is written as quoted string, the quotes can merge into static parts */
+	template <class T>
+	struct JsonFieldIsString : std::false_type { };
+
+	template <>
+	struct JsonFieldIsString<SharedString> : std::true_type { };
+
+	template <>
+	struct JsonFieldIsString<std::string> : std::true_type { };
+
+	/**
+	 * Generate json serialization and deserialization for members, used by CPV_JSON_FIELDS.
+	 * The keys must not require to encode, and members not present in json are left unchanged.
+	 */
+	template <class... Types>
+	class JsonFields {
+	public:
+		static const constexpr std::size_t Count = sizeof...(Types);
+		static_assert(Count > 0 && Count <= std::numeric_limits<std::uint8_t>::max(),
+			"number of fields out of range");
+		/** Table size of perfect hash index, at least 4 times of keys */
+		static const constexpr std::size_t IndexTableSize = [] {
+			std::size_t size = 4;
+			while (size < Count * 4) {
+				size *= 2;
+			}
+			return size;
+		}();
+		/** Limit of seeds to try when building perfect hash index */
+		static const constexpr std::uint32_t MaxIndexSeeds = 10000;
+
+		/** Build static parts between values, merge quotes of string values into them */
+		template <std::size_t... Sizes>
+		static constexpr auto makeKeys(const char(&... names)[Sizes]) {
+			static_assert(sizeof...(Sizes) == Count, "number of names not matched");
+			JsonFieldsKeys<Count, (Sizes + ...) + Count * 5 + 2> keys {};
+			const char* nameList[] = { names... };
+			const std::size_t nameSizes[] = { (Sizes - 1)... };
+			const bool isString[] = { JsonFieldIsString<Types>::value... };
+			std::size_t offset = 0;
+			for (std::size_t i = 0; i < Count; ++i) {
+				keys.offsets[i] = offset;
+				if (i == 0) {
+					keys.buffer[offset++] = '{';
+				} else {
+					if (isString[i - 1]) {
+						keys.buffer[offset++] = '"';
+					}
+					keys.buffer[offset++] = ',';
+				}
+				keys.buffer[offset++] = '"';
+				for (std::size_t j = 0; j < nameSizes[i]; ++j) {
+					keys.buffer[offset++] = nameList[i][j];
+				}
+				keys.buffer[offset++] = '"';
+				keys.buffer[offset++] = ':';
+				if (isString[i]) {
+					keys.buffer[offset++] = '"';
+				}
+			}
+			keys.offsets[Count] = offset;
+			if (isString[Count - 1]) {
+				keys.buffer[offset++] = '"';
+			}
+			keys.buffer[offset++] = '}';
+			keys.offsets[Count + 1] = offset;
+			return keys;
+		}
+
+		/** Build perfect hash index for field names */
+		template <std::size_t... Sizes>
+		static constexpr auto makeIndex(const char(&... names)[Sizes]) {
+			static_assert(sizeof...(Sizes) == Count, "number of names not matched");
+			JsonFieldsIndex<Count, IndexTableSize, (Sizes + ...)> index {};
+			const char* nameList[] = { names... };
+			const std::size_t nameSizes[] = { (Sizes - 1)... };
+			std::size_t offset = 0;
+			for (std::size_t i = 0; i < Count; ++i) {
+				index.offsets[i] = offset;
+				for (std::size_t j = 0; j < nameSizes[i]; ++j) {
+					index.names[offset++] = nameList[i][j];
+				}
+			}
+			index.offsets[Count] = offset;
+			for (std::size_t i = 0; i < Count; ++i) {
+				for (std::size_t j = 0; j < i; ++j) {
+					if (index.getName(i) == index.getName(j)) {
+						// it's a compile error if reached in constant evaluation
+						throw LogicException(CPV_CODEINFO, "duplicated field name");
+					}
+				}
+			}
+			for (std::uint32_t seed = 0; seed < MaxIndexSeeds; ++seed) {
+				bool conflict = false;
+				for (std::size_t slot = 0; slot < IndexTableSize; ++slot) {
+					index.slots[slot] = 0;
+				}
+				for (std::size_t i = 0; i < Count && !conflict; ++i) {
+					std::size_t slot = jsonFieldHash(
+						nameList[i], nameSizes[i], seed) & (IndexTableSize - 1);
+					if (index.slots[slot] != 0) {
+						conflict = true;
+					} else {
+						index.slots[slot] = static_cast<std::uint8_t>(i + 1);
+					}
+				}
+				if (!conflict) {
+					index.seed = seed;
+					return index;
+				}
+			}
+			throw LogicException(CPV_CODEINFO, "failed to build perfect hash index");
+		}
+
+		/** Write members to json builder */
+		template <std::size_t Capacity, class... Values>
+		static void dump(
+			JsonBuilder& builder,
+			const JsonFieldsKeys<Count, Capacity>& keys,
+			const Values&... values) {
+			std::size_t index = 0;
+			((builder.writeRaw(SharedString::fromStatic(keys.get(index++))),
+				dumpValue(builder, values)), ...);
+			builder.writeRaw(SharedString::fromStatic(keys.get(Count)));
+		}
+
+		/** Read members from json object, return false if it's not an object */
+		template <class Index, class... Values>
+		static bool load(const JsonValue& value, const Index& index, Values&... values) {
+			if (CPV_UNLIKELY(value.get_type() != JsonType::TYPE_OBJECT)) {
+				return false;
+			}
+			std::size_t length = value.get_length();
+			for (std::size_t i = 0; i < length; ++i) {
+				sajson::string key = value.get_object_key(i);
+				std::size_t fieldIndex = index.find({ key.data(), key.length() });
+				if (fieldIndex < Count) {
+					loadValue(fieldIndex, JsonValue(value.get_object_value(i), value.jsonStr()),
+						std::index_sequence_for<Values...>(), values...);
+				}
+			}
+			return true;
+		}
+
+	private:
+		/** Write value to json builder, quotes of string are already in static parts */
+		template <class T>
+		static void dumpValue(JsonBuilder& builder, const T& value) {
+			if constexpr (std::is_same_v<T, SharedString>) {
+				builder.writeRaw(jsonEncode(value.share()));
+			} else if constexpr (std::is_same_v<T, std::string>) {
+				builder.writeRaw(jsonEncode(SharedString(value)));
+			} else {
+				JsonBuilderWriter<T>::write(value, builder);
+			}
+		}
+
+		/** Convert json value to the member at given index */
+		template <std::size_t... Indexes, class... Values>
+		static void loadValue(
+			std::size_t fieldIndex,
+			const JsonValue& value,
+			std::index_sequence<Indexes...>,
+			Values&... values) {
+			((Indexes == fieldIndex ?
+				static_cast<void>(JsonValueConverter<Values>::convert(values, value)) :
+				static_cast<void>(0)), ...);
+		}
+	};
+}
+
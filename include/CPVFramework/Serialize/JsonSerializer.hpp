@@ -3,12 +3,14 @@
 #include <limits>
 #include <memory>
 #include <optional>
+#include <variant>
 #include <seastar/core/shared_ptr.hh>
 #include "../Allocators/StackAllocator.hpp"
 #include "../Utility/ConstantStrings.hpp"
 #include "../Utility/ObjectTrait.hpp"
 #include "../Utility/Packet.hpp"
 #include "../Utility/SharedString.hpp"
+#include "../Utility/SharedStringBuilder.hpp"
 
 // construct JsonMemberKey, please ensure key is already encoded
 #define CPV_JSONKEY(key) cpv::JsonMemberKey("\"" key "\":", ",\"" key "\":")
@@ -49,6 +51,18 @@ namespace cpv {
 		std::string_view encodedKeyWithPreviousComma_;
 	};
 
+	/** The way JsonBuilder stores generated json */
+	enum class JsonBuilderMode {
+		/** Append every token to packet, only strings shorter than Packet's inline threshold are copied */
+		Fragments,
+		/**
+		 * Write tokens to a contiguous buffer, only strings not shorter than
+		 * JsonBuilder::LargeStringThreshold are appended as separate fragments,
+		 * it reduces the number of fragments (iovec entries) and chained deleters.
+		 */
+		ContiguousBuffer
+	};
+
 	/**
 	 * The class used to build json packet.
 	 * For performance reason, it won't validate the sequence of operations,
@@ -56,6 +70,9 @@ namespace cpv {
 	 */
 	class JsonBuilder {
 	public:
+		/** Strings not shorter than this size won't be copied in contiguous buffer mode */
+		static const constexpr std::size_t LargeStringThreshold = 256;
+
 		/** Write { to json packet */
 		JsonBuilder& startObject() {
 			writeRaw(constants::CurlyBacketStart);
@@ -106,26 +123,115 @@ namespace cpv {
 		}
 
 		/** Write raw string */
-		template <class... Args>
-		void writeRaw(Args&&... args) {
-			fragments_->append(std::forward<Args>(args)...);
+		void writeRaw(SharedString&& str) {
+			if (mode_ == JsonBuilderMode::Fragments) {
+				fragments_->append(std::move(str));
+			} else if (str.size() < LargeStringThreshold) {
+				buffer_.append(str.view());
+			} else {
+				flushBuffer();
+				fragments_->append(std::move(str));
+			}
+		}
+
+		/** Write raw static string */
+		template <std::size_t Size>
+		void writeRaw(const char(&str)[Size]) {
+			if (mode_ == JsonBuilderMode::Fragments) {
+				fragments_->append(str);
+			} else {
+				buffer_.append(std::string_view(str, Size - 1));
+			}
+		}
+
+		/**
+		 * Write string representation of integer or floating point,
+		 * it's formatted into the buffer directly in contiguous buffer mode.
+		 */
+		template <class T>
+		void writeNumber(T value) {
+			if (mode_ == JsonBuilderMode::ContiguousBuffer) {
+				buffer_.append(value);
+			} else if constexpr (std::numeric_limits<T>::is_integer) {
+				fragments_->append(SharedString::fromInt(value));
+			} else {
+				fragments_->append(SharedString::fromDouble(value));
+			}
+		}
+
+		/** Get the size in bytes of json written so far, notice it's dynamically calculated */
+		std::size_t bufferedSize() const {
+			return packet_.size() + buffer_.size();
+		}
+
+		/**
+		 * Take the json written so far as packet and continue with an empty buffer,
+		 * it's used to write large json by parts.
+		 */
+		Packet takePacket() {
+			Packet packet = std::move(*this).toPacket();
+			if (mode_ == JsonBuilderMode::Fragments) {
+				packet_ = Packet(capacity_);
+				fragments_ = &packet_.getOrConvertToMultiple();
+			} else {
+				packet_ = Packet();
+				buffer_.reserve(capacity_);
+			}
+			return packet;
 		}
 
 		/** Get the json packet, don't touch the json builder after invoked this */
 		Packet toPacket() && {
+			if (mode_ == JsonBuilderMode::ContiguousBuffer) {
+				if (fragments_ == nullptr) {
+					// no large string, the packet contains only one fragment
+					packet_ = Packet(buffer_.build());
+				} else {
+					flushBuffer();
+				}
+			}
 			fragments_ = nullptr;
 			return std::move(packet_);
 		}
 
 		/** Constructor with capacity of packet */
 		explicit JsonBuilder(std::size_t capacity) :
-			packet_(capacity),
-			fragments_(&packet_.getOrConvertToMultiple()),
-			addPreviousComma_(false) { }
+			JsonBuilder(JsonBuilderMode::Fragments, capacity) { }
+
+		/**
+		 * Constructor with mode and capacity,
+		 * capacity is the number of fragments for fragments mode,
+		 * or the size in bytes of buffer for contiguous buffer mode.
+		 */
+		JsonBuilder(JsonBuilderMode mode, std::size_t capacity) :
+			packet_(mode == JsonBuilderMode::Fragments ? Packet(capacity) : Packet()),
+			fragments_(mode == JsonBuilderMode::Fragments ? &packet_.getOrConvertToMultiple() : nullptr),
+			buffer_(),
+			capacity_(capacity),
+			mode_(mode),
+			addPreviousComma_(false) {
+			if (mode_ == JsonBuilderMode::ContiguousBuffer) {
+				buffer_.reserve(capacity);
+			}
+		}
+
+	private:
+		/** Append content of buffer to packet as a fragment, for contiguous buffer mode */
+		void flushBuffer() {
+			if (fragments_ == nullptr) {
+				fragments_ = &packet_.getOrConvertToMultiple();
+			}
+			if (!buffer_.empty()) {
+				fragments_->append(buffer_.build());
+			}
+		}
 
 	private:
 		Packet packet_;
 		Packet::MultipleFragments* fragments_;
+		SharedStringBuilder buffer_;
+		std::size_t capacity_;
+		JsonBuilderMode mode_;
 		bool addPreviousComma_;
 	};
 
@@ -151,7 +257,7 @@ namespace cpv {
 		std::enable_if_t<std::numeric_limits<T>::is_integer && !std::is_same_v<T, bool>>> {
 		/** Write integer to json builder */
 		static void write(const T& value, JsonBuilder& builder) {
-			builder.writeRaw(SharedString::fromInt(value));
+			builder.writeNumber(value);
 		}
 	};
 
@@ -161,7 +267,7 @@ namespace cpv {
 		std::enable_if_t<std::is_floating_point_v<T>>> {
 		/** Write floating point to json builder */
 		static void write(const T& value, JsonBuilder& builder) {
-			builder.writeRaw(SharedString::fromDouble(value));
+			builder.writeNumber(value);
 		}
 	};
 
@@ -214,6 +320,50 @@ namespace cpv {
 		}
 	};
 
+	/** Specialize for map like types with string key */
+	template <class T>
+	struct JsonBuilderWriter<T, std::enable_if_t<ObjectTrait<T>::IsMapLike>> {
+		/** Write map like object to json builder */
+		static void write(const T& values, JsonBuilder& builder) {
+			using KeyType = typename ObjectTrait<T>::KeyType;
+			static_assert(std::is_same_v<KeyType, SharedString> || std::is_same_v<KeyType, std::string>,
+				"key of map should be SharedString or std::string");
+			builder.startObject();
+			ObjectTrait<T>::apply(values, [&builder] (const auto& key, const auto& value) {
+				if constexpr (std::is_same_v<KeyType, SharedString>) {
+					builder.addMember(key, value);
+				} else {
+					builder.addMember(SharedString(std::string_view(key)), value);
+				}
+			});
+			builder.endObject();
+		}
+	};
+
+	/** Specialize for std::monostate, it's the null alternative of std::variant */
+	template <>
+	struct JsonBuilderWriter<std::monostate> {
+		/** Write null to json builder */
+		static void write(const std::monostate&, JsonBuilder& builder) {
+			builder.writeRaw(constants::Null);
+		}
+	};
+
+	/** Specialize for std::variant */
+	template <class... Types>
+	struct JsonBuilderWriter<std::variant<Types...>> {
+		/** Write the holding alternative of std::variant to json builder */
+		static void write(const std::variant<Types...>& value, JsonBuilder& builder) {
+			if (CPV_UNLIKELY(value.valueless_by_exception())) {
+				builder.writeRaw(constants::Null);
+				return;
+			}
+			std::visit([&builder] (const auto& alternative) {
+				JsonBuilderWriter<std::decay_t<decltype(alternative)>>::write(alternative, builder);
+			}, value);
+		}
+	};
+
 	/** Specialize for pointer like types */
 	template <class T>
 	struct JsonBuilderWriter<T, std::enable_if_t<ObjectTrait<T>::IsPointerLike>> {
@@ -235,7 +385,7 @@ namespace cpv {
 		/** Write chrono durations to json builder */
 		static void write(
 			const std::chrono::duration<Rep, Period>& value, JsonBuilder& builder) {
-			builder.writeRaw(SharedString::fromInt(value.count()));
+			builder.writeNumber(value.count());
 		}
 	};
 
@@ -286,12 +436,22 @@ namespace cpv {
 	template <class T, class = void /* for enable_if */>
 	class JsonSerializer {
 	public:
-		/** The default packet capacity */
+		/** The default packet capacity (for fragments mode) */
 		static const constexpr std::size_t PacketCapacity = 128;
+		/** The default size hint, it's the initial buffer size for contiguous buffer mode */
+		static const constexpr std::size_t DefaultSizeHint = 512;
+		/**
+		 * Use fragments mode if size hint is larger than this,
+		 * very large json is usually dominated by large strings that not worth copying,
+		 * and allocate very large contiguous buffer is expensive.
+		 */
+		static const constexpr std::size_t MaxContiguousBufferSizeHint = 1048576;
 
-		/** Serialize model to json packet */
-		static Packet serialize(const T& model) {
-			JsonBuilder builder(PacketCapacity);
+		/** Serialize model to json packet, sizeHint is the estimated size of json in bytes */
+		static Packet serialize(const T& model, std::size_t sizeHint = DefaultSizeHint) {
+			JsonBuilder builder = (sizeHint > MaxContiguousBufferSizeHint) ?
+				JsonBuilder(JsonBuilderMode::Fragments, PacketCapacity) :
+				JsonBuilder(JsonBuilderMode::ContiguousBuffer, sizeHint);
 			JsonBuilderWriter<T>::write(model, builder);
 			return std::move(builder).toPacket();
 		}
@@ -299,8 +459,9 @@ namespace cpv {
 
 	/** Convenient static function for JsonSerializer */
 	template <class T>
-	static inline Packet serializeJson(const T& model) {
-		return JsonSerializer<T>::serialize(model);
+	static inline Packet serializeJson(
+		const T& model, std::size_t sizeHint = JsonSerializer<T>::DefaultSizeHint) {
+		return JsonSerializer<T>::serialize(model, sizeHint);
 	}
 }
 
@@ -0,0 +1,231 @@
+#pragma once
+#include <limits>
+#include <vector>
+#include <seastar/core/future-util.hh>
+#include "../Exceptions/DeserializeException.hpp"
+#include "../Stream/InputStreamBase.hpp"
+#include "../Utility/SharedStringBuilder.hpp"
+#include "./JsonDeserializer.hpp"
+
+namespace cpv {
+	/**
+	 * Interface of callbacks invoked by JsonStreamParser.
+	 *
+	 * Keys and strings are decoded, numbers are passed as original text
+	 * so they can be converted to any type without losing precision.
+	 * Callbacks can throw exception (prefer DeserializeException) to stop parsing.
+	 */
+	class JsonStreamHandler {
+	public:
+		/** Virtual destructor */
+		virtual ~JsonStreamHandler() = default;
+
+		/** Invoked when '{' is parsed */
+		virtual void onStartObject() { }
+
+		/** Invoked when '}' is parsed */
+		virtual void onEndObject() { }
+
+		/** Invoked when '[' is parsed */
+		virtual void onStartArray() { }
+
+		/** Invoked when ']' is parsed */
+		virtual void onEndArray() { }
+
+		/** Invoked when key of object member is parsed */
+		virtual void onKey(SharedString&&) { }
+
+		/** Invoked when string value is parsed */
+		virtual void onString(SharedString&&) { }
+
+		/** Invoked when number value is parsed */
+		virtual void onNumber(SharedString&&) { }
+
+		/** Invoked when true or false is parsed */
+		virtual void onBool(bool) { }
+
+		/** Invoked when null is parsed */
+		virtual void onNull() { }
+	};
+
+	/**
+	 * Incremental (SAX like) json parser, json can be fed chunk by chunk.
+	 *
+	 * Only the token across chunks (key, string or number) is buffered,
+	 * tokens inside a single chunk without escape characters share the storage of chunk,
+	 * so the memory usage is bounded by maxTokenSize and maxDepth instead of the size of json.
+	 * DeserializeException will be thrown if json is invalid or exceeds the limits.
+	 */
+	class JsonStreamParser {
+	public:
+		/** The default max depth of nested objects and arrays */
+		static const constexpr std::size_t DefaultMaxDepth = 64;
+		/** The default max size of a single token (key, string or number) */
+		static const constexpr std::size_t DefaultMaxTokenSize = 1048576;
+
+		/** Parse next part of json, callbacks of handler will be invoked inside */
+		void feed(const SharedString& data);
+
+		/** Notify the json is ended, throws exception if json is incomplete */
+		void finish();
+
+		/** Get the size of json parsed */
+		std::size_t parsedSize() const { return parsedSize_; }
+
+		/** Constructor */
+		explicit JsonStreamParser(
+			JsonStreamHandler& handler,
+			std::size_t maxDepth = DefaultMaxDepth,
+			std::size_t maxTokenSize = DefaultMaxTokenSize,
+			std::size_t maxSize = std::numeric_limits<std::size_t>::max());
+
+	private:
+		/** What the parser expects next */
+		enum class State {
+			Value,
+			ValueOrArrayEnd,
+			KeyOrObjectEnd,
+			Key,
+			Colon,
+			CommaOrEnd,
+			Done,
+			String,
+			StringEscape,
+			StringUnicode,
+			Number,
+			Literal
+		};
+
+		const char* parseStructural(const char* ptr);
+		const char* parseValue(const char* ptr);
+		const char* parseString(const SharedString& data, const char* ptr, const char* end);
+		const char* parseEscape(const char* ptr);
+		const char* parseUnicode(const char* ptr, const char* end);
+		const char* parseNumber(const SharedString& data, const char* ptr, const char* end);
+		const char* parseLiteral(const char* ptr, const char* end);
+		void finishNumber(SharedString&& value);
+		void startContainer(bool isObject);
+		void endContainer(bool isObject);
+		void endValue();
+		void appendToken(const char* begin, const char* end);
+		[[noreturn]] void throwError(const char* message, const char* ptr) const;
+
+	private:
+		JsonStreamHandler& handler_;
+		std::size_t maxDepth_;
+		std::size_t maxTokenSize_;
+		std::size_t maxSize_;
+		std::size_t parsedSize_;
+		const char* chunkBegin_;
+		State state_;
+		bool isKey_;
+		std::vector<bool> containers_;
+		SharedStringBuilder token_;
+		std::string_view literal_;
+		std::size_t literalMatched_;
+		std::uint32_t unicodeValue_;
+		std::size_t unicodeDigits_;
+		std::uint32_t highSurrogate_;
+	};
+
+	/**
+	 * Handler that collects items of root array, each item is stored as a standalone
+	 * json array contains only this item so it can be parsed by JsonDeserializer.
+	 * DeserializeException will be thrown if root is not array or item exceeds maxItemSize.
+	 */
+	class JsonItemsCollector : public JsonStreamHandler {
+	public:
+		/** The default max size of a single item */
+		static const constexpr std::size_t DefaultMaxItemSize = 1048576;
+
+		/** Get collected items, caller should clear it after handled */
+		std::vector<SharedString>& items() & { return items_; }
+
+		void onStartObject() override;
+		void onEndObject() override;
+		void onStartArray() override;
+		void onEndArray() override;
+		void onKey(SharedString&& key) override;
+		void onString(SharedString&& value) override;
+		void onNumber(SharedString&& value) override;
+		void onBool(bool value) override;
+		void onNull() override;
+
+		/** Constructor */
+		explicit JsonItemsCollector(std::size_t maxItemSize = DefaultMaxItemSize);
+
+	private:
+		void beforeValue();
+		void afterValue();
+		void append(std::string_view str);
+
+	private:
+		std::size_t maxItemSize_;
+		std::size_t depth_;
+		bool addComma_;
+		SharedStringBuilder builder_;
+		std::vector<SharedString> items_;
+	};
+
+	/**
+	 * Read json from stream and feed it to parser chunk by chunk,
+	 * must keep stream and parser alive until future resolved.
+	 */
+	seastar::future<> parseJsonFromStream(InputStreamBase& stream, JsonStreamParser& parser);
+
+	/**
+	 * Read json array from stream and convert items to model one by one,
+	 * func will be invoked with each converted model and should return seastar::future<>,
+	 * next part of stream will be read after futures for previous items resolved,
+	 * so the memory usage is bounded by the size of chunk plus maxItemSize.
+	 * Must keep stream alive until future resolved.
+	 */
+	template <class T, class Func>
+	seastar::future<> deserializeJsonItemsFromStream(
+		InputStreamBase& stream,
+		Func&& func,
+		std::size_t maxItemSize = JsonItemsCollector::DefaultMaxItemSize,
+		std::size_t maxSize = std::numeric_limits<std::size_t>::max()) {
+		return seastar::do_with(
+			JsonItemsCollector(maxItemSize),
+			std::forward<Func>(func),
+			[&stream, maxItemSize, maxSize] (auto& collector, auto& func) {
+			return seastar::do_with(
+				JsonStreamParser(collector, JsonStreamParser::DefaultMaxDepth, maxItemSize, maxSize),
+				[&stream, &collector, &func] (auto& parser) {
+				return seastar::repeat([&stream, &collector, &func, &parser] {
+					return stream.read().then([&collector, &func, &parser] (auto&& result) {
+						parser.feed(result.data);
+						if (result.isEnd) {
+							parser.finish();
+						}
+						return seastar::do_for_each(collector.items(), [&func] (SharedString& item) {
+							// item is a standalone json array contains only one element
+							Reusable<JsonAstBuffer> astBuffer = makeReusable<JsonAstBuffer>(item.size());
+							JsonDocument document = sajson::parse_bounded_allocation(
+								sajson::mutable_string_view(item.size(), item.data()),
+								astBuffer->data(), astBuffer->capacity());
+							if (CPV_UNLIKELY(!document.is_valid())) {
+								return seastar::make_exception_future<>(DeserializeException(
+									CPV_CODEINFO, document.get_error_message_as_cstring()));
+							}
+							T model;
+							JsonValue root(document.get_root(), item);
+							if (CPV_UNLIKELY(!JsonValueConverter<T>::convert(model, root[std::size_t(0)]))) {
+								return seastar::make_exception_future<>(
+									DeserializeException(CPV_CODEINFO, "convert failed"));
+							}
+							return func(std::move(model));
+						}).then([&collector, isEnd = result.isEnd] {
+							collector.items().clear();
+							return isEnd ?
+								seastar::stop_iteration::yes :
+								seastar::stop_iteration::no;
+						});
+					});
+				});
+			});
+		});
+	}
+}
+
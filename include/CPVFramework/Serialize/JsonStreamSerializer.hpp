@@ -0,0 +1,77 @@
+#pragma once
+#include <iterator>
+#include <seastar/core/future-util.hh>
+#include "../Stream/OutputStreamBase.hpp"
+#include "./JsonSerializer.hpp"
+
+namespace cpv {
+	/**
+	 * The class used to serialize model to output stream by parts.
+	 *
+	 * The json is written to stream whenever the size of buffer passes flushThreshold,
+	 * and it waits for the write to complete before continue, so a slow client slows
+	 * down the serialization instead of letting the buffered data grow.
+	 *
+	 * Default implementation writes the whole model at once,
+	 * the specialization for collection like types writes items one by one,
+	 * so the memory usage is bounded by flushThreshold plus the size of one item.
+	 */
+	template <class T, class = void /* for enable_if */>
+	class JsonStreamSerializer {
+	public:
+		/** The default size in bytes of buffer that triggers a write */
+		static const constexpr std::size_t DefaultFlushThreshold = 65536;
+
+		/** Serialize model to stream, must keep model and stream alive until future resolved */
+		static seastar::future<> serialize(
+			OutputStreamBase& stream, const T& model, std::size_t flushThreshold) {
+			return stream.write(serializeJson(model, flushThreshold));
+		}
+	};
+
+	/** Specialize for collection like types */
+	template <class T>
+	class JsonStreamSerializer<T, std::enable_if_t<
+		ObjectTrait<T>::IsCollectionLike && !ObjectTrait<T>::IsPointerLike>> {
+	public:
+		/** The default size in bytes of buffer that triggers a write */
+		static const constexpr std::size_t DefaultFlushThreshold = 65536;
+
+		/** Serialize collection to stream, must keep model and stream alive until future resolved */
+		static seastar::future<> serialize(
+			OutputStreamBase& stream, const T& values, std::size_t flushThreshold) {
+			// reserve some more space since the last item may exceed the threshold
+			JsonBuilder builder(JsonBuilderMode::ContiguousBuffer, flushThreshold + flushThreshold / 4);
+			builder.startArray();
+			return seastar::do_with(std::move(builder), std::begin(values),
+				[&stream, &values, flushThreshold] (auto& builder, auto& it) {
+				return seastar::repeat([&stream, &values, flushThreshold, &builder, &it] {
+					auto end = std::end(values);
+					while (it != end) {
+						builder.addItem(*it);
+						++it;
+						if (builder.bufferedSize() >= flushThreshold) {
+							return stream.write(builder.takePacket()).then([] {
+								return seastar::stop_iteration::no;
+							});
+						}
+					}
+					builder.endArray();
+					return stream.write(builder.takePacket()).then([] {
+						return seastar::stop_iteration::yes;
+					});
+				});
+			});
+		}
+	};
+
+	/** Convenient static function for JsonStreamSerializer */
+	template <class T>
+	static inline seastar::future<> serializeJsonToStream(
+		OutputStreamBase& stream,
+		const T& model,
+		std::size_t flushThreshold = JsonStreamSerializer<T>::DefaultFlushThreshold) {
+		return JsonStreamSerializer<T>::serialize(stream, model, flushThreshold);
+	}
+}
+
@@ -0,0 +1,477 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include "../Exceptions/DeserializeException.hpp"
+#include "../Utility/ObjectTrait.hpp"
+#include "../Utility/SharedString.hpp"
+
+namespace cpv {
+	/** Type of msgpack value */
+	enum class MsgPackType {
+		Nil,
+		Bool,
+		Integer,
+		Double,
+		String,
+		Binary,
+		Array,
+		Map,
+		Extension,
+		/** Returned from operator[] when key not exists or index out of range */
+		NoKey
+	};
+
+	/** Decoded header of msgpack value */
+	struct MsgPackHeader {
+		MsgPackType type;
+		/** Size of header in bytes, includes the payload of scalar values */
+		std::uint32_t size;
+		/** Size of payload in bytes for string, binary and extension, or number of children */
+		std::uint64_t length;
+	};
+
+	/** Read big endian unsigned integer from msgpack */
+	template <class T>
+	static inline T readMsgPackBigEndian(const char* ptr) {
+		T value = 0;
+		for (std::size_t i = 0; i < sizeof(T); ++i) {
+			value = static_cast<T>((value << 8) | static_cast<std::uint8_t>(ptr[i]));
+		}
+		return value;
+	}
+
+	/**
+	 * Get the size of header by the first byte of msgpack value,
+	 * return 0 for the never used byte (0xc1).
+	 */
+	static inline std::uint32_t getMsgPackHeaderSize(std::uint8_t first) {
+		if (first <= 0xbf || first >= 0xe0) {
+			// fixint, fixmap, fixarray, fixstr
+			return 1;
+		}
+		static const constexpr std::uint8_t Sizes[] = {
+			1, 0, 1, 1, // nil, (never used), false, true
+			2, 3, 5, // bin 8, 16, 32
+			3, 4, 6, // ext 8, 16, 32
+			5, 9, // float 32, 64
+			2, 3, 5, 9, // uint 8, 16, 32, 64
+			2, 3, 5, 9, // int 8, 16, 32, 64
+			2, 2, 2, 2, 2, // fixext 1, 2, 4, 8, 16
+			2, 3, 5, // str 8, 16, 32
+			3, 5, // array 16, 32
+			3, 5 // map 16, 32
+		};
+		return Sizes[first - 0xc0];
+	}
+
+	/** Decode header of msgpack value, the size returned by getMsgPackHeaderSize must be readable */
+	static inline MsgPackHeader parseMsgPackHeader(const char* ptr) {
+		std::uint8_t first = static_cast<std::uint8_t>(*ptr);
+		if (first <= 0x7f || first >= 0xe0) {
+			return { MsgPackType::Integer, 1, 0 };
+		} else if (first <= 0x8f) {
+			return { MsgPackType::Map, 1, first & 0x0fU };
+		} else if (first <= 0x9f) {
+			return { MsgPackType::Array, 1, first & 0x0fU };
+		} else if (first <= 0xbf) {
+			return { MsgPackType::String, 1, first & 0x1fU };
+		}
+		std::uint32_t size = getMsgPackHeaderSize(first);
+		switch (first) {
+			case 0xc0: return { MsgPackType::Nil, size, 0 };
+			case 0xc2: case 0xc3: return { MsgPackType::Bool, size, 0 };
+			case 0xc4: return { MsgPackType::Binary, size, readMsgPackBigEndian<std::uint8_t>(ptr + 1) };
+			case 0xc5: return { MsgPackType::Binary, size, readMsgPackBigEndian<std::uint16_t>(ptr + 1) };
+			case 0xc6: return { MsgPackType::Binary, size, readMsgPackBigEndian<std::uint32_t>(ptr + 1) };
+			case 0xc7: return { MsgPackType::Extension, size, readMsgPackBigEndian<std::uint8_t>(ptr + 1) };
+			case 0xc8: return { MsgPackType::Extension, size, readMsgPackBigEndian<std::uint16_t>(ptr + 1) };
+			case 0xc9: return { MsgPackType::Extension, size, readMsgPackBigEndian<std::uint32_t>(ptr + 1) };
+			case 0xca: case 0xcb: return { MsgPackType::Double, size, 0 };
+			case 0xd4: return { MsgPackType::Extension, size, 1 };
+			case 0xd5: return { MsgPackType::Extension, size, 2 };
+			case 0xd6: return { MsgPackType::Extension, size, 4 };
+			case 0xd7: return { MsgPackType::Extension, size, 8 };
+			case 0xd8: return { MsgPackType::Extension, size, 16 };
+			case 0xd9: return { MsgPackType::String, size, readMsgPackBigEndian<std::uint8_t>(ptr + 1) };
+			case 0xda: return { MsgPackType::String, size, readMsgPackBigEndian<std::uint16_t>(ptr + 1) };
+			case 0xdb: return { MsgPackType::String, size, readMsgPackBigEndian<std::uint32_t>(ptr + 1) };
+			case 0xdc: return { MsgPackType::Array, size, readMsgPackBigEndian<std::uint16_t>(ptr + 1) };
+			case 0xdd: return { MsgPackType::Array, size, readMsgPackBigEndian<std::uint32_t>(ptr + 1) };
+			case 0xde: return { MsgPackType::Map, size, readMsgPackBigEndian<std::uint16_t>(ptr + 1) };
+			case 0xdf: return { MsgPackType::Map, size, readMsgPackBigEndian<std::uint32_t>(ptr + 1) };
+			default: return { MsgPackType::Integer, size, 0 }; // uint and int 8 ~ 64, and 0xc1
+		}
+	}
+
+	/**
+	 * Validate msgpack, return nullptr if valid or the error message if invalid,
+	 * position is set to the offset of error.
+	 * It iterates values without recursion so deeply nested msgpack won't overflow the stack.
+	 */
+	const char* validateMsgPack(std::string_view data, std::size_t& position);
+
+	/**
+	 * Value inside msgpack, it points to the original buffer (parse in place),
+	 * strings and binaries can share the storage of buffer.
+	 * The msgpack must be validated before accessing values.
+	 */
+	class MsgPackValue {
+	public:
+		/** Get the type of value */
+		MsgPackType getType() const {
+			return ptr_ == nullptr ? MsgPackType::NoKey : parseMsgPackHeader(ptr_).type;
+		}
+
+		/** Get boolean value, type must be Bool */
+		bool getBool() const {
+			return static_cast<std::uint8_t>(*ptr_) == 0xc3;
+		}
+
+		/** Get integer value, type must be Integer, uint 64 larger than int64 max is wrapped */
+		std::int64_t getInteger() const;
+
+		/** Get floating point value, type must be Double (float 32 or float 64) */
+		double getDouble() const;
+
+		/** Get the view of string or binary, type must be String or Binary */
+		std::string_view getStringView() const {
+			MsgPackHeader header = parseMsgPackHeader(ptr_);
+			return { ptr_ + header.size, static_cast<std::size_t>(header.length) };
+		}
+
+		/** Get string or binary shares the storage of msgpack, type must be String or Binary */
+		SharedString getString() const {
+			return str_.share(getStringView());
+		}
+
+		/**
+		 * Get the number of items for array, number of members for map,
+		 * or size in bytes for string, binary and extension.
+		 */
+		std::size_t getLength() const {
+			return static_cast<std::size_t>(parseMsgPackHeader(ptr_).length);
+		}
+
+		/**
+		 * Get value by key for map, return NoKey if key not exists.
+		 * Notice it's a linear search, prefer forEachMember for iterating all members.
+		 */
+		MsgPackValue operator[](std::string_view key) const;
+
+		/**
+		 * Get value by index for array, return NoKey if index out of range.
+		 * Notice it's a linear search, prefer forEachItem for iterating all items.
+		 */
+		MsgPackValue operator[](std::size_t index) const;
+
+		/** Invoke func with each item of array, type must be Array */
+		template <class Func>
+		void forEachItem(const Func& func) const {
+			MsgPackHeader header = parseMsgPackHeader(ptr_);
+			const char* ptr = ptr_ + header.size;
+			for (std::uint64_t i = 0; i < header.length; ++i) {
+				MsgPackValue item(ptr, str_);
+				func(item);
+				ptr = item.next();
+			}
+		}
+
+		/** Invoke func with key and value of each member of map, type must be Map */
+		template <class Func>
+		void forEachMember(const Func& func) const {
+			MsgPackHeader header = parseMsgPackHeader(ptr_);
+			const char* ptr = ptr_ + header.size;
+			for (std::uint64_t i = 0; i < header.length; ++i) {
+				MsgPackValue key(ptr, str_);
+				MsgPackValue value(key.next(), str_);
+				func(key, value);
+				ptr = value.next();
+			}
+		}
+
+		/** Get the pointer after this value */
+		const char* next() const;
+
+		/** Get original msgpack buffer */
+		const SharedString& msgPackStr() const& { return str_; }
+
+		/** Constructor, ptr can be nullptr for NoKey */
+		MsgPackValue(const char* ptr, const SharedString& str) :
+			ptr_(ptr), str_(str) { }
+
+	private:
+		const char* ptr_;
+		const SharedString& str_;
+	};
+
+	/**
+	 * The class used to convert msgpack value to model.
+	 *
+	 * The model type should contains a public function named loadMsgPack
+	 * that takes a MsgPackValue represents the map and return whether
+	 * loaded successfully.
+	 *
+	 * You can specialize it for more types.
+	 */
+	template <class T, class = void /* for enable_if */>
+	struct MsgPackValueConverter {
+		/** Convert msgpack value to model */
+		static bool convert(T& model, const MsgPackValue& value) {
+			if (CPV_LIKELY(value.getType() == MsgPackType::Map)) {
+				return model.loadMsgPack(value);
+			}
+			return false;
+		}
+	};
+
+	/** Specialize for integer */
+	template <class T>
+	struct MsgPackValueConverter<T,
+		std::enable_if_t<std::numeric_limits<T>::is_integer && !std::is_same_v<T, bool>>> {
+		/** Convert msgpack value to integer if type matched */
+		static bool convert(T& target, const MsgPackValue& value) {
+			if (CPV_LIKELY(value.getType() == MsgPackType::Integer)) {
+				target = static_cast<T>(value.getInteger());
+				return true;
+			}
+			return false;
+		}
+	};
+
+	/** Specialize for floating point */
+	template <class T>
+	struct MsgPackValueConverter<T,
+		std::enable_if_t<std::is_floating_point_v<T>>> {
+		/** Convert msgpack value to floating point if type matched */
+		static bool convert(T& target, const MsgPackValue& value) {
+			MsgPackType type = value.getType();
+			if (type == MsgPackType::Double) {
+				target = static_cast<T>(value.getDouble());
+				return true;
+			} else if (type == MsgPackType::Integer) {
+				target = static_cast<T>(value.getInteger());
+				return true;
+			}
+			return false;
+		}
+	};
+
+	/** Specialize for bool */
+	template <>
+	struct MsgPackValueConverter<bool> {
+		/** Convert msgpack value to bool if type matched */
+		static bool convert(bool& target, const MsgPackValue& value) {
+			if (CPV_LIKELY(value.getType() == MsgPackType::Bool)) {
+				target = value.getBool();
+				return true;
+			}
+			return false;
+		}
+	};
+
+	/** Specialize for SharedString, string shares the storage of msgpack */
+	template <>
+	struct MsgPackValueConverter<SharedString> {
+		/** Convert msgpack value to SharedString if type matched */
+		static bool convert(SharedString& target, const MsgPackValue& value) {
+			MsgPackType type = value.getType();
+			if (CPV_LIKELY(type == MsgPackType::String || type == MsgPackType::Binary)) {
+				target = value.getString();
+				return true;
+			}
+			return false;
+		}
+	};
+
+	/** Specialize for std::string */
+	template <>
+	struct MsgPackValueConverter<std::string> {
+		/** Convert msgpack value to std::string if type matched */
+		static bool convert(std::string& target, const MsgPackValue& value) {
+			MsgPackType type = value.getType();
+			if (CPV_LIKELY(type == MsgPackType::String || type == MsgPackType::Binary)) {
+				target.assign(value.getStringView());
+				return true;
+			}
+			return false;
+		}
+	};
+
+	/** Specialize for collection like types */
+	template <class T>
+	struct MsgPackValueConverter<T, std::enable_if_t<
+		ObjectTrait<T>::IsCollectionLike && !ObjectTrait<T>::IsPointerLike>> {
+		/** Convert msgpack value to collection like object if type matched */
+		static bool convert(T& models, const MsgPackValue& value) {
+			using Trait = ObjectTrait<T>;
+			using UnderlyingType = typename Trait::UnderlyingType;
+			if (CPV_LIKELY(value.getType() == MsgPackType::Array)) {
+				Trait::reserve(models, Trait::size(models) + value.getLength());
+				bool result = true;
+				value.forEachItem([&models, &result] (const MsgPackValue& item) {
+					result = MsgPackValueConverter<UnderlyingType>::convert(
+						Trait::add(models), item) && result;
+				});
+				return result;
+			}
+			return false;
+		}
+	};
+
+	/** Specialize for map like types with string key */
+	template <class T>
+	struct MsgPackValueConverter<T, std::enable_if_t<ObjectTrait<T>::IsMapLike>> {
+		/** Convert msgpack map to map like object if type matched */
+		static bool convert(T& models, const MsgPackValue& value) {
+			using Trait = ObjectTrait<T>;
+			using KeyType = typename Trait::KeyType;
+			using UnderlyingType = typename Trait::UnderlyingType;
+			static_assert(std::is_same_v<KeyType, SharedString> || std::is_same_v<KeyType, std::string>,
+				"key of map should be SharedString or std::string");
+			if (CPV_LIKELY(value.getType() == MsgPackType::Map)) {
+				Trait::reserve(models, Trait::size(models) + value.getLength());
+				bool result = true;
+				value.forEachMember([&models, &result] (const MsgPackValue& key, const MsgPackValue& child) {
+					KeyType keyValue;
+					if (CPV_UNLIKELY(!MsgPackValueConverter<KeyType>::convert(keyValue, key))) {
+						result = false;
+						return;
+					}
+					// reset existing value, the last one wins if key is duplicated
+					UnderlyingType& model = Trait::add(models, std::move(keyValue));
+					model = UnderlyingType();
+					result = MsgPackValueConverter<UnderlyingType>::convert(model, child) && result;
+				});
+				return result;
+			}
+			return false;
+		}
+	};
+
+	/** Specialize for pointer like types */
+	template <class T>
+	struct MsgPackValueConverter<T, std::enable_if_t<ObjectTrait<T>::IsPointerLike>> {
+		/** Convert msgpack value to pointer like object if type matched */
+		static bool convert(T& target, const MsgPackValue& value) {
+			using Trait = ObjectTrait<T>;
+			using UnderlyingType = typename Trait::UnderlyingType;
+			if (value.getType() == MsgPackType::Nil) {
+				Trait::reset(target);
+				return true;
+			} else {
+				if (Trait::get(target) == nullptr) {
+					target = Trait::create();
+				}
+				return MsgPackValueConverter<UnderlyingType>::convert(
+					*Trait::get(target), value);
+			}
+		}
+	};
+
+	/** Specialize for chrono durations */
+	template <class Rep, class Period>
+	struct MsgPackValueConverter<std::chrono::duration<Rep, Period>> {
+		/** Convert msgpack value to chrono duration if type matched */
+		static bool convert(
+			std::chrono::duration<Rep, Period>& target, const MsgPackValue& value) {
+			Rep count;
+			if (CPV_LIKELY(MsgPackValueConverter<Rep>::convert(count, value))) {
+				target = std::chrono::duration<Rep, Period>(count);
+				return true;
+			}
+			return false;
+		}
+	};
+
+	/** Specialize for std::monostate, it's the nil alternative of std::variant */
+	template <>
+	struct MsgPackValueConverter<std::monostate> {
+		/** Convert msgpack value to std::monostate if it's nil */
+		static bool convert(std::monostate&, const MsgPackValue& value) {
+			return value.getType() == MsgPackType::Nil;
+		}
+	};
+
+	/**
+	 * Specialize for std::variant.
+	 * Alternatives are tried in order and the first alternative converted successfully
+	 * will be used, same as the json deserializer.
+	 */
+	template <class... Types>
+	struct MsgPackValueConverter<std::variant<Types...>> {
+		/** Convert msgpack value to the first matched alternative of std::variant */
+		static bool convert(std::variant<Types...>& target, const MsgPackValue& value) {
+			return convertAlternatives(target, value, std::index_sequence_for<Types...>());
+		}
+
+	private:
+		template <std::size_t... Indices>
+		static bool convertAlternatives(std::variant<Types...>& target,
+			const MsgPackValue& value, std::index_sequence<Indices...>) {
+			return (convertAlternative<Indices>(target, value) || ...);
+		}
+
+		template <std::size_t Index>
+		static bool convertAlternative(std::variant<Types...>& target, const MsgPackValue& value) {
+			// convert to temporary object to keep target unchanged if not matched
+			std::variant_alternative_t<Index, std::variant<Types...>> alternative;
+			if (MsgPackValueConverter<decltype(alternative)>::convert(alternative, value)) {
+				target.template emplace<Index>(std::move(alternative));
+				return true;
+			}
+			return false;
+		}
+	};
+
+	/** Convenient static function for MsgPackValueConverter */
+	template <class T>
+	static inline bool convertMsgPackValue(T& model, const MsgPackValue& value) {
+		return MsgPackValueConverter<T>::convert(model, value);
+	}
+
+	/**
+	 * The class used to deserialize msgpack to model.
+	 *
+	 * The model should be convertible from MsgPackValue by using MsgPackValueConverter.
+	 *
+	 * Unlike json, msgpack is parsed in place without modifying the buffer,
+	 * strings of model can share the storage of buffer.
+	 */
+	template <class T, class = void /* for enable_if */>
+	class MsgPackDeserializer {
+	public:
+		/** Deserialize msgpack to model */
+		static std::optional<DeserializeException> deserialize(
+			T& model, const SharedString& str) {
+			std::size_t position = 0;
+			const char* error = validateMsgPack(str.view(), position);
+			if (CPV_UNLIKELY(error != nullptr)) {
+				return DeserializeException(CPV_CODEINFO, error, "at position", position);
+			}
+			MsgPackValue root(str.data(), str);
+			if (CPV_UNLIKELY(!MsgPackValueConverter<T>::convert(model, root))) {
+				return DeserializeException(CPV_CODEINFO, "convert failed");
+			}
+			return std::nullopt;
+		}
+	};
+
+	/** Convenient static function for MsgPackDeserializer */
+	template <class T>
+	static inline std::optional<DeserializeException> deserializeMsgPack(
+		T& model, const SharedString& str) {
+		return MsgPackDeserializer<T>::deserialize(model, str);
+	}
+
+	/** Convenient operator overload for MsgPackValueConverter */
+	template <class T>
+	static inline void operator<<(T& model, const MsgPackValue& value) {
+		MsgPackValueConverter<T>::convert(model, value);
+	}
+}
+
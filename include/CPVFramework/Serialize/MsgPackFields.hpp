@@ -0,0 +1,121 @@
+#pragma once
+#include "./JsonFields.hpp"
+#include "./MsgPackDeserializer.hpp"
+#include "./MsgPackSerializer.hpp"
+
+// generate dumpMsgPack and loadMsgPack for given members, member names are used as map keys
+#define CPV_MSGPACK_FIELDS(...) \
+	void dumpMsgPack(::cpv::MsgPackBuilder& builder) const { \
+		using Fields = ::cpv::MsgPackFields<CPV_JSON_FIELDS_MAP(CPV_JSON_FIELDS_TYPE, __VA_ARGS__)>; \
+		static const constexpr auto keys = Fields::makeKeys( \
+			CPV_JSON_FIELDS_MAP(CPV_JSON_FIELDS_NAME, __VA_ARGS__)); \
+		Fields::dump(builder, keys, __VA_ARGS__); \
+	} \
+	bool loadMsgPack(const ::cpv::MsgPackValue& value) { \
+		using Fields = ::cpv::MsgPackFields<CPV_JSON_FIELDS_MAP(CPV_JSON_FIELDS_TYPE, __VA_ARGS__)>; \
+		static const constexpr auto index = Fields::makeIndex( \
+			CPV_JSON_FIELDS_MAP(CPV_JSON_FIELDS_NAME, __VA_ARGS__)); \
+		return Fields::load(value, index, __VA_ARGS__); \
+	}
+
+namespace cpv {
+	/**
+	 * Generate msgpack serialization and deserialization for members, used by CPV_MSGPACK_FIELDS.
+	 * It shares the field list macros and the perfect hash index with CPV_JSON_FIELDS,
+	 * the map header and encoded keys are built at compile time.
+	 */
+	template <class... Types>
+	class MsgPackFields {
+	public:
+		static const constexpr std::size_t Count = sizeof...(Types);
+		static_assert(Count > 0 && Count <= std::numeric_limits<std::uint8_t>::max(),
+			"number of fields out of range");
+
+		/** Build encoded keys, part i is written before value i, the map header is merged into part 0 */
+		template <std::size_t... Sizes>
+		static constexpr auto makeKeys(const char(&... names)[Sizes]) {
+			static_assert(sizeof...(Sizes) == Count, "number of names not matched");
+			JsonFieldsKeys<Count, (Sizes + ...) + Count + 3> keys {};
+			const char* nameList[] = { names... };
+			const std::size_t nameSizes[] = { (Sizes - 1)... };
+			std::size_t offset = 0;
+			for (std::size_t i = 0; i < Count; ++i) {
+				keys.offsets[i] = offset;
+				if (i == 0) {
+					// fixmap or map 16
+					if (Count <= 15) {
+						keys.buffer[offset++] = static_cast<char>(0x80 | Count);
+					} else {
+						keys.buffer[offset++] = static_cast<char>(0xde);
+						keys.buffer[offset++] = 0;
+						keys.buffer[offset++] = static_cast<char>(Count);
+					}
+				}
+				// fixstr or str 8
+				if (nameSizes[i] <= 31) {
+					keys.buffer[offset++] = static_cast<char>(0xa0 | nameSizes[i]);
+				} else if (nameSizes[i] <= 255) {
+					keys.buffer[offset++] = static_cast<char>(0xd9);
+					keys.buffer[offset++] = static_cast<char>(nameSizes[i]);
+				} else {
+					// it's a compile error if reached in constant evaluation
+					throw LogicException(CPV_CODEINFO, "field name too long");
+				}
+				for (std::size_t j = 0; j < nameSizes[i]; ++j) {
+					keys.buffer[offset++] = nameList[i][j];
+				}
+			}
+			keys.offsets[Count] = offset;
+			keys.offsets[Count + 1] = offset;
+			return keys;
+		}
+
+		/** Build perfect hash index for field names */
+		template <std::size_t... Sizes>
+		static constexpr auto makeIndex(const char(&... names)[Sizes]) {
+			return JsonFields<Types...>::makeIndex(names...);
+		}
+
+		/** Write members to msgpack builder */
+		template <std::size_t Capacity, class... Values>
+		static void dump(
+			MsgPackBuilder& builder,
+			const JsonFieldsKeys<Count, Capacity>& keys,
+			const Values&... values) {
+			std::size_t index = 0;
+			((builder.writeRaw(keys.get(index++)),
+				MsgPackBuilderWriter<Values>::write(values, builder)), ...);
+		}
+
+		/** Read members from msgpack map, return false if it's not a map */
+		template <class Index, class... Values>
+		static bool load(const MsgPackValue& value, const Index& index, Values&... values) {
+			if (CPV_UNLIKELY(value.getType() != MsgPackType::Map)) {
+				return false;
+			}
+			value.forEachMember([&index, &values...] (const MsgPackValue& key, const MsgPackValue& child) {
+				if (CPV_LIKELY(key.getType() == MsgPackType::String)) {
+					std::size_t fieldIndex = index.find(key.getStringView());
+					if (fieldIndex < Count) {
+						loadValue(fieldIndex, child, std::index_sequence_for<Values...>(), values...);
+					}
+				}
+			});
+			return true;
+		}
+
+	private:
+		/** Convert msgpack value to the member at given index */
+		template <std::size_t... Indexes, class... Values>
+		static void loadValue(
+			std::size_t fieldIndex,
+			const MsgPackValue& value,
+			std::index_sequence<Indexes...>,
+			Values&... values) {
+			((Indexes == fieldIndex ?
+				static_cast<void>(MsgPackValueConverter<Values>::convert(values, value)) :
+				static_cast<void>(0)), ...);
+		}
+	};
+}
+
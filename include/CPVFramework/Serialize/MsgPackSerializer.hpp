@@ -0,0 +1,298 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <variant>
+#include "../Utility/ObjectTrait.hpp"
+#include "../Utility/Packet.hpp"
+#include "../Utility/SharedString.hpp"
+#include "../Utility/SharedStringBuilder.hpp"
+
+namespace cpv {
+	/**
+	 * The class used to build MessagePack packet.
+	 *
+	 * Values are written to a contiguous buffer, only strings not shorter than
+	 * LargeStringThreshold are appended as separate fragments without copying.
+	 * The number of items or members must be given when starting an array or map,
+	 * for performance reason, it won't validate the sequence of operations.
+	 */
+	class MsgPackBuilder {
+	public:
+		/** Strings not shorter than this size won't be copied */
+		static const constexpr std::size_t LargeStringThreshold = 256;
+
+		/** Write header of map with given number of members */
+		MsgPackBuilder& startMap(std::size_t size);
+
+		/**
+		 * Write key and value to msgpack packet.
+		 * It should be used after startMap for the given number of times.
+		 */
+		template <class T>
+		MsgPackBuilder& addMember(const SharedString& key, const T& value);
+
+		/** Write header of array with given number of items */
+		MsgPackBuilder& startArray(std::size_t size);
+
+		/**
+		 * Write item to msgpack packet.
+		 * It should be used after startArray for the given number of times.
+		 */
+		template <class T>
+		MsgPackBuilder& addItem(const T& value);
+
+		/** Write nil */
+		void writeNil() {
+			buffer_.append(1, static_cast<char>(0xc0));
+		}
+
+		/** Write boolean */
+		void writeBool(bool value) {
+			buffer_.append(1, static_cast<char>(value ? 0xc3 : 0xc2));
+		}
+
+		/** Write signed integer with the shortest encoding */
+		void writeInteger(std::int64_t value);
+
+		/** Write unsigned integer with the shortest encoding */
+		void writeUnsignedInteger(std::uint64_t value);
+
+		/** Write floating point as float 64 */
+		void writeDouble(double value);
+
+		/** Write string, large string is appended as a separate fragment without copying */
+		void writeString(const SharedString& value);
+
+		/** Write string by copying */
+		void writeString(std::string_view value);
+
+		/** Write raw encoded data */
+		void writeRaw(std::string_view data) {
+			buffer_.append(data);
+		}
+
+		/** Get the size in bytes of msgpack written so far */
+		std::size_t bufferedSize() const {
+			return packet_.size() + buffer_.size();
+		}
+
+		/** Get the msgpack packet, don't touch the msgpack builder after invoked this */
+		Packet toPacket() &&;
+
+		/** Constructor with initial size of buffer */
+		explicit MsgPackBuilder(std::size_t capacity);
+
+	private:
+		/** Write header of string, array or map, headers are selected by length */
+		void writeHeader(std::size_t size,
+			std::uint8_t fixPrefix, std::size_t fixLimit,
+			std::uint8_t prefix8, std::uint8_t prefix16, std::uint8_t prefix32);
+
+		/** Write prefix and big endian integer */
+		template <class T>
+		void writeBigEndian(std::uint8_t prefix, T value) {
+			char* ptr = buffer_.grow(sizeof(T) + 1);
+			*ptr++ = static_cast<char>(prefix);
+			for (std::size_t i = sizeof(T); i > 0; --i) {
+				*ptr++ = static_cast<char>(static_cast<std::uint8_t>(value >> ((i - 1) * 8)));
+			}
+		}
+
+		/** Append content of buffer to packet as a fragment */
+		void flushBuffer();
+
+	private:
+		Packet packet_;
+		Packet::MultipleFragments* fragments_;
+		SharedStringBuilder buffer_;
+	};
+
+	/**
+	 * The class used to write model to msgpack builder.
+	 *
+	 * The model type should contains a public function named dumpMsgPack
+	 * that takes an instance of MsgPackBuilder.
+	 *
+	 * You can specialize it for more types.
+	 */
+	template <class T, class = void /* for enable_if */>
+	struct MsgPackBuilderWriter {
+		/** Write model to msgpack builder */
+		static void write(const T& model, MsgPackBuilder& builder) {
+			model.dumpMsgPack(builder);
+		}
+	};
+
+	/** Specialize for integer (except of bool) */
+	template <class T>
+	struct MsgPackBuilderWriter<T,
+		std::enable_if_t<std::numeric_limits<T>::is_integer && !std::is_same_v<T, bool>>> {
+		/** Write integer to msgpack builder */
+		static void write(const T& value, MsgPackBuilder& builder) {
+			if constexpr (std::numeric_limits<T>::is_signed) {
+				builder.writeInteger(static_cast<std::int64_t>(value));
+			} else {
+				builder.writeUnsignedInteger(static_cast<std::uint64_t>(value));
+			}
+		}
+	};
+
+	/** Specialize for floating point */
+	template <class T>
+	struct MsgPackBuilderWriter<T,
+		std::enable_if_t<std::is_floating_point_v<T>>> {
+		/** Write floating point to msgpack builder */
+		static void write(const T& value, MsgPackBuilder& builder) {
+			builder.writeDouble(static_cast<double>(value));
+		}
+	};
+
+	/** Specialize for bool */
+	template <>
+	struct MsgPackBuilderWriter<bool> {
+		/** Write boolean to msgpack builder */
+		static void write(bool value, MsgPackBuilder& builder) {
+			builder.writeBool(value);
+		}
+	};
+
+	/** Specialize for SharedString */
+	template <>
+	struct MsgPackBuilderWriter<SharedString> {
+		/** Write SharedString to msgpack builder */
+		static void write(const SharedString& value, MsgPackBuilder& builder) {
+			builder.writeString(value);
+		}
+	};
+
+	/** Specialize for std::string */
+	template <>
+	struct MsgPackBuilderWriter<std::string> {
+		/** Write std::string to msgpack builder */
+		static void write(const std::string& value, MsgPackBuilder& builder) {
+			builder.writeString(std::string_view(value));
+		}
+	};
+
+	/** Specialize for collection like types */
+	template <class T>
+	struct MsgPackBuilderWriter<T, std::enable_if_t<
+		ObjectTrait<T>::IsCollectionLike && !ObjectTrait<T>::IsPointerLike>> {
+		/** Write collection like oject to msgpack builder */
+		static void write(const T& values, MsgPackBuilder& builder) {
+			builder.startArray(ObjectTrait<T>::size(values));
+			ObjectTrait<T>::apply(values, [&builder] (const auto& value) {
+				builder.addItem(value);
+			});
+		}
+	};
+
+	/** Specialize for map like types with string key */
+	template <class T>
+	struct MsgPackBuilderWriter<T, std::enable_if_t<ObjectTrait<T>::IsMapLike>> {
+		/** Write map like object to msgpack builder */
+		static void write(const T& values, MsgPackBuilder& builder) {
+			using KeyType = typename ObjectTrait<T>::KeyType;
+			static_assert(std::is_same_v<KeyType, SharedString> || std::is_same_v<KeyType, std::string>,
+				"key of map should be SharedString or std::string");
+			builder.startMap(ObjectTrait<T>::size(values));
+			ObjectTrait<T>::apply(values, [&builder] (const auto& key, const auto& value) {
+				MsgPackBuilderWriter<KeyType>::write(key, builder);
+				MsgPackBuilderWriter<std::decay_t<decltype(value)>>::write(value, builder);
+			});
+		}
+	};
+
+	/** Specialize for pointer like types */
+	template <class T>
+	struct MsgPackBuilderWriter<T, std::enable_if_t<ObjectTrait<T>::IsPointerLike>> {
+		/** Write pointer like object to msgpack builder */
+		static void write(const T& value, MsgPackBuilder& builder) {
+			using UnderlyingType = typename ObjectTrait<T>::UnderlyingType;
+			const UnderlyingType* ptr = ObjectTrait<T>::get(value);
+			if (ptr != nullptr) {
+				MsgPackBuilderWriter<UnderlyingType>::write(*ptr, builder);
+			} else {
+				builder.writeNil();
+			}
+		}
+	};
+
+	/** Specialize for chrono durations */
+	template <class Rep, class Period>
+	struct MsgPackBuilderWriter<std::chrono::duration<Rep, Period>> {
+		/** Write chrono durations to msgpack builder */
+		static void write(
+			const std::chrono::duration<Rep, Period>& value, MsgPackBuilder& builder) {
+			MsgPackBuilderWriter<Rep>::write(value.count(), builder);
+		}
+	};
+
+	/** Specialize for std::monostate, it's the nil alternative of std::variant */
+	template <>
+	struct MsgPackBuilderWriter<std::monostate> {
+		/** Write nil to msgpack builder */
+		static void write(const std::monostate&, MsgPackBuilder& builder) {
+			builder.writeNil();
+		}
+	};
+
+	/** Specialize for std::variant */
+	template <class... Types>
+	struct MsgPackBuilderWriter<std::variant<Types...>> {
+		/** Write the holding alternative of std::variant to msgpack builder */
+		static void write(const std::variant<Types...>& value, MsgPackBuilder& builder) {
+			if (CPV_UNLIKELY(value.valueless_by_exception())) {
+				builder.writeNil();
+				return;
+			}
+			std::visit([&builder] (const auto& alternative) {
+				MsgPackBuilderWriter<std::decay_t<decltype(alternative)>>::write(alternative, builder);
+			}, value);
+		}
+	};
+
+	/** Write key and value to msgpack packet */
+	template <class T>
+	MsgPackBuilder& MsgPackBuilder::addMember(const SharedString& key, const T& value) {
+		writeString(key);
+		MsgPackBuilderWriter<T>::write(value, *this);
+		return *this;
+	}
+
+	/** Write item to msgpack packet */
+	template <class T>
+	MsgPackBuilder& MsgPackBuilder::addItem(const T& value) {
+		MsgPackBuilderWriter<T>::write(value, *this);
+		return *this;
+	}
+
+	/**
+	 * The class used to serialize model to msgpack packet.
+	 * The model should be writable to MsgPackBuilder from MsgPackBuilderWriter.
+	 * If you want to build a msgpack without model, you can use MsgPackBuilder directly.
+	 */
+	template <class T, class = void /* for enable_if */>
+	class MsgPackSerializer {
+	public:
+		/** The default size hint, it's the initial buffer size */
+		static const constexpr std::size_t DefaultSizeHint = 512;
+
+		/** Serialize model to msgpack packet, sizeHint is the estimated size of msgpack in bytes */
+		static Packet serialize(const T& model, std::size_t sizeHint = DefaultSizeHint) {
+			MsgPackBuilder builder(sizeHint);
+			MsgPackBuilderWriter<T>::write(model, builder);
+			return std::move(builder).toPacket();
+		}
+	};
+
+	/** Convenient static function for MsgPackSerializer */
+	template <class T>
+	static inline Packet serializeMsgPack(
+		const T& model, std::size_t sizeHint = MsgPackSerializer<T>::DefaultSizeHint) {
+		return MsgPackSerializer<T>::serialize(model, sizeHint);
+	}
+}
+
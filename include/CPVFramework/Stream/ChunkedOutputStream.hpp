@@ -0,0 +1,32 @@
+#pragma once
+#include "../Utility/Packet.hpp"
+#include "./OutputStreamBase.hpp"
+
+namespace cpv {
+	/**
+	 * Output stream that encodes each write as a chunk of http chunked transfer encoding
+	 * and writes it to the underlying stream, writeEnd should be called after all data written.
+	 * The underlying stream must keep alive until all writes completed.
+	 */
+	class ChunkedOutputStream : public OutputStreamBase {
+	public:
+		/** Write data as a chunk, empty data is ignored because empty chunk indicates the end */
+		seastar::future<> write(Packet&& data) override;
+		
+		/** Write the last chunk to indicate the end */
+		seastar::future<> writeEnd();
+		
+		/** For Reusable<> */
+		void freeResources();
+		
+		/** For Reusable<> */
+		void reset(OutputStreamBase* stream);
+		
+		/** Constructor */
+		ChunkedOutputStream();
+		
+	private:
+		OutputStreamBase* stream_;
+	};
+}
+
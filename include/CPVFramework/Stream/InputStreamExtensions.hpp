@@ -42,5 +42,13 @@ namespace cpv::extensions {
 		}
 		return readAll(*stream.get());
 	}
+
+	/**
+	 * Read all data from stream and write to file (created or truncated) with dma,
+	 * return the size of data written, must keep stream live until future resolved.
+	 * Data is copied to aligned buffer and written by blocks, so the memory usage
+	 * doesn't depend on the size of stream.
+	 */
+	seastar::future<std::size_t> writeAllToFile(InputStreamBase& stream, const SharedString& path);
 }
 
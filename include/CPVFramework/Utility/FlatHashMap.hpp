@@ -0,0 +1,517 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#include "./Macros.hpp"
+
+namespace cpv {
+	/**
+	 * Hash map with open addressing, entries are stored in a flat array.
+	 *
+	 * Each slot has a control byte that is either empty, deleted, or 7 bits of the hash,
+	 * lookup compares 16 control bytes at once (with sse2 if available) and only compares
+	 * keys when the hash bits matched, probing stops at the first group contains an empty slot.
+	 * Slots and control bytes are allocated in a single memory block, and clear() keeps
+	 * the memory block, so a map that reused after clear won't allocate again.
+	 * The interface is a subset of std::unordered_map.
+	 *
+	 * Notice:
+	 * Insert may rehash and invalidate iterators and references, erase doesn't.
+	 * The value type is std::pair<Key, T> (key is not const), don't modify keys while iterating.
+	 */
+	template <
+		class Key,
+		class T,
+		class Hash = std::hash<Key>,
+		class KeyEqual = std::equal_to<Key>>
+	class FlatHashMap {
+	public:
+		using key_type = Key;
+		using mapped_type = T;
+		using value_type = std::pair<Key, T>;
+		using hasher = Hash;
+		using key_equal = KeyEqual;
+		using size_type = std::size_t;
+
+		/** The number of control bytes compared at once */
+		static const constexpr std::size_t GroupSize = 16;
+
+		/** Iterator type for const and non const map */
+		template <bool IsConst>
+		class Iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = FlatHashMap::value_type;
+			using difference_type = std::ptrdiff_t;
+			using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
+			using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
+
+			reference operator*() const { return *slot_; }
+			pointer operator->() const { return slot_; }
+			bool operator==(const Iterator& other) const { return ctrl_ == other.ctrl_; }
+			bool operator!=(const Iterator& other) const { return ctrl_ != other.ctrl_; }
+			Iterator& operator++() {
+				++ctrl_;
+				++slot_;
+				skipEmptySlots();
+				return *this;
+			}
+			Iterator operator++(int) {
+				Iterator result = *this;
+				++*this;
+				return result;
+			}
+
+			/** Convert non const iterator to const iterator */
+			template <bool IsOtherConst, std::enable_if_t<IsConst && !IsOtherConst, int> = 0>
+			// cppcheck-suppress noExplicitConstructor
+			Iterator(const Iterator<IsOtherConst>& other) :
+				ctrl_(other.ctrl_), ctrlEnd_(other.ctrlEnd_), slot_(other.slot_) { }
+
+			/** Constructor */
+			Iterator(const std::int8_t* ctrl, const std::int8_t* ctrlEnd, pointer slot) :
+				ctrl_(ctrl), ctrlEnd_(ctrlEnd), slot_(slot) { }
+
+		private:
+			void skipEmptySlots() {
+				while (ctrl_ != ctrlEnd_ && *ctrl_ < 0) {
+					++ctrl_;
+					++slot_;
+				}
+			}
+
+			friend class FlatHashMap;
+			template <bool> friend class Iterator;
+
+		private:
+			const std::int8_t* ctrl_;
+			const std::int8_t* ctrlEnd_;
+			pointer slot_;
+		};
+
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+
+		iterator begin() {
+			iterator it(ctrl_, ctrl_ + capacity_, slots_);
+			it.skipEmptySlots();
+			return it;
+		}
+		iterator end() { return iterator(ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_); }
+		const_iterator begin() const { return const_cast<FlatHashMap*>(this)->begin(); }
+		const_iterator end() const { return const_cast<FlatHashMap*>(this)->end(); }
+		size_type size() const { return size_; }
+		bool empty() const { return size_ == 0; }
+		size_type capacity() const { return capacity_; }
+
+		/** Find entry with given key, return end() if not exists */
+		iterator find(const Key& key) {
+			if (CPV_UNLIKELY(capacity_ == 0)) {
+				return end();
+			}
+			std::size_t hash = mix(hash_(key));
+			std::size_t index = findIndex(key, hash);
+			return index != capacity_ ? iteratorAt(index) : end();
+		}
+
+		/** Find entry with given key, return end() if not exists */
+		const_iterator find(const Key& key) const {
+			return const_cast<FlatHashMap*>(this)->find(key);
+		}
+
+		/** Return 1 if key exists, otherwise 0 */
+		size_type count(const Key& key) const {
+			return find(key) != end() ? 1 : 0;
+		}
+
+		/** Get value associated with given key, throws std::out_of_range if not exists */
+		T& at(const Key& key) {
+			auto it = find(key);
+			if (CPV_UNLIKELY(it == end())) {
+				throw std::out_of_range("key not found in FlatHashMap");
+			}
+			return it->second;
+		}
+
+		/** Get value associated with given key, throws std::out_of_range if not exists */
+		const T& at(const Key& key) const {
+			return const_cast<FlatHashMap*>(this)->at(key);
+		}
+
+		/** Insert value constructed from args if key not exists */
+		template <class K, class... Args>
+		std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+			std::size_t hash = mix(hash_(key));
+			std::size_t index = findIndexOrCapacity(key, hash);
+			if (index != capacity_) {
+				return { iteratorAt(index), false };
+			}
+			return { insertNew(hash,
+				std::piecewise_construct,
+				std::forward_as_tuple(std::forward<K>(key)),
+				std::forward_as_tuple(std::forward<Args>(args)...)), true };
+		}
+
+		/** Insert value if key not exists, otherwise replace the exists value */
+		template <class K, class V>
+		std::pair<iterator, bool> insert_or_assign(K&& key, V&& value) {
+			std::size_t hash = mix(hash_(key));
+			std::size_t index = findIndexOrCapacity(key, hash);
+			if (index != capacity_) {
+				slots_[index].second = std::forward<V>(value);
+				return { iteratorAt(index), false };
+			}
+			return { insertNew(hash, std::forward<K>(key), std::forward<V>(value)), true };
+		}
+
+		/** Insert entry if key not exists */
+		std::pair<iterator, bool> insert(value_type&& entry) {
+			return try_emplace(std::move(entry.first), std::move(entry.second));
+		}
+
+		/** Insert entry constructed from args if key not exists */
+		template <class... Args>
+		std::pair<iterator, bool> emplace(Args&&... args) {
+			return insert(value_type(std::forward<Args>(args)...));
+		}
+
+		/** Get value associated with given key, insert a default constructed value if not exists */
+		template <class K>
+		T& operator[](K&& key) {
+			return try_emplace(std::forward<K>(key)).first->second;
+		}
+
+		/** Erase entry at given position, return iterator to the next entry */
+		iterator erase(const_iterator it) {
+			std::size_t index = it.ctrl_ - ctrl_;
+			eraseAt(index);
+			iterator next = iteratorAt(index);
+			next.skipEmptySlots();
+			return next;
+		}
+
+		/** Erase entry with given key, return number of erased entries */
+		size_type erase(const Key& key) {
+			auto it = find(key);
+			if (it == end()) {
+				return 0;
+			}
+			eraseAt(it.ctrl_ - ctrl_);
+			return 1;
+		}
+
+		/** Remove all entries, the memory block is kept for reuse */
+		void clear() {
+			if (size_ != 0) {
+				destroySlots();
+			}
+			if (capacity_ != 0) {
+				std::memset(ctrl_, Empty, capacity_ + GroupSize);
+				growthLeft_ = maxLoad(capacity_);
+			}
+			size_ = 0;
+		}
+
+		/** Reserve space for at least given number of entries */
+		void reserve(size_type count) {
+			if (count > maxLoad(capacity_)) {
+				rehash(capacityFor(count));
+			}
+		}
+
+		/** Constructor, no memory is allocated until first insert */
+		FlatHashMap() :
+			slots_(nullptr), ctrl_(nullptr), capacity_(0), size_(0), growthLeft_(0), hash_(), equal_() { }
+
+		/** Destructor */
+		~FlatHashMap() {
+			destroySlots();
+			::operator delete(slots_);
+		}
+
+		/** Copy constructor */
+		FlatHashMap(const FlatHashMap& other) : FlatHashMap() {
+			reserve(other.size());
+			for (auto& entry : other) {
+				try_emplace(entry.first, entry.second);
+			}
+		}
+
+		/** Move constructor */
+		FlatHashMap(FlatHashMap&& other) noexcept :
+			slots_(other.slots_),
+			ctrl_(other.ctrl_),
+			capacity_(other.capacity_),
+			size_(other.size_),
+			growthLeft_(other.growthLeft_),
+			hash_(std::move(other.hash_)),
+			equal_(std::move(other.equal_)) {
+			other.slots_ = nullptr;
+			other.ctrl_ = nullptr;
+			other.capacity_ = 0;
+			other.size_ = 0;
+			other.growthLeft_ = 0;
+		}
+
+		/** Copy assignment */
+		FlatHashMap& operator=(const FlatHashMap& other) {
+			if (this != &other) {
+				clear();
+				reserve(other.size());
+				for (auto& entry : other) {
+					try_emplace(entry.first, entry.second);
+				}
+			}
+			return *this;
+		}
+
+		/** Move assignment */
+		FlatHashMap& operator=(FlatHashMap&& other) noexcept {
+			if (this != &other) {
+				std::swap(slots_, other.slots_);
+				std::swap(ctrl_, other.ctrl_);
+				std::swap(capacity_, other.capacity_);
+				std::swap(size_, other.size_);
+				std::swap(growthLeft_, other.growthLeft_);
+				std::swap(hash_, other.hash_);
+				std::swap(equal_, other.equal_);
+				other.clear();
+			}
+			return *this;
+		}
+
+		/** Construct with initial entries, later entries with duplicated key are ignored */
+		// cppcheck-suppress noExplicitConstructor
+		FlatHashMap(std::initializer_list<value_type> items) : FlatHashMap() {
+			reserve(items.size());
+			for (auto& item : items) {
+				try_emplace(item.first, item.second);
+			}
+		}
+
+	private:
+		/** Control byte values, full slots store 7 bits of hash (0~127) */
+		static const constexpr std::int8_t Empty = -128;
+		static const constexpr std::int8_t Deleted = -2;
+
+		static_assert(alignof(value_type) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+			"over aligned value type is unsupported");
+
+		/** Control bytes of a probing group */
+		struct Group {
+#if defined(__SSE2__)
+			__m128i ctrl;
+			explicit Group(const std::int8_t* ptr) :
+				ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr))) { }
+			/** Bitmask of slots that control byte equals to given hash bits */
+			std::uint32_t match(std::int8_t h2) const {
+				return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+			}
+			/** Bitmask of empty slots */
+			std::uint32_t matchEmpty() const {
+				return match(Empty);
+			}
+			/** Bitmask of empty or deleted slots */
+			std::uint32_t matchEmptyOrDeleted() const {
+				return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl)));
+			}
+#else
+			const std::int8_t* ctrl;
+			explicit Group(const std::int8_t* ptr) : ctrl(ptr) { }
+			std::uint32_t match(std::int8_t h2) const {
+				std::uint32_t mask = 0;
+				for (std::size_t i = 0; i < GroupSize; ++i) {
+					mask |= static_cast<std::uint32_t>(ctrl[i] == h2) << i;
+				}
+				return mask;
+			}
+			std::uint32_t matchEmpty() const {
+				return match(Empty);
+			}
+			std::uint32_t matchEmptyOrDeleted() const {
+				std::uint32_t mask = 0;
+				for (std::size_t i = 0; i < GroupSize; ++i) {
+					mask |= static_cast<std::uint32_t>(ctrl[i] < -1) << i;
+				}
+				return mask;
+			}
+#endif
+		};
+
+		/** Mix the bits of hash, std::hash for integers is identity */
+		static std::size_t mix(std::size_t hash) {
+			__uint128_t result = static_cast<__uint128_t>(hash) * 0x9e3779b97f4a7c15ULL;
+			return static_cast<std::size_t>(result) ^ static_cast<std::size_t>(result >> 64);
+		}
+
+		/** Get the hash bits stored in control byte */
+		static std::int8_t h2(std::size_t hash) {
+			return static_cast<std::int8_t>(hash & 0x7f);
+		}
+
+		/** Get the max number of entries for given capacity (load factor 7/8) */
+		static std::size_t maxLoad(std::size_t capacity) {
+			return capacity - capacity / 8;
+		}
+
+		/** Get the capacity (power of two) for given number of entries */
+		static std::size_t capacityFor(std::size_t count) {
+			std::size_t capacity = GroupSize;
+			while (maxLoad(capacity) < count) {
+				capacity *= 2;
+			}
+			return capacity;
+		}
+
+		iterator iteratorAt(std::size_t index) {
+			return iterator(ctrl_ + index, ctrl_ + capacity_, slots_ + index);
+		}
+
+		/** Set control byte, the first group is mirrored after the last slot for unaligned loads */
+		void setCtrl(std::size_t index, std::int8_t value) {
+			ctrl_[index] = value;
+			if (index < GroupSize) {
+				ctrl_[capacity_ + index] = value;
+			}
+		}
+
+		/** Find index of given key, return capacity_ if not found, capacity_ should not be 0 */
+		template <class K>
+		std::size_t findIndex(const K& key, std::size_t hash) const {
+			std::size_t mask = capacity_ - 1;
+			std::size_t offset = (hash >> 7) & mask;
+			std::int8_t h = h2(hash);
+			// triangular probing over groups visits every group when capacity is power of two
+			for (std::size_t step = GroupSize; ; step += GroupSize) {
+				Group group(ctrl_ + offset);
+				for (std::uint32_t bits = group.match(h); bits != 0; bits &= bits - 1) {
+					std::size_t index = (offset + __builtin_ctz(bits)) & mask;
+					if (CPV_LIKELY(equal_(slots_[index].first, key))) {
+						return index;
+					}
+				}
+				if (CPV_LIKELY(group.matchEmpty() != 0)) {
+					return capacity_;
+				}
+				offset = (offset + step) & mask;
+			}
+		}
+
+		/** Find the first empty or deleted slot for given hash, capacity_ should not be 0 */
+		std::size_t findInsertIndex(std::size_t hash) const {
+			std::size_t mask = capacity_ - 1;
+			std::size_t offset = (hash >> 7) & mask;
+			for (std::size_t step = GroupSize; ; step += GroupSize) {
+				std::uint32_t bits = Group(ctrl_ + offset).matchEmptyOrDeleted();
+				if (CPV_LIKELY(bits != 0)) {
+					return (offset + __builtin_ctz(bits)) & mask;
+				}
+				offset = (offset + step) & mask;
+			}
+		}
+
+		/** Find index of given key, return capacity_ if not found or no memory allocated */
+		template <class K>
+		std::size_t findIndexOrCapacity(const K& key, std::size_t hash) const {
+			return CPV_LIKELY(capacity_ != 0) ? findIndex(key, hash) : capacity_;
+		}
+
+		/**
+		 * Construct entry from args and insert it to a free slot, the key must not exists.
+		 * The control byte and size are updated after construction, so the map is unchanged
+		 * if construction throws. Args may refer to entries of this map, so the entry is
+		 * constructed before rehash if the map have to grow.
+		 */
+		template <class... Args>
+		iterator insertNew(std::size_t hash, Args&&... args) {
+			std::size_t index = capacity_ != 0 ? findInsertIndex(hash) : 0;
+			if (CPV_UNLIKELY(capacity_ == 0 || (growthLeft_ == 0 && ctrl_[index] == Empty))) {
+				value_type entry(std::forward<Args>(args)...);
+				// rehash in place if there are many deleted slots, otherwise grow
+				rehash(capacityFor(std::max(size_ * 2, size_ + 1)));
+				index = findInsertIndex(hash);
+				new (slots_ + index) value_type(std::move(entry));
+			} else {
+				new (slots_ + index) value_type(std::forward<Args>(args)...);
+			}
+			if (ctrl_[index] == Empty) {
+				--growthLeft_;
+			}
+			setCtrl(index, h2(hash));
+			++size_;
+			return iteratorAt(index);
+		}
+
+		/** Destroy entry at given index */
+		void eraseAt(std::size_t index) {
+			slots_[index].~value_type();
+			--size_;
+			// mark as empty if no probing sequence passed this slot without finding an empty slot
+			std::size_t mask = capacity_ - 1;
+			std::uint32_t emptyBefore = Group(ctrl_ + ((index - GroupSize) & mask)).matchEmpty();
+			std::uint32_t emptyAfter = Group(ctrl_ + index).matchEmpty();
+			if (emptyBefore != 0 && emptyAfter != 0 &&
+				(__builtin_ctz(emptyAfter) + (__builtin_clz(emptyBefore) - 16)) < static_cast<int>(GroupSize)) {
+				setCtrl(index, Empty);
+				++growthLeft_;
+			} else {
+				setCtrl(index, Deleted);
+			}
+		}
+
+		/** Destroy all entries, control bytes are not updated */
+		void destroySlots() {
+			if constexpr (!std::is_trivially_destructible_v<value_type>) {
+				for (std::size_t i = 0; i < capacity_; ++i) {
+					if (ctrl_[i] >= 0) {
+						slots_[i].~value_type();
+					}
+				}
+			}
+		}
+
+		/** Move all entries to a new memory block with given capacity */
+		void rehash(std::size_t capacity) {
+			value_type* oldSlots = slots_;
+			std::int8_t* oldCtrl = ctrl_;
+			std::size_t oldCapacity = capacity_;
+			void* memory = ::operator new(capacity * sizeof(value_type) + capacity + GroupSize);
+			slots_ = static_cast<value_type*>(memory);
+			ctrl_ = reinterpret_cast<std::int8_t*>(slots_ + capacity);
+			capacity_ = capacity;
+			std::memset(ctrl_, Empty, capacity + GroupSize);
+			growthLeft_ = maxLoad(capacity) - size_;
+			for (std::size_t i = 0; i < oldCapacity; ++i) {
+				if (oldCtrl[i] >= 0) {
+					std::size_t hash = mix(hash_(oldSlots[i].first));
+					std::size_t index = findInsertIndex(hash);
+					setCtrl(index, h2(hash));
+					new (slots_ + index) value_type(std::move(oldSlots[i]));
+					oldSlots[i].~value_type();
+				}
+			}
+			::operator delete(oldSlots);
+		}
+
+	private:
+		value_type* slots_;
+		std::int8_t* ctrl_;
+		std::size_t capacity_;
+		std::size_t size_;
+		std::size_t growthLeft_;
+		Hash hash_;
+		KeyEqual equal_;
+	};
+}
+
@@ -40,5 +40,29 @@ namespace cpv {
 
 	/** Get mime type of file path (path can be extension only) */
 	SharedString getMimeType(std::string_view path);
+
+	/**
+	 * Check whether content of mime type is worth compressing,
+	 * includes text types and text based application types like json, javascript and svg.
+	 */
+	bool isCompressibleMimeType(std::string_view mimeType);
+
+	/**
+	 * Get quality of content coding from Accept-Encoding header,
+	 * return q-value multiplied by 1000 (0 ~ 1000), 0 means not acceptable.
+	 * Notice:
+	 * coding is compared case insensitively, "*" matches codings not listed explicitly,
+	 * malformed q-value is treat as not acceptable.
+	 */
+	std::size_t getAcceptEncodingQuality(std::string_view acceptEncoding, std::string_view coding);
+
+	/**
+	 * Get quality of mime type from Accept header,
+	 * return q-value multiplied by 1000 (0 ~ 1000), 0 means not acceptable.
+	 * Notice:
+	 * the most specific media range is used (exact type, then wildcard subtype, then full wildcard),
+	 * parameters of mime type should be removed before calling.
+	 */
+	std::size_t getAcceptMimeTypeQuality(std::string_view accept, std::string_view mimeType);
 }
 
@@ -1,70 +1,92 @@
 #pragma once
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <deque>
 #include <functional>
-#include <list>
-#include <map>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <type_traits>
 #include <utility>
+#include <vector>
+#include "./Macros.hpp"
 
 namespace cpv {
+	/**
+	 * Default hash function used by LRUCache.
+	 * For string like keys (convertible to std::string_view) it hashes the string view,
+	 * so the cache can be looked up by SharedString, std::string_view or std::string.
+	 */
+	template <class Key, class = void>
+	struct LRUCacheHash : std::hash<Key> { };
+
+	/** Default hash function used by LRUCache, specialization for string like keys */
+	template <class Key>
+	struct LRUCacheHash<Key,
+		std::enable_if_t<std::is_convertible_v<const Key&, std::string_view>>> {
+		std::size_t operator()(std::string_view key) const {
+			return std::hash<std::string_view>()(key);
+		}
+	};
+
 	/**
 	 * A cache type that keeps up to given number of least recently used values.
 	 *
+	 * It uses an open addressing hash index (linear probing with backward shift deletion)
+	 * and intrusive doubly linked entries from a pool, entries are reused after eviction,
+	 * so get and overwrite won't allocate, and set will only allocate before the pool
+	 * reaches max size. Lookup is heterogeneous if Hash and KeyEqual support it,
+	 * by default string like keys can be looked up by std::string_view.
+	 *
+	 * Pointer returned from get is stable until the value is erased or evicted.
+	 *
 	 * Notice:
 	 * It's not thread safe, don't use it across threads without mutex.
 	 */
 	template <
 		class Key,
 		class Value,
-		class List = std::list<std::pair<Key, Value>>,
-		// use ordered map and std::less<> by default for heterogeneous lookup
-		class Map = std::map<Key, typename List::iterator, std::less<>>>
+		class Hash = LRUCacheHash<Key>,
+		class KeyEqual = std::equal_to<>>
 	class LRUCache {
 	public:
 		/** Associate value with key, remove finally not used value if size is over */
 		template <class TKey, class TValue>
 		void set(TKey&& keyForMap, TKey&& keyForList, TValue&& value) {
 			assert(keyForMap == keyForList);
-			auto it = map_.find(keyForMap);
-			if (it != map_.end()) {
-				list_.erase(it->second);
-				map_.erase(it);
-			}
-			list_.emplace_front(
-				std::forward<TKey>(keyForList), std::forward<TValue>(value));
-			map_.emplace(std::forward<TKey>(keyForMap), list_.begin());
-			if (map_.size() > maxSize_) {
-				map_.erase(list_.back().first);
-				list_.pop_back();
-			}
+			static_cast<void>(keyForMap);
+			setImpl(std::forward<TKey>(keyForList), std::forward<TValue>(value));
 		}
 
 		/** Associate value with key, remove finally not used value if size is over */
 		template <class TKey, class TValue>
 		void set(const TKey& key, TValue&& value) {
-			set(TKey(key), TKey(key), std::forward<TValue>(value));
+			setImpl(key, std::forward<TValue>(value));
 		}
 
 		/** Associate value with key, remove finally not used value if size is over */
 		void set(Key&& keyForMap, Key&& keyForList, Value&& value) {
 			assert(keyForMap == keyForList);
-			set<Key, Value>(std::move(keyForMap), std::move(keyForList), std::move(value));
+			static_cast<void>(keyForMap);
+			setImpl(std::move(keyForList), std::move(value));
 		}
 
 		/** Associate value with key, remove finally not used value if size is over */
 		void set(const Key& key, Value&& value) {
-			set<Key, Value>(Key(key), Key(key), std::move(value));
+			setImpl(key, std::move(value));
 		}
 
 		/** Get pointer of value associated with key or return nullptr */
 		template <class TKey>
 		Value* get(TKey&& key) & {
-			auto it = map_.find(std::forward<TKey>(key));
-			if (it == map_.end()) {
+			std::size_t slot = findSlot(key, hash_(key));
+			if (slot == NoIndex) {
 				return nullptr;
-			} else {
-				list_.splice(list_.begin(), list_, it->second);
-				return &it->second->second;
 			}
+			std::size_t index = slots_[slot];
+			moveToFront(index);
+			return &nodes_[index].item->second;
 		}
 
 		/** Get pointer of value associated with key or return nullptr */
@@ -75,14 +97,16 @@ namespace cpv {
 		/** Erase value associated with key, return whether key was exists */
 		template <class TKey>
 		bool erase(TKey&& key) {
-			auto it = map_.find(std::forward<TKey>(key));
-			if (it == map_.end()) {
+			std::size_t slot = findSlot(key, hash_(key));
+			if (slot == NoIndex) {
 				return false;
-			} else {
-				list_.erase(it->second);
-				map_.erase(it);
-				return true;
 			}
+			std::size_t index = slots_[slot];
+			eraseSlot(slot);
+			unlink(index);
+			releaseNode(index);
+			--size_;
+			return true;
 		}
 
 		/** Erase value associated with key, return whether key was exists */
@@ -90,15 +114,23 @@ namespace cpv {
 			return erase<const Key&>(key);
 		}
 
-		/** Erase all values in cache */
+		/** Erase all values in cache, the pool and index storage will remain */
 		void clear() {
-			list_.clear();
-			map_.clear();
+			std::size_t index = head_;
+			while (index != NoIndex) {
+				std::size_t next = nodes_[index].next;
+				releaseNode(index);
+				index = next;
+			}
+			std::fill(slots_.begin(), slots_.end(), NoIndex);
+			head_ = NoIndex;
+			tail_ = NoIndex;
+			size_ = 0;
 		}
 
 		/** Get the number of values in cache */
 		std::size_t size() const {
-			return map_.size();
+			return size_;
 		}
 
 		/** Get the maximum number of values allow to keep in cache */
@@ -108,19 +140,220 @@ namespace cpv {
 
 		/** Return whether the cache is empty */
 		bool empty() const {
-			return map_.empty();
+			return size_ == 0;
 		}
 
 		/** Construct with max number of values allow to keep in cache */
+		// cppcheck-suppress noExplicitConstructor
 		LRUCache(std::size_t maxSize) :
-			list_(),
-			map_(),
-			maxSize_(maxSize) { }
+			nodes_(),
+			slots_(),
+			slotShift_(std::numeric_limits<std::uint64_t>::digits),
+			head_(NoIndex),
+			tail_(NoIndex),
+			freeHead_(NoIndex),
+			size_(0),
+			maxSize_(maxSize),
+			hash_(),
+			keyEqual_() { }
 
 	private:
-		List list_;
-		Map map_;
+		/** Index used to represent empty slot or end of list */
+		static const constexpr std::size_t NoIndex = std::numeric_limits<std::size_t>::max();
+		/** Minimal number of slots in hash index */
+		static const constexpr std::size_t MinSlots = 16;
+
+		/** Intrusive list node, owned by the pool (nodes_) */
+		struct Node {
+			std::optional<std::pair<Key, Value>> item;
+			std::size_t hash = 0;
+			std::size_t prev = NoIndex;
+			std::size_t next = NoIndex;
+		};
+
+		/** Associate value with key, remove finally not used value if size is over */
+		template <class TKey, class TValue>
+		void setImpl(TKey&& key, TValue&& value) {
+			if (CPV_UNLIKELY(maxSize_ == 0)) {
+				return;
+			}
+			std::size_t hash = hash_(key);
+			std::size_t slot = findSlot(key, hash);
+			if (slot != NoIndex) {
+				// overwrite value in place, keep the original key
+				std::size_t index = slots_[slot];
+				nodes_[index].item->second = std::forward<TValue>(value);
+				moveToFront(index);
+				return;
+			}
+			if (size_ >= maxSize_) {
+				// evict the finally not used value, it's node will be reused below
+				std::size_t index = tail_;
+				eraseSlot(findSlotByIndex(index));
+				unlink(index);
+				releaseNode(index);
+				--size_;
+			}
+			if ((size_ + 1) * 2 > slots_.size()) {
+				rehash(std::max(slots_.size() * 2, MinSlots));
+			}
+			std::size_t index = acquireNode();
+			Node& node = nodes_[index];
+			node.item.emplace(std::forward<TKey>(key), std::forward<TValue>(value));
+			node.hash = hash;
+			insertSlot(index, hash);
+			linkFront(index);
+			++size_;
+		}
+
+		/** Get the home slot of given hash value (fibonacci hashing) */
+		std::size_t homeSlot(std::size_t hash) const {
+			return static_cast<std::size_t>(
+				(static_cast<std::uint64_t>(hash) * 0x9e3779b97f4a7c15ULL) >> slotShift_);
+		}
+
+		/** Find the slot contains given key, return NoIndex if not found */
+		template <class TKey>
+		std::size_t findSlot(const TKey& key, std::size_t hash) const {
+			if (size_ == 0) {
+				return NoIndex;
+			}
+			std::size_t mask = slots_.size() - 1;
+			for (std::size_t slot = homeSlot(hash); ; slot = (slot + 1) & mask) {
+				std::size_t index = slots_[slot];
+				if (index == NoIndex) {
+					return NoIndex;
+				}
+				const Node& node = nodes_[index];
+				if (node.hash == hash && keyEqual_(node.item->first, key)) {
+					return slot;
+				}
+			}
+		}
+
+		/** Find the slot points to given node, the node must exists in index */
+		std::size_t findSlotByIndex(std::size_t index) const {
+			std::size_t mask = slots_.size() - 1;
+			std::size_t slot = homeSlot(nodes_[index].hash);
+			while (slots_[slot] != index) {
+				slot = (slot + 1) & mask;
+			}
+			return slot;
+		}
+
+		/** Insert node to hash index, the key must not exists in index */
+		void insertSlot(std::size_t index, std::size_t hash) {
+			std::size_t mask = slots_.size() - 1;
+			std::size_t slot = homeSlot(hash);
+			while (slots_[slot] != NoIndex) {
+				slot = (slot + 1) & mask;
+			}
+			slots_[slot] = index;
+		}
+
+		/** Remove slot from hash index, shift following slots back to keep probe chains */
+		void eraseSlot(std::size_t slot) {
+			std::size_t mask = slots_.size() - 1;
+			std::size_t next = slot;
+			for (;;) {
+				next = (next + 1) & mask;
+				std::size_t index = slots_[next];
+				if (index == NoIndex) {
+					break;
+				}
+				std::size_t home = homeSlot(nodes_[index].hash);
+				// keep the entry if it's home is cyclically in (slot, next]
+				bool keep = (slot <= next) ?
+					(slot < home && home <= next) :
+					(slot < home || home <= next);
+				if (!keep) {
+					slots_[slot] = index;
+					slot = next;
+				}
+			}
+			slots_[slot] = NoIndex;
+		}
+
+		/** Resize hash index and reinsert all nodes, only happens while cache is growing */
+		void rehash(std::size_t slotCount) {
+			assert((slotCount & (slotCount - 1)) == 0);
+			slots_.assign(slotCount, NoIndex);
+			slotShift_ = std::numeric_limits<std::uint64_t>::digits;
+			for (std::size_t count = slotCount; count > 1; count >>= 1) {
+				--slotShift_;
+			}
+			for (std::size_t index = head_; index != NoIndex; index = nodes_[index].next) {
+				insertSlot(index, nodes_[index].hash);
+			}
+		}
+
+		/** Take a node from free list or append a new node to pool */
+		std::size_t acquireNode() {
+			if (freeHead_ != NoIndex) {
+				std::size_t index = freeHead_;
+				freeHead_ = nodes_[index].next;
+				return index;
+			}
+			nodes_.emplace_back();
+			return nodes_.size() - 1;
+		}
+
+		/** Destroy the item of node and put node back to free list */
+		void releaseNode(std::size_t index) {
+			Node& node = nodes_[index];
+			node.item.reset();
+			node.prev = NoIndex;
+			node.next = freeHead_;
+			freeHead_ = index;
+		}
+
+		/** Link node to the front of list (most recently used) */
+		void linkFront(std::size_t index) {
+			Node& node = nodes_[index];
+			node.prev = NoIndex;
+			node.next = head_;
+			if (head_ != NoIndex) {
+				nodes_[head_].prev = index;
+			} else {
+				tail_ = index;
+			}
+			head_ = index;
+		}
+
+		/** Unlink node from list */
+		void unlink(std::size_t index) {
+			Node& node = nodes_[index];
+			if (node.prev != NoIndex) {
+				nodes_[node.prev].next = node.next;
+			} else {
+				head_ = node.next;
+			}
+			if (node.next != NoIndex) {
+				nodes_[node.next].prev = node.prev;
+			} else {
+				tail_ = node.prev;
+			}
+		}
+
+		/** Move node to the front of list */
+		void moveToFront(std::size_t index) {
+			if (head_ != index) {
+				unlink(index);
+				linkFront(index);
+			}
+		}
+
+	private:
+		// std::deque keeps element address stable on emplace_back
+		std::deque<Node> nodes_;
+		std::vector<std::size_t> slots_;
+		std::size_t slotShift_;
+		std::size_t head_;
+		std::size_t tail_;
+		std::size_t freeHead_;
+		std::size_t size_;
 		std::size_t maxSize_;
+		Hash hash_;
+		KeyEqual keyEqual_;
 	};
 }
-
@@ -1,8 +1,12 @@
 #pragma once
+#include <map>
 #include <memory>
 #include <optional>
+#include <unordered_map>
 #include <seastar/core/shared_ptr.hh>
 #include "../Allocators/StackAllocator.hpp"
+#include "./FlatHashMap.hpp"
+#include "./SmallFlatMap.hpp"
 #include "./Reusable.hpp"
 
 namespace cpv {
@@ -11,6 +15,7 @@ namespace cpv {
 	struct ObjectTrait {
 		static const constexpr bool IsPointerLike = false;
 		static const constexpr bool IsCollectionLike = false;
+		static const constexpr bool IsMapLike = false;
 		using Type = T;
 		using UnderlyingType = T;
 		template <class... Args>
@@ -31,6 +36,7 @@ namespace cpv {
 	struct ObjectTrait<std::optional<T>> {
 		static const constexpr bool IsPointerLike = true;
 		static const constexpr bool IsCollectionLike = false;
+		static const constexpr bool IsMapLike = false;
 		using Type = std::optional<T>;
 		using UnderlyingType = T;
 		template <class... Args>
@@ -61,6 +67,7 @@ namespace cpv {
 	struct ObjectTrait<std::unique_ptr<T>> {
 		static const constexpr bool IsPointerLike = true;
 		static const constexpr bool IsCollectionLike = false;
+		static const constexpr bool IsMapLike = false;
 		using Type = std::unique_ptr<T>;
 		using UnderlyingType = T;
 		template <class... Args>
@@ -85,6 +92,7 @@ namespace cpv {
 	struct ObjectTrait<seastar::shared_ptr<T>> {
 		static const constexpr bool IsPointerLike = true;
 		static const constexpr bool IsCollectionLike = false;
+		static const constexpr bool IsMapLike = false;
 		using Type = seastar::shared_ptr<T>;
 		using UnderlyingType = T;
 		template <class... Args>
@@ -109,6 +117,7 @@ namespace cpv {
 	struct ObjectTrait<seastar::lw_shared_ptr<T>> {
 		static const constexpr bool IsPointerLike = true;
 		static const constexpr bool IsCollectionLike = false;
+		static const constexpr bool IsMapLike = false;
 		using Type = seastar::lw_shared_ptr<T>;
 		using UnderlyingType = T;
 		template <class... Args>
@@ -133,6 +142,7 @@ namespace cpv {
 	struct ObjectTrait<Reusable<T>> {
 		static const constexpr bool IsPointerLike = true;
 		static const constexpr bool IsCollectionLike = false;
+		static const constexpr bool IsMapLike = false;
 		using Type = Reusable<T>;
 		using UnderlyingType = T;
 		template <class... Args>
@@ -153,6 +163,7 @@ namespace cpv {
 	struct ObjectTrait<std::vector<T, Allocator>> {
 		static const constexpr bool IsPointerLike = false;
 		static const constexpr bool IsCollectionLike = true;
+		static const constexpr bool IsMapLike = false;
 		using Type = std::vector<T, Allocator>;
 		using UnderlyingType = T;
 		template <class... Args>
@@ -187,6 +198,7 @@ namespace cpv {
 	struct ObjectTrait<StackAllocatedVector<T, InitialSize, UpstreamAllocator>> {
 		static const constexpr bool IsPointerLike = false;
 		static const constexpr bool IsCollectionLike = true;
+		static const constexpr bool IsMapLike = false;
 		using Type = StackAllocatedVector<T, InitialSize, UpstreamAllocator>;
 		using UnderlyingType = T;
 		template <class... Args>
@@ -215,5 +227,77 @@ namespace cpv {
 			}
 		}
 	};
+
+	/** Common implementation for map like types, keys are unique and values are mutable */
+	template <class T, bool Reservable>
+	struct MapLikeObjectTrait {
+		static const constexpr bool IsPointerLike = false;
+		static const constexpr bool IsCollectionLike = false;
+		static const constexpr bool IsMapLike = true;
+		using Type = T;
+		using KeyType = typename T::key_type;
+		using UnderlyingType = typename T::mapped_type;
+		template <class... Args>
+		static inline Type create(Args&&... args) {
+			return Type(std::forward<Args>(args)...);
+		}
+		static inline void reset(Type& value) { value.clear(); }
+		static inline Type& get(Type& value) { return value; }
+		static inline const Type& get(const Type& value) { return value; }
+		template <class U>
+		static inline void set(Type& target, U&& source) { target = std::forward<U>(source); }
+		static inline std::size_t size(const Type& values) {
+			return values.size();
+		}
+		static inline void reserve(Type& values, std::size_t capacity) {
+			if constexpr (Reservable) {
+				values.reserve(capacity);
+			}
+		}
+		/** Get value by key, insert a default constructed value if key not exists */
+		template <class Key>
+		static inline UnderlyingType& add(Type& values, Key&& key) {
+			return values.try_emplace(std::forward<Key>(key)).first->second;
+		}
+		template <class Func>
+		static inline void apply(const Type& values, const Func& func) {
+			for (const auto& pair : values) {
+				func(pair.first, pair.second);
+			}
+		}
+	};
+
+	/** Specialize for std::unordered_map */
+	template <class Key, class T, class Hash, class KeyEqual, class Allocator>
+	struct ObjectTrait<std::unordered_map<Key, T, Hash, KeyEqual, Allocator>> :
+		MapLikeObjectTrait<std::unordered_map<Key, T, Hash, KeyEqual, Allocator>, true> { };
+
+	/** Specialize for std::map */
+	template <class Key, class T, class Compare, class Allocator>
+	struct ObjectTrait<std::map<Key, T, Compare, Allocator>> :
+		MapLikeObjectTrait<std::map<Key, T, Compare, Allocator>, false> { };
+
+	/** Specialize for StackAllocatedUnorderedMap */
+	template <class Key, class T, std::size_t InitialSize,
+		class Hash, class KeyEqual, class UpstreamAllocator>
+	struct ObjectTrait<StackAllocatedUnorderedMap<
+		Key, T, InitialSize, Hash, KeyEqual, UpstreamAllocator>> :
+		MapLikeObjectTrait<StackAllocatedUnorderedMap<
+			Key, T, InitialSize, Hash, KeyEqual, UpstreamAllocator>, true> { };
+
+	/** Specialize for StackAllocatedMap */
+	template <class Key, class T, std::size_t InitialSize, class Compare, class UpstreamAllocator>
+	struct ObjectTrait<StackAllocatedMap<Key, T, InitialSize, Compare, UpstreamAllocator>> :
+		MapLikeObjectTrait<StackAllocatedMap<Key, T, InitialSize, Compare, UpstreamAllocator>, false> { };
+
+	/** Specialize for SmallFlatMap */
+	template <class Key, class T, std::size_t InitialSize, class Compare, class UpstreamAllocator>
+	struct ObjectTrait<SmallFlatMap<Key, T, InitialSize, Compare, UpstreamAllocator>> :
+		MapLikeObjectTrait<SmallFlatMap<Key, T, InitialSize, Compare, UpstreamAllocator>, true> { };
+
+	/** Specialize for FlatHashMap */
+	template <class Key, class T, class Hash, class KeyEqual>
+	struct ObjectTrait<FlatHashMap<Key, T, Hash, KeyEqual>> :
+		MapLikeObjectTrait<FlatHashMap<Key, T, Hash, KeyEqual>, true> { };
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 #include <cassert>
+#include <cstring>
 #include <variant>
 #include <vector>
 #include <iostream>
@@ -68,15 +69,30 @@ namespace cpv {
 			}
 		};
 
-		/** Multiple fragments with deleter, deleter can be chained, also this class is reusable */
+		/**
+		 * Multiple fragments with deleter, deleter can be chained, also this class is reusable.
+		 *
+		 * Strings shorter than InlineThreshold are copied into a scratch block owned by
+		 * the deleter, contiguous copies extend the last fragment instead of adding new one,
+		 * so small pieces like ": " and CRLF won't take an iovec and a deleter link each.
+		 * Larger strings are still appended as separate fragments without copying.
+		 */
 		struct MultipleFragments {
+			/** Strings shorter than this size are copied into scratch block */
+			static const constexpr std::size_t InlineThreshold = 64;
+			/** The size of scratch block allocated for inlined strings */
+			static const constexpr std::size_t ScratchBlockSize = 512;
+
 			std::vector<seastar::net::fragment> fragments;
 			seastar::deleter deleter;
+			char* scratchPtr;
+			char* scratchEnd;
 
 			/** For Reusable */
 			void freeResources() {
 				fragments.clear();
 				deleter = seastar::deleter();
+				resetScratch();
 			}
 
 			/** For Reusable */
@@ -84,15 +100,27 @@ namespace cpv {
 
 			/** Append string to fragments */
 			CPV_INLINE void append(SharedString&& str) {
-				fragments.emplace_back(seastar::net::fragment({ str.data(), str.size() }));
-				deleter.append(str.release());
+				if (CPV_LIKELY(str.size() < InlineThreshold)) {
+					if (CPV_UNLIKELY(str.size() > static_cast<std::size_t>(scratchEnd - scratchPtr))) {
+						allocateScratch();
+					}
+					appendToScratch(str.view());
+				} else {
+					fragments.emplace_back(seastar::net::fragment({ str.data(), str.size() }));
+					deleter.append(str.release());
+				}
 			}
 
-			/** Append static string to fragments */
+			/** Append static string to fragments, copy it only if scratch block has enough space */
 			template <std::size_t Size>
 			CPV_INLINE void append(const char(&str)[Size]) {
-				fragments.emplace_back(toFragment({ str, Size - 1 }));
 				static_assert(Size >= 1, "static string should contains tailing zero");
+				if (Size - 1 < InlineThreshold &&
+					Size - 1 <= static_cast<std::size_t>(scratchEnd - scratchPtr)) {
+					appendToScratch({ str, Size - 1 });
+				} else {
+					fragments.emplace_back(toFragment({ str, Size - 1 }));
+				}
 			}
 
 			/** Reserve addition capacity of fragments */
@@ -107,10 +135,36 @@ namespace cpv {
 				// we want to keep the internal storage, so iterator overload is used here
 				seastar::net::packet p(fragments.begin(), fragments.end(), std::move(deleter));
 				fragments.clear();
+				resetScratch();
 				return p;
 			};
 
-			MultipleFragments() : fragments(), deleter() { }
+			/** Stop appending to scratch block, should call it after deleter is moved */
+			CPV_INLINE void resetScratch() {
+				scratchPtr = nullptr;
+				scratchEnd = nullptr;
+			}
+
+			MultipleFragments() :
+				fragments(), deleter(), scratchPtr(nullptr), scratchEnd(nullptr) { }
+
+		private:
+			/** Copy string to scratch block, extend the last fragment if it's contiguous */
+			CPV_INLINE void appendToScratch(std::string_view str) {
+				if (CPV_UNLIKELY(str.empty())) {
+					return;
+				}
+				std::memcpy(scratchPtr, str.data(), str.size());
+				if (!fragments.empty() && fragments.back().base + fragments.back().size == scratchPtr) {
+					fragments.back().size += str.size();
+				} else {
+					fragments.emplace_back(seastar::net::fragment({ scratchPtr, str.size() }));
+				}
+				scratchPtr += str.size();
+			}
+
+			/** Allocate new scratch block, the remaining space of previous block is discarded */
+			void allocateScratch();
 		};
 
 	public:
@@ -1,9 +1,13 @@
 #pragma once
 #include <cassert>
+#include <cmath>
 #include <string_view>
+#include <cstring>
 #include <optional>
 #include <seastar/core/temporary_buffer.hh>
+#include "../Allocators/SlabAllocator.hpp"
 #include "./ConstantStrings.hpp"
+#include "./Macros.hpp"
 
 namespace cpv {
 	/**
@@ -113,6 +117,18 @@ namespace cpv {
 			}
 		}
 
+		/** Construct with uninitialized buffer of given size, allocated from SlabAllocator */
+		explicit BasicSharedString(std::size_t size) :
+			Base(allocateBuffer(size)) { }
+
+		/** Construct with data copied from given buffer */
+		BasicSharedString(const CharType* str, std::size_t size) :
+			Base(allocateBuffer(size)) {
+			if (CPV_LIKELY(size != 0)) {
+				std::memcpy(data(), str, size * sizeof(CharType));
+			}
+		}
+
 		/** Construct with data copied from given string view */
 		explicit BasicSharedString(View view) :
 			BasicSharedString(view.data(), view.size()) { }
@@ -161,6 +177,16 @@ namespace cpv {
 		bool operator >=(const CharType(&str)[Size]) const { return *this >= BasicSharedString(str); }
 
 	private:
+		/** Allocate buffer from SlabAllocator, the deleter returns the block to free list */
+		static Base allocateBuffer(std::size_t size) {
+			if (CPV_UNLIKELY(size == 0)) {
+				return Base();
+			}
+			seastar::deleter deleter;
+			void* ptr = SlabAllocator::allocate(size * sizeof(CharType), deleter);
+			return Base(static_cast<CharType*>(ptr), size, std::move(deleter));
+		}
+
 		std::optional<std::intmax_t> toIntImpl() const;
 		std::optional<std::uintmax_t> toUintImpl() const;
 		std::optional<double> toDoubleImpl() const;
@@ -202,9 +228,12 @@ namespace cpv {
 		/** Construct with string representation of floating point */
 		template <class T, std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
 		static BasicSharedString fromDouble(T value) {
-			std::size_t intValue = value;
-			if (value == static_cast<T>(intValue) && intValue < constants::Integers.size()) {
-				return BasicSharedString(constants::Integers[intValue]);
+			// -0.0 compares equal to 0 but should be formatted as "-0"
+			if (!std::signbit(value) && value < static_cast<T>(constants::Integers.size())) {
+				std::size_t intValue = static_cast<std::size_t>(value);
+				if (value == static_cast<T>(intValue)) {
+					return BasicSharedString::fromStatic(constants::Integers[intValue]);
+				}
 			}
 			if constexpr (sizeof(T) <= sizeof(double)) {
 				return fromDoubleImpl(static_cast<double>(value));
@@ -0,0 +1,214 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include "../Allocators/StackAllocator.hpp"
+#include "./Macros.hpp"
+
+namespace cpv {
+	/**
+	 * Map stored in a vector sorted by key, the first InitialSize entries are stored inline.
+	 *
+	 * It's designed for small collections like headers, query parameters and cookies,
+	 * inserting into it doesn't allocate until the inline storage is full, and lookup
+	 * is a binary search over contiguous memory instead of chasing tree nodes.
+	 * The interface is a subset of std::map, iteration visits entries in key order.
+	 *
+	 * Notice:
+	 * Insert and erase are O(n), parsers that add many entries from input should use
+	 * appendUnsorted and sortAndDeduplicate instead of inserting one by one.
+	 * Insert and erase will invalidate iterators and references.
+	 * The value type is std::pair<Key, T> (key is not const), don't modify keys while iterating.
+	 */
+	template <
+		class Key,
+		class T,
+		std::size_t InitialSize,
+		class Compare = std::less<Key>,
+		class UpstreamAllocator = std::allocator<std::pair<Key, T>>>
+	class SmallFlatMap {
+	public:
+		using key_type = Key;
+		using mapped_type = T;
+		using value_type = std::pair<Key, T>;
+		using key_compare = Compare;
+		using StorageType = StackAllocatedVector<value_type, InitialSize, UpstreamAllocator>;
+		using size_type = typename StorageType::size_type;
+		using iterator = typename StorageType::iterator;
+		using const_iterator = typename StorageType::const_iterator;
+
+		iterator begin() { return entries_.begin(); }
+		iterator end() { return entries_.end(); }
+		const_iterator begin() const { return entries_.begin(); }
+		const_iterator end() const { return entries_.end(); }
+		size_type size() const { return entries_.size(); }
+		bool empty() const { return entries_.empty(); }
+		void reserve(size_type capacity) { entries_.reserve(capacity); }
+		void clear() { entries_.clear(); }
+
+		/** Find entry with given key, return end() if not exists */
+		iterator find(const Key& key) {
+			auto it = lowerBound(key);
+			return (it != entries_.end() && !compare_(key, it->first)) ? it : entries_.end();
+		}
+
+		/** Find entry with given key, return end() if not exists */
+		const_iterator find(const Key& key) const {
+			return const_cast<SmallFlatMap*>(this)->find(key);
+		}
+
+		/** Return 1 if key exists, otherwise 0 */
+		size_type count(const Key& key) const {
+			return find(key) != end() ? 1 : 0;
+		}
+
+		/** Get value associated with given key, throws std::out_of_range if not exists */
+		T& at(const Key& key) {
+			auto it = find(key);
+			if (CPV_UNLIKELY(it == entries_.end())) {
+				throw std::out_of_range("key not found in SmallFlatMap");
+			}
+			return it->second;
+		}
+
+		/** Get value associated with given key, throws std::out_of_range if not exists */
+		const T& at(const Key& key) const {
+			return const_cast<SmallFlatMap*>(this)->at(key);
+		}
+
+		/** Insert value constructed from args if key not exists */
+		template <class K, class... Args>
+		std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+			auto it = lowerBound(key);
+			if (it != entries_.end() && !compare_(key, it->first)) {
+				return { it, false };
+			}
+			it = entries_.emplace(it,
+				std::piecewise_construct,
+				std::forward_as_tuple(std::forward<K>(key)),
+				std::forward_as_tuple(std::forward<Args>(args)...));
+			return { it, true };
+		}
+
+		/** Insert value if key not exists, otherwise replace the exists value */
+		template <class K, class V>
+		std::pair<iterator, bool> insert_or_assign(K&& key, V&& value) {
+			auto it = lowerBound(key);
+			if (it != entries_.end() && !compare_(key, it->first)) {
+				it->second = std::forward<V>(value);
+				return { it, false };
+			}
+			it = entries_.emplace(it, std::forward<K>(key), std::forward<V>(value));
+			return { it, true };
+		}
+
+		/** Insert entry if key not exists */
+		std::pair<iterator, bool> insert(value_type&& entry) {
+			return try_emplace(std::move(entry.first), std::move(entry.second));
+		}
+
+		/** Insert entry constructed from args if key not exists */
+		template <class... Args>
+		std::pair<iterator, bool> emplace(Args&&... args) {
+			return insert(value_type(std::forward<Args>(args)...));
+		}
+
+		/** Get value associated with given key, insert a default constructed value if not exists */
+		template <class K>
+		T& operator[](K&& key) {
+			return try_emplace(std::forward<K>(key)).first->second;
+		}
+
+		/**
+		 * Append entry to the end without keeping the order and checking duplicated key,
+		 * sortAndDeduplicate must be called before using the map.
+		 */
+		template <class K, class V>
+		void appendUnsorted(K&& key, V&& value) {
+			entries_.emplace_back(std::forward<K>(key), std::forward<V>(value));
+		}
+
+		/**
+		 * Sort entries added by appendUnsorted, the last entry is kept for duplicated keys,
+		 * it's the same as calling insert_or_assign for each entry but O(n log n).
+		 */
+		void sortAndDeduplicate() {
+			auto keyLess = [this] (const value_type& a, const value_type& b) {
+				return compare_(a.first, b.first);
+			};
+			// sort should be stable to keep the last entry, std::stable_sort allocates buffer
+			// so small maps use insertion sort
+			if (entries_.size() <= InsertionSortThreshold) {
+				for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+					std::rotate(std::upper_bound(entries_.begin(), it, *it, keyLess), it, it + 1);
+				}
+			} else {
+				std::stable_sort(entries_.begin(), entries_.end(), keyLess);
+			}
+			auto last = entries_.begin();
+			for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+				if (it == last) {
+					continue;
+				} else if (!keyLess(*last, *it)) {
+					*last = std::move(*it);
+				} else if (++last != it) {
+					*last = std::move(*it);
+				}
+			}
+			if (last != entries_.end()) {
+				entries_.erase(last + 1, entries_.end());
+			}
+		}
+
+		/** Erase entry at given position */
+		iterator erase(const_iterator it) {
+			return entries_.erase(it);
+		}
+
+		/** Erase entry with given key, return number of erased entries */
+		size_type erase(const Key& key) {
+			auto it = find(key);
+			if (it == entries_.end()) {
+				return 0;
+			}
+			entries_.erase(it);
+			return 1;
+		}
+
+		/** Constructor */
+		SmallFlatMap() : entries_(), compare_() { }
+
+		/** Constructor with stateful upstream allocator (e.g. ArenaAllocator) */
+		explicit SmallFlatMap(const UpstreamAllocator& upstream) :
+			entries_(upstream), compare_() { }
+
+		/** Construct with initial entries, later entries with duplicated key are ignored */
+		// cppcheck-suppress noExplicitConstructor
+		SmallFlatMap(std::initializer_list<value_type> items) : SmallFlatMap() {
+			for (auto& item : items) {
+				try_emplace(item.first, item.second);
+			}
+		}
+
+	private:
+		/** Max number of entries sorted by insertion sort in sortAndDeduplicate */
+		static const constexpr std::size_t InsertionSortThreshold = 32;
+
+		/** Find the first entry that its key is not less than given key */
+		template <class K>
+		iterator lowerBound(const K& key) {
+			return std::lower_bound(entries_.begin(), entries_.end(), key,
+				[this] (const value_type& entry, const K& value) {
+					return compare_(entry.first, value);
+				});
+		}
+
+	private:
+		StorageType entries_;
+		Compare compare_;
+	};
+}
+
@@ -1,6 +1,7 @@
 #pragma once
 #include <cctype>
 #include <vector>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <type_traits>
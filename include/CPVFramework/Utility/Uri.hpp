@@ -1,6 +1,7 @@
 #pragma once
 #include "../Allocators/StackAllocator.hpp"
 #include "./Packet.hpp"
+#include "./SmallFlatMap.hpp"
 
 namespace cpv {
 	/**
@@ -28,7 +29,7 @@ namespace cpv {
 	class Uri {
 	public:
 		using PathFragmentsType = StackAllocatedVector<SharedString, 6>;
-		using QueryParametersType = StackAllocatedMap<SharedString, SharedString, 6>;
+		using QueryParametersType = SmallFlatMap<SharedString, SharedString, 6>;
 		
 		// getters and setters
 		const SharedString& getProtocol() const& { return protocol_; }
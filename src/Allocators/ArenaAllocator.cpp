@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <CPVFramework/Allocators/ArenaAllocator.hpp>
+
+namespace cpv {
+	/** Deleter shared by strings, owns the blocks handed over from arena */
+	class Arena::BlockOwner : public seastar::deleter::impl {
+	public:
+		Block* block;
+
+		BlockOwner() : seastar::deleter::impl(seastar::deleter()), block(nullptr) { }
+
+		~BlockOwner() override {
+			while (block != nullptr) {
+				Block* previous = block->previous;
+				std::free(block);
+				block = previous;
+			}
+		}
+	};
+
+	/** Release all allocated memory, the first block is kept for reuse */
+	void Arena::reset() {
+		handOverBlocks();
+		if (block_ == nullptr) {
+			return;
+		}
+		// find the first block, keep it only if it's a regular block
+		Block* first = block_;
+		while (first->previous != nullptr) {
+			first = first->previous;
+		}
+		if (first->size == blockSize_) {
+			freeBlocks(first);
+			block_ = first;
+			ptr_ = reinterpret_cast<char*>(first + 1);
+			end_ = ptr_ + first->size;
+		} else {
+			freeBlocks(nullptr);
+		}
+	}
+
+	/** Constructor */
+	Arena::Arena(std::size_t blockSize) :
+		block_(nullptr),
+		ptr_(nullptr),
+		end_(nullptr),
+		blockSize_(blockSize),
+		blockCount_(0),
+		blockOwner_(nullptr),
+		blockOwnerDeleter_() { }
+
+	/** Destructor */
+	Arena::~Arena() {
+		handOverBlocks();
+		freeBlocks(nullptr);
+	}
+
+	/** Move constructor */
+	Arena::Arena(Arena&& other) noexcept :
+		block_(other.block_),
+		ptr_(other.ptr_),
+		end_(other.end_),
+		blockSize_(other.blockSize_),
+		blockCount_(other.blockCount_),
+		blockOwner_(other.blockOwner_),
+		blockOwnerDeleter_(std::move(other.blockOwnerDeleter_)) {
+		other.block_ = nullptr;
+		other.ptr_ = nullptr;
+		other.end_ = nullptr;
+		other.blockCount_ = 0;
+		other.blockOwner_ = nullptr;
+	}
+
+	/** Move assignment */
+	Arena& Arena::operator=(Arena&& other) noexcept {
+		if (this != &other) {
+			handOverBlocks();
+			freeBlocks(nullptr);
+			block_ = other.block_;
+			ptr_ = other.ptr_;
+			end_ = other.end_;
+			blockSize_ = other.blockSize_;
+			blockCount_ = other.blockCount_;
+			blockOwner_ = other.blockOwner_;
+			blockOwnerDeleter_ = std::move(other.blockOwnerDeleter_);
+			other.block_ = nullptr;
+			other.ptr_ = nullptr;
+			other.end_ = nullptr;
+			other.blockCount_ = 0;
+			other.blockOwner_ = nullptr;
+		}
+		return *this;
+	}
+
+	/** Allocate a new block and allocate memory from it */
+	void* Arena::allocateFromNewBlock(std::size_t size, std::size_t alignment) {
+		// large allocation takes a dedicated block
+		std::size_t blockSize = std::max(blockSize_, size + alignment);
+		void* memory = std::malloc(sizeof(Block) + blockSize);
+		if (CPV_UNLIKELY(memory == nullptr)) {
+			throw std::bad_alloc();
+		}
+		Block* block = static_cast<Block*>(memory);
+		block->previous = block_;
+		block->size = blockSize;
+		block_ = block;
+		ptr_ = reinterpret_cast<char*>(block + 1);
+		end_ = ptr_ + blockSize;
+		++blockCount_;
+		void* ptr = ptr_;
+		std::size_t space = blockSize;
+		ptr = std::align(alignment, size, ptr, space);
+		ptr_ = static_cast<char*>(ptr) + size;
+		return ptr;
+	}
+
+	/** Free blocks allocated after the given block, free all blocks if it's nullptr */
+	void Arena::freeBlocks(Block* until) {
+		while (block_ != until) {
+			Block* previous = block_->previous;
+			std::free(block_);
+			block_ = previous;
+			--blockCount_;
+		}
+		if (until == nullptr) {
+			ptr_ = nullptr;
+			end_ = nullptr;
+		}
+	}
+
+	/** Get the deleter for strings allocated from arena, the owner is created at the first call */
+	seastar::deleter Arena::shareBlocks() {
+		if (blockOwner_ == nullptr) {
+			blockOwner_ = new BlockOwner();
+			blockOwnerDeleter_ = seastar::deleter(blockOwner_);
+		}
+		return blockOwnerDeleter_.share();
+	}
+
+	/**
+	 * Hand over all blocks to the owner if any string allocated from them is still alive,
+	 * they will be released after the last string is released, the arena starts from scratch.
+	 */
+	void Arena::handOverBlocks() {
+		if (blockOwner_ == nullptr) {
+			return;
+		}
+		if (blockOwner_->refs > 1) {
+			blockOwner_->block = block_;
+			block_ = nullptr;
+			ptr_ = nullptr;
+			end_ = nullptr;
+			blockCount_ = 0;
+		}
+		blockOwner_ = nullptr;
+		blockOwnerDeleter_ = seastar::deleter();
+	}
+}
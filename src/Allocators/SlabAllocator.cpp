@@ -0,0 +1,114 @@
+#include <array>
+#include <cstdlib>
+#include <new>
+#include <CPVFramework/Allocators/SlabAllocator.hpp>
+#include <CPVFramework/Utility/Macros.hpp>
+
+namespace cpv {
+	namespace {
+		/** Free blocks of current thread, linked by the first pointer in each block */
+		struct SlabStorage {
+			std::array<void*, SlabAllocator::SizeClassCount> freeBlocks;
+			std::array<std::size_t, SlabAllocator::SizeClassCount> freeCounts;
+			bool isDestroyed;
+
+			SlabStorage() : freeBlocks(), freeCounts(), isDestroyed(false) { }
+
+			~SlabStorage() {
+				for (void* block : freeBlocks) {
+					while (block != nullptr) {
+						void* next = *static_cast<void**>(block);
+						std::free(block);
+						block = next;
+					}
+				}
+				freeBlocks.fill(nullptr);
+				freeCounts.fill(0);
+				isDestroyed = true;
+			}
+		};
+
+		/** The free blocks of current thread */
+		thread_local SlabStorage Storage;
+
+		/** The information of block stored before the deleter */
+		struct SlabBlockPrefix {
+			std::size_t sizeClass;
+			SlabStorage* owner;
+		};
+
+		/** The deleter placed in block header, return the block to free list instead of delete */
+		class SlabBlockDeleter : public seastar::deleter::impl {
+		public:
+			/** Invoked by the deleting destructor after the last reference released */
+			static void operator delete(void* ptr) {
+				SlabBlockPrefix* prefix = static_cast<SlabBlockPrefix*>(ptr) - 1;
+				std::size_t sizeClass = prefix->sizeClass;
+				SlabStorage& storage = Storage;
+				// the total size of free blocks is (count * (MinBlockSize << sizeClass))
+				if (CPV_LIKELY(prefix->owner == &storage && !storage.isDestroyed &&
+					(storage.freeCounts[sizeClass] << sizeClass) <
+						SlabAllocator::MaxFreeBytesPerSizeClass / SlabAllocator::MinBlockSize)) {
+					*reinterpret_cast<void**>(prefix) = storage.freeBlocks[sizeClass];
+					storage.freeBlocks[sizeClass] = prefix;
+					++storage.freeCounts[sizeClass];
+				} else {
+					std::free(prefix);
+				}
+			}
+
+			SlabBlockDeleter() : seastar::deleter::impl(seastar::deleter()) { }
+
+		};
+
+		/** The size of block header (prefix and deleter), keeps data aligned to 16 bytes */
+		static const constexpr std::size_t HeaderSize =
+			(sizeof(SlabBlockPrefix) + sizeof(SlabBlockDeleter) + 15) & ~static_cast<std::size_t>(15);
+
+		/** Get the size class index for given size, size should not be larger than MaxBlockSize */
+		std::size_t getSizeClass(std::size_t size) {
+			if (size <= SlabAllocator::MinBlockSize) {
+				return 0;
+			}
+			// 17~32 => 1, 33~64 => 2, ...
+			return (sizeof(unsigned long) * 8 - __builtin_clzl(size - 1)) - 4;
+		}
+	}
+
+	/** Allocate memory with given size in bytes */
+	void* SlabAllocator::allocate(std::size_t size, seastar::deleter& deleter) {
+		if (CPV_UNLIKELY(size > MaxBlockSize)) {
+			void* ptr = std::malloc(size);
+			if (CPV_UNLIKELY(ptr == nullptr)) {
+				throw std::bad_alloc();
+			}
+			deleter = seastar::make_free_deleter(ptr);
+			return ptr;
+		}
+		std::size_t sizeClass = getSizeClass(size);
+		SlabStorage& storage = Storage;
+		void* block = storage.freeBlocks[sizeClass];
+		if (CPV_LIKELY(block != nullptr)) {
+			storage.freeBlocks[sizeClass] = *static_cast<void**>(block);
+			--storage.freeCounts[sizeClass];
+		} else {
+			block = std::malloc(HeaderSize + (MinBlockSize << sizeClass));
+			if (CPV_UNLIKELY(block == nullptr)) {
+				throw std::bad_alloc();
+			}
+		}
+		SlabBlockPrefix* prefix = new (block) SlabBlockPrefix({ sizeClass, &storage });
+		deleter = seastar::deleter(new (prefix + 1) SlabBlockDeleter());
+		return static_cast<char*>(block) + HeaderSize;
+	}
+
+	/** Get the number of free blocks of current thread */
+	std::size_t SlabAllocator::freeBlockCount() {
+		std::size_t count = 0;
+		for (std::size_t freeCount : Storage.freeCounts) {
+			count += freeCount;
+		}
+		return count;
+	}
+}
+
@@ -1,35 +1,81 @@
 #include <CPVFramework/Http/HttpForm.hpp>
 #include <CPVFramework/Utility/ConstantStrings.hpp>
 #include <CPVFramework/Utility/HttpUtils.hpp>
+#include <CPVFramework/Utility/Macros.hpp>
+#include "../Utility/EscapeCharScanner.hpp"
 
 namespace cpv {
+	namespace {
+		/** Key and value parsed from url encoded form, index is used to keep the order of values */
+		struct FormSlice {
+			SharedString key;
+			SharedString value;
+			std::size_t index;
+		};
+
+		/** Share part of form body, decode it only if it contains '%' or '+' */
+		SharedString shareFormSlice(
+			const SharedString& body, const char* begin, const char* end, bool encoded) {
+			SharedString slice = body.share({ begin, static_cast<std::size_t>(end - begin) });
+			if (CPV_UNLIKELY(encoded)) {
+				return urlDecode(std::move(slice));
+			}
+			return slice;
+		}
+	}
+
 	/** Static empty vector for getMany */
 	const HttpForm::ValuesType HttpForm::Empty;
 
 	/** Parse url encoded form body */
 	void HttpForm::parseUrlEncoded(const SharedString& body) {
+		// scan delimiters and collect slices in a single pass
+		StackAllocatedVector<FormSlice, InitialParameters> slices;
 		const char* mark = body.begin();
 		const char* ptr = mark;
 		const char* end = body.end();
+		bool encoded = false;
 		SharedString formKey;
-		for (; ptr < end; ++ptr) {
+		while ((ptr = findFirstEscapeChar<FormDelimiterCharMatcher>(ptr, end)) != end) {
 			const char c = *ptr;
 			if (c == '=') {
 				// end of key, start of value
-				formKey = urlDecode(body.share(
-					{ mark, static_cast<std::size_t>(ptr - mark) }));
+				formKey = shareFormSlice(body, mark, ptr, encoded);
 				mark = ptr + 1;
+				encoded = false;
 			} else if (c == '&') {
 				// end of value
-				add(std::move(formKey), urlDecode(body.share(
-					{ mark, static_cast<std::size_t>(ptr - mark) })));
+				slices.emplace_back(FormSlice{ std::move(formKey),
+					shareFormSlice(body, mark, ptr, encoded), slices.size() });
 				mark = ptr + 1;
+				encoded = false;
+			} else {
+				encoded = true;
 			}
+			++ptr;
 		}
 		if (ptr > mark || !formKey.empty()) {
 			// end of value
-			add(std::move(formKey), urlDecode(body.share(
-				{ mark, static_cast<std::size_t>(ptr - mark) })));
+			slices.emplace_back(FormSlice{ std::move(formKey),
+				shareFormSlice(body, mark, ptr, encoded), slices.size() });
+		}
+		if (!formParameters_.empty()) {
+			// merge with existing parameters
+			for (auto& slice : slices) {
+				add(std::move(slice.key), std::move(slice.value));
+			}
+			return;
+		}
+		// build the sorted parameters at once, sort is not stable so compare index as well
+		std::sort(slices.begin(), slices.end(), [] (const FormSlice& a, const FormSlice& b) {
+			int result = a.key.view().compare(b.key.view());
+			return result < 0 || (result == 0 && a.index < b.index);
+		});
+		for (auto& slice : slices) {
+			if (formParameters_.empty() || formParameters_.back().first != slice.key) {
+				formParameters_.emplace_back(std::move(slice.key), ValuesType());
+			}
+			formParameters_.back().second.emplace_back(std::move(slice.value));
 		}
 	}
 
@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <cstring>
+#include <CPVFramework/Exceptions/DeserializeException.hpp>
+#include <CPVFramework/Exceptions/LogicException.hpp>
+#include <CPVFramework/Http/HttpConstantStrings.hpp>
+#include <CPVFramework/Http/HttpMultipartParser.hpp>
+#include <CPVFramework/Utility/Macros.hpp>
+#include <CPVFramework/Utility/StringUtils.hpp>
+
+namespace cpv {
+	namespace {
+		/** The line break between headers */
+		static const constexpr char CRLF[] = "\r\n";
+		/** The end of part headers, the CRLF of delimiter line is included in headers buffer */
+		static const constexpr char CRLFCRLF[] = "\r\n\r\n";
+
+		/**
+		 * Parse parameters of header value like `form-data; name="a"; filename="b"`,
+		 * func(key, value, escaped) will be invoked for each parameter,
+		 * escaped is true if quoted value contains backslash.
+		 */
+		template <class Func>
+		void parseHeaderParameters(std::string_view headerValue, const Func& func) {
+			const char* ptr = headerValue.begin();
+			const char* end = headerValue.end();
+			// skip the value before the first parameter
+			for (; ptr < end && *ptr != ';'; ++ptr) { }
+			while (ptr < end) {
+				// skip ';' and find '='
+				const char* keyBegin = ++ptr;
+				for (; ptr < end && *ptr != '=' && *ptr != ';'; ++ptr) { }
+				std::string_view key = trimString({ keyBegin, static_cast<std::size_t>(ptr - keyBegin) });
+				if (ptr == end || *ptr == ';') {
+					continue;
+				}
+				for (++ptr; ptr < end && (*ptr == ' ' || *ptr == '\t'); ++ptr) { }
+				if (ptr < end && *ptr == '"') {
+					// quoted string, may contains ';'
+					const char* valueBegin = ++ptr;
+					bool escaped = false;
+					for (; ptr < end && *ptr != '"'; ++ptr) {
+						if (*ptr == '\\' && ptr + 1 < end) {
+							escaped = true;
+							++ptr;
+						}
+					}
+					func(key, std::string_view(valueBegin, ptr - valueBegin), escaped);
+					for (; ptr < end && *ptr != ';'; ++ptr) { }
+				} else {
+					const char* valueBegin = ptr;
+					for (; ptr < end && *ptr != ';'; ++ptr) { }
+					func(key, trimString({ valueBegin, static_cast<std::size_t>(ptr - valueBegin) }), false);
+				}
+			}
+		}
+
+		/** Share parameter value from headers, remove backslashes if escaped */
+		SharedString shareParameterValue(
+			const SharedString& headers, std::string_view value, bool escaped) {
+			if (CPV_LIKELY(!escaped)) {
+				return headers.share(value);
+			}
+			SharedStringBuilder builder(value.size());
+			for (const char* ptr = value.begin(); ptr < value.end(); ++ptr) {
+				if (*ptr == '\\' && ptr + 1 < value.end()) {
+					++ptr;
+				}
+				builder.append(1, *ptr);
+			}
+			return builder.build();
+		}
+	}
+
+	/** Append next chunk of body */
+	void HttpMultipartParser::feed(SharedString&& chunk) {
+		if (CPV_UNLIKELY(ptr_ != chunk_.end() || isFinished_)) {
+			throw LogicException(CPV_CODEINFO, "previous chunk isn't parsed or body is finished");
+		}
+		parsedSize_ += chunk_.size();
+		chunk_ = std::move(chunk);
+		ptr_ = chunk_.begin();
+	}
+
+	/** Notify the body is ended */
+	void HttpMultipartParser::finish() {
+		isFinished_ = true;
+	}
+
+	/** Parse until next event */
+	HttpMultipartEvent HttpMultipartParser::next() {
+		for (;;) {
+			if (isInPart_ && state_ != State::Body) {
+				isInPart_ = false;
+				return HttpMultipartEvent::PartEnd;
+			}
+			if (state_ == State::Epilogue) {
+				// ignore data after close delimiter
+				ptr_ = chunk_.end();
+				return HttpMultipartEvent::End;
+			}
+			if (ptr_ == chunk_.end()) {
+				if (isFinished_) {
+					throwError("incomplete multipart body");
+				}
+				return HttpMultipartEvent::NeedMoreData;
+			}
+			switch (state_) {
+			case State::Preamble:
+			case State::Body:
+				if (parseBody()) {
+					return HttpMultipartEvent::PartData;
+				}
+				break;
+			case State::Headers:
+				if (parseHeaders()) {
+					return HttpMultipartEvent::PartBegin;
+				}
+				break;
+			default:
+				parseDelimiterSuffix();
+				break;
+			}
+		}
+	}
+
+	/** Get boundary from Content-Type header */
+	SharedString HttpMultipartParser::getBoundary(const SharedString& contentType) {
+		std::string_view view = contentType.view();
+		if (!caseInsensitiveEquals(
+			trimString(view.substr(0, view.find_first_of(';'))), constants::MultipartFormData)) {
+			return SharedString();
+		}
+		std::string_view boundary;
+		parseHeaderParameters(view, [&boundary] (std::string_view key, std::string_view value, bool) {
+			if (caseInsensitiveEquals(key, "boundary")) {
+				boundary = value;
+			}
+		});
+		if (boundary.empty() || boundary.size() > MaxBoundarySize) {
+			return SharedString();
+		}
+		return contentType.share(boundary);
+	}
+
+	/** Constructor */
+	HttpMultipartParser::HttpMultipartParser(
+		std::string_view boundary,
+		std::size_t maxHeaderSize) :
+		delimiter_(SharedStringBuilder(boundary.size() + 4)
+			.append(CRLF).append("--").append(boundary).build()),
+		searcher_(delimiter_.begin(), delimiter_.end()),
+		maxHeaderSize_(maxHeaderSize),
+		state_(State::Preamble),
+		isInPart_(false),
+		isFinished_(false),
+		parsedSize_(0),
+		chunk_(),
+		ptr_(chunk_.end()),
+		carry_(),
+		headers_(),
+		part_(),
+		data_() {
+		if (CPV_UNLIKELY(boundary.empty() || boundary.size() > MaxBoundarySize)) {
+			throw DeserializeException(CPV_CODEINFO,
+				"invalid size of multipart boundary:", boundary.size());
+		}
+		// the first delimiter may not be preceded by CRLF
+		carry_.append(CRLF);
+	}
+
+	/**
+	 * Search delimiter from data of part (or preamble),
+	 * return true if there is data to emit (data_ is not empty and in part).
+	 */
+	bool HttpMultipartParser::parseBody() {
+		const char* end = chunk_.end();
+		std::size_t keep = delimiter_.size() - 1;
+		bool isPreamble = (state_ == State::Preamble);
+		if (CPV_UNLIKELY(!carry_.empty())) {
+			// the carried tail of previous chunk may be the beginning of delimiter,
+			// join it with the beginning of this chunk and search again
+			std::size_t carrySize = carry_.size();
+			std::size_t take = std::min(static_cast<std::size_t>(end - ptr_), keep);
+			carry_.append({ ptr_, take });
+			std::string_view view = carry_.view();
+			const char* found = std::search(view.begin(), view.end(), searcher_);
+			if (found != view.end()) {
+				std::size_t dataSize = found - view.begin();
+				data_ = SharedString(view.substr(0, dataSize));
+				ptr_ += dataSize + delimiter_.size() - carrySize;
+				carry_.clear();
+				state_ = State::DelimiterSuffix;
+			} else if (take == keep) {
+				// the carried tail isn't a part of delimiter
+				data_ = SharedString(view.substr(0, carrySize));
+				carry_.clear();
+			} else {
+				// the chunk is shorter than delimiter, keep the tail
+				std::size_t dataSize = view.size() > keep ? view.size() - keep : 0;
+				data_ = SharedString(view.substr(0, dataSize));
+				SharedString tail(view.substr(dataSize));
+				carry_.clear();
+				carry_.append(tail);
+				ptr_ = end;
+			}
+		} else {
+			const char* found = std::search(ptr_, end, searcher_);
+			if (found != end) {
+				data_ = chunk_.share({ ptr_, static_cast<std::size_t>(found - ptr_) });
+				ptr_ = found + delimiter_.size();
+				state_ = State::DelimiterSuffix;
+			} else {
+				// only the tail starts with '\r' may be the beginning of delimiter
+				const char* tail = (static_cast<std::size_t>(end - ptr_) > keep) ? end - keep : ptr_;
+				const void* cr = std::memchr(tail, '\r', end - tail);
+				tail = (cr != nullptr) ? static_cast<const char*>(cr) : end;
+				data_ = chunk_.share({ ptr_, static_cast<std::size_t>(tail - ptr_) });
+				carry_.append({ tail, static_cast<std::size_t>(end - tail) });
+				ptr_ = end;
+			}
+		}
+		if (isPreamble) {
+			data_ = SharedString();
+			return false;
+		}
+		return !data_.empty();
+	}
+
+	/** Parse transport padding and CRLF (or "--" for close delimiter) after delimiter */
+	void HttpMultipartParser::parseDelimiterSuffix() {
+		const char* end = chunk_.end();
+		for (; ptr_ < end; ++ptr_) {
+			const char c = *ptr_;
+			if (state_ == State::DelimiterSuffix) {
+				if (c == '-') {
+					state_ = State::CloseDelimiter;
+				} else if (c == '\r') {
+					state_ = State::DelimiterLF;
+				} else if (CPV_UNLIKELY(c != ' ' && c != '\t')) {
+					throwError("invalid character after delimiter");
+				}
+			} else if (state_ == State::DelimiterLF) {
+				if (CPV_UNLIKELY(c != '\n')) {
+					throwError("invalid character after delimiter");
+				}
+				++ptr_;
+				state_ = State::Headers;
+				headers_.clear();
+				headers_.append(CRLF);
+				return;
+			} else {
+				if (CPV_UNLIKELY(c != '-')) {
+					throwError("invalid close delimiter");
+				}
+				++ptr_;
+				state_ = State::Epilogue;
+				return;
+			}
+		}
+	}
+
+	/** Parse headers of part, return true if headers are ended */
+	bool HttpMultipartParser::parseHeaders() {
+		// headers buffer starts with CRLF so empty headers can be found by CRLFCRLF
+		std::size_t limit = maxHeaderSize_ + sizeof(CRLF) - 1 + sizeof(CRLFCRLF) - 1;
+		std::size_t oldSize = headers_.size();
+		std::size_t take = std::min(static_cast<std::size_t>(chunk_.end() - ptr_), limit - oldSize);
+		headers_.append({ ptr_, take });
+		std::size_t index = headers_.view().find(CRLFCRLF, oldSize >= 3 ? oldSize - 3 : 0);
+		if (index == std::string_view::npos) {
+			if (CPV_UNLIKELY(headers_.size() >= limit)) {
+				throwError("multipart headers too large");
+			}
+			ptr_ += take;
+			return false;
+		}
+		ptr_ += index + sizeof(CRLFCRLF) - 1 - oldSize;
+		headers_.resize(index);
+		parsePartHeaders(headers_.build());
+		state_ = State::Body;
+		isInPart_ = true;
+		return true;
+	}
+
+	/** Parse Content-Disposition and Content-Type from headers */
+	void HttpMultipartParser::parsePartHeaders(SharedString&& headers) {
+		part_ = HttpMultipartPartHeaders();
+		splitString(headers.view(), [this, &headers] (std::string_view line, std::size_t) {
+			std::size_t colon = line.find_first_of(':');
+			if (colon == line.npos) {
+				return;
+			}
+			std::string_view name = trimString(line.substr(0, colon));
+			std::string_view value = trimString(line.substr(colon + 1));
+			if (caseInsensitiveEquals(name, constants::ContentDisposition)) {
+				parseHeaderParameters(value, [this, &headers]
+					(std::string_view key, std::string_view paramValue, bool escaped) {
+					if (caseInsensitiveEquals(key, "name")) {
+						part_.name = shareParameterValue(headers, paramValue, escaped);
+					} else if (caseInsensitiveEquals(key, "filename")) {
+						part_.filename = shareParameterValue(headers, paramValue, escaped);
+						part_.isFile = true;
+					}
+				});
+			} else if (caseInsensitiveEquals(name, constants::ContentType)) {
+				part_.contentType = headers.share(value);
+			}
+		}, CRLF);
+	}
+
+	/** Throw DeserializeException with position */
+	void HttpMultipartParser::throwError(const char* message) const {
+		throw DeserializeException(CPV_CODEINFO, message,
+			"at position", parsedSize_ + (ptr_ - chunk_.begin()));
+	}
+}
+
@@ -0,0 +1,91 @@
+#include <CPVFramework/Exceptions/DeserializeException.hpp>
+#include <CPVFramework/Http/HttpMultipartReader.hpp>
+#include <CPVFramework/Utility/Macros.hpp>
+
+namespace cpv {
+	/** Move to next part, remaining data of current part will be skipped */
+	seastar::future<bool> HttpMultipartReader::nextPart() {
+		if (isEnd_) {
+			return seastar::make_ready_future<bool>(false);
+		}
+		return seastar::repeat_until_value([this] {
+			return nextEvent().then([this] (HttpMultipartEvent event) {
+				if (event == HttpMultipartEvent::PartBegin) {
+					isInPart_ = true;
+					partSize_ = 0;
+					return std::optional<bool>(true);
+				} else if (event == HttpMultipartEvent::End) {
+					isInPart_ = false;
+					isEnd_ = true;
+					return std::optional<bool>(false);
+				}
+				// skip data of current part
+				isInPart_ = (event == HttpMultipartEvent::PartData);
+				return std::optional<bool>();
+			});
+		});
+	}
+
+	/** Constructor */
+	HttpMultipartReader::HttpMultipartReader(
+		InputStreamBase& stream,
+		std::string_view boundary,
+		std::size_t maxPartSize,
+		std::size_t maxHeaderSize) :
+		stream_(stream),
+		parser_(boundary, maxHeaderSize),
+		partStream_(*this),
+		maxPartSize_(maxPartSize),
+		partSize_(0),
+		isInPart_(false),
+		isEnd_(false) { }
+
+	/** Read data of current part */
+	seastar::future<InputStreamReadResult> HttpMultipartReader::PartInputStream::read() {
+		return reader_.readPart();
+	}
+
+	/** Parse next event, read more data from stream if required */
+	seastar::future<HttpMultipartEvent> HttpMultipartReader::nextEvent() {
+		HttpMultipartEvent event;
+		try {
+			event = parser_.next();
+		} catch (...) {
+			return seastar::make_exception_future<HttpMultipartEvent>(std::current_exception());
+		}
+		if (CPV_LIKELY(event != HttpMultipartEvent::NeedMoreData)) {
+			return seastar::make_ready_future<HttpMultipartEvent>(event);
+		}
+		return stream_.read().then([this] (InputStreamReadResult result) {
+			parser_.feed(std::move(result.data));
+			if (result.isEnd) {
+				parser_.finish();
+			}
+			return nextEvent();
+		});
+	}
+
+	/** Read data of current part */
+	seastar::future<InputStreamReadResult> HttpMultipartReader::readPart() {
+		if (!isInPart_) {
+			return seastar::make_ready_future<InputStreamReadResult>();
+		}
+		return nextEvent().then([this] (HttpMultipartEvent event) {
+			if (event == HttpMultipartEvent::PartData) {
+				SharedString& data = parser_.data();
+				partSize_ += data.size();
+				if (CPV_UNLIKELY(partSize_ > maxPartSize_)) {
+					return seastar::make_exception_future<InputStreamReadResult>(
+						DeserializeException(CPV_CODEINFO,
+							"size of multipart part exceeds limit:", maxPartSize_));
+				}
+				return seastar::make_ready_future<InputStreamReadResult>(
+					InputStreamReadResult(std::move(data), false));
+			}
+			// PartEnd, End is unreachable because PartEnd comes first
+			isInPart_ = false;
+			return seastar::make_ready_future<InputStreamReadResult>();
+		});
+	}
+}
+
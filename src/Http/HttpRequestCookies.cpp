@@ -35,9 +35,9 @@ namespace cpv {
 					{ mark, static_cast<std::size_t>(ptr - mark) }));
 				mark = ptr + 1;
 				if (!key.empty()) {
-					cookies_.insert_or_assign(std::move(key), std::move(value));
+					cookies_.appendUnsorted(std::move(key), std::move(value));
 				} else if (!value.empty()) {
-					cookies_.insert_or_assign(std::move(value), "");
+					cookies_.appendUnsorted(std::move(value), "");
 				}
 				key = {};
 				value = {};
@@ -47,11 +47,13 @@ namespace cpv {
 			value = cookies.share(trimString(
 				{ mark, static_cast<std::size_t>(ptr - mark) }));
 			if (!key.empty()) {
-				cookies_.insert_or_assign(std::move(key), std::move(value));
+				cookies_.appendUnsorted(std::move(key), std::move(value));
 			} else if (!value.empty()) {
-				cookies_.insert_or_assign(std::move(value), "");
+				cookies_.appendUnsorted(std::move(value), "");
 			}
 		}
+		// cookies are appended in order of appearance, sort them at once
+		cookies_.sortAndDeduplicate();
 	}
 	
 	/** Clear all parsed cookies */
@@ -35,6 +35,21 @@ namespace cpv {
 		}
 	}
 	
+	/** Append header value without checking duplicated key */
+	void HttpRequestHeaders::appendHeader(SharedString&& key, SharedString&& value) {
+		auto it = Internal::FixedMembers.find(key);
+		if (CPV_LIKELY(it != Internal::FixedMembers.end())) {
+			this->*(it->second) = std::move(value);
+		} else {
+			remainHeaders_.appendUnsorted(std::move(key), std::move(value));
+		}
+	}
+	
+	/** Sort headers added by appendHeader */
+	void HttpRequestHeaders::sortHeaders() {
+		remainHeaders_.sortAndDeduplicate();
+	}
+	
 	/** Append all headers to packet fragments for http 1 */
 	void HttpRequestHeaders::appendToHttp1Packet(Packet::MultipleFragments& fragments) {
 		namespace cs = constants::with_crlf_colonspace;
@@ -25,7 +25,7 @@ namespace cpv {
 	});
 	
 	/** Append all headers to packet fragments for http 1 */
-	void HttpResponseHeaders::appendToHttp1Packet(Packet::MultipleFragments& fragments) {
+	void HttpResponseHeaders::appendToHttp1Packet(Packet::MultipleFragments& fragments) const {
 		namespace cs = constants::with_crlf_colonspace;
 		if (!date_.empty()) {
 			fragments.append(cs::Date);
@@ -87,6 +87,19 @@ namespace cpv {
 			fragments.append(constants::ColonSpace);
 			fragments.append(pair.second.share());
 		}
+		if (!http1HeadersBlock_.empty()) {
+			fragments.append(http1HeadersBlock_.share());
+		}
+	}
+	
+	/** Render all headers to a single block for http 1 and replace the existing block with it */
+	SharedString HttpResponseHeaders::toHttp1HeadersBlock() {
+		Packet packet;
+		appendToHttp1Packet(packet.getOrConvertToMultiple());
+		SharedString block = packet.toString();
+		clear();
+		http1HeadersBlock_ = block.share();
+		return block;
 	}
 	
 	/** Set header value */
@@ -145,7 +158,8 @@ namespace cpv {
 	std::size_t HttpResponseHeaders::maxSize() const {
 		return (Internal::FixedMembers.size() +
 			remainHeaders_.size() +
-			additionHeaders_.size());
+			additionHeaders_.size() +
+			(http1HeadersBlock_.empty() ? 0 : 1));
 	}
 	
 	/** Clear headers in this collection */
@@ -164,6 +178,7 @@ namespace cpv {
 		cacheControl_.clear();
 		expires_.clear();
 		lastModified_.clear();
+		http1HeadersBlock_.clear();
 	}
 	
 	/** Constructor */
@@ -181,6 +196,7 @@ namespace cpv {
 		etag_(),
 		cacheControl_(),
 		expires_(),
-		lastModified_() { }
+		lastModified_(),
+		http1HeadersBlock_() { }
 }
 
@@ -375,6 +375,8 @@ namespace cpv {
 				makeReusable<Http11ServerConnectionResponseStream>(this).cast<OutputStreamBase>());
 			processingContext_.setRequestResponse(std::move(entry.request), std::move(response));
 			processingContext_.clearServiceStorage();
+			// blocks referenced by strings still kept by network stack are handed over to them
+			processingContext_.resetArena();
 			// reset reply loop data
 			replyLoopData_ = {};
 			replyLoopData_.requestId = entry.id;
@@ -458,8 +460,9 @@ namespace cpv {
 		if (CPV_LIKELY(responseHeaders.getDate().empty())) {
 			responseHeaders.setDate(SharedString::fromStatic(formatNowForHttpHeader()));
 		}
-		// set server header
-		if (CPV_LIKELY(responseHeaders.getServer().empty())) {
+		// set server header, the pre-rendered headers block may contains it
+		if (CPV_LIKELY(responseHeaders.getServer().empty() &&
+			responseHeaders.getHttp1HeadersBlock().empty())) {
 			// no version number for security
 			responseHeaders.setServer(constants::CPVFramework);
 		}
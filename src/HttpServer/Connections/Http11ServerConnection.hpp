@@ -123,7 +123,7 @@ namespace cpv {
 			if (CPV_LIKELY(state_ == Http11ServerConnectionState::ReceiveRequestHeaderValue)) {
 				// the first time received a new header field, store last header field and value
 				state_ = Http11ServerConnectionState::ReceiveRequestHeaderField;
-				newRequest_.setHeader(
+				newRequest_.getHeaders().appendHeader(
 					receiveLoopData_.headerField.build(),
 					receiveLoopData_.headerValue.build());
 				receiveLoopData_.headerField = SharedStringBuilder(
@@ -165,9 +165,10 @@ namespace cpv {
 			if (CPV_LIKELY(state_ == Http11ServerConnectionState::ReceiveRequestHeaderValue)) {
 				// all headers received, store last header field and value
 				state_ = Http11ServerConnectionState::ReceiveRequestHeadersComplete;
-				newRequest_.setHeader(
+				newRequest_.getHeaders().appendHeader(
 					receiveLoopData_.headerField.build(),
 					receiveLoopData_.headerValue.build());
+				newRequest_.getHeaders().sortHeaders();
 			} else if (state_ == Http11ServerConnectionState::ReceiveRequestUrl) {
 				// no headers but url
 				state_ = Http11ServerConnectionState::ReceiveRequestHeadersComplete;
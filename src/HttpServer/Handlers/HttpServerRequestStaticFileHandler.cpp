@@ -1,5 +1,26 @@
+#include <algorithm>
 #include <array>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <boost/iterator/counting_iterator.hpp>
+#include <seastar/core/alien.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/posix.hh>
 #include <seastar/core/reactor.hh>
+#include <seastar/core/smp.hh>
 #include <seastar/core/fstream.hh>
 #include <seastar/core/future-util.hh>
 #include <CPVFramework/Allocators/StackAllocator.hpp>
@@ -16,77 +37,963 @@
 
 namespace cpv {
 	namespace {
-		/** Suffix of gzip compressed file */
-		static const constexpr char CompressedFileSuffix[] = ".gz";
-		/** Encoding string of gzip compressed content */
-		static const constexpr char CompressEncoding[] = "gzip";
+		/** Pre-compressed variant of file, detected by suffix of file name */
+		struct CompressedVariant {
+			const char* suffix;
+			const char* encoding;
+		};
+		/** Supported pre-compressed variants, former one is preferred if qualities are equal */
+		static const constexpr std::array<CompressedVariant, 3> CompressedVariants = {{
+			{ ".br", "br" },
+			{ ".zst", "zstd" },
+			{ ".gz", "gzip" },
+		}};
+		/** Variant index represents the original file */
+		static const constexpr std::size_t NoVariant = CompressedVariants.size();
+		/** Variant index of gzip, also used by on-the-fly compression */
+		static const constexpr std::size_t GzipVariant = 2;
+		/** Suffix appended to entity tag of on-the-fly compressed content */
+		static const constexpr char CompressedETagSuffix[] = "-gzip\"";
 		/** Prefix for Range header, only bytes is supported */
 		static const constexpr char RangePrefix[] = "bytes=";
 		/** Prefix for Content-Range header, only bytes is supported */
 		static const constexpr char ContentRangePrefix[] = "bytes ";
+		/** Maximum number of ranges in Range header, header contains more ranges will be ignored */
+		static const constexpr std::size_t MaxRangeCount = 16;
+		/** Start position of suffix range like "-500" (last 500 bytes) */
+		static const constexpr std::size_t SuffixRangeStart = std::numeric_limits<std::size_t>::max();
+		/** End position of open range like "500-" (from 500 to end of file) */
+		static const constexpr std::size_t OpenRangeEnd = std::numeric_limits<std::size_t>::max();
+		/** Content-Type of multiple ranges response */
+		static const constexpr char MultipartContentType[] =
+			"multipart/byteranges; boundary=CPVFrameworkByteRangesBoundary";
+		/** Leading boundary and Content-Type header of each part in multiple ranges response */
+		static const constexpr char MultipartPartStart[] =
+			"\r\n--CPVFrameworkByteRangesBoundary\r\nContent-Type: ";
+		/** Content-Range header of each part in multiple ranges response */
+		static const constexpr char MultipartContentRange[] = "\r\nContent-Range: bytes ";
+		/** Closing boundary of multiple ranges response */
+		static const constexpr char MultipartEnd[] = "\r\n--CPVFrameworkByteRangesBoundary--\r\n";
 		/** Maximum size when reading file content to chunk */
 		static const constexpr std::size_t ReadFileChunkSize = 4096;
 		/** Header field for cache hit or miss */
 		static const constexpr char XCacheHeader[] = "X-Cache";
 		/** Header value for cache hit */
 		static const constexpr char XCacheHitValue[] = "HIT";
+		/** Inotify events that may change cached content or metadata */
+		static const constexpr std::uint32_t WatchEventMask = (
+			IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE |
+			IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
+
+		/** Pre-compressed variants accepted by client, ordered by quality from high to low */
+		struct CompressedVariantCandidates {
+			std::array<std::size_t, CompressedVariants.size()> variants;
+			std::size_t count;
+		};
+
+		/** Parse Accept-Encoding header and return accepted pre-compressed variants */
+		CompressedVariantCandidates getCompressedVariantCandidates(std::string_view acceptEncoding) {
+			CompressedVariantCandidates candidates = {};
+			if (acceptEncoding.empty()) {
+				return candidates;
+			}
+			std::array<std::size_t, CompressedVariants.size()> qualities;
+			for (std::size_t i = 0; i < CompressedVariants.size(); ++i) {
+				qualities[i] = getAcceptEncodingQuality(acceptEncoding, CompressedVariants[i].encoding);
+				if (qualities[i] > 0) {
+					candidates.variants[candidates.count++] = i;
+				}
+			}
+			std::stable_sort(
+				candidates.variants.begin(),
+				candidates.variants.begin() + candidates.count,
+				[&qualities] (std::size_t a, std::size_t b) { return qualities[a] > qualities[b]; });
+			return candidates;
+		}
+
+		/** Check whether gzip is accepted by client (it's in candidates) */
+		bool isGzipAccepted(const CompressedVariantCandidates& candidates) {
+			auto end = candidates.variants.begin() + candidates.count;
+			return std::find(candidates.variants.begin(), end, GzipVariant) != end;
+		}
+
+		/**
+		 * Compress content to gzip format with given level (1 ~ 9),
+		 * return empty string if compression failed or compressed content is not smaller.
+		 * It's cpu heavy for large content, execute it in BackgroundWorker.
+		 */
+		std::string compressGzip(std::string_view content, int level) {
+			::z_stream stream = {};
+			// window bits 15 + 16 makes zlib write gzip header and trailer
+			if (::deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+				return std::string();
+			}
+			std::string buf(::deflateBound(&stream, content.size()), '\0');
+			stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(content.data()));
+			stream.avail_in = static_cast<uInt>(content.size());
+			stream.next_out = reinterpret_cast<Bytef*>(buf.data());
+			stream.avail_out = static_cast<uInt>(buf.size());
+			int result = ::deflate(&stream, Z_FINISH);
+			std::size_t compressedSize = stream.total_out;
+			::deflateEnd(&stream);
+			if (result != Z_STREAM_END || compressedSize >= content.size()) {
+				return std::string();
+			}
+			// release the unused capacity because it will be kept in cache
+			buf.resize(compressedSize);
+			buf.shrink_to_fit();
+			return buf;
+		}
+
+		/** Build entity tag of on-the-fly compressed content, like "2a1b3-f-15dc0d7b5bd0e1f0-gzip" */
+		SharedString buildCompressedETag(const SharedString& etag) {
+			return SharedStringBuilder(etag.size() + sizeof(CompressedETagSuffix))
+				.append(etag.view().substr(0, etag.size() - 1))
+				.append(CompressedETagSuffix).build();
+		}
+
+		/** Byte ranges, each range is [from, to] (notice to is inclusive) */
+		using ByteRanges = StackAllocatedVector<std::pair<std::size_t, std::size_t>, 4>;
+
+		/**
+		 * Parse "Range: bytes=from-to, from-, -suffixLength" to range specs,
+		 * return false if header is absent, malformed or contains too many ranges.
+		 */
+		bool parseRangeHeader(std::string_view rangeHeader, ByteRanges& rangeSpecs) {
+			if (!startsWith(rangeHeader, RangePrefix)) {
+				return false;
+			}
+			bool isValid = true;
+			splitString(rangeHeader.substr(sizeof(RangePrefix) - 1),
+				[&rangeSpecs, &isValid] (std::string_view rangeStr, std::size_t) {
+				rangeStr = trimString(rangeStr);
+				if (!isValid || rangeStr.empty()) {
+					return;
+				}
+				std::size_t pos = rangeStr.find_first_of('-');
+				if (pos == rangeStr.npos || rangeSpecs.size() >= MaxRangeCount) {
+					isValid = false;
+					return;
+				}
+				std::string_view fromStr = rangeStr.substr(0, pos);
+				std::string_view toStr = rangeStr.substr(pos + 1);
+				std::size_t from = SuffixRangeStart;
+				std::size_t to = OpenRangeEnd;
+				if (fromStr.empty()) {
+					// suffix range, to is the length of suffix
+					isValid = !toStr.empty() && loadIntFromDec(toStr.data(), toStr.size(), to);
+				} else {
+					isValid = loadIntFromDec(fromStr.data(), fromStr.size(), from) && (toStr.empty() ||
+						(loadIntFromDec(toStr.data(), toStr.size(), to) && from <= to));
+				}
+				rangeSpecs.emplace_back(from, to);
+			}, ',');
+			if (!isValid) {
+				rangeSpecs.clear();
+			}
+			return !rangeSpecs.empty();
+		}
+
+		/**
+		 * Resolve range specs with content size, unsatisfiable ranges will be removed,
+		 * all ranges will be removed if they overlapped too much (larger than content).
+		 */
+		void resolveRanges(const ByteRanges& rangeSpecs, std::size_t size, ByteRanges& ranges) {
+			std::size_t totalSize = 0;
+			for (auto [from, to] : rangeSpecs) {
+				if (from == SuffixRangeStart) {
+					if (to == 0 || size == 0) {
+						continue;
+					}
+					from = size - std::min(to, size);
+					to = size - 1;
+				} else if (from >= size) {
+					continue;
+				} else {
+					to = std::min(to, size - 1);
+				}
+				ranges.emplace_back(from, to);
+				totalSize += to - from + 1;
+			}
+			if (totalSize > size) {
+				ranges.clear();
+			}
+		}
+
+		/** Buffer for entity tag: two quotes, two hyphens and three hex numbers */
+		using ETagBuffer = std::array<char, 2 + 2 + 16 * 3>;
+
+		/**
+		 * Format strong ETag from inode, size and modified time in nanoseconds,
+		 * format is "inode-size-mtime" in hex, like "2a1b3-f-15dc0d7b5bd0e1f0".
+		 * It writes to given buffer and return the size, it doesn't allocate memory,
+		 * so it's safe to call from background thread.
+		 */
+		std::size_t formatETag(const struct ::stat& st, ETagBuffer& buf) {
+			static const constexpr char digits[] = "0123456789abcdef";
+			std::uint64_t modifiedTimeNs = (
+				static_cast<std::uint64_t>(st.st_mtim.tv_sec) * 1000000000ULL +
+				static_cast<std::uint64_t>(st.st_mtim.tv_nsec));
+			std::array<std::uint64_t, 3> values({
+				static_cast<std::uint64_t>(st.st_ino),
+				static_cast<std::uint64_t>(st.st_size),
+				modifiedTimeNs });
+			std::size_t size = 0;
+			buf[size++] = '"';
+			for (std::size_t i = 0; i < values.size(); ++i) {
+				if (i != 0) {
+					buf[size++] = '-';
+				}
+				std::array<char, 16> hex;
+				std::size_t pos = hex.size();
+				std::uint64_t value = values[i];
+				do {
+					hex[--pos] = digits[value & 0xf];
+					value >>= 4;
+				} while (value != 0);
+				std::memcpy(buf.data() + size, hex.data() + pos, hex.size() - pos);
+				size += hex.size() - pos;
+			}
+			buf[size++] = '"';
+			return size;
+		}
+
+		/** Build strong ETag from inode, size and modified time in nanoseconds, see formatETag */
+		SharedString buildETag(const struct ::stat& st) {
+			ETagBuffer buf;
+			return SharedString(std::string_view(buf.data(), formatETag(st, buf)));
+		}
+
+		/** Remove weak indicator "W/" from entity tag */
+		std::string_view removeWeakIndicator(std::string_view etag) {
+			return startsWith(etag, "W/") ? etag.substr(2) : etag;
+		}
+
+		/** Check If-None-Match header (list of entity tags or "*") with weak comparison */
+		bool isIfNoneMatchMatched(std::string_view ifNoneMatchHeader, std::string_view etag) {
+			bool matched = false;
+			std::string_view etagOpaque = removeWeakIndicator(etag);
+			splitString(ifNoneMatchHeader, [&matched, etagOpaque] (std::string_view part, std::size_t) {
+				part = trimString(part);
+				matched = matched || part == "*" || removeWeakIndicator(part) == etagOpaque;
+			}, ',');
+			return matched;
+		}
+
+		/**
+		 * Check whether client cached content is not modified,
+		 * If-Modified-Since will be ignored if If-None-Match is presented.
+		 */
+		bool isNotModified(
+			std::string_view ifNoneMatchHeader,
+			std::string_view ifModifiedSinceHeader,
+			std::string_view etag,
+			std::string_view lastModified) {
+			if (!ifNoneMatchHeader.empty()) {
+				return isIfNoneMatchMatched(ifNoneMatchHeader, etag);
+			}
+			return ifModifiedSinceHeader == lastModified;
+		}
+
+		/**
+		 * Check If-Range header (entity tag or http date), ranges should be ignored if not matched,
+		 * entity tag uses strong comparison so weak entity tag never match.
+		 */
+		bool isIfRangeMatched(
+			std::string_view ifRangeHeader, std::string_view etag, std::string_view lastModified) {
+			if (ifRangeHeader.empty()) {
+				return true;
+			} else if (startsWith(ifRangeHeader, "W/")) {
+				return false;
+			} else if (startsWith(ifRangeHeader, constants::DoubleQuote)) {
+				return !startsWith(etag, "W/") && ifRangeHeader == etag;
+			}
+			return ifRangeHeader == lastModified;
+		}
+
+		/** Build value of Content-Range header, like "bytes 200-1000/67589" */
+		SharedString buildContentRange(std::size_t from, std::size_t to, std::size_t size) {
+			return SharedStringBuilder(32).append(ContentRangePrefix)
+				.append(from).append(constants::Hyphen)
+				.append(to).append(constants::Slash)
+				.append(size).build();
+		}
+
+		/** Build leading boundary and headers of part in multiple ranges response */
+		SharedString buildMultipartPartHeader(
+			const SharedString& mimeType, std::size_t from, std::size_t to, std::size_t size) {
+			return SharedStringBuilder(sizeof(MultipartPartStart) + mimeType.size() + 64)
+				.append(MultipartPartStart).append(mimeType)
+				.append(MultipartContentRange).append(from)
+				.append(constants::Hyphen).append(to)
+				.append(constants::Slash).append(size)
+				.append(constants::CRLFCRLF).build();
+		}
+
+		/** Reply whole content or resolved ranges of content to http response */
+		seastar::future<> replyContent(
+			HttpResponse& response,
+			SharedString&& content,
+			SharedString&& mimeType,
+			const ByteRanges& ranges) {
+			if (ranges.empty()) {
+				return extensions::reply(response, std::move(content), std::move(mimeType));
+			}
+			std::size_t size = content.size();
+			if (ranges.size() == 1) {
+				auto [from, to] = ranges.front();
+				response.getHeaders().setHeader(constants::ContentRange, buildContentRange(from, to, size));
+				return extensions::reply(response, content.share(from, to - from + 1),
+					std::move(mimeType), constants::_206, constants::PartialContent);
+			}
+			// build multipart/byteranges body with fragments point to content
+			Packet packet(ranges.size() * 2 + 1);
+			auto& fragments = packet.getOrConvertToMultiple();
+			for (auto [from, to] : ranges) {
+				fragments.append(buildMultipartPartHeader(mimeType, from, to, size));
+				fragments.append(content.share(from, to - from + 1));
+			}
+			fragments.append(MultipartEnd);
+			return extensions::reply(response, std::move(packet),
+				MultipartContentType, constants::_206, constants::PartialContent);
+		}
+
+		/** Read only memory mapped file, shared by handlers on all shards */
+		class MemoryMappedFile {
+		public:
+			/** Get address of mapped memory */
+			char* data() const { return data_; }
+
+			/** Get size of mapped memory */
+			std::size_t size() const { return size_; }
+
+			/** Get entity tag of file when it's mapped */
+			const std::string& etag() const { return etag_; }
+
+			/**
+			 * Map file to memory, throws FileSystemException if failed.
+			 * Return nullptr if file has write permission, truncate a mapped file makes access
+			 * to the truncated pages raise SIGBUS, so only files that can't be modified in place
+			 * (no write permission for anyone) are mapped, others should be read into memory.
+			 * It's blocking, only call it from BackgroundWorker.
+			 */
+			static std::shared_ptr<MemoryMappedFile> create(const std::string& path) {
+				int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+				if (CPV_UNLIKELY(fd < 0)) {
+					throw FileSystemException(CPV_CODEINFO,
+						"open file", path, "failed:", std::strerror(errno));
+				}
+				struct ::stat st = {};
+				if (CPV_UNLIKELY(::fstat(fd, &st) != 0)) {
+					int err = errno;
+					::close(fd);
+					throw FileSystemException(CPV_CODEINFO,
+						"stat file", path, "failed:", std::strerror(err));
+				}
+				if ((st.st_mode & (S_IWUSR | S_IWGRP | S_IWOTH)) != 0) {
+					::close(fd);
+					return nullptr;
+				}
+				std::size_t size = static_cast<std::size_t>(st.st_size);
+				char* data = nullptr;
+				if (size > 0) {
+					void* ptr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if (CPV_UNLIKELY(ptr == MAP_FAILED)) {
+						int err = errno;
+						::close(fd);
+						throw FileSystemException(CPV_CODEINFO,
+							"map file", path, "to memory failed:", std::strerror(err));
+					}
+					data = static_cast<char*>(ptr);
+					// let kernel read ahead asynchronously to reduce page faults in reactor
+					::madvise(data, size, MADV_WILLNEED);
+				}
+				::close(fd);
+				// SharedString uses the allocator of reactor thread, use std::string here
+				ETagBuffer etag;
+				return std::make_shared<MemoryMappedFile>(data, size, std::string(etag.data(), formatETag(st, etag)));
+			}
+
+			/** Construct with mapped memory, the memory will be unmapped in destructor */
+			MemoryMappedFile(char* data, std::size_t size, std::string&& etag) :
+				data_(data),
+				size_(size),
+				etag_(std::move(etag)) { }
+
+			/** Disallow copy and move */
+			MemoryMappedFile(const MemoryMappedFile&) = delete;
+			MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+			/** Destructor */
+			~MemoryMappedFile() {
+				if (data_ != nullptr) {
+					::munmap(data_, size_);
+				}
+			}
+
+		private:
+			char* data_;
+			std::size_t size_;
+			std::string etag_;
+		};
+
+		/**
+		 * Background thread for operations that may block the reactor, like mapping files
+		 * (open, fstat and mmap may wait for disk) and compressing content, shared by all shards.
+		 * The result is delivered back to the requesting shard by seastar::alien::run_on.
+		 */
+		class BackgroundWorker {
+		public:
+			/** Execute function in background thread, the thread is started on first use */
+			template <class T, class Func>
+			seastar::future<T> submit(Func&& func) {
+				auto promise = std::make_unique<seastar::promise<T>>();
+				auto future = promise->get_future();
+				enqueue([func=std::forward<Func>(func),
+					promise=promise.release(), shard=seastar::engine().cpu_id()] () mutable {
+					std::optional<T> result;
+					std::exception_ptr error;
+					try {
+						result.emplace(func());
+					} catch (...) {
+						error = std::current_exception();
+					}
+					// promise is not thread safe, it must be fulfilled and destroyed on it's shard
+					seastar::alien::run_on(shard,
+						[promise, result=std::move(result), error] () mutable {
+						std::unique_ptr<seastar::promise<T>> guard(promise);
+						if (error) {
+							guard->set_exception(error);
+						} else {
+							guard->set_value(std::move(*result));
+						}
+					});
+				});
+				return future;
+			}
+
+			/** Constructor */
+			BackgroundWorker() :
+				mutex_(),
+				condition_(),
+				tasks_(),
+				stopping_(false),
+				thread_() { }
+
+			/** Disallow copy and move */
+			BackgroundWorker(const BackgroundWorker&) = delete;
+			BackgroundWorker& operator=(const BackgroundWorker&) = delete;
+
+			/** Destructor, stop the background thread, all tasks should be finished already */
+			~BackgroundWorker() {
+				{
+					std::lock_guard<std::mutex> guard(mutex_);
+					stopping_ = true;
+				}
+				condition_.notify_one();
+				if (thread_.joinable()) {
+					thread_.join();
+				}
+			}
+
+		private:
+			/** Add task to queue and start the thread if it's not started */
+			void enqueue(std::function<void()>&& task) {
+				{
+					std::lock_guard<std::mutex> guard(mutex_);
+					if (!thread_.joinable()) {
+						thread_ = std::thread([this] { run(); });
+					}
+					tasks_.emplace_back(std::move(task));
+				}
+				condition_.notify_one();
+			}
+
+			/** Main loop of background thread */
+			void run() {
+				for (;;) {
+					std::function<void()> task;
+					{
+						std::unique_lock<std::mutex> lock(mutex_);
+						condition_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+						if (tasks_.empty()) {
+							return;
+						}
+						task = std::move(tasks_.front());
+						tasks_.pop_front();
+					}
+					task();
+				}
+			}
+
+		private:
+			std::mutex mutex_;
+			std::condition_variable condition_;
+			std::deque<std::function<void()>> tasks_;
+			bool stopping_;
+			std::thread thread_;
+		};
+
+		/** Get the global background worker */
+		BackgroundWorker& getBackgroundWorker() {
+			static BackgroundWorker worker;
+			return worker;
+		}
+
+		/** Memory mapped files by path, it's shared by all shards so protected by mutex */
+		struct MemoryMappedFileRegistry {
+			std::mutex mutex;
+			std::unordered_map<std::string, std::weak_ptr<MemoryMappedFile>> files;
+			std::size_t sweepThreshold = 64;
+		};
+
+		/** Get the global registry of memory mapped files */
+		MemoryMappedFileRegistry& getMemoryMappedFileRegistry() {
+			static MemoryMappedFileRegistry registry;
+			return registry;
+		}
+
+		/** Build string points to memory mapped file, the file is kept alive until string released */
+		SharedString toSharedString(std::shared_ptr<MemoryMappedFile>&& mappedFile) {
+			// each shard has it's own deleter because seastar::deleter is not thread safe,
+			// the reference count of std::shared_ptr is atomic so it's safe to share mapping
+			char* data = mappedFile->data();
+			std::size_t size = mappedFile->size();
+			return SharedString(seastar::temporary_buffer<char>(
+				data, size, seastar::make_deleter([mappedFile=std::move(mappedFile)] { })));
+		}
+
+		/**
+		 * Map file to memory and return string points to the mapped memory,
+		 * the mapping is reused if it's already mapped (by any shard) and entity tag matched,
+		 * it will be unmapped after all strings on all shards released.
+		 * Return empty optional if file has write permission or changed after etag was built,
+		 * the caller should read file content instead.
+		 * Notice the mapped memory is read only, don't modify the returned string.
+		 */
+		seastar::future<std::optional<SharedString>> mapFileToMemory(
+			const SharedString& path, std::string_view etag) {
+			std::string pathStr(path.view());
+			std::shared_ptr<MemoryMappedFile> mappedFile;
+			auto& registry = getMemoryMappedFileRegistry();
+			{
+				std::lock_guard<std::mutex> guard(registry.mutex);
+				auto it = registry.files.find(pathStr);
+				if (it != registry.files.end()) {
+					mappedFile = it->second.lock();
+				}
+			}
+			if (mappedFile != nullptr && mappedFile->etag() == etag) {
+				return seastar::make_ready_future<std::optional<SharedString>>(
+					toSharedString(std::move(mappedFile)));
+			}
+			return getBackgroundWorker().submit<std::shared_ptr<MemoryMappedFile>>(
+				[pathForLoad=pathStr] { return MemoryMappedFile::create(pathForLoad); }).then(
+				[pathStr=std::move(pathStr), etag=std::string(etag)]
+				(std::shared_ptr<MemoryMappedFile> mappedFile) mutable {
+				if (mappedFile == nullptr || mappedFile->etag() != etag) {
+					return std::optional<SharedString>();
+				}
+				auto& registry = getMemoryMappedFileRegistry();
+				std::lock_guard<std::mutex> guard(registry.mutex);
+				registry.files.insert_or_assign(std::move(pathStr), mappedFile);
+				if (registry.files.size() >= registry.sweepThreshold) {
+					// remove released mappings, they are kept in map until next sweep
+					for (auto it = registry.files.begin(); it != registry.files.end();) {
+						it = it->second.expired() ? registry.files.erase(it) : std::next(it);
+					}
+					registry.sweepThreshold = std::max<std::size_t>(64, registry.files.size() * 2);
+				}
+				return std::optional<SharedString>(toSharedString(std::move(mappedFile)));
+			});
+		}
+
+		/** Handlers that watching pathBase on this shard, used to receive invalidations */
+		thread_local std::vector<HttpServerRequestStaticFileHandlerData*> WatchingHandlers;
+
+		/** Evict changed files (relative to pathBase) from handlers on all shards */
+		void broadcastFileChanges(
+			const SharedString& pathBase, std::vector<std::string>&& relPaths, bool clearAll);
 	}
 
+	/**
+	 * Watch pathBase recursively by inotify, only created on shard 0 and shared by
+	 * handlers with the same pathBase. The inotify fd is registered to the reactor and
+	 * events are read when it becomes readable, sub directories are listed by seastar
+	 * file api so walking a large tree won't block the reactor.
+	 * Changed paths will be broadcast to handlers on all shards.
+	 */
+	class HttpServerRequestStaticFileWatcher :
+		public std::enable_shared_from_this<HttpServerRequestStaticFileWatcher> {
+	public:
+		/** Get the watcher of pathBase on this shard, create and start it if not exists */
+		static std::shared_ptr<HttpServerRequestStaticFileWatcher> get(const SharedString& pathBase) {
+			static thread_local std::unordered_map<
+				std::string, std::weak_ptr<HttpServerRequestStaticFileWatcher>> watchers;
+			std::string key(pathBase.view());
+			auto it = watchers.find(key);
+			if (it != watchers.end()) {
+				auto watcher = it->second.lock();
+				if (watcher != nullptr) {
+					return watcher;
+				}
+			}
+			auto watcher = std::make_shared<HttpServerRequestStaticFileWatcher>(pathBase);
+			watcher->start();
+			for (auto it = watchers.begin(); it != watchers.end();) {
+				it = it->second.expired() ? watchers.erase(it) : std::next(it);
+			}
+			watchers.insert_or_assign(std::move(key), watcher);
+			return watcher;
+		}
+
+		/** Constructor */
+		explicit HttpServerRequestStaticFileWatcher(const SharedString& pathBase) :
+			pathBase_(pathBase.share()),
+			fd_(createInotifyFd()),
+			directories_() { }
+
+		/** Disallow copy and move */
+		HttpServerRequestStaticFileWatcher(const HttpServerRequestStaticFileWatcher&) = delete;
+		HttpServerRequestStaticFileWatcher& operator=(const HttpServerRequestStaticFileWatcher&) = delete;
+
+	private:
+		/** Create non blocking inotify fd and register it to reactor */
+		static seastar::pollable_fd createInotifyFd() {
+			int fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (CPV_UNLIKELY(fd < 0)) {
+				throw FileSystemException(CPV_CODEINFO,
+					"create inotify instance failed:", std::strerror(errno));
+			}
+			return seastar::pollable_fd(seastar::file_desc::from_fd(fd));
+		}
+
+		/**
+		 * Watch pathBase and start reading events, sub directories are watched in background.
+		 * The background tasks only keep weak reference, they stop after the watcher destroyed
+		 * (the pending readable future is broken when the pollable fd is closed).
+		 */
+		void start() {
+			if (CPV_UNLIKELY(!addWatch(""))) {
+				throw FileSystemException(CPV_CODEINFO,
+					"watch directory", pathBase_, "failed:", std::strerror(errno));
+			}
+			std::weak_ptr<HttpServerRequestStaticFileWatcher> self = weak_from_this();
+			static_cast<void>(watchSubDirectories(self, ""));
+			static_cast<void>(seastar::repeat([self] {
+				auto watcher = self.lock();
+				if (watcher == nullptr) {
+					return seastar::make_ready_future<seastar::stop_iteration>(
+						seastar::stop_iteration::yes);
+				}
+				return watcher->fd_.readable().then([self] {
+					auto watcher = self.lock();
+					if (watcher == nullptr) {
+						return seastar::stop_iteration::yes;
+					}
+					watcher->poll();
+					return seastar::stop_iteration::no;
+				});
+			}).handle_exception([] (std::exception_ptr) { }));
+		}
+
+		/** Watch directory (not recursive), relDir should be empty or ends with '/' */
+		bool addWatch(const std::string& relDir) {
+			std::string path(pathBase_.view());
+			path.append(relDir);
+			// IN_ONLYDIR makes it fail for entries that turned out to be not directory
+			int wd = ::inotify_add_watch(
+				fd_.get_file_desc().get(), path.c_str(), WatchEventMask | IN_ONLYDIR);
+			if (wd < 0) {
+				return false;
+			}
+			directories_[wd] = relDir;
+			return true;
+		}
+
+		/** Watch sub directories of relDir recursively, errors are ignored (directory may removed) */
+		static seastar::future<> watchSubDirectories(
+			std::weak_ptr<HttpServerRequestStaticFileWatcher> self, std::string relDir) {
+			auto watcher = self.lock();
+			if (watcher == nullptr) {
+				return seastar::make_ready_future<>();
+			}
+			std::string path(watcher->pathBase_.view());
+			path.append(relDir);
+			return seastar::open_directory(seastar::sstring(path.data(), path.size()))
+			.then([self=std::move(self), relDir=std::move(relDir)] (seastar::file dir) mutable {
+				return seastar::do_with(
+					std::move(dir), std::move(self), std::move(relDir), std::vector<std::string>(),
+					[] (auto& dir, auto& self, auto& relDir, auto& subDirs) {
+					return seastar::do_with(dir.list_directory(
+						[&relDir, &subDirs] (seastar::directory_entry entry) {
+						// type is unknown on some file systems, addWatch will filter them
+						if (!entry.type || *entry.type == seastar::directory_entry_type::directory) {
+							subDirs.emplace_back(relDir);
+							subDirs.back().append(entry.name.data(), entry.name.size()).append("/");
+						}
+						return seastar::make_ready_future<>();
+					}), [] (auto& listing) {
+						return listing.done();
+					}).then([&self, &subDirs] {
+						return seastar::do_for_each(subDirs, [&self] (const std::string& subDir) {
+							auto watcher = self.lock();
+							if (watcher == nullptr || !watcher->addWatch(subDir)) {
+								return seastar::make_ready_future<>();
+							}
+							return watchSubDirectories(self, subDir);
+						});
+					}).finally([&dir] {
+						return dir.close();
+					});
+				});
+			}).handle_exception([] (std::exception_ptr) { });
+		}
+
+		/** Read pending events and broadcast changed paths */
+		void poll() {
+			alignas(struct ::inotify_event) std::array<char, 4096> buf;
+			std::vector<std::string> relPaths;
+			bool clearAll = false;
+			for (;;) {
+				::ssize_t size = ::read(fd_.get_file_desc().get(), buf.data(), buf.size());
+				if (size <= 0) {
+					break; // EAGAIN, no more events
+				}
+				for (char* ptr = buf.data(); ptr < buf.data() + size; ) {
+					auto* event = reinterpret_cast<struct ::inotify_event*>(ptr);
+					ptr += sizeof(struct ::inotify_event) + event->len;
+					if (event->mask & IN_Q_OVERFLOW) {
+						clearAll = true; // events lost
+						continue;
+					}
+					auto it = directories_.find(event->wd);
+					if (it == directories_.end()) {
+						continue;
+					}
+					if (event->mask & IN_IGNORED) {
+						directories_.erase(it);
+						continue;
+					}
+					if (event->len == 0) {
+						continue;
+					}
+					std::string relPath = it->second + event->name;
+					if (event->mask & IN_ISDIR) {
+						// directory changed, files under it are unknown so clear all
+						if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+							relPath.append("/");
+							if (addWatch(relPath)) {
+								static_cast<void>(watchSubDirectories(weak_from_this(), relPath));
+							}
+						}
+						clearAll = true;
+						continue;
+					}
+					relPaths.emplace_back(std::move(relPath));
+				}
+			}
+			if (clearAll || !relPaths.empty()) {
+				std::sort(relPaths.begin(), relPaths.end());
+				relPaths.erase(std::unique(relPaths.begin(), relPaths.end()), relPaths.end());
+				broadcastFileChanges(pathBase_, std::move(relPaths), clearAll);
+			}
+		}
+
+	private:
+		SharedString pathBase_;
+		seastar::pollable_fd fd_;
+		std::unordered_map<int, std::string> directories_;
+	};
+
 	/** Members of HttpServerRequestStaticFileHandler */
 	class HttpServerRequestStaticFileHandlerData {
 	public:
-		/** File content and modified time */
+		/** File content, modified time and entity tag */
 		struct FileCacheEntry {
 			SharedString content;
 			SharedString lastModified;
-			bool noCompressedVersion;
+			SharedString etag;
+			// bit mask of pre-compressed variants known to be not exists (for original file)
+			std::uint8_t missingVariants;
+			// on-the-fly compressed content and it's entity tag, empty if not compressible
+			SharedString compressedContent;
+			SharedString compressedETag;
+			bool compressionTried;
 
 			/** Constructor */
 			FileCacheEntry(
 				SharedString&& contentVal,
 				SharedString&& lastModifiedVal,
-				bool noCompressedVersionVal) :
+				SharedString&& etagVal,
+				std::uint8_t missingVariantsVal) :
 				content(std::move(contentVal)),
 				lastModified(std::move(lastModifiedVal)),
-				noCompressedVersion(noCompressedVersionVal) { }
+				etag(std::move(etagVal)),
+				missingVariants(missingVariantsVal),
+				compressedContent(),
+				compressedETag(),
+				compressionTried(false) { }
+
+			/** Get a copy of this entry, strings are shared */
+			FileCacheEntry share() const {
+				FileCacheEntry entry(content.share(), lastModified.share(), etag.share(), missingVariants);
+				entry.compressedContent = compressedContent.share();
+				entry.compressedETag = compressedETag.share();
+				entry.compressionTried = compressionTried;
+				return entry;
+			}
 
 			/** Reply to http response with 304 or 200 */
 			seastar::future<> reply(
 				HttpResponse& response,
 				SharedString&& mimeType,
 				SharedString&& ifModifiedSinceHeader,
+				std::string_view ifNoneMatchHeader,
 				const SharedString& cacheControl,
-				bool isCompressed) {
+				std::size_t variant,
+				const ByteRanges& rangeSpecs,
+				std::string_view ifRangeHeader,
+				bool useCompressedContent) {
+				const SharedString& replyETag = useCompressedContent ? compressedETag : etag;
+				const SharedString& replyContentStr = useCompressedContent ? compressedContent : content;
 				// set Cache-Control if present
 				auto& headers = response.getHeaders();
 				if (!cacheControl.empty()) {
 					headers.setCacheControl(cacheControl.share());
 				}
+				// response may differ by Accept-Encoding because of pre-compressed variants
+				headers.setVary(constants::AcceptEncoding);
 				// set X-Cache to indicates cache hitted
 				headers.setHeader(XCacheHeader, XCacheHitValue);
+				headers.setETag(replyETag.share());
 				// check if we can return 304 not modified
-				if (ifModifiedSinceHeader == lastModified) {
+				if (isNotModified(ifNoneMatchHeader, ifModifiedSinceHeader, replyETag, lastModified)) {
 					response.setStatusCode(constants::_304);
 					response.setStatusMessage(constants::NotModified);
 					headers.setContentType(std::move(mimeType));
-					headers.setLastModified(std::move(ifModifiedSinceHeader));
+					headers.setLastModified(lastModified.share());
 					return seastar::make_ready_future<>();
 				}
-				// set Content-Encoding if compressed file is used
-				if (isCompressed) {
-					headers.setContentEncoding(CompressEncoding);
+				// set Content-Encoding if pre-compressed variant or compressed content is used
+				if (variant != NoVariant) {
+					headers.setContentEncoding(
+						SharedString::fromStatic(CompressedVariants[variant].encoding));
 				}
-				// return cached file content
+				// return cached file content, or ranges of it if If-Range matched
 				headers.setLastModified(lastModified.share());
-				return extensions::reply(response, content.share(), std::move(mimeType));
+				ByteRanges ranges;
+				if (!rangeSpecs.empty() && isIfRangeMatched(ifRangeHeader, replyETag, lastModified)) {
+					resolveRanges(rangeSpecs, replyContentStr.size(), ranges);
+				}
+				return replyContent(response, replyContentStr.share(), std::move(mimeType), ranges);
 			}
 		};
 
+		/** File metadata, exists is false for negative entry (file not exists or is directory) */
+		struct FileMetadataEntry {
+			seastar::lowres_clock::time_point expireTime;
+			std::size_t size;
+			std::time_t lastModifiedTime;
+			SharedString etag;
+			bool exists;
+		};
+
 		SharedString urlBase;
 		SharedString pathBase;
 		SharedString cacheControl;
 		std::size_t maxCacheFileSize;
 		LRUCache<SharedString, FileCacheEntry> fileCache;
+		seastar::lowres_clock::duration fileMetadataCacheTime;
+		LRUCache<SharedString, FileMetadataEntry> fileMetadataCache;
+		bool watchPathBase;
+		bool useMemoryMappedFiles;
+		int compressionLevel;
+		std::shared_ptr<HttpServerRequestStaticFileWatcher> watcher;
+
+		/** Get cached metadata of file, return nullptr if not cached or expired */
+		const FileMetadataEntry* getFileMetadata(std::string_view path) {
+			if (fileMetadataCache.maxSize() == 0) {
+				return nullptr;
+			}
+			const FileMetadataEntry* entry = fileMetadataCache.get(path);
+			if (entry == nullptr || entry->expireTime <= seastar::lowres_clock::now()) {
+				return nullptr;
+			}
+			return entry;
+		}
+
+		/** Evict cached content and metadata of changed file (relative to pathBase) */
+		void evictFile(std::string_view relPath) {
+			std::string path(pathBase.view());
+			path.append(relPath);
+			fileCache.erase(std::string_view(path));
+			fileMetadataCache.erase(std::string_view(path));
+			for (const auto& variant : CompressedVariants) {
+				if (endsWith(path, variant.suffix)) {
+					// the missing variants of original file may changed
+					path.resize(path.size() - std::strlen(variant.suffix));
+					fileCache.erase(std::string_view(path));
+					break;
+				}
+			}
+		}
+
+		/**
+		 * Compress cached content of original file in background thread (only try once),
+		 * return compressed content, or empty string if it's not compressible.
+		 * Requests arrive while compressing will get the original content.
+		 */
+		seastar::future<SharedString> compressFileCache(const SharedString& path, FileCacheEntry& entry) {
+			if (entry.compressionTried) {
+				return seastar::make_ready_future<SharedString>(entry.compressedContent.share());
+			}
+			entry.compressionTried = true;
+			return getBackgroundWorker().submit<std::string>(
+				[content=entry.content.view(), level=compressionLevel] {
+				return compressGzip(content, level);
+			}).then([this, path=path.share(), content=entry.content.share(), etag=entry.etag.share()]
+				(std::string compressed) {
+				// content is captured to keep it alive while compressing
+				static_cast<void>(content);
+				if (compressed.empty()) {
+					return SharedString();
+				}
+				auto holder = std::make_unique<std::string>(std::move(compressed));
+				char* data = holder->data();
+				std::size_t size = holder->size();
+				SharedString compressedContent(seastar::temporary_buffer<char>(
+					data, size, seastar::make_object_deleter(std::move(holder))));
+				// entry may evicted or replaced while compressing
+				auto* entry = fileCache.get(path.view());
+				if (entry != nullptr && entry->etag == etag) {
+					entry->compressedContent = compressedContent.share();
+					entry->compressedETag = buildCompressedETag(etag);
+				}
+				return compressedContent;
+			});
+		}
+
+		/** Clear cached file contents and metadata */
+		void clearCache() {
+			fileCache.clear();
+			fileMetadataCache.clear();
+		}
+
+		/** Store metadata of file to cache */
+		void setFileMetadata(
+			const SharedString& path,
+			bool exists,
+			std::size_t size,
+			std::time_t lastModifiedTime,
+			SharedString&& etag) {
+			if (fileMetadataCache.maxSize() == 0) {
+				return;
+			}
+			fileMetadataCache.set(path.share(), path.share(), FileMetadataEntry{
+				seastar::lowres_clock::now() + fileMetadataCacheTime,
+				size, lastModifiedTime, std::move(etag), exists });
+		}
 
 		/** Constructor */
 		HttpServerRequestStaticFileHandlerData(
@@ -94,38 +1001,98 @@ namespace cpv {
 			SharedString&& pathBaseVal,
 			SharedString&& cacheControlVal,
 			std::size_t maxCacheFileEntitiesVal,
-			std::size_t maxCacheFileSizeVal) :
+			std::size_t maxCacheFileSizeVal,
+			std::size_t maxCacheFileMetadataEntitiesVal,
+			std::chrono::milliseconds fileMetadataCacheTimeVal,
+			bool watchPathBaseVal,
+			bool useMemoryMappedFilesVal,
+			int compressionLevelVal) :
 			urlBase(std::move(urlBaseVal)),
 			pathBase(std::move(pathBaseVal)),
 			cacheControl(std::move(cacheControlVal)),
 			maxCacheFileSize(maxCacheFileSizeVal),
-			fileCache(maxCacheFileEntitiesVal) {
+			fileCache(maxCacheFileEntitiesVal),
+			fileMetadataCacheTime(std::chrono::duration_cast<
+				seastar::lowres_clock::duration>(fileMetadataCacheTimeVal)),
+			fileMetadataCache(fileMetadataCacheTimeVal.count() > 0 ?
+				maxCacheFileMetadataEntitiesVal : 0),
+			watchPathBase(watchPathBaseVal),
+			useMemoryMappedFiles(useMemoryMappedFilesVal),
+			compressionLevel(compressionLevelVal),
+			watcher() {
 			if (!endsWith(urlBase, "/")) {
 				urlBase = SharedStringBuilder().append(urlBase).append("/").build();
 			}
 			if (!endsWith(pathBase, "/")) {
 				pathBase = SharedStringBuilder().append(pathBase).append("/").build();
 			}
+			if (watchPathBase) {
+				if (seastar::engine().cpu_id() == 0) {
+					watcher = HttpServerRequestStaticFileWatcher::get(pathBase);
+				}
+				WatchingHandlers.emplace_back(this);
+			}
+		}
+
+		/** Disallow copy and move (address is registered to WatchingHandlers) */
+		HttpServerRequestStaticFileHandlerData(const HttpServerRequestStaticFileHandlerData&) = delete;
+		HttpServerRequestStaticFileHandlerData& operator=(
+			const HttpServerRequestStaticFileHandlerData&) = delete;
+
+		/** Destructor */
+		~HttpServerRequestStaticFileHandlerData() {
+			if (watchPathBase) {
+				WatchingHandlers.erase(std::remove(
+					WatchingHandlers.begin(), WatchingHandlers.end(), this),
+					WatchingHandlers.end());
+			}
 		}
 	};
 
+	namespace {
+		/** Evict changed files (relative to pathBase) from handlers on all shards */
+		void broadcastFileChanges(
+			const SharedString& pathBase, std::vector<std::string>&& relPaths, bool clearAll) {
+			// the invalidation is best effort, ignore errors like shutting down
+			auto pathBaseCopy = std::string(pathBase.view());
+			static_cast<void>(seastar::smp::invoke_on_all(
+				[pathBase=std::move(pathBaseCopy), relPaths=std::move(relPaths), clearAll] {
+				for (auto* data : WatchingHandlers) {
+					if (data->pathBase != pathBase) {
+						continue;
+					} else if (clearAll) {
+						data->clearCache();
+					} else {
+						for (auto& relPath : relPaths) {
+							data->evictFile(relPath);
+						}
+					}
+				}
+			}).handle_exception([] (std::exception_ptr) { }));
+		}
+	}
+
 	/** Class for reply content of static file, allocate in once */
 	class HttpServerRequestStaticFileReplier {
 	public:
 		/** Execute reply operation */
 		seastar::future<> execute() {
+			// use cached metadata if present, it avoids file system calls for common cases
 			auto& path = getPath();
+			auto* metadata = data_.getFileMetadata(path);
+			if (metadata != nullptr) {
+				if (!metadata->exists) {
+					return replyFileNotExists();
+				}
+				return replyFileExists(
+					metadata->size, metadata->lastModifiedTime, metadata->etag.share(), false);
+			}
 			return seastar::engine().file_type(seastar::sstring(path.data(), path.size()))
 			.then([this] (auto type) {
 				if (!type || *type == seastar::directory_entry_type::directory) {
 					// file not exists or is directory
-					if (supportCompress_) {
-						supportCompress_ = false;
-						noCompressedVersion_ = true;
-						return execute();
-					} else {
-						return (*next_)->handle(context_, next_ + 1);
-					}
+					data_.setFileMetadata(getPath(), false, 0, 0, SharedString());
+					return replyFileNotExists();
 				}
 				auto& path = getPath();
 				return seastar::open_file_dma(
@@ -134,93 +1101,10 @@ namespace cpv {
 					file_ = std::move(f);
 					return file_.stat();
 				}).then([this] (struct ::stat st) {
-					// set Cache-Control if present
-					auto& response = context_.getResponse();
-					auto& headers = response.getHeaders();
-					if (!data_.cacheControl.empty()) {
-						headers.setCacheControl(data_.cacheControl.share());
-					}
-					// check if we can return 304 not modified
-					std::string_view lastModifiedStr = formatTimeForHttpHeader(st.st_mtime);
-					if (ifModifiedSinceHeader_ == lastModifiedStr) {
-						response.setStatusCode(constants::_304);
-						response.setStatusMessage(constants::NotModified);
-						headers.setContentType(std::move(mimeType_));
-						headers.setLastModified(std::move(ifModifiedSinceHeader_));
-						return seastar::make_ready_future<>();
-					}
-					// allocate string for Last-Modified header
-					SharedString lastModified(lastModifiedStr);
-					// set Content-Encoding if compressed file is used
-					if (supportCompress_) {
-						headers.setContentEncoding(CompressEncoding);
-					}
-					// read whole file from disk and store to cache if appropriate
-					fileStream_ = seastar::make_file_input_stream(std::move(file_));
 					std::size_t fileSize = static_cast<std::size_t>(st.st_size);
-					if (fileSize <= data_.maxCacheFileSize &&
-						data_.fileCache.maxSize() > 0 && !range_.has_value()) {
-						return fileStream_.read_exactly(fileSize).then(
-							[this, lastModified=std::move(lastModified)] (auto buf) mutable {
-							// store file content to cache
-							data_.fileCache.set(
-								getPath().share(), getPath().share(),
-								{ buf.share(), lastModified.share(), noCompressedVersion_ });
-							// set Last-Modified header
-							auto& response = context_.getResponse();
-							auto& headers = response.getHeaders();
-							headers.setLastModified(std::move(lastModified));
-							return extensions::reply(response,
-								std::move(buf), std::move(mimeType_));
-						});
-					}
-					// calculate actual range and add headers
-					seastar::future<> seekFuture = seastar::make_ready_future<>();
-					if (range_.has_value() &&
-						range_->first < fileSize && range_->first <= range_->second) {
-						// return partial content, notice to is inclusive: [form, to]
-						// Content-Range example: bytes 200-1000/67589
-						std::size_t from = range_->first;
-						std::size_t to = range_->second;
-						to = std::min(to, fileSize - 1);
-						remainSize_ = to - from + 1;
-						seekFuture = fileStream_.skip(from);
-						response.setStatusCode(constants::_206);
-						response.setStatusMessage(constants::PartialContent);
-						headers.setHeader(constants::ContentRange,
-							SharedStringBuilder(32).append(ContentRangePrefix)
-								.append(from).append(constants::Hyphen)
-								.append(to).append(constants::Slash)
-								.append(fileSize).build());
-					} else {
-						// return full content
-						remainSize_ = fileSize;
-						response.setStatusCode(constants::_200);
-						response.setStatusMessage(constants::OK);
-						headers.setLastModified(std::move(lastModified));
-					}
-					headers.setContentType(std::move(mimeType_));
-					headers.setContentLength(SharedString::fromInt(remainSize_));
-					return seekFuture.then([this] {
-						// read and reply file content by chunks
-						return seastar::repeat([this] {
-							std::size_t readSize = std::min(remainSize_, ReadFileChunkSize);
-							return fileStream_.read_up_to(readSize).then([this] (auto buf) {
-								if (buf.size() == 0) {
-									return seastar::make_exception_future<>(FileSystemException(
-										CPV_CODEINFO, "remain size > 0 but eof occurs"));
-								}
-								SharedString str(std::move(buf));
-								remainSize_ -= str.size();
-								return extensions::writeAll(
-									context_.getResponse().getBodyStream(), std::move(str));
-							}).then([this] {
-								return remainSize_ == 0 ?
-									seastar::stop_iteration::yes :
-									seastar::stop_iteration::no;
-							});
-						});
-					});
+					SharedString etag = buildETag(st);
+					data_.setFileMetadata(getPath(), true, fileSize, st.st_mtime, etag.share());
+					return replyFileExists(fileSize, st.st_mtime, std::move(etag), true);
 				});
 			});
 		}
@@ -228,78 +1112,333 @@ namespace cpv {
 		/** Constructor */
 		HttpServerRequestStaticFileReplier(
 			SharedString&& filePath,
-			SharedString&& compressedPath,
-			bool supportCompress,
-			SharedString&& rangeHeader,
+			const CompressedVariantCandidates& candidates,
+			std::uint8_t missingVariants,
+			bool compressOnTheFly,
+			ByteRanges&& rangeSpecs,
+			SharedString&& ifRangeHeader,
 			SharedString&& mimeType,
 			SharedString&& ifModifiedSinceHeader,
+			SharedString&& ifNoneMatchHeader,
 			HttpServerRequestStaticFileHandlerData& data,
 			HttpContext& context,
 			HttpServerRequestHandlerIterator next) :
 			filePath_(std::move(filePath)),
-			compressedPath_(std::move(compressedPath)),
-			supportCompress_(supportCompress),
-			noCompressedVersion_(false),
-			rangeHeader_(std::move(rangeHeader)),
-			range_(parseRangeHeader()),
+			variantPath_(),
+			candidates_(candidates),
+			nextCandidate_(0),
+			variant_(NoVariant),
+			missingVariants_(missingVariants),
+			compressOnTheFly_(compressOnTheFly),
+			etag_(),
+			rangeSpecs_(std::move(rangeSpecs)),
+			ifRangeHeader_(std::move(ifRangeHeader)),
+			ranges_(),
+			partHeaders_(),
 			mimeType_(std::move(mimeType)),
 			ifModifiedSinceHeader_(std::move(ifModifiedSinceHeader)),
+			ifNoneMatchHeader_(std::move(ifNoneMatchHeader)),
 			data_(data),
 			context_(context),
 			next_(next),
 			file_(),
 			fileStream_(),
-			remainSize_(0) { }
+			position_(0),
+			remainSize_(0) {
+			selectNextVariant();
+		}
 
 	private:
-		/** Get file path for execute */
-		const SharedString& getPath() const {
-			return supportCompress_ ? compressedPath_ : filePath_;
+		/** Select next pre-compressed variant accepted by client, or the original file */
+		void selectNextVariant() {
+			if (nextCandidate_ < candidates_.count) {
+				variant_ = candidates_.variants[nextCandidate_++];
+				const char* suffix = CompressedVariants[variant_].suffix;
+				variantPath_ = SharedStringBuilder(filePath_.size() + std::strlen(suffix))
+					.append(filePath_).append(suffix).build();
+			} else {
+				variant_ = NoVariant;
+			}
 		}
 
-		/** Parse "Range: bytes=from-to" or "Range: bytes=from-" */
-		std::optional<std::pair<std::size_t, std::size_t>> parseRangeHeader() const {
-			if (!startsWith(rangeHeader_, RangePrefix)) {
-				return std::nullopt;
+		/** Try next variant or pass to next handler */
+		seastar::future<> replyFileNotExists() {
+			if (variant_ != NoVariant) {
+				missingVariants_ |= static_cast<std::uint8_t>(1U << variant_);
+				selectNextVariant();
+				return execute();
+			} else {
+				return (*next_)->handle(context_, next_ + 1);
+			}
+		}
+
+		/** Reply 304 or file content, open file if it's not opened */
+		seastar::future<> replyFileExists(
+			std::size_t fileSize, std::time_t lastModifiedTime, SharedString&& etag, bool fileOpened) {
+			// set Cache-Control if present
+			auto& response = context_.getResponse();
+			auto& headers = response.getHeaders();
+			if (!data_.cacheControl.empty()) {
+				headers.setCacheControl(data_.cacheControl.share());
+			}
+			// response may differ by Accept-Encoding because of pre-compressed variants
+			headers.setVary(constants::AcceptEncoding);
+			// original file will be compressed on-the-fly if it's cacheable,
+			// compressed content has it's own entity tag, it's unknown whether the content
+			// is compressible before it's read, so check If-None-Match after compression
+			etag_ = std::move(etag);
+			compressOnTheFly_ = (compressOnTheFly_ &&
+				variant_ == NoVariant && fileSize <= data_.maxCacheFileSize);
+			headers.setETag(etag_.share());
+			// check if we can return 304 not modified
+			std::string_view lastModifiedStr = formatTimeForHttpHeader(lastModifiedTime);
+			if ((!compressOnTheFly_ || ifNoneMatchHeader_.empty()) &&
+				isNotModified(ifNoneMatchHeader_, ifModifiedSinceHeader_, etag_, lastModifiedStr)) {
+				response.setStatusCode(constants::_304);
+				response.setStatusMessage(constants::NotModified);
+				headers.setContentType(std::move(mimeType_));
+				headers.setLastModified(SharedString(lastModifiedStr));
+				return seastar::make_ready_future<>();
+			}
+			// allocate string for Last-Modified header
+			SharedString lastModified(lastModifiedStr);
+			if (fileOpened) {
+				return replyFileContent(fileSize, std::move(lastModified));
+			}
+			// open file from cached metadata, the file may removed after metadata cached,
+			// in this case remove cached metadata and query file system again
+			auto& path = getPath();
+			return seastar::open_file_dma(
+				seastar::sstring(path.data(), path.size()), seastar::open_flags::ro)
+			.then_wrapped([this, fileSize, lastModified=std::move(lastModified)]
+				(seastar::future<seastar::file> f) mutable {
+				if (CPV_UNLIKELY(f.failed())) {
+					f.ignore_ready_future();
+					data_.fileMetadataCache.erase(getPath().view());
+					return execute();
+				}
+				file_ = f.get0();
+				return replyFileContent(fileSize, std::move(lastModified));
+			});
+		}
+
+		/** Read whole file from disk, store it to cache and reply from the content */
+		seastar::future<> readFileToCache(std::size_t fileSize) {
+			fileStream_ = seastar::make_file_input_stream(std::move(file_));
+			return fileStream_.read_exactly(fileSize).then([this] (auto buf) {
+				SharedString content(std::move(buf));
+				storeFileCache(content);
+				return replyCachedContent(std::move(content));
+			});
+		}
+
+		/** Reply content of opened file */
+		seastar::future<> replyFileContent(std::size_t fileSize, SharedString&& lastModified) {
+			auto& response = context_.getResponse();
+			auto& headers = response.getHeaders();
+			// set Content-Encoding if pre-compressed variant is used
+			if (variant_ != NoVariant) {
+				headers.setContentEncoding(
+					SharedString::fromStatic(CompressedVariants[variant_].encoding));
+			}
+			// resolve ranges if If-Range matched
+			if (!rangeSpecs_.empty() &&
+				isIfRangeMatched(ifRangeHeader_, headers.getETag(), lastModified)) {
+				resolveRanges(rangeSpecs_, fileSize, ranges_);
+			}
+			headers.setLastModified(std::move(lastModified));
+			// read whole file from disk and store to cache if appropriate,
+			// ranges will be replied from the content like cache hit
+			if (fileSize <= data_.maxCacheFileSize && data_.fileCache.maxSize() > 0) {
+				if (data_.useMemoryMappedFiles) {
+					// map file to memory instead of copying, the mapping is shared by all shards,
+					// read file if it's not mappable (writable or changed after stat)
+					return mapFileToMemory(getPath(), etag_).then(
+						[this, fileSize] (std::optional<SharedString> content) {
+						if (!content.has_value()) {
+							return readFileToCache(fileSize);
+						}
+						storeFileCache(*content);
+						return replyCachedContent(std::move(*content));
+					});
+				}
+				return readFileToCache(fileSize);
 			}
-			std::string_view rangeStr = rangeHeader_.view().substr(sizeof(RangePrefix) - 1);
-			if (rangeStr.find_first_of(',') != rangeStr.npos) {
-				// multiple range is unsupported for now
-				return std::nullopt;
+			// reply multiple ranges by reading file at offsets
+			if (ranges_.size() > 1) {
+				return replyFileRanges(fileSize);
 			}
-			std::size_t pos = rangeStr.find_first_of('-');
-			if (pos == rangeStr.npos) {
-				return std::nullopt;
+			// calculate actual range and add headers
+			fileStream_ = seastar::make_file_input_stream(std::move(file_));
+			seastar::future<> seekFuture = seastar::make_ready_future<>();
+			if (!ranges_.empty()) {
+				// return partial content
+				auto [from, to] = ranges_.front();
+				remainSize_ = to - from + 1;
+				seekFuture = fileStream_.skip(from);
+				response.setStatusCode(constants::_206);
+				response.setStatusMessage(constants::PartialContent);
+				headers.setHeader(constants::ContentRange, buildContentRange(from, to, fileSize));
+			} else {
+				// return full content
+				remainSize_ = fileSize;
+				response.setStatusCode(constants::_200);
+				response.setStatusMessage(constants::OK);
 			}
-			std::size_t from = 0;
-			std::size_t to = 0;
-			if (!loadIntFromDec(rangeStr.data(), pos, from)) {
-				return std::nullopt;
+			headers.setContentType(std::move(mimeType_));
+			headers.setContentLength(SharedString::fromInt(remainSize_));
+			return seekFuture.then([this] {
+				// read and reply file content by chunks
+				return seastar::repeat([this] {
+					std::size_t readSize = std::min(remainSize_, ReadFileChunkSize);
+					return fileStream_.read_up_to(readSize).then([this] (auto buf) {
+						if (buf.size() == 0) {
+							return seastar::make_exception_future<>(FileSystemException(
+								CPV_CODEINFO, "remain size > 0 but eof occurs"));
+						}
+						SharedString str(std::move(buf));
+						remainSize_ -= str.size();
+						return extensions::writeAll(
+							context_.getResponse().getBodyStream(), std::move(str));
+					}).then([this] {
+						return remainSize_ == 0 ?
+							seastar::stop_iteration::yes :
+							seastar::stop_iteration::no;
+					});
+				});
+			});
+		}
+
+		/**
+		 * Store file content to cache, keep known missing variants of original file,
+		 * and keep compressed content if file not changed.
+		 */
+		void storeFileCache(const SharedString& content) {
+			auto& headers = context_.getResponse().getHeaders();
+			HttpServerRequestStaticFileHandlerData::FileCacheEntry entry(
+				content.share(), headers.getLastModified().share(), etag_.share(), missingVariants_);
+			auto* previousEntry = data_.fileCache.get(getPath().view());
+			if (previousEntry != nullptr) {
+				entry.missingVariants |= previousEntry->missingVariants;
+				if (previousEntry->etag == etag_) {
+					entry.compressedContent = std::move(previousEntry->compressedContent);
+					entry.compressedETag = std::move(previousEntry->compressedETag);
+					entry.compressionTried = previousEntry->compressionTried;
+				}
 			}
-			std::string_view lastStr = rangeStr.substr(pos + 1);
-			if (lastStr.empty()) {
-				return std::make_pair(from, std::numeric_limits<std::size_t>::max());
+			data_.fileCache.set(getPath().share(), getPath().share(), std::move(entry));
+		}
+
+		/** Reply content just stored to cache, compress it on-the-fly if appropriate */
+		seastar::future<> replyCachedContent(SharedString&& content) {
+			auto& response = context_.getResponse();
+			auto* entry = compressOnTheFly_ ? data_.fileCache.get(getPath().view()) : nullptr;
+			if (entry == nullptr) {
+				return replyContent(response, std::move(content), std::move(mimeType_), ranges_);
 			}
-			if (!loadIntFromDec(lastStr.data(), lastStr.size(), to)) {
-				return std::nullopt;
+			return data_.compressFileCache(getPath(), *entry).then(
+				[this, content=std::move(content)] (SharedString compressed) mutable {
+				auto& response = context_.getResponse();
+				auto& headers = response.getHeaders();
+				// use entity tag of original file if it's not compressible
+				bool useCompressedContent = !compressed.empty();
+				if (useCompressedContent) {
+					headers.setETag(buildCompressedETag(etag_));
+				}
+				// If-None-Match is not checked before compression
+				if (isNotModified(ifNoneMatchHeader_, ifModifiedSinceHeader_,
+					headers.getETag(), headers.getLastModified())) {
+					response.setStatusCode(constants::_304);
+					response.setStatusMessage(constants::NotModified);
+					headers.setContentType(std::move(mimeType_));
+					return seastar::make_ready_future<>();
+				}
+				if (useCompressedContent) {
+					headers.setContentEncoding(
+						SharedString::fromStatic(CompressedVariants[GzipVariant].encoding));
+					return replyContent(response, std::move(compressed), std::move(mimeType_), ranges_);
+				}
+				return replyContent(response, std::move(content), std::move(mimeType_), ranges_);
+			});
+		}
+
+		/** Reply multiple ranges of opened file as multipart/byteranges by chunks */
+		seastar::future<> replyFileRanges(std::size_t fileSize) {
+			// build headers of parts first to calculate content length
+			auto& response = context_.getResponse();
+			auto& headers = response.getHeaders();
+			std::size_t contentLength = sizeof(MultipartEnd) - 1;
+			partHeaders_.reserve(ranges_.size());
+			for (auto [from, to] : ranges_) {
+				partHeaders_.emplace_back(buildMultipartPartHeader(mimeType_, from, to, fileSize));
+				contentLength += partHeaders_.back().size() + (to - from + 1);
 			}
-			return std::make_pair(from, to);
+			response.setStatusCode(constants::_206);
+			response.setStatusMessage(constants::PartialContent);
+			headers.setContentType(MultipartContentType);
+			headers.setContentLength(SharedString::fromInt(contentLength));
+			return seastar::do_for_each(
+				boost::counting_iterator<std::size_t>(0),
+				boost::counting_iterator<std::size_t>(ranges_.size()),
+				[this] (std::size_t index) {
+				auto [from, to] = ranges_[index];
+				position_ = from;
+				remainSize_ = to - from + 1;
+				return extensions::writeAll(context_.getResponse().getBodyStream(),
+					partHeaders_[index].share()).then([this] {
+					// read and reply range content by chunks
+					return seastar::repeat([this] {
+						std::size_t readSize = std::min(remainSize_, ReadFileChunkSize);
+						return file_.dma_read<char>(position_, readSize).then([this] (auto buf) {
+							if (buf.size() == 0) {
+								return seastar::make_exception_future<>(FileSystemException(
+									CPV_CODEINFO, "remain size > 0 but eof occurs"));
+							}
+							SharedString str(std::move(buf));
+							position_ += str.size();
+							remainSize_ -= str.size();
+							return extensions::writeAll(
+								context_.getResponse().getBodyStream(), std::move(str));
+						}).then([this] {
+							return remainSize_ == 0 ?
+								seastar::stop_iteration::yes :
+								seastar::stop_iteration::no;
+						});
+					});
+				});
+			}).then([this] {
+				return extensions::writeAll(context_.getResponse().getBodyStream(),
+					SharedString::fromStatic(MultipartEnd));
+			});
+		}
+
+		/** Get file path for execute */
+		const SharedString& getPath() const {
+			return variant_ != NoVariant ? variantPath_ : filePath_;
 		}
 
 	private:
 		SharedString filePath_;
-		SharedString compressedPath_;
-		bool supportCompress_;
-		bool noCompressedVersion_;
-		SharedString rangeHeader_;
-		std::optional<std::pair<std::size_t, std::size_t>> range_;
+		SharedString variantPath_;
+		CompressedVariantCandidates candidates_;
+		std::size_t nextCandidate_;
+		std::size_t variant_;
+		std::uint8_t missingVariants_;
+		bool compressOnTheFly_;
+		SharedString etag_;
+		ByteRanges rangeSpecs_;
+		SharedString ifRangeHeader_;
+		ByteRanges ranges_;
+		std::vector<SharedString> partHeaders_;
 		SharedString mimeType_;
 		SharedString ifModifiedSinceHeader_;
+		SharedString ifNoneMatchHeader_;
 		HttpServerRequestStaticFileHandlerData& data_;
 		HttpContext& context_;
 		HttpServerRequestHandlerIterator next_;
 		seastar::file file_;
 		seastar::input_stream<char> fileStream_;
+		std::size_t position_;
 		std::size_t remainSize_;
 	};
 
@@ -324,57 +1463,111 @@ namespace cpv {
 		if (CPV_UNLIKELY(!isSafePath(relPath))) {
 			return (*next)->handle(context, next + 1);
 		}
-		// generate file path (and detect is compression supported)
+		// generate file path
 		thread_local static SharedStringBuilder pathBuilder;
 		pathBuilder.clear();
-		pathBuilder.append(data_->pathBase).append(relPath).append(CompressedFileSuffix);
+		pathBuilder.append(data_->pathBase).append(relPath);
+		std::size_t filePathSize = pathBuilder.size();
 		auto& headers = request.getHeaders();
-		bool supportCompress = (
-			headers.getAcceptEncoding().view().find(CompressEncoding) !=
-			std::string_view::npos);
 		SharedString rangeHeader = headers.getHeader(constants::Range);
 		SharedString ifModifiedSinceHeader = headers.getHeader(constants::IfModifiedSince);
-		// get file content from cache if appropriate
+		SharedString ifNoneMatchHeader = headers.getHeader(constants::IfNoneMatch);
+		ByteRanges rangeSpecs;
+		bool hasRange = parseRangeHeader(rangeHeader, rangeSpecs);
+		SharedString ifRangeHeader = hasRange ? headers.getHeader(constants::IfRange) : SharedString();
+		// select pre-compressed variants accepted by client,
+		// disable them when range header is presented
+		CompressedVariantCandidates candidates = {};
+		if (!hasRange) {
+			candidates = getCompressedVariantCandidates(headers.getAcceptEncoding());
+		}
+		// get file content from cache if appropriate, variants known to be not exists are skipped
 		auto& response = context.getResponse();
 		SharedString mimeType = getMimeType(relPath);
-		if (data_->fileCache.maxSize() > 0 && rangeHeader.empty()) {
-			HttpServerRequestStaticFileHandlerData::FileCacheEntry* entry = nullptr;
-			if (supportCompress) {
-				entry = data_->fileCache.get(SharedString::fromStatic(pathBuilder.view()));
+		bool useCache = (data_->fileCache.maxSize() > 0);
+		// compress original file on-the-fly if enabled and client accept gzip,
+		// the compressed content is stored in cache so it requires caching
+		bool compressOnTheFly = (useCache && data_->compressionLevel > 0 &&
+			isGzipAccepted(candidates) && isCompressibleMimeType(mimeType));
+		HttpServerRequestStaticFileHandlerData::FileCacheEntry* fileEntry = useCache ?
+			data_->fileCache.get(pathBuilder.view()) : nullptr;
+		std::uint8_t missingVariants = 0;
+		CompressedVariantCandidates remainCandidates = {};
+		for (std::size_t i = 0; i < candidates.count; ++i) {
+			std::size_t variant = candidates.variants[i];
+			std::uint8_t variantBit = static_cast<std::uint8_t>(1U << variant);
+			pathBuilder.resize(filePathSize);
+			pathBuilder.append(CompressedVariants[variant].suffix);
+			if (useCache && remainCandidates.count == 0) {
+				auto* entry = data_->fileCache.get(pathBuilder.view());
 				if (entry != nullptr) {
 					return entry->reply(response, std::move(mimeType),
-						std::move(ifModifiedSinceHeader), data_->cacheControl, true);
+						std::move(ifModifiedSinceHeader), ifNoneMatchHeader, data_->cacheControl, variant,
+						rangeSpecs, ifRangeHeader, false);
 				}
 			}
-			entry = data_->fileCache.get(SharedString::fromStatic(
-				pathBuilder.view().substr(0,
-					pathBuilder.size() - sizeof(CompressedFileSuffix) + 1)));
-			if (entry != nullptr && (!supportCompress || entry->noCompressedVersion)) {
-				// client not support compress or ensure there no compressed version
-				return entry->reply(response, std::move(mimeType),
-					std::move(ifModifiedSinceHeader), data_->cacheControl, false);
+			auto* metadata = data_->getFileMetadata(pathBuilder.view());
+			if ((fileEntry != nullptr && (fileEntry->missingVariants & variantBit)) ||
+				(metadata != nullptr && !metadata->exists)) {
+				missingVariants |= variantBit;
+				continue;
+			}
+			remainCandidates.variants[remainCandidates.count++] = variant;
+		}
+		pathBuilder.resize(filePathSize);
+		if (fileEntry != nullptr && remainCandidates.count == 0) {
+			// client not accept compressed content or ensure there no such variants
+			if (!compressOnTheFly || fileEntry->compressionTried) {
+				bool compressed = compressOnTheFly && !fileEntry->compressedContent.empty();
+				return fileEntry->reply(response, std::move(mimeType),
+					std::move(ifModifiedSinceHeader), ifNoneMatchHeader, data_->cacheControl,
+					compressed ? GzipVariant : NoVariant, rangeSpecs, ifRangeHeader, compressed);
 			}
+			// compress in background then reply, the entry may evicted while compressing
+			// so reply from a copy of it (strings are shared, no content is copied),
+			// reply only uses headers synchronously so they can be owned by the continuation
+			SharedString filePath(pathBuilder.view());
+			return data_->compressFileCache(filePath, *fileEntry).then([
+				this, &response,
+				entry=fileEntry->share(),
+				mimeType=std::move(mimeType),
+				ifModifiedSinceHeader=std::move(ifModifiedSinceHeader),
+				ifNoneMatchHeader=std::move(ifNoneMatchHeader),
+				rangeSpecs=std::move(rangeSpecs),
+				ifRangeHeader=std::move(ifRangeHeader)] (SharedString compressed) mutable {
+				bool useCompressedContent = !compressed.empty();
+				if (useCompressedContent) {
+					entry.compressedContent = std::move(compressed);
+					entry.compressedETag = buildCompressedETag(entry.etag);
+				}
+				return entry.reply(response, std::move(mimeType),
+					std::move(ifModifiedSinceHeader), ifNoneMatchHeader, data_->cacheControl,
+					useCompressedContent ? GzipVariant : NoVariant, rangeSpecs, ifRangeHeader,
+					useCompressedContent);
+			});
 		}
-		// disable compress when range header is presented
-		if (!rangeHeader.empty()) {
-			supportCompress = false;
+		// pass to next handler if file is known to be not exists (from cached metadata)
+		if (remainCandidates.count == 0) {
+			auto* metadata = data_->getFileMetadata(pathBuilder.view());
+			if (metadata != nullptr && !metadata->exists) {
+				return (*next)->handle(context, next + 1);
+			}
 		}
 		// get file content from disk
-		SharedString compressedPath(pathBuilder.view());
-		SharedString filePath = compressedPath.share(
-			0, compressedPath.size() - sizeof(CompressedFileSuffix) + 1);
+		SharedString filePath(pathBuilder.view());
 		return seastar::do_with(std::make_unique<HttpServerRequestStaticFileReplier>(
-			std::move(filePath), std::move(compressedPath), supportCompress,
-			std::move(rangeHeader), std::move(mimeType), std::move(ifModifiedSinceHeader),
+			std::move(filePath), remainCandidates, missingVariants, compressOnTheFly,
+			std::move(rangeSpecs), std::move(ifRangeHeader), std::move(mimeType),
+			std::move(ifModifiedSinceHeader), std::move(ifNoneMatchHeader),
 			*data_, context, next),
 			[] (auto& reply) {
 			return reply->execute();
 		});
 	}
 
-	/** Clear cached file contents */
+	/** Clear cached file contents and metadata */
 	void HttpServerRequestStaticFileHandler::clearCache() {
-		data_->fileCache.clear();
+		data_->clearCache();
 	}
 
 	/** Constructor */
@@ -383,13 +1576,23 @@ namespace cpv {
 		SharedString&& pathBase,
 		SharedString&& cacheControl,
 		std::size_t maxCacheFileEntities,
-		std::size_t maxCacheFileSize) :
+		std::size_t maxCacheFileSize,
+		std::size_t maxCacheFileMetadataEntities,
+		std::chrono::milliseconds fileMetadataCacheTime,
+		bool watchPathBase,
+		bool useMemoryMappedFiles,
+		int compressionLevel) :
 		data_(std::make_unique<HttpServerRequestStaticFileHandlerData>(
 			std::move(urlBase),
 			std::move(pathBase),
 			std::move(cacheControl),
 			maxCacheFileEntities,
-			maxCacheFileSize)) { }
+			maxCacheFileSize,
+			maxCacheFileMetadataEntities,
+			fileMetadataCacheTime,
+			watchPathBase,
+			useMemoryMappedFiles,
+			compressionLevel)) { }
 
 	/** Move constructor (for incomplete member type) */
 	HttpServerRequestStaticFileHandler::HttpServerRequestStaticFileHandler(
@@ -0,0 +1,34 @@
+#include <algorithm>
+#include <CPVFramework/Serialize/JsonDeserializer.hpp>
+
+namespace cpv {
+	/** The storage of JsonAstBuffer */
+	template <>
+	thread_local ReusableStorageType<JsonAstBuffer>
+		ReusableStorageInstance<JsonAstBuffer>;
+
+	/** For Reusable<> */
+	void JsonAstBuffer::freeResources() {
+		if (capacity_ > MaxReservedCapacity) {
+			buffer_ = nullptr;
+			capacity_ = 0;
+		}
+	}
+
+	/** For Reusable<>, ensure the capacity is not less than sizeInWords */
+	void JsonAstBuffer::reset(std::size_t sizeInWords) {
+		if (sizeInWords > capacity_) {
+			// grow by at least twice to avoid frequent reallocation for similar sizes,
+			// no need to keep original contents so use new instead of make_unique (no zero fill)
+			std::size_t newCapacity = std::max(std::max(sizeInWords, capacity_ * 2), MinCapacity);
+			buffer_.reset(new std::size_t[newCapacity]);
+			capacity_ = newCapacity;
+		}
+	}
+
+	/** Constructor */
+	JsonAstBuffer::JsonAstBuffer() :
+		buffer_(),
+		capacity_(0) { }
+}
+
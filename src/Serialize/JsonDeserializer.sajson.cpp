@@ -23,8 +23,11 @@
  */
 
 // sajson 2dcfd350586375f9910f74821d4f07d67ae455ba 2018-09-21
+// modified: scan strings and whitespaces 16 or 32 bytes at a time (sse2/runtime detected avx2)
 
+#include <cstring>
 #include <CPVFramework/Serialize/JsonDeserializer.sajson.hpp>
+#include "../Utility/EscapeCharScanner.hpp"
 
 namespace sajson {
 	/// Allocation policy that allocates one large buffer guaranteed to hold the
@@ -701,20 +704,14 @@ namespace sajson {
 		}
 
 		char* skip_whitespace(char* p) {
-			// There is an opportunity to make better use of superscalar
-			// hardware here* but if someone cares about JSON parsing
-			// performance the first thing they do is minify, so prefer
-			// to optimize for code size here.
-			// * https://github.com/chadaustin/Web-Benchmarks/blob/master/json/third-party/pjson/pjson.h#L1873
-			for (;;) {
-				if (SAJSON_UNLIKELY(p == input_end)) {
-					return 0;
-				} else if (internal::is_whitespace(*p)) {
-					++p;
-				} else {
-					return p;
-				}
-			}
+			// fast path for minified json
+			if (SAJSON_LIKELY(p != input_end && !internal::is_whitespace(*p))) {
+				return p;
+			}
+			// indentation of formatted json is checked 16 or 32 bytes at a time
+			p = const_cast<char*>(cpv::findFirstEscapeChar<
+				cpv::JsonNonWhitespaceCharMatcher>(p, input_end));
+			return SAJSON_UNLIKELY(p == input_end) ? 0 : p;
 		}
 
 		error_result oom(char* p) {
@@ -1384,25 +1381,12 @@ namespace sajson {
 			++p; // "
 			size_t start = p - input.get_data();
 			char* input_end_local = input_end;
-			while (input_end_local - p >= 4) {
-				if (!is_plain_string_character(p[0])) { goto found; }
-				if (!is_plain_string_character(p[1])) { p += 1; goto found; }
-				if (!is_plain_string_character(p[2])) { p += 2; goto found; }
-				if (!is_plain_string_character(p[3])) { p += 3; goto found; }
-				p += 4;
-			}
-			for (;;) {
-				if (SAJSON_UNLIKELY(p >= input_end_local)) {
-					return make_error(p, ERROR_UNEXPECTED_END);
-				}
-
-				if (!is_plain_string_character(*p)) {
-					break;
-				}
-
-				++p;
+			// find quote, backslash, control or non ascii character, 16 or 32 bytes at a time
+			p = const_cast<char*>(cpv::findFirstEscapeChar<
+				cpv::JsonStringSpecialCharMatcher>(p, input_end_local));
+			if (SAJSON_UNLIKELY(p >= input_end_local)) {
+				return make_error(p, ERROR_UNEXPECTED_END);
 			}
-		found:
 			if (SAJSON_LIKELY(*p == '"')) {
 				tag[0] = start;
 				tag[1] = p - input.get_data();
@@ -1467,6 +1451,16 @@ namespace sajson {
 					return make_error(p, ERROR_UNEXPECTED_END);
 				}
 
+				if (internal::is_plain_string_character(*p)) {
+					// move the plain part between escapes at once
+					char* next = const_cast<char*>(cpv::findFirstEscapeChar<
+						cpv::JsonStringSpecialCharMatcher>(p, input_end_local));
+					std::memmove(end, p, next - p);
+					end += next - p;
+					p = next;
+					continue;
+				}
+
 				if (SAJSON_UNLIKELY(*p >= 0 && *p < 0x20)) {
 					return make_error(p, ERROR_ILLEGAL_CODEPOINT, static_cast<int>(*p));
 				}
@@ -0,0 +1,575 @@
+#include <seastar/core/future-util.hh>
+#include <CPVFramework/Serialize/JsonSerializer.hpp>
+#include <CPVFramework/Serialize/JsonStreamParser.hpp>
+#include "../Utility/EscapeCharScanner.hpp"
+
+namespace cpv {
+	namespace {
+		static const constexpr std::string_view TrueLiteral("true");
+		static const constexpr std::string_view FalseLiteral("false");
+		static const constexpr std::string_view NullLiteral("null");
+
+		/** Check whether char is json whitespace */
+		static inline bool isJsonWhitespace(char c) {
+			return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+		}
+
+		/** Check whether char may be part of json number */
+		static inline bool isJsonNumberChar(char c) {
+			return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+		}
+
+		/** Check whether text matches the json number grammar */
+		bool isValidJsonNumber(std::string_view str) {
+			const char* ptr = str.begin();
+			const char* end = str.end();
+			auto isDigit = [&ptr, end] { return ptr < end && *ptr >= '0' && *ptr <= '9'; };
+			if (ptr < end && *ptr == '-') {
+				++ptr;
+			}
+			if (ptr < end && *ptr == '0') {
+				++ptr;
+			} else if (isDigit()) {
+				while (isDigit()) { ++ptr; }
+			} else {
+				return false;
+			}
+			if (ptr < end && *ptr == '.') {
+				++ptr;
+				if (!isDigit()) {
+					return false;
+				}
+				while (isDigit()) { ++ptr; }
+			}
+			if (ptr < end && (*ptr == 'e' || *ptr == 'E')) {
+				++ptr;
+				if (ptr < end && (*ptr == '+' || *ptr == '-')) {
+					++ptr;
+				}
+				if (!isDigit()) {
+					return false;
+				}
+				while (isDigit()) { ++ptr; }
+			}
+			return ptr == end;
+		}
+
+		/** Append code point as utf-8 to string builder */
+		void appendUtf8(SharedStringBuilder& builder, std::uint32_t codePoint) {
+			if (codePoint < 0x80) {
+				builder.append(1, static_cast<char>(codePoint));
+			} else if (codePoint < 0x800) {
+				char* ptr = builder.grow(2);
+				ptr[0] = static_cast<char>(0xc0 | (codePoint >> 6));
+				ptr[1] = static_cast<char>(0x80 | (codePoint & 0x3f));
+			} else if (codePoint < 0x10000) {
+				char* ptr = builder.grow(3);
+				ptr[0] = static_cast<char>(0xe0 | (codePoint >> 12));
+				ptr[1] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+				ptr[2] = static_cast<char>(0x80 | (codePoint & 0x3f));
+			} else {
+				char* ptr = builder.grow(4);
+				ptr[0] = static_cast<char>(0xf0 | (codePoint >> 18));
+				ptr[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+				ptr[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+				ptr[3] = static_cast<char>(0x80 | (codePoint & 0x3f));
+			}
+		}
+	}
+
+	/** Parse next part of json, callbacks of handler will be invoked inside */
+	void JsonStreamParser::feed(const SharedString& data) {
+		chunkBegin_ = data.begin();
+		if (CPV_UNLIKELY(maxSize_ - parsedSize_ < data.size())) {
+			throwError("json size exceeds limit", data.begin() + (maxSize_ - parsedSize_));
+		}
+		const char* ptr = data.begin();
+		const char* end = data.end();
+		while (ptr < end) {
+			switch (state_) {
+			case State::String:
+				ptr = parseString(data, ptr, end);
+				break;
+			case State::StringEscape:
+				ptr = parseEscape(ptr);
+				break;
+			case State::StringUnicode:
+				ptr = parseUnicode(ptr, end);
+				break;
+			case State::Number:
+				ptr = parseNumber(data, ptr, end);
+				break;
+			case State::Literal:
+				ptr = parseLiteral(ptr, end);
+				break;
+			default:
+				if (isJsonWhitespace(*ptr)) {
+					++ptr;
+				} else {
+					ptr = parseStructural(ptr);
+				}
+				break;
+			}
+		}
+		parsedSize_ += data.size();
+		chunkBegin_ = nullptr;
+	}
+
+	/** Notify the json is ended, throws exception if json is incomplete */
+	void JsonStreamParser::finish() {
+		if (state_ == State::Number && containers_.empty()) {
+			// number at root is terminated by the end of json
+			finishNumber(token_.build());
+		}
+		if (CPV_UNLIKELY(state_ != State::Done)) {
+			throw DeserializeException(CPV_CODEINFO,
+				"unexpected end of json at position", parsedSize_);
+		}
+	}
+
+	/** Constructor */
+	JsonStreamParser::JsonStreamParser(
+		JsonStreamHandler& handler,
+		std::size_t maxDepth,
+		std::size_t maxTokenSize,
+		std::size_t maxSize) :
+		handler_(handler),
+		maxDepth_(maxDepth),
+		maxTokenSize_(maxTokenSize),
+		maxSize_(maxSize),
+		parsedSize_(0),
+		chunkBegin_(nullptr),
+		state_(State::Value),
+		isKey_(false),
+		containers_(),
+		token_(),
+		literal_(),
+		literalMatched_(0),
+		unicodeValue_(0),
+		unicodeDigits_(0),
+		highSurrogate_(0) { }
+
+	/** Handle the char outside of token */
+	const char* JsonStreamParser::parseStructural(const char* ptr) {
+		char c = *ptr;
+		switch (state_) {
+		case State::Value:
+			return parseValue(ptr);
+		case State::ValueOrArrayEnd:
+			if (c == ']') {
+				endContainer(false);
+				return ptr + 1;
+			}
+			return parseValue(ptr);
+		case State::KeyOrObjectEnd:
+			if (c == '}') {
+				endContainer(true);
+				return ptr + 1;
+			}
+			[[fallthrough]];
+		case State::Key:
+			if (CPV_UNLIKELY(c != '"')) {
+				throwError("expect object key", ptr);
+			}
+			isKey_ = true;
+			state_ = State::String;
+			return ptr + 1;
+		case State::Colon:
+			if (CPV_UNLIKELY(c != ':')) {
+				throwError("expect ':'", ptr);
+			}
+			state_ = State::Value;
+			return ptr + 1;
+		case State::CommaOrEnd:
+			if (c == ',') {
+				state_ = containers_.back() ? State::Key : State::Value;
+				return ptr + 1;
+			} else if (c == '}' && containers_.back()) {
+				endContainer(true);
+				return ptr + 1;
+			} else if (c == ']' && !containers_.back()) {
+				endContainer(false);
+				return ptr + 1;
+			}
+			throwError("expect ',' or end of container", ptr);
+		default:
+			throwError("unexpected character after root element", ptr);
+		}
+	}
+
+	/** Handle the first char of value */
+	const char* JsonStreamParser::parseValue(const char* ptr) {
+		switch (*ptr) {
+		case '{':
+			startContainer(true);
+			return ptr + 1;
+		case '[':
+			startContainer(false);
+			return ptr + 1;
+		case '"':
+			isKey_ = false;
+			state_ = State::String;
+			return ptr + 1;
+		case 't':
+			literal_ = TrueLiteral;
+			break;
+		case 'f':
+			literal_ = FalseLiteral;
+			break;
+		case 'n':
+			literal_ = NullLiteral;
+			break;
+		default:
+			if (CPV_UNLIKELY(*ptr != '-' && (*ptr < '0' || *ptr > '9'))) {
+				throwError("unexpected character", ptr);
+			}
+			state_ = State::Number;
+			return ptr;
+		}
+		literalMatched_ = 0;
+		state_ = State::Literal;
+		return ptr;
+	}
+
+	/** Handle chars inside string */
+	const char* JsonStreamParser::parseString(
+		const SharedString& data, const char* ptr, const char* end) {
+		if (CPV_UNLIKELY(highSurrogate_ != 0 && *ptr != '\\')) {
+			throwError("invalid surrogate pair", ptr);
+		}
+		const char* stop = findFirstEscapeChar<JsonEscapeCharMatcher>(ptr, end);
+		if (stop == end) {
+			appendToken(ptr, end);
+			return end;
+		} else if (*stop == '"') {
+			SharedString value;
+			if (token_.empty()) {
+				// fast path: the string is inside this chunk and contains no escape characters
+				if (CPV_UNLIKELY(static_cast<std::size_t>(stop - ptr) > maxTokenSize_)) {
+					throwError("json token size exceeds limit", ptr);
+				}
+				value = data.share({ ptr, static_cast<std::size_t>(stop - ptr) });
+			} else {
+				appendToken(ptr, stop);
+				value = token_.build();
+			}
+			if (isKey_) {
+				handler_.onKey(std::move(value));
+				state_ = State::Colon;
+			} else {
+				handler_.onString(std::move(value));
+				endValue();
+			}
+			return stop + 1;
+		} else if (*stop == '\\') {
+			appendToken(ptr, stop);
+			state_ = State::StringEscape;
+			return stop + 1;
+		}
+		throwError("control character in string", stop);
+	}
+
+	/** Handle the char after backslash */
+	const char* JsonStreamParser::parseEscape(const char* ptr) {
+		char c = *ptr;
+		if (CPV_UNLIKELY(highSurrogate_ != 0 && c != 'u')) {
+			throwError("invalid surrogate pair", ptr);
+		}
+		switch (c) {
+		case '"':
+		case '\\':
+		case '/':
+			break;
+		case 'b':
+			c = '\b';
+			break;
+		case 'f':
+			c = '\f';
+			break;
+		case 'n':
+			c = '\n';
+			break;
+		case 'r':
+			c = '\r';
+			break;
+		case 't':
+			c = '\t';
+			break;
+		case 'u':
+			unicodeValue_ = 0;
+			unicodeDigits_ = 0;
+			state_ = State::StringUnicode;
+			return ptr + 1;
+		default:
+			throwError("invalid escape character", ptr);
+		}
+		appendToken(&c, &c + 1);
+		state_ = State::String;
+		return ptr + 1;
+	}
+
+	/** Handle the hex digits after \u */
+	const char* JsonStreamParser::parseUnicode(const char* ptr, const char* end) {
+		for (; ptr < end && unicodeDigits_ < 4; ++ptr, ++unicodeDigits_) {
+			char c = *ptr;
+			std::uint32_t digit;
+			if (c >= '0' && c <= '9') {
+				digit = c - '0';
+			} else if (c >= 'a' && c <= 'f') {
+				digit = c - 'a' + 10;
+			} else if (c >= 'A' && c <= 'F') {
+				digit = c - 'A' + 10;
+			} else {
+				throwError("invalid unicode escape", ptr);
+			}
+			unicodeValue_ = (unicodeValue_ << 4) | digit;
+		}
+		if (unicodeDigits_ < 4) {
+			return ptr;
+		}
+		std::uint32_t codePoint = unicodeValue_;
+		if (highSurrogate_ != 0) {
+			if (CPV_UNLIKELY(codePoint < 0xdc00 || codePoint > 0xdfff)) {
+				throwError("invalid surrogate pair", ptr);
+			}
+			codePoint = 0x10000 + ((highSurrogate_ - 0xd800) << 10) + (codePoint - 0xdc00);
+			highSurrogate_ = 0;
+		} else if (codePoint >= 0xd800 && codePoint <= 0xdbff) {
+			// wait for low surrogate
+			highSurrogate_ = codePoint;
+			state_ = State::String;
+			return ptr;
+		} else if (CPV_UNLIKELY(codePoint >= 0xdc00 && codePoint <= 0xdfff)) {
+			throwError("invalid surrogate pair", ptr);
+		}
+		if (CPV_UNLIKELY(token_.size() + 4 > maxTokenSize_)) {
+			throwError("json token size exceeds limit", ptr);
+		}
+		appendUtf8(token_, codePoint);
+		state_ = State::String;
+		return ptr;
+	}
+
+	/** Handle chars of number */
+	const char* JsonStreamParser::parseNumber(
+		const SharedString& data, const char* ptr, const char* end) {
+		const char* stop = ptr;
+		while (stop < end && isJsonNumberChar(*stop)) {
+			++stop;
+		}
+		if (stop == end) {
+			// number may continue in next chunk
+			appendToken(ptr, end);
+			return end;
+		} else if (token_.empty()) {
+			if (CPV_UNLIKELY(static_cast<std::size_t>(stop - ptr) > maxTokenSize_)) {
+				throwError("json token size exceeds limit", ptr);
+			}
+			finishNumber(data.share({ ptr, static_cast<std::size_t>(stop - ptr) }));
+		} else {
+			appendToken(ptr, stop);
+			finishNumber(token_.build());
+		}
+		return stop;
+	}
+
+	/** Handle chars of true, false or null */
+	const char* JsonStreamParser::parseLiteral(const char* ptr, const char* end) {
+		for (; ptr < end && literalMatched_ < literal_.size(); ++ptr, ++literalMatched_) {
+			if (CPV_UNLIKELY(*ptr != literal_[literalMatched_])) {
+				throwError("invalid literal", ptr);
+			}
+		}
+		if (literalMatched_ == literal_.size()) {
+			if (literal_.size() == NullLiteral.size() && literal_[0] == 'n') {
+				handler_.onNull();
+			} else {
+				handler_.onBool(literal_[0] == 't');
+			}
+			endValue();
+		}
+		return ptr;
+	}
+
+	/** Validate number and pass it to handler */
+	void JsonStreamParser::finishNumber(SharedString&& value) {
+		if (CPV_UNLIKELY(!isValidJsonNumber(value.view()))) {
+			throw DeserializeException(CPV_CODEINFO, "invalid number:", value);
+		}
+		handler_.onNumber(std::move(value));
+		endValue();
+	}
+
+	/** Handle the start of object or array */
+	void JsonStreamParser::startContainer(bool isObject) {
+		if (CPV_UNLIKELY(containers_.size() >= maxDepth_)) {
+			throw DeserializeException(CPV_CODEINFO, "json depth exceeds limit:", maxDepth_);
+		}
+		containers_.push_back(isObject);
+		if (isObject) {
+			handler_.onStartObject();
+			state_ = State::KeyOrObjectEnd;
+		} else {
+			handler_.onStartArray();
+			state_ = State::ValueOrArrayEnd;
+		}
+	}
+
+	/** Handle the end of object or array */
+	void JsonStreamParser::endContainer(bool isObject) {
+		containers_.pop_back();
+		if (isObject) {
+			handler_.onEndObject();
+		} else {
+			handler_.onEndArray();
+		}
+		endValue();
+	}
+
+	/** Update state after a value is parsed */
+	void JsonStreamParser::endValue() {
+		state_ = containers_.empty() ? State::Done : State::CommaOrEnd;
+	}
+
+	/** Append part of token to buffer */
+	void JsonStreamParser::appendToken(const char* begin, const char* end) {
+		std::size_t size = end - begin;
+		if (CPV_UNLIKELY(maxTokenSize_ - token_.size() < size)) {
+			throwError("json token size exceeds limit", begin);
+		}
+		token_.append({ begin, size });
+	}
+
+	/** Throw DeserializeException with position */
+	void JsonStreamParser::throwError(const char* message, const char* ptr) const {
+		std::size_t position = parsedSize_;
+		if (chunkBegin_ != nullptr) {
+			position += ptr - chunkBegin_;
+		}
+		throw DeserializeException(CPV_CODEINFO, message, "at position", position);
+	}
+
+	void JsonItemsCollector::onStartObject() {
+		beforeValue();
+		append("{");
+		++depth_;
+		addComma_ = false;
+	}
+
+	void JsonItemsCollector::onEndObject() {
+		append("}");
+		--depth_;
+		afterValue();
+	}
+
+	void JsonItemsCollector::onStartArray() {
+		if (depth_ == 0) {
+			// root array
+			depth_ = 1;
+			return;
+		}
+		beforeValue();
+		append("[");
+		++depth_;
+		addComma_ = false;
+	}
+
+	void JsonItemsCollector::onEndArray() {
+		if (depth_ == 1) {
+			// root array
+			depth_ = 0;
+			return;
+		}
+		append("]");
+		--depth_;
+		afterValue();
+	}
+
+	void JsonItemsCollector::onKey(SharedString&& key) {
+		if (addComma_) {
+			append(",");
+		}
+		append("\"");
+		append(jsonEncode(std::move(key)));
+		append("\":");
+		addComma_ = false;
+	}
+
+	void JsonItemsCollector::onString(SharedString&& value) {
+		beforeValue();
+		append("\"");
+		append(jsonEncode(std::move(value)));
+		append("\"");
+		afterValue();
+	}
+
+	void JsonItemsCollector::onNumber(SharedString&& value) {
+		beforeValue();
+		append(value);
+		afterValue();
+	}
+
+	void JsonItemsCollector::onBool(bool value) {
+		beforeValue();
+		append(value ? TrueLiteral : FalseLiteral);
+		afterValue();
+	}
+
+	void JsonItemsCollector::onNull() {
+		beforeValue();
+		append(NullLiteral);
+		afterValue();
+	}
+
+	/** Constructor */
+	JsonItemsCollector::JsonItemsCollector(std::size_t maxItemSize) :
+		maxItemSize_(maxItemSize),
+		depth_(0),
+		addComma_(false),
+		builder_(),
+		items_() { }
+
+	/** Start new item or add comma between values */
+	void JsonItemsCollector::beforeValue() {
+		if (CPV_UNLIKELY(depth_ == 0)) {
+			throw DeserializeException(CPV_CODEINFO, "root element must be array");
+		}
+		if (depth_ == 1) {
+			append("[");
+		} else if (addComma_) {
+			append(",");
+		}
+	}
+
+	/** Complete the item if value is directly under root array */
+	void JsonItemsCollector::afterValue() {
+		addComma_ = true;
+		if (depth_ == 1) {
+			append("]");
+			items_.emplace_back(builder_.build());
+		}
+	}
+
+	/** Append string to item, throws exception if item size exceeds limit */
+	void JsonItemsCollector::append(std::string_view str) {
+		if (CPV_UNLIKELY(maxItemSize_ - builder_.size() < str.size())) {
+			throw DeserializeException(CPV_CODEINFO, "json item size exceeds limit:", maxItemSize_);
+		}
+		builder_.append(str);
+	}
+
+	/** Read json from stream and feed it to parser chunk by chunk */
+	seastar::future<> parseJsonFromStream(InputStreamBase& stream, JsonStreamParser& parser) {
+		return seastar::repeat([&stream, &parser] {
+			return stream.read().then([&parser] (auto&& result) {
+				parser.feed(result.data);
+				if (result.isEnd) {
+					parser.finish();
+					return seastar::stop_iteration::yes;
+				}
+				return seastar::stop_iteration::no;
+			});
+		});
+	}
+}
+
@@ -0,0 +1,127 @@
+#include <CPVFramework/Serialize/MsgPackDeserializer.hpp>
+
+namespace cpv {
+	/** Validate msgpack, return nullptr if valid or the error message if invalid */
+	const char* validateMsgPack(std::string_view data, std::size_t& position) {
+		const char* begin = data.data();
+		const char* end = begin + data.size();
+		const char* ptr = begin;
+		// number of values still need to read, each value takes at least one byte
+		// so the loop is bounded by the size of data
+		std::uint64_t pending = 1;
+		while (pending > 0) {
+			position = ptr - begin;
+			if (CPV_UNLIKELY(ptr >= end)) {
+				return "unexpected end of input";
+			}
+			std::uint32_t headerSize = getMsgPackHeaderSize(static_cast<std::uint8_t>(*ptr));
+			if (CPV_UNLIKELY(headerSize == 0)) {
+				return "invalid type";
+			} else if (CPV_UNLIKELY(static_cast<std::size_t>(end - ptr) < headerSize)) {
+				return "unexpected end of input";
+			}
+			MsgPackHeader header = parseMsgPackHeader(ptr);
+			ptr += headerSize;
+			--pending;
+			if (header.type == MsgPackType::String ||
+				header.type == MsgPackType::Binary ||
+				header.type == MsgPackType::Extension) {
+				if (CPV_UNLIKELY(static_cast<std::uint64_t>(end - ptr) < header.length)) {
+					return "unexpected end of input";
+				}
+				ptr += header.length;
+			} else if (header.type == MsgPackType::Array) {
+				pending += header.length;
+			} else if (header.type == MsgPackType::Map) {
+				pending += header.length * 2;
+			}
+		}
+		position = ptr - begin;
+		if (CPV_UNLIKELY(ptr != end)) {
+			return "unexpected trailing data";
+		}
+		return nullptr;
+	}
+
+	/** Get integer value, type must be Integer */
+	std::int64_t MsgPackValue::getInteger() const {
+		std::uint8_t first = static_cast<std::uint8_t>(*ptr_);
+		const char* payload = ptr_ + 1;
+		switch (first) {
+			case 0xcc: return readMsgPackBigEndian<std::uint8_t>(payload);
+			case 0xcd: return readMsgPackBigEndian<std::uint16_t>(payload);
+			case 0xce: return readMsgPackBigEndian<std::uint32_t>(payload);
+			case 0xcf: return static_cast<std::int64_t>(readMsgPackBigEndian<std::uint64_t>(payload));
+			case 0xd0: return static_cast<std::int8_t>(readMsgPackBigEndian<std::uint8_t>(payload));
+			case 0xd1: return static_cast<std::int16_t>(readMsgPackBigEndian<std::uint16_t>(payload));
+			case 0xd2: return static_cast<std::int32_t>(readMsgPackBigEndian<std::uint32_t>(payload));
+			case 0xd3: return static_cast<std::int64_t>(readMsgPackBigEndian<std::uint64_t>(payload));
+			default: return static_cast<std::int8_t>(first); // positive and negative fixint
+		}
+	}
+
+	/** Get floating point value, type must be Double */
+	double MsgPackValue::getDouble() const {
+		if (static_cast<std::uint8_t>(*ptr_) == 0xca) {
+			std::uint32_t bits = readMsgPackBigEndian<std::uint32_t>(ptr_ + 1);
+			float value = 0;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+		std::uint64_t bits = readMsgPackBigEndian<std::uint64_t>(ptr_ + 1);
+		double value = 0;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	/** Get value by key for map, return NoKey if key not exists */
+	MsgPackValue MsgPackValue::operator[](std::string_view key) const {
+		if (getType() == MsgPackType::Map) {
+			MsgPackHeader header = parseMsgPackHeader(ptr_);
+			const char* ptr = ptr_ + header.size;
+			for (std::uint64_t i = 0; i < header.length; ++i) {
+				MsgPackValue memberKey(ptr, str_);
+				MsgPackValue memberValue(memberKey.next(), str_);
+				if (memberKey.getType() == MsgPackType::String && memberKey.getStringView() == key) {
+					return memberValue;
+				}
+				ptr = memberValue.next();
+			}
+		}
+		return { nullptr, str_ };
+	}
+
+	/** Get value by index for array, return NoKey if index out of range */
+	MsgPackValue MsgPackValue::operator[](std::size_t index) const {
+		if (getType() == MsgPackType::Array && index < getLength()) {
+			const char* ptr = ptr_ + parseMsgPackHeader(ptr_).size;
+			for (std::size_t i = 0; i < index; ++i) {
+				ptr = MsgPackValue(ptr, str_).next();
+			}
+			return { ptr, str_ };
+		}
+		return { nullptr, str_ };
+	}
+
+	/** Get the pointer after this value */
+	const char* MsgPackValue::next() const {
+		const char* ptr = ptr_;
+		std::uint64_t pending = 1;
+		while (pending > 0) {
+			MsgPackHeader header = parseMsgPackHeader(ptr);
+			ptr += header.size;
+			--pending;
+			if (header.type == MsgPackType::String ||
+				header.type == MsgPackType::Binary ||
+				header.type == MsgPackType::Extension) {
+				ptr += header.length;
+			} else if (header.type == MsgPackType::Array) {
+				pending += header.length;
+			} else if (header.type == MsgPackType::Map) {
+				pending += header.length * 2;
+			}
+		}
+		return ptr;
+	}
+}
+
@@ -0,0 +1,123 @@
+#include <cstring>
+#include <CPVFramework/Serialize/MsgPackSerializer.hpp>
+
+namespace cpv {
+	/** Write header of map with given number of members */
+	MsgPackBuilder& MsgPackBuilder::startMap(std::size_t size) {
+		// map 8 not exists, 0 means it's unused
+		writeHeader(size, 0x80, 15, 0, 0xde, 0xdf);
+		return *this;
+	}
+
+	/** Write header of array with given number of items */
+	MsgPackBuilder& MsgPackBuilder::startArray(std::size_t size) {
+		// array 8 not exists, 0 means it's unused
+		writeHeader(size, 0x90, 15, 0, 0xdc, 0xdd);
+		return *this;
+	}
+
+	/** Write signed integer with the shortest encoding */
+	void MsgPackBuilder::writeInteger(std::int64_t value) {
+		if (value >= 0) {
+			writeUnsignedInteger(static_cast<std::uint64_t>(value));
+		} else if (value >= -32) {
+			// negative fixint
+			buffer_.append(1, static_cast<char>(value));
+		} else if (value >= std::numeric_limits<std::int8_t>::min()) {
+			writeBigEndian(0xd0, static_cast<std::uint8_t>(value));
+		} else if (value >= std::numeric_limits<std::int16_t>::min()) {
+			writeBigEndian(0xd1, static_cast<std::uint16_t>(value));
+		} else if (value >= std::numeric_limits<std::int32_t>::min()) {
+			writeBigEndian(0xd2, static_cast<std::uint32_t>(value));
+		} else {
+			writeBigEndian(0xd3, static_cast<std::uint64_t>(value));
+		}
+	}
+
+	/** Write unsigned integer with the shortest encoding */
+	void MsgPackBuilder::writeUnsignedInteger(std::uint64_t value) {
+		if (value <= 0x7f) {
+			// positive fixint
+			buffer_.append(1, static_cast<char>(value));
+		} else if (value <= std::numeric_limits<std::uint8_t>::max()) {
+			writeBigEndian(0xcc, static_cast<std::uint8_t>(value));
+		} else if (value <= std::numeric_limits<std::uint16_t>::max()) {
+			writeBigEndian(0xcd, static_cast<std::uint16_t>(value));
+		} else if (value <= std::numeric_limits<std::uint32_t>::max()) {
+			writeBigEndian(0xce, static_cast<std::uint32_t>(value));
+		} else {
+			writeBigEndian(0xcf, value);
+		}
+	}
+
+	/** Write floating point as float 64 */
+	void MsgPackBuilder::writeDouble(double value) {
+		static_assert(sizeof(double) == sizeof(std::uint64_t), "unsupported double size");
+		std::uint64_t bits = 0;
+		std::memcpy(&bits, &value, sizeof(bits));
+		writeBigEndian(0xcb, bits);
+	}
+
+	/** Write string, large string is appended as a separate fragment without copying */
+	void MsgPackBuilder::writeString(const SharedString& value) {
+		if (value.size() < LargeStringThreshold) {
+			writeString(value.view());
+			return;
+		}
+		writeHeader(value.size(), 0xa0, 31, 0xd9, 0xda, 0xdb);
+		flushBuffer();
+		fragments_->append(value.share());
+	}
+
+	/** Write string by copying */
+	void MsgPackBuilder::writeString(std::string_view value) {
+		writeHeader(value.size(), 0xa0, 31, 0xd9, 0xda, 0xdb);
+		buffer_.append(value);
+	}
+
+	/** Get the msgpack packet, don't touch the msgpack builder after invoked this */
+	Packet MsgPackBuilder::toPacket() && {
+		if (fragments_ == nullptr) {
+			// no large string, the packet contains only one fragment
+			packet_ = Packet(buffer_.build());
+		} else {
+			flushBuffer();
+		}
+		fragments_ = nullptr;
+		return std::move(packet_);
+	}
+
+	/** Constructor with initial size of buffer */
+	MsgPackBuilder::MsgPackBuilder(std::size_t capacity) :
+		packet_(),
+		fragments_(nullptr),
+		buffer_() {
+		buffer_.reserve(capacity);
+	}
+
+	/** Write header of string, array or map, headers are selected by length */
+	void MsgPackBuilder::writeHeader(std::size_t size,
+		std::uint8_t fixPrefix, std::size_t fixLimit,
+		std::uint8_t prefix8, std::uint8_t prefix16, std::uint8_t prefix32) {
+		if (size <= fixLimit) {
+			buffer_.append(1, static_cast<char>(fixPrefix | size));
+		} else if (prefix8 != 0 && size <= std::numeric_limits<std::uint8_t>::max()) {
+			writeBigEndian(prefix8, static_cast<std::uint8_t>(size));
+		} else if (size <= std::numeric_limits<std::uint16_t>::max()) {
+			writeBigEndian(prefix16, static_cast<std::uint16_t>(size));
+		} else {
+			writeBigEndian(prefix32, static_cast<std::uint32_t>(size));
+		}
+	}
+
+	/** Append content of buffer to packet as a fragment */
+	void MsgPackBuilder::flushBuffer() {
+		if (fragments_ == nullptr) {
+			fragments_ = &packet_.getOrConvertToMultiple();
+		}
+		if (!buffer_.empty()) {
+			fragments_->append(buffer_.build());
+		}
+	}
+}
+
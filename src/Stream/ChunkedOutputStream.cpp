@@ -0,0 +1,71 @@
+#include <CPVFramework/Exceptions/LogicException.hpp>
+#include <CPVFramework/Stream/ChunkedOutputStream.hpp>
+#include <CPVFramework/Utility/Reusable.hpp>
+#include <CPVFramework/Utility/Macros.hpp>
+
+namespace cpv {
+	namespace {
+		static const constexpr char HexDigits[] = "0123456789abcdef";
+		static const constexpr char ChunkEnd[] = "\r\n";
+		static const constexpr char LastChunk[] = "0\r\n\r\n";
+	}
+
+	/** The storage of ChunkedOutputStream */
+	template <>
+	thread_local ReusableStorageType<ChunkedOutputStream>
+		ReusableStorageInstance<ChunkedOutputStream>;
+	
+	/** Write data as a chunk, empty data is ignored because empty chunk indicates the end */
+	seastar::future<> ChunkedOutputStream::write(Packet&& data) {
+		if (CPV_UNLIKELY(stream_ == nullptr)) {
+			return seastar::make_exception_future<>(LogicException(
+				CPV_CODEINFO, "write to null stream"));
+		}
+		std::size_t size = data.size();
+		if (size == 0) {
+			return seastar::make_ready_future<>();
+		}
+		// build chunk size line, the size is written in hex without leading zeros
+		char digits[sizeof(std::size_t) * 2];
+		char* digitsEnd = digits + sizeof(digits);
+		char* digitsBegin = digitsEnd;
+		do {
+			*--digitsBegin = HexDigits[size & 0xf];
+			size >>= 4;
+		} while (size != 0);
+		std::size_t digitsSize = static_cast<std::size_t>(digitsEnd - digitsBegin);
+		SharedString header(digitsSize + 2);
+		std::memcpy(header.data(), digitsBegin, digitsSize);
+		std::memcpy(header.data() + digitsSize, ChunkEnd, 2);
+		// chunk size line + data + crlf
+		Packet packet(data.segments() + 2);
+		packet.getOrConvertToMultiple().append(std::move(header));
+		packet.append(std::move(data));
+		packet.getOrConvertToMultiple().append(ChunkEnd);
+		return stream_->write(std::move(packet));
+	}
+	
+	/** Write the last chunk to indicate the end */
+	seastar::future<> ChunkedOutputStream::writeEnd() {
+		if (CPV_UNLIKELY(stream_ == nullptr)) {
+			return seastar::make_exception_future<>(LogicException(
+				CPV_CODEINFO, "write to null stream"));
+		}
+		return stream_->write(Packet(SharedString::fromStatic(LastChunk)));
+	}
+	
+	/** For Reusable<> */
+	void ChunkedOutputStream::freeResources() {
+		stream_ = nullptr;
+	}
+	
+	/** For Reusable<> */
+	void ChunkedOutputStream::reset(OutputStreamBase* stream) {
+		stream_ = stream;
+	}
+	
+	/** Constructor */
+	ChunkedOutputStream::ChunkedOutputStream() :
+		stream_(nullptr) { }
+}
+
@@ -1,11 +1,98 @@
 #include <algorithm>
+#include <cstring>
+#include <seastar/core/file.hh>
 #include <seastar/core/future-util.hh>
+#include <seastar/core/reactor.hh>
+#include <CPVFramework/Exceptions/FileSystemException.hpp>
 #include <CPVFramework/Stream/InputStreamExtensions.hpp>
 
 namespace cpv::extensions {
 	namespace {
 		// avoid out-of-memory attack and handle overflow
 		static const constexpr std::size_t MaxReservedCapacity = 1048576;
+
+		/** Write data to file with dma, data is copied to aligned buffer and written by blocks */
+		class DmaFileWriter {
+		public:
+			/** The size of aligned buffer, it's a multiple of common dma alignments */
+			static const constexpr std::size_t BufferSize = 131072;
+
+			/** Append data to buffer, write buffer to file when it's full */
+			seastar::future<> write(SharedString&& data) {
+				pending_ = std::move(data);
+				pendingOffset_ = 0;
+				return seastar::repeat([this] {
+					std::size_t size = std::min(
+						pending_.size() - pendingOffset_, buffer_.size() - bufferSize_);
+					std::memcpy(buffer_.get_write() + bufferSize_, pending_.data() + pendingOffset_, size);
+					bufferSize_ += size;
+					pendingOffset_ += size;
+					if (bufferSize_ < buffer_.size()) {
+						return seastar::make_ready_future<seastar::stop_iteration>(
+							seastar::stop_iteration::yes);
+					}
+					return writeBuffer(buffer_.size()).then([] {
+						return seastar::stop_iteration::no;
+					});
+				});
+			}
+
+			/** Write remaining data and truncate file to actual size, return the actual size */
+			seastar::future<std::size_t> finish() {
+				std::size_t size = position_ + bufferSize_;
+				pending_ = SharedString();
+				if (bufferSize_ == 0) {
+					return file_.flush().then([size] { return size; });
+				}
+				// the size of dma write must be aligned, pad zeros and truncate later
+				std::size_t alignment = file_.disk_write_dma_alignment();
+				std::size_t alignedSize = (bufferSize_ + alignment - 1) / alignment * alignment;
+				std::memset(buffer_.get_write() + bufferSize_, 0, alignedSize - bufferSize_);
+				return writeBuffer(alignedSize).then([this, size] {
+					return file_.truncate(size);
+				}).then([this] {
+					return file_.flush();
+				}).then([size] {
+					return size;
+				});
+			}
+
+			/** Close file */
+			seastar::future<> close() {
+				return file_.close();
+			}
+
+			/** Constructor */
+			explicit DmaFileWriter(seastar::file&& file) :
+				file_(std::move(file)),
+				buffer_(seastar::temporary_buffer<char>::aligned(file_.memory_dma_alignment(), BufferSize)),
+				bufferSize_(0),
+				position_(0),
+				pending_(),
+				pendingOffset_(0) { }
+
+		private:
+			/** Write the first size bytes of buffer to file */
+			seastar::future<> writeBuffer(std::size_t size) {
+				return file_.dma_write(position_, buffer_.get(), size).then([this, size] (std::size_t written) {
+					if (CPV_UNLIKELY(written != size)) {
+						return seastar::make_exception_future<>(FileSystemException(CPV_CODEINFO,
+							"write file failed, expected size:", size, "written size:", written));
+					}
+					position_ += size;
+					bufferSize_ = 0;
+					return seastar::make_ready_future<>();
+				});
+			}
+
+		private:
+			seastar::file file_;
+			seastar::temporary_buffer<char> buffer_;
+			std::size_t bufferSize_;
+			std::size_t position_;
+			SharedString pending_;
+			std::size_t pendingOffset_;
+		};
 	}
 
 	/** Read all data from stream and append to given string builder */
@@ -69,5 +156,29 @@ namespace cpv::extensions {
 			});
 		});
 	}
-}
 
+	/** Read all data from stream and write to file with dma */
+	seastar::future<std::size_t> writeAllToFile(InputStreamBase& stream, const SharedString& path) {
+		return seastar::open_file_dma(
+			seastar::sstring(path.data(), path.size()),
+			seastar::open_flags::wo | seastar::open_flags::create | seastar::open_flags::truncate)
+		.then([&stream] (seastar::file file) {
+			return seastar::do_with(DmaFileWriter(std::move(file)), [&stream] (auto& writer) {
+				return seastar::repeat([&stream, &writer] {
+					return stream.read().then([&writer] (auto&& result) {
+						bool isEnd = result.isEnd;
+						return writer.write(std::move(result.data)).then([isEnd] {
+							return isEnd ?
+								seastar::stop_iteration::yes :
+								seastar::stop_iteration::no;
+						});
+					});
+				}).then([&writer] {
+					return writer.finish();
+				}).finally([&writer] {
+					return writer.close();
+				});
+			});
+		});
+	}
+}
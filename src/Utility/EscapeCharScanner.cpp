@@ -0,0 +1,12 @@
+#include "./EscapeCharScanner.hpp"
+
+namespace cpv {
+#if defined(CPV_ESCAPE_CHAR_SCANNER_AVX2)
+	bool EscapeCharScannerUseAvx2 = ([] {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+	})();
+#else
+	bool EscapeCharScannerUseAvx2 = false;
+#endif
+}
@@ -0,0 +1,267 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#if defined(__x86_64__) && defined(__GNUC__)
+// avx2 code is compiled with target attribute and selected at runtime
+#define CPV_ESCAPE_CHAR_SCANNER_AVX2
+#endif
+#if defined(__SSE2__) || defined(CPV_ESCAPE_CHAR_SCANNER_AVX2)
+#include <immintrin.h>
+#endif
+#include <CPVFramework/Utility/Macros.hpp>
+#include <CPVFramework/Utility/SharedString.hpp>
+
+#if defined(CPV_ESCAPE_CHAR_SCANNER_AVX2)
+// avx2 vectors are only passed between inlined functions, the abi change doesn't matter
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace cpv {
+	/**
+	 * Whether findFirstEscapeChar uses avx2, detected once on startup by cpuid.
+	 * It's false before static initialization so early callers fallback to sse2 safely,
+	 * tests may change it to check both code paths.
+	 */
+	extern bool EscapeCharScannerUseAvx2;
+
+	namespace {
+		/** Mapping from char to it's encoded representation */
+		using EscapeCharMapping = std::array<
+			std::string_view, std::numeric_limits<unsigned char>::max() + 1>;
+
+#if defined(__SSE2__)
+		/** Operations on 16 bytes vector */
+		struct SimdVector128 {
+			using Type = __m128i;
+			static const constexpr std::size_t Size = 16;
+			static Type load(const char* ptr) {
+				return _mm_loadu_si128(reinterpret_cast<const Type*>(ptr));
+			}
+			static Type set1(char c) { return _mm_set1_epi8(c); }
+			static Type eq(Type a, Type b) { return _mm_cmpeq_epi8(a, b); }
+			static Type orOp(Type a, Type b) { return _mm_or_si128(a, b); }
+			/** Check whether unsigned bytes are in [from, to] */
+			static Type inRange(Type a, char from, char to) {
+				return _mm_cmpeq_epi8(_mm_min_epu8(_mm_max_epu8(a, set1(from)), set1(to)), a);
+			}
+			static std::uint32_t mask(Type a) {
+				return static_cast<std::uint32_t>(_mm_movemask_epi8(a));
+			}
+			static const constexpr std::uint32_t FullMask = 0xffff;
+		};
+#endif
+
+#if defined(CPV_ESCAPE_CHAR_SCANNER_AVX2)
+		/** Operations on 32 bytes vector, only call them from functions with avx2 target */
+		struct SimdVector256 {
+			using Type = __m256i;
+			static const constexpr std::size_t Size = 32;
+			__attribute__((target("avx2")))
+			static Type load(const char* ptr) {
+				return _mm256_loadu_si256(reinterpret_cast<const Type*>(ptr));
+			}
+			__attribute__((target("avx2")))
+			static Type set1(char c) { return _mm256_set1_epi8(c); }
+			__attribute__((target("avx2")))
+			static Type eq(Type a, Type b) { return _mm256_cmpeq_epi8(a, b); }
+			__attribute__((target("avx2")))
+			static Type orOp(Type a, Type b) { return _mm256_or_si256(a, b); }
+			/** Check whether unsigned bytes are in [from, to] */
+			__attribute__((target("avx2")))
+			static Type inRange(Type a, char from, char to) {
+				return _mm256_cmpeq_epi8(_mm256_min_epu8(_mm256_max_epu8(a, set1(from)), set1(to)), a);
+			}
+			__attribute__((target("avx2")))
+			static std::uint32_t mask(Type a) {
+				return static_cast<std::uint32_t>(_mm256_movemask_epi8(a));
+			}
+			static const constexpr std::uint32_t FullMask = 0xffffffff;
+		};
+#endif
+
+		/** Match chars need to escape in json: control characters, quote and backslash */
+		struct JsonEscapeCharMatcher {
+			static bool match(unsigned char c) {
+				return c < 0x20 || c == '"' || c == '\\';
+			}
+
+			template <class V>
+			[[gnu::always_inline]] static std::uint32_t match(typename V::Type x) {
+				return V::mask(V::orOp(V::orOp(
+					V::eq(x, V::set1('"')), V::eq(x, V::set1('\\'))), V::inRange(x, 0, 0x1f)));
+			}
+		};
+
+		/** Match chars end the plain part of json string: control characters, quote, backslash and non ascii */
+		struct JsonStringSpecialCharMatcher {
+			static bool match(unsigned char c) {
+				return c < 0x20 || c >= 0x80 || c == '"' || c == '\\';
+			}
+
+			template <class V>
+			[[gnu::always_inline]] static std::uint32_t match(typename V::Type x) {
+				return (~V::mask(V::inRange(x, 0x20, 0x7f)) & V::FullMask) |
+					V::mask(V::orOp(V::eq(x, V::set1('"')), V::eq(x, V::set1('\\'))));
+			}
+		};
+
+		/** Match chars other than json whitespace: space, \t, \n and \r */
+		struct JsonNonWhitespaceCharMatcher {
+			static bool match(unsigned char c) {
+				return !(c == ' ' || c == '\t' || c == '\n' || c == '\r');
+			}
+
+			template <class V>
+			[[gnu::always_inline]] static std::uint32_t match(typename V::Type x) {
+				return ~V::mask(V::orOp(V::orOp(V::orOp(
+					V::eq(x, V::set1(' ')), V::eq(x, V::set1('\t'))),
+					V::eq(x, V::set1('\n'))), V::eq(x, V::set1('\r')))) & V::FullMask;
+			}
+		};
+
+		/** Match chars need to escape in html: & < > " ' */
+		struct HtmlEscapeCharMatcher {
+			static bool match(unsigned char c) {
+				return c == '&' || c == '<' || c == '>' || c == '"' || c == '\'';
+			}
+
+			template <class V>
+			[[gnu::always_inline]] static std::uint32_t match(typename V::Type x) {
+				return V::mask(V::orOp(V::orOp(V::orOp(V::orOp(
+					V::eq(x, V::set1('&')), V::eq(x, V::set1('<'))),
+					V::eq(x, V::set1('>'))), V::eq(x, V::set1('"'))), V::eq(x, V::set1('\''))));
+			}
+		};
+
+		/** Match chars need to escape in url: all chars except alphanumeric and - . / _ ~ */
+		struct UrlEscapeCharMatcher {
+			static bool match(unsigned char c) {
+				return !((c >= '-' && c <= '9') || (c >= 'A' && c <= 'Z') ||
+					(c >= 'a' && c <= 'z') || c == '_' || c == '~');
+			}
+
+			template <class V>
+			[[gnu::always_inline]] static std::uint32_t match(typename V::Type x) {
+				// '-', '.', '/' and '0' ~ '9' are continuous
+				return ~V::mask(V::orOp(V::orOp(V::orOp(V::orOp(
+					V::inRange(x, '-', '9'), V::inRange(x, 'A', 'Z')),
+					V::inRange(x, 'a', 'z')), V::eq(x, V::set1('_'))), V::eq(x, V::set1('~')))) &
+					V::FullMask;
+			}
+		};
+
+		/** Match chars end a key or value in url encoded form, or require decoding: & = % + */
+		struct FormDelimiterCharMatcher {
+			static bool match(unsigned char c) {
+				return c == '&' || c == '=' || c == '%' || c == '+';
+			}
+
+			template <class V>
+			[[gnu::always_inline]] static std::uint32_t match(typename V::Type x) {
+				return V::mask(V::orOp(V::orOp(V::orOp(
+					V::eq(x, V::set1('&')), V::eq(x, V::set1('='))),
+					V::eq(x, V::set1('%'))), V::eq(x, V::set1('+'))));
+			}
+		};
+
+		/**
+		 * Find the first char matched by Matcher in [begin, end), return end if not found.
+		 * It checks 16 bytes at a time if sse2 is available.
+		 */
+		template <class Matcher>
+		const char* findFirstEscapeCharGeneric(const char* begin, const char* end) {
+			const char* ptr = begin;
+#if defined(__SSE2__)
+			for (; static_cast<std::size_t>(end - ptr) >= SimdVector128::Size; ptr += SimdVector128::Size) {
+				std::uint32_t mask = Matcher::template match<SimdVector128>(SimdVector128::load(ptr));
+				if (mask != 0) {
+					return ptr + __builtin_ctz(mask);
+				}
+			}
+#endif
+			for (; ptr < end; ++ptr) {
+				if (Matcher::match(static_cast<unsigned char>(*ptr))) {
+					return ptr;
+				}
+			}
+			return end;
+		}
+
+#if defined(CPV_ESCAPE_CHAR_SCANNER_AVX2)
+		/**
+		 * Find the first char matched by Matcher in [begin, end), return end if not found.
+		 * It checks 32 bytes at a time, the cpu must support avx2.
+		 */
+		template <class Matcher>
+		__attribute__((target("avx2")))
+		const char* findFirstEscapeCharAvx2(const char* begin, const char* end) {
+			const char* ptr = begin;
+			for (; static_cast<std::size_t>(end - ptr) >= SimdVector256::Size; ptr += SimdVector256::Size) {
+				std::uint32_t mask = Matcher::template match<SimdVector256>(SimdVector256::load(ptr));
+				if (mask != 0) {
+					return ptr + __builtin_ctz(mask);
+				}
+			}
+			return findFirstEscapeCharGeneric<Matcher>(ptr, end);
+		}
+#endif
+
+		/**
+		 * Find the first char matched by Matcher (usually the char need to escape)
+		 * in [begin, end), return end if not found.
+		 * It checks 32 bytes (avx2, detected at runtime) or 16 bytes (sse2) at a time if available.
+		 */
+		template <class Matcher>
+		const char* findFirstEscapeChar(const char* begin, const char* end) {
+#if defined(CPV_ESCAPE_CHAR_SCANNER_AVX2)
+			if (EscapeCharScannerUseAvx2) {
+				return findFirstEscapeCharAvx2<Matcher>(begin, end);
+			}
+#endif
+			return findFirstEscapeCharGeneric<Matcher>(begin, end);
+		}
+
+		/**
+		 * Encode string by mapping, chars matched by Matcher must be the chars changed by mapping,
+		 * return original string if no char need to escape.
+		 * Unchanged parts are copied by memcpy, and only chars from the first hit are checked again.
+		 */
+		template <class Matcher>
+		SharedString encodeByMapping(SharedString&& str, const EscapeCharMapping& mapping) {
+			const char* begin = str.begin();
+			const char* end = str.end();
+			const char* first = findFirstEscapeChar<Matcher>(begin, end);
+			if (CPV_LIKELY(first == end)) {
+				// no change, return original string
+				return std::move(str);
+			}
+			std::size_t encodedSize = str.size();
+			for (const char* ptr = first; ptr != end; ptr = findFirstEscapeChar<Matcher>(ptr + 1, end)) {
+				encodedSize += mapping[static_cast<unsigned char>(*ptr)].size() - 1;
+			}
+			SharedString buf(encodedSize);
+			char* dst = buf.data();
+			const char* src = begin;
+			for (const char* ptr = first; ; ptr = findFirstEscapeChar<Matcher>(ptr + 1, end)) {
+				std::memcpy(dst, src, ptr - src);
+				dst += ptr - src;
+				if (ptr == end) {
+					break;
+				}
+				auto mapped = mapping[static_cast<unsigned char>(*ptr)];
+				std::memcpy(dst, mapped.data(), mapped.size());
+				dst += mapped.size();
+				src = ptr + 1;
+			}
+			return buf;
+		}
+	}
+}
+
+#if defined(CPV_ESCAPE_CHAR_SCANNER_AVX2)
+#pragma GCC diagnostic pop
+#endif
@@ -20,7 +20,7 @@ namespace cpv {
 		 */
 		const constexpr std::array<std::string_view, std::numeric_limits<unsigned char>::max() + 1>
 			HtmlEncodeMapping = {
-			"\x00", // '\x00'
+			std::string_view("\x00", 1), // '\x00'
 			"\x01", // '\x01'
 			"\x02", // '\x02'
 			"\x03", // '\x03'
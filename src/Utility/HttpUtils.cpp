@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstring>
 #include <CPVFramework/Utility/HttpUtils.hpp>
 #include <CPVFramework/Utility/Macros.hpp>
@@ -6,31 +7,13 @@
 #include "./HttpUtils.HtmlEncodeMapping.hpp"
 #include "./HttpUtils.HtmlEntitiesMapping.hpp"
 #include "./HttpUtils.MimeMapping.hpp"
+#include "./EscapeCharScanner.hpp"
 
 namespace cpv {
 	/** Encode string for use in url */
 	SharedString urlEncode(SharedString&& str) {
-		std::size_t encodedSize = 0;
-		for (char c : str) {
-			encodedSize += UrlEncodeMapping[static_cast<unsigned char>(c)].size();
-		}
-		if (encodedSize == str.size()) {
-			// no change, return original string
-			// notice space will not convert to +, so we can sure by checking encoded size
-			return std::move(str);
-		}
-		SharedString buf(encodedSize);
-		char* dst = buf.data();
-		for (char c : str) {
-			auto mapped = UrlEncodeMapping[static_cast<unsigned char>(c)];
-			if (CPV_LIKELY(mapped.size() == 1)) {
-				*dst++ = c;
-			} else {
-				std::memcpy(dst, mapped.data(), mapped.size());
-				dst += mapped.size();
-			}
-		}
-		return buf;
+		// notice space will not convert to +, so chars not matched are unchanged
+		return encodeByMapping<UrlEscapeCharMatcher>(std::move(str), UrlEncodeMapping);
 	}
 
 	/** Decode string from url parts */
@@ -73,26 +56,7 @@ namespace cpv {
 
 	/** Encode string for use in html */
 	SharedString htmlEncode(SharedString&& str) {
-		std::size_t encodedSize = 0;
-		for (char c : str) {
-			encodedSize += HtmlEncodeMapping[static_cast<unsigned char>(c)].size();
-		}
-		if (encodedSize == str.size()) {
-			// no change, return original string
-			return std::move(str);
-		}
-		SharedString buf(encodedSize);
-		char* dst = buf.data();
-		for (char c : str) {
-			auto mapped = HtmlEncodeMapping[static_cast<unsigned char>(c)];
-			if (CPV_LIKELY(mapped.size() == 1)) {
-				*dst++ = c;
-			} else {
-				std::memcpy(dst, mapped.data(), mapped.size());
-				dst += mapped.size();
-			}
-		}
-		return buf;
+		return encodeByMapping<HtmlEscapeCharMatcher>(std::move(str), HtmlEncodeMapping);
 	}
 
 	/** Decode string from html content */
@@ -180,5 +144,119 @@ namespace cpv {
 		}
 		return "application/octet-stream";
 	}
-}
 
+	/** Check whether content of mime type is worth compressing */
+	bool isCompressibleMimeType(std::string_view mimeType) {
+		static const constexpr std::string_view CompressibleApplicationTypes[] = {
+			"application/javascript",
+			"application/json",
+			"application/xml",
+			"application/xhtml+xml",
+			"application/rss+xml",
+			"application/atom+xml",
+			"application/manifest+json",
+			"application/wasm",
+			"image/svg+xml",
+			"image/x-icon",
+			"font/ttf",
+			"font/otf",
+		};
+		// ignore parameters like "; charset=utf-8"
+		mimeType = trimString(mimeType.substr(0, mimeType.find_first_of(';')));
+		if (startsWith(mimeType, "text/")) {
+			return true;
+		}
+		for (std::string_view type : CompressibleApplicationTypes) {
+			if (caseInsensitiveEquals(mimeType, type)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	namespace {
+		/** Get q-value from parameters like ";q=0.8", return q-value multiplied by 1000 */
+		std::size_t parseQualityParameters(std::string_view parameters) {
+			std::size_t value = 1000;
+			splitString(parameters, [&value] (std::string_view param, std::size_t) {
+				param = trimString(param);
+				if (param.size() < 2 || (param[0] != 'q' && param[0] != 'Q') || param[1] != '=') {
+					return;
+				}
+				// qvalue = ( "0" [ "." 0*3DIGIT ] ) / ( "1" [ "." 0*3("0") ] )
+				std::string_view qvalue = param.substr(2);
+				if (qvalue.empty() || qvalue.size() > 5 || (qvalue[0] != '0' && qvalue[0] != '1') ||
+					(qvalue.size() > 1 && qvalue[1] != '.')) {
+					value = 0;
+					return;
+				}
+				value = (qvalue[0] == '1') ? 1000 : 0;
+				std::size_t scale = 100;
+				for (std::size_t i = 2; i < qvalue.size(); ++i, scale /= 10) {
+					if (qvalue[i] < '0' || qvalue[i] > '9') {
+						value = 0;
+						return;
+					}
+					value += static_cast<std::size_t>(qvalue[i] - '0') * scale;
+				}
+				value = std::min<std::size_t>(value, 1000);
+			}, ';');
+			return value;
+		}
+	}
+
+	/** Get quality of content coding from Accept-Encoding header */
+	std::size_t getAcceptEncodingQuality(std::string_view acceptEncoding, std::string_view coding) {
+		std::size_t quality = 0;
+		std::size_t wildcardQuality = 0;
+		bool matched = false;
+		bool wildcardMatched = false;
+		splitString(acceptEncoding, [&] (std::string_view part, std::size_t) {
+			// part example: gzip;q=0.8
+			std::size_t semicolonPos = part.find_first_of(';');
+			std::string_view name = trimString(part.substr(0, semicolonPos));
+			bool isWildcard = (name == "*");
+			if (matched || (!isWildcard && !caseInsensitiveEquals(name, coding))) {
+				return;
+			}
+			std::size_t value = (semicolonPos != part.npos) ?
+				parseQualityParameters(part.substr(semicolonPos + 1)) : 1000;
+			if (isWildcard) {
+				wildcardQuality = value;
+				wildcardMatched = true;
+			} else {
+				quality = value;
+				matched = true;
+			}
+		}, ',');
+		return matched ? quality : (wildcardMatched ? wildcardQuality : 0);
+	}
+
+	/** Get quality of mime type from Accept header */
+	std::size_t getAcceptMimeTypeQuality(std::string_view accept, std::string_view mimeType) {
+		// the most specific media range wins: exact type, then wildcard subtype, then full wildcard
+		std::size_t quality = 0;
+		std::size_t matchedLevel = 0;
+		std::string_view type = mimeType.substr(0, mimeType.find_first_of('/'));
+		splitString(accept, [&] (std::string_view part, std::size_t) {
+			// part example: application/json;q=0.8
+			std::size_t semicolonPos = part.find_first_of(';');
+			std::string_view range = trimString(part.substr(0, semicolonPos));
+			std::size_t level = 0;
+			if (caseInsensitiveEquals(range, mimeType)) {
+				level = 3;
+			} else if (range.size() == type.size() + 2 && endsWith(range, "/*") &&
+				caseInsensitiveEquals(range.substr(0, type.size()), type)) {
+				level = 2;
+			} else if (range == "*/*") {
+				level = 1;
+			}
+			if (level > matchedLevel) {
+				matchedLevel = level;
+				quality = (semicolonPos != part.npos) ?
+					parseQualityParameters(part.substr(semicolonPos + 1)) : 1000;
+			}
+		}, ',');
+		return quality;
+	}
+}
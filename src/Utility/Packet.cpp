@@ -7,6 +7,14 @@ namespace cpv {
 	thread_local ReusableStorageType<Packet::MultipleFragments>
 		ReusableStorageInstance<Packet::MultipleFragments>;
 
+	/** Allocate new scratch block, the remaining space of previous block is discarded */
+	void Packet::MultipleFragments::allocateScratch() {
+		SharedString block(ScratchBlockSize);
+		scratchPtr = block.data();
+		scratchEnd = scratchPtr + block.size();
+		deleter.append(block.release());
+	}
+
 	/** Get MultipleFragments, or convert to MultipleFragments if it's not */
 	Packet::MultipleFragments& Packet::getOrConvertToMultiple() & {
 		if (auto ptr = getIfMultiple()) {
@@ -59,6 +67,7 @@ namespace cpv {
 					otherFragments.begin(), otherFragments.end());
 				thisPtr->deleter.append(std::move(otherPtr->deleter));
 				otherFragments.clear();
+				otherPtr->resetScratch();
 			} else if (auto otherPtr = other.getIfSingle()) {
 				// append single to multiple
 				auto& thisFragments = thisPtr->fragments;
@@ -1,24 +1,50 @@
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
 #include <CPVFramework/Utility/SharedStringBuilder.hpp>
 
 namespace cpv {
 	namespace {
-		/** Get max string size of integer, doesn't include zero terminator */
-		template <class IntType>
-		constexpr std::size_t getMaxStringSize(std::size_t base) {
-			IntType max = std::numeric_limits<IntType>::max();
-			std::size_t result = 1; // the first digit
-			if (std::numeric_limits<IntType>::is_signed) {
-				++result; // the sign
-			} 
-			while (static_cast<std::make_unsigned_t<IntType>>(max) >= base) {
-				++result;
-				max /= base;
+		/** For appending integer, two digits for each number in [0, 100) */
+		static const char DecimalDigitPairs[] =
+			"0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+			"5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+		/** Get the number of decimal digits of unsigned integer */
+		std::size_t countDecimalDigits(std::uintmax_t value) {
+			std::size_t count = 1;
+			for (;;) {
+				if (value < 10) {
+					return count;
+				} else if (value < 100) {
+					return count + 1;
+				} else if (value < 1000) {
+					return count + 2;
+				} else if (value < 10000) {
+					return count + 3;
+				}
+				value /= 10000U;
+				count += 4;
+			}
+		}
+
+		/** Write decimal digits of unsigned integer backward from end, two digits at a time */
+		template <class CharType>
+		void writeDecimalDigits(CharType* end, std::uintmax_t value) {
+			while (value >= 100) {
+				std::size_t index = static_cast<std::size_t>(value % 100) * 2;
+				value /= 100;
+				*--end = static_cast<CharType>(DecimalDigitPairs[index + 1]);
+				*--end = static_cast<CharType>(DecimalDigitPairs[index]);
+			}
+			if (value >= 10) {
+				std::size_t index = static_cast<std::size_t>(value) * 2;
+				*--end = static_cast<CharType>(DecimalDigitPairs[index + 1]);
+				*--end = static_cast<CharType>(DecimalDigitPairs[index]);
+			} else {
+				*--end = static_cast<CharType>('0' + value);
 			}
-			return result;
 		}
-		
-		/** For appending integer */
-		static const char DecimalDigits[] = "0123456789";
 
 		/** Remove tailing zero for string converted from double and append to builder */
 		template <class CharType>
@@ -50,19 +76,15 @@ namespace cpv {
 	template <class CharType>
 	BasicSharedStringBuilder<CharType>&
 		BasicSharedStringBuilder<CharType>::appendImpl(std::intmax_t value) {
-		static const constexpr std::size_t MaxSize = getMaxStringSize<std::intmax_t>(10);
-		CharType* ptr = grow(MaxSize);
+		// negate in unsigned type to avoid overflow for the min value
+		std::uintmax_t absValue = value < 0 ?
+			0 - static_cast<std::uintmax_t>(value) : static_cast<std::uintmax_t>(value);
+		std::size_t digits = countDecimalDigits(absValue);
+		CharType* ptr = grow(digits + (value < 0 ? 1 : 0));
 		if (value < 0) {
 			*ptr++ = '-';
 		}
-		CharType* ptrStart = ptr;
-		do {
-			int rem = value % 10;
-			value /= 10;
-			*ptr++ = static_cast<CharType>(DecimalDigits[rem >= 0 ? rem : -rem]);
-		} while (value != 0);
-		std::reverse(ptrStart, ptr);
-		size_ = static_cast<std::size_t>(ptr - buffer_.data());
+		writeDecimalDigits(ptr + digits, absValue);
 		return *this;
 	}
 
@@ -70,32 +92,38 @@ namespace cpv {
 	template <class CharType>
 	BasicSharedStringBuilder<CharType>&
 		BasicSharedStringBuilder<CharType>::appendImpl(std::uintmax_t value) {
-		static const constexpr std::size_t MaxSize = getMaxStringSize<std::uintmax_t>(10);
-		CharType* ptr = grow(MaxSize);
-		CharType* ptrStart = ptr;
-		do {
-			unsigned int rem = value % 10;
-			value /= 10;
-			*ptr++ = static_cast<CharType>(DecimalDigits[rem]);
-		} while (value != 0);
-		std::reverse(ptrStart, ptr);
-		size_ = static_cast<std::size_t>(ptr - buffer_.data());
+		std::size_t digits = countDecimalDigits(value);
+		writeDecimalDigits(grow(digits) + digits, value);
 		return *this;
 	}
 
-	/** Append string representation of double to end */
+	/** Append shortest string representation of double that round trips to end */
 	template <class CharType>
 	BasicSharedStringBuilder<CharType>&
 		BasicSharedStringBuilder<CharType>::appendImpl(double value) {
-		// to_chars for float is not available in gcc 9, use snprintf now
-		thread_local static std::array<char, 512> buffer;
-		int size = std::snprintf(buffer.data(), buffer.size(), "%lf", value);
-		if (CPV_LIKELY(size > 0)) {
-			trimTailingZeroAndAppend(*this, buffer.data(), size);
-		} else {
-			std::string str = std::to_string(value);
-			trimTailingZeroAndAppend(*this, str.data(), str.size());
+		static_assert(sizeof(CharType) == 1, "size of char type must be 1");
+		// the longest one is like -2.2250738585072014e-308
+		static const constexpr std::size_t MaxSize = 32;
+		std::size_t oldSize = size_;
+		char* ptr = reinterpret_cast<char*>(grow(MaxSize));
+#if defined(__cpp_lib_to_chars)
+		auto result = std::to_chars(ptr, ptr + MaxSize, value);
+		if (CPV_LIKELY(result.ec == std::errc())) {
+			size_ = oldSize + static_cast<std::size_t>(result.ptr - ptr);
+			return *this;
+		}
+#endif
+		// to_chars for float is not available in gcc 9,
+		// use the shortest precision of snprintf that round trips
+		int size = 0;
+		for (int precision = std::numeric_limits<double>::digits10;
+			precision <= std::numeric_limits<double>::max_digits10; ++precision) {
+			size = std::snprintf(ptr, MaxSize, "%.*g", precision, value);
+			if (size > 0 && std::strtod(ptr, nullptr) == value) {
+				break;
+			}
 		}
+		size_ = oldSize + static_cast<std::size_t>(std::max(size, 0));
 		return *this;
 	}
 
@@ -96,7 +96,7 @@ namespace cpv {
 			} else if (c == '&') {
 				if (state == UriParserState::Query) {
 					// end of value
-					queryParameters_.insert_or_assign(
+					queryParameters_.appendUnsorted(
 						std::move(queryKey), urlDecode(uri.share(
 							{ mark, static_cast<std::size_t>(ptr - mark) })));
 					mark = ptr + 1;
@@ -154,11 +154,13 @@ namespace cpv {
 				port_ = uri.share({ mark, static_cast<std::size_t>(ptr - mark) });
 			} else if (state == UriParserState::Query) {
 				// ends with query value
-				queryParameters_.insert_or_assign(
+				queryParameters_.appendUnsorted(
 					std::move(queryKey), urlDecode(uri.share(
 						{ mark, static_cast<std::size_t>(ptr - mark) })));
 			}
 		}
+		// query parameters are appended in order of appearance, sort them at once
+		queryParameters_.sortAndDeduplicate();
 		if (state == UriParserState::Path) {
 			// ends with path, path may be "/" so don't put this inside if (ptr > mark)
 			path_ = urlDecode(uri.share(
@@ -0,0 +1,183 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <CPVFramework/Allocators/ArenaAllocator.hpp>
+#include <CPVFramework/Allocators/StackAllocator.hpp>
+#include <CPVFramework/Testing/GTestUtils.hpp>
+
+TEST(Arena, allocate) {
+	cpv::Arena arena(256);
+	ASSERT_EQ(arena.blockCount(), 0U);
+	char* a = arena.allocate<char>(3);
+	std::uint64_t* b = arena.allocate<std::uint64_t>(2);
+	ASSERT_EQ(arena.blockCount(), 1U);
+	ASSERT_EQ(reinterpret_cast<std::uintptr_t>(b) % alignof(std::uint64_t), 0U);
+	ASSERT_GT(static_cast<void*>(b), static_cast<void*>(a));
+	ASSERT_LT(reinterpret_cast<char*>(b) - a, 16);
+	void* c = arena.allocate(64, 64);
+	ASSERT_EQ(reinterpret_cast<std::uintptr_t>(c) % 64, 0U);
+	// allocate new block if space not enough
+	arena.allocate<char>(200);
+	ASSERT_EQ(arena.blockCount(), 2U);
+	// large allocation takes a dedicated block
+	char* large = arena.allocate<char>(1000);
+	std::memset(large, 0, 1000);
+	ASSERT_EQ(arena.blockCount(), 3U);
+}
+
+TEST(Arena, reset) {
+	cpv::Arena arena(256);
+	char* first = arena.allocate<char>(100);
+	arena.allocate<char>(200);
+	arena.allocate<char>(1000);
+	ASSERT_EQ(arena.blockCount(), 3U);
+	// the first block is kept for reuse
+	arena.reset();
+	ASSERT_EQ(arena.blockCount(), 1U);
+	ASSERT_EQ(arena.allocate<char>(100), first);
+	ASSERT_EQ(arena.blockCount(), 1U);
+	arena.reset();
+	ASSERT_EQ(arena.blockCount(), 1U);
+	// the first block is not kept if it's a dedicated large block
+	cpv::Arena arenaLarge(256);
+	arenaLarge.allocate<char>(1000);
+	arenaLarge.reset();
+	ASSERT_EQ(arenaLarge.blockCount(), 0U);
+}
+
+TEST(Arena, move) {
+	cpv::Arena arena(256);
+	arena.allocate<char>(1);
+	cpv::Arena arenaMove(std::move(arena));
+	ASSERT_EQ(arena.blockCount(), 0U);
+	ASSERT_EQ(arenaMove.blockCount(), 1U);
+	cpv::Arena arenaMoveAssign;
+	arenaMoveAssign.allocate<char>(1);
+	arenaMoveAssign = std::move(arenaMove);
+	ASSERT_EQ(arenaMove.blockCount(), 0U);
+	ASSERT_EQ(arenaMoveAssign.blockCount(), 1U);
+	arena.allocate<char>(1);
+	ASSERT_EQ(arena.blockCount(), 1U);
+}
+
+TEST(Arena, string) {
+	cpv::Arena arena;
+	cpv::SharedString a = arena.copyString("abc");
+	cpv::SharedString b = arena.allocateString(3);
+	std::memcpy(b.data(), "def", 3);
+	cpv::SharedString c = arena.copyString("");
+	ASSERT_EQ(a, "abc");
+	ASSERT_EQ(b, "def");
+	ASSERT_EQ(c, "");
+	ASSERT_EQ(a.data() + 3, b.data());
+	ASSERT_EQ(arena.blockCount(), 1U);
+}
+
+TEST(Arena, stringOutlivesReset) {
+	cpv::Arena arena(256);
+	char* first = arena.allocate<char>(1);
+	cpv::SharedString a = arena.copyString("abc");
+	cpv::SharedString b = a.share();
+	arena.allocate<char>(1000);
+	ASSERT_EQ(arena.blockCount(), 2U);
+	// blocks are handed over to alive strings, and arena starts from scratch
+	arena.reset();
+	ASSERT_EQ(arena.blockCount(), 0U);
+	cpv::SharedString c = arena.copyString("def");
+	ASSERT_EQ(a, "abc");
+	ASSERT_EQ(b, "abc");
+	ASSERT_EQ(c, "def");
+	ASSERT_NE(a.data(), c.data());
+	a = {};
+	ASSERT_EQ(b, "abc");
+	b = {};
+	// the first block is kept for reuse if no string alive
+	c = {};
+	arena.reset();
+	ASSERT_EQ(arena.blockCount(), 1U);
+	first = arena.allocate<char>(1);
+	arena.reset();
+	ASSERT_EQ(arena.allocate<char>(1), first);
+	// strings outlive the arena
+	{
+		cpv::Arena scoped(256);
+		a = scoped.copyString("abc");
+	}
+	ASSERT_EQ(a, "abc");
+}
+
+TEST(ArenaAllocator, vector) {
+	cpv::Arena arena;
+	{
+		std::vector<std::string, cpv::ArenaAllocator<std::string>> vec(
+			(cpv::ArenaAllocator<std::string>(arena)));
+		for (std::size_t i = 0; i < 100; ++i) {
+			vec.emplace_back(std::to_string(i));
+		}
+		ASSERT_EQ(vec.at(99), "99");
+		ASSERT_EQ(arena.blockCount(), 2U);
+	}
+	{
+		// without arena
+		std::vector<int, cpv::ArenaAllocator<int>> vec;
+		vec.emplace_back(1);
+		ASSERT_EQ(vec.at(0), 1);
+		ASSERT_TRUE(vec.get_allocator().arena() == nullptr);
+	}
+	ASSERT_TRUE(cpv::ArenaAllocator<int>(arena) == cpv::ArenaAllocator<char>(arena));
+	ASSERT_TRUE(cpv::ArenaAllocator<int>(arena) != cpv::ArenaAllocator<int>());
+}
+
+TEST(ArenaAllocator, stackAllocated) {
+	cpv::Arena arena(256);
+	{
+		cpv::StackAllocatedVector<int, 4, cpv::ArenaAllocator<int>> vec(
+			(cpv::ArenaAllocator<int>(arena)));
+		for (int i = 0; i < 4; ++i) {
+			vec.emplace_back(i);
+		}
+		// initial elements are stored in the container itself
+		ASSERT_EQ(arena.blockCount(), 0U);
+		vec.emplace_back(4);
+		ASSERT_EQ(arena.blockCount(), 1U);
+		ASSERT_EQ(vec.at(4), 4);
+		auto vecCopy = vec;
+		ASSERT_EQ(vecCopy.size(), 5U);
+		ASSERT_EQ(vecCopy.get_allocator().upstream().arena(), &arena);
+		auto vecMoved = std::move(vecCopy);
+		ASSERT_EQ(vecMoved.size(), 5U);
+		ASSERT_EQ(vecMoved.get_allocator().upstream().arena(), &arena);
+	}
+	{
+		using MapType = cpv::StackAllocatedMap<int, int, 2,
+			std::less<int>, cpv::ArenaAllocator<std::pair<const int, int>>>;
+		MapType map((cpv::ArenaAllocator<std::pair<const int, int>>(arena)));
+		for (int i = 0; i < 10; ++i) {
+			map.emplace(i, i * 2);
+		}
+		ASSERT_EQ(map.at(9), 18);
+		auto mapCopy = map;
+		ASSERT_EQ(mapCopy.at(9), 18);
+		ASSERT_EQ(mapCopy.get_allocator().upstream().arena(), &arena);
+		auto mapMoved = std::move(mapCopy);
+		ASSERT_EQ(mapMoved.at(9), 18);
+		ASSERT_EQ(mapMoved.get_allocator().upstream().arena(), &arena);
+	}
+	{
+		using MapType = cpv::StackAllocatedUnorderedMap<int, int, 2,
+			std::hash<int>, std::equal_to<int>, cpv::ArenaAllocator<std::pair<const int, int>>>;
+		MapType map((cpv::ArenaAllocator<std::pair<const int, int>>(arena)));
+		for (int i = 0; i < 10; ++i) {
+			map.emplace(i, i * 2);
+		}
+		ASSERT_EQ(map.at(9), 18);
+		auto mapCopy = map;
+		ASSERT_EQ(mapCopy.at(9), 18);
+		ASSERT_EQ(mapCopy.get_allocator().upstream().arena(), &arena);
+		auto mapMoved = std::move(mapCopy);
+		ASSERT_EQ(mapMoved.at(9), 18);
+		ASSERT_EQ(mapMoved.get_allocator().upstream().arena(), &arena);
+		mapMoved.clear();
+		ASSERT_EQ(mapMoved.get_allocator().upstream().arena(), &arena);
+	}
+}
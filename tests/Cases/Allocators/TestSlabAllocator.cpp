@@ -0,0 +1,65 @@
+#include <CPVFramework/Allocators/SlabAllocator.hpp>
+#include <CPVFramework/Utility/SharedString.hpp>
+#include <CPVFramework/Testing/GTestUtils.hpp>
+
+TEST(SlabAllocator, reuseBlock) {
+	void* first = nullptr;
+	{
+		seastar::deleter deleter;
+		first = cpv::SlabAllocator::allocate(20, deleter);
+		ASSERT_EQ(reinterpret_cast<std::uintptr_t>(first) % 16, 0U);
+		std::memset(first, 'a', 20);
+	}
+	std::size_t freeCount = cpv::SlabAllocator::freeBlockCount();
+	ASSERT_GE(freeCount, 1U);
+	{
+		// same size class (17~32)
+		seastar::deleter deleter;
+		void* second = cpv::SlabAllocator::allocate(32, deleter);
+		ASSERT_EQ(first, second);
+		ASSERT_EQ(cpv::SlabAllocator::freeBlockCount(), freeCount - 1);
+	}
+	ASSERT_EQ(cpv::SlabAllocator::freeBlockCount(), freeCount);
+	{
+		// different size class
+		seastar::deleter deleter;
+		void* third = cpv::SlabAllocator::allocate(33, deleter);
+		ASSERT_NE(first, third);
+	}
+}
+
+TEST(SlabAllocator, largeSize) {
+	std::size_t freeCount = cpv::SlabAllocator::freeBlockCount();
+	{
+		seastar::deleter deleter;
+		void* ptr = cpv::SlabAllocator::allocate(cpv::SlabAllocator::MaxBlockSize + 1, deleter);
+		std::memset(ptr, 'a', cpv::SlabAllocator::MaxBlockSize + 1);
+	}
+	ASSERT_EQ(cpv::SlabAllocator::freeBlockCount(), freeCount);
+}
+
+TEST(SlabAllocator, sharedAndAppendedDeleter) {
+	cpv::SharedString str(std::string_view("shared string from slab"));
+	const char* ptr = str.data();
+	std::size_t freeCount = cpv::SlabAllocator::freeBlockCount();
+	{
+		cpv::SharedString shared = str.share();
+		str = cpv::SharedString();
+		ASSERT_EQ(cpv::SlabAllocator::freeBlockCount(), freeCount);
+		// block should be kept alive by the chained deleter
+		seastar::deleter chained = seastar::make_free_deleter(std::malloc(1));
+		chained.append(shared.release());
+		ASSERT_EQ(cpv::SlabAllocator::freeBlockCount(), freeCount);
+	}
+	ASSERT_EQ(cpv::SlabAllocator::freeBlockCount(), freeCount + 1);
+	cpv::SharedString reused(std::string_view("reused string from slab"));
+	ASSERT_EQ(reused.data(), ptr);
+	ASSERT_EQ(reused, "reused string from slab");
+}
+
+TEST(SlabAllocator, emptyString) {
+	std::size_t freeCount = cpv::SlabAllocator::freeBlockCount();
+	cpv::SharedString str(std::size_t(0));
+	ASSERT_TRUE(str.empty());
+	ASSERT_EQ(cpv::SlabAllocator::freeBlockCount(), freeCount);
+}
@@ -102,3 +102,57 @@ TEST(HttpForm, buildUrlEncoded) {
 		"key%201=value%201&key_2=value_2&key_2=%E4%B8%80%E4%BA%8C%E4%B8%89");
 }
 
+TEST(HttpForm, parseUrlEncodedSorted) {
+	{
+		cpv::HttpForm form;
+		form.parseUrlEncoded("c=1&a=2&b=3&a=4&c=5&a=6");
+		auto& parameters = form.getAll();
+		ASSERT_EQ(parameters.size(), 3U);
+		ASSERT_EQ(parameters.at(0).first, "a");
+		ASSERT_EQ(parameters.at(1).first, "b");
+		ASSERT_EQ(parameters.at(2).first, "c");
+		ASSERT_EQ(form.getMany("a").size(), 3U);
+		ASSERT_EQ(form.getMany("a").at(0), "2");
+		ASSERT_EQ(form.getMany("a").at(1), "4");
+		ASSERT_EQ(form.getMany("a").at(2), "6");
+		ASSERT_EQ(form.getMany("c").at(0), "1");
+		ASSERT_EQ(form.getMany("c").at(1), "5");
+	}
+	{
+		// merge with existing parameters
+		cpv::HttpForm form;
+		form.add("b", "0");
+		form.parseUrlEncoded("c=1&b=2&a=3");
+		auto& parameters = form.getAll();
+		ASSERT_EQ(parameters.size(), 3U);
+		ASSERT_EQ(parameters.at(0).first, "a");
+		ASSERT_EQ(form.getMany("b").size(), 2U);
+		ASSERT_EQ(form.getMany("b").at(0), "0");
+		ASSERT_EQ(form.getMany("b").at(1), "2");
+		form.remove("b");
+		ASSERT_EQ(parameters.size(), 2U);
+		ASSERT_TRUE(form.getMany("b").empty());
+	}
+}
+
+TEST(HttpForm, parseUrlEncodedZeroCopy) {
+	// plain keys and values share the storage of body, only encoded ones are decoded
+	cpv::SharedString body(std::string_view(
+		"key_a=value_a_which_is_longer_than_sixteen_bytes&key%20b=value+b&key_c=%E4%B8%80"));
+	cpv::HttpForm form(body);
+	ASSERT_EQ(form.getAll().size(), 3U);
+	ASSERT_EQ(form.get("key_a"), "value_a_which_is_longer_than_sixteen_bytes");
+	ASSERT_EQ(form.get("key b"), "value b");
+	ASSERT_EQ(form.get("key_c"), "一");
+	auto isShared = [&body] (const cpv::SharedString& str) {
+		return str.data() >= body.data() && str.data() < body.data() + body.size();
+	};
+	ASSERT_EQ(form.getAll().at(0).first, "key b");
+	ASSERT_FALSE(isShared(form.getAll().at(0).first));
+	ASSERT_FALSE(isShared(form.get("key b")));
+	ASSERT_TRUE(isShared(form.getAll().at(1).first));
+	ASSERT_TRUE(isShared(form.get("key_a")));
+	ASSERT_TRUE(isShared(form.getAll().at(2).first));
+	ASSERT_FALSE(isShared(form.get("key_c")));
+}
+
@@ -0,0 +1,135 @@
+#include <CPVFramework/Exceptions/DeserializeException.hpp>
+#include <CPVFramework/Http/HttpMultipartParser.hpp>
+#include <CPVFramework/Testing/GTestUtils.hpp>
+
+namespace {
+	static const char Boundary[] = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
+	static const char Body[] =
+		"preamble should be ignored\r\n"
+		"------WebKitFormBoundary7MA4YWxkTrZu0gW\r\n"
+		"Content-Disposition: form-data; name=\"field_a\"\r\n"
+		"\r\n"
+		"value a\r\n"
+		"------WebKitFormBoundary7MA4YWxkTrZu0gW\r\n"
+		"content-disposition: form-data; name=\"file\"; filename=\"a;\\\"b\\\".txt\"\r\n"
+		"Content-Type: text/plain\r\n"
+		"\r\n"
+		"line 1\r\n"
+		"line 2 with \r\n------WebKitFormBoundary not matched\r\n"
+		"------WebKitFormBoundary7MA4YWxkTrZu0gW  \r\n"
+		"\r\n"
+		"part without headers\r\n"
+		"------WebKitFormBoundary7MA4YWxkTrZu0gW--\r\n"
+		"epilogue should be ignored";
+
+	/** Parsed part for comparison */
+	struct Part {
+		cpv::HttpMultipartPartHeaders headers;
+		std::string data;
+	};
+
+	/** Feed body to parser by given chunk size and collect parts */
+	std::vector<Part> parse(std::string_view body, std::size_t chunkSize) {
+		cpv::HttpMultipartParser parser(Boundary);
+		std::vector<Part> parts;
+		bool isInPart = false;
+		std::size_t offset = 0;
+		for (;;) {
+			auto event = parser.next();
+			if (event == cpv::HttpMultipartEvent::NeedMoreData) {
+				parser.feed(cpv::SharedString(body.substr(offset, chunkSize)));
+				offset += chunkSize;
+				if (offset >= body.size()) {
+					parser.finish();
+				}
+			} else if (event == cpv::HttpMultipartEvent::PartBegin) {
+				EXPECT_FALSE(isInPart);
+				isInPart = true;
+				parts.emplace_back();
+				auto& headers = parts.back().headers;
+				headers.name = parser.part().name.share();
+				headers.filename = parser.part().filename.share();
+				headers.contentType = parser.part().contentType.share();
+				headers.isFile = parser.part().isFile;
+			} else if (event == cpv::HttpMultipartEvent::PartData) {
+				EXPECT_TRUE(isInPart);
+				EXPECT_FALSE(parser.data().empty());
+				parts.back().data.append(parser.data().view());
+			} else if (event == cpv::HttpMultipartEvent::PartEnd) {
+				EXPECT_TRUE(isInPart);
+				isInPart = false;
+			} else {
+				EXPECT_FALSE(isInPart);
+				break;
+			}
+		}
+		return parts;
+	}
+}
+
+TEST(HttpMultipartParser, parse) {
+	// delimiter across any chunk edge should be found
+	for (std::size_t chunkSize = 1; chunkSize <= sizeof(Body); ++chunkSize) {
+		auto parts = parse(Body, chunkSize);
+		ASSERT_EQ(parts.size(), 3U);
+		ASSERT_EQ(parts.at(0).headers.name, "field_a");
+		ASSERT_FALSE(parts.at(0).headers.isFile);
+		ASSERT_EQ(parts.at(0).headers.contentType, "");
+		ASSERT_EQ(parts.at(0).data, "value a");
+		ASSERT_EQ(parts.at(1).headers.name, "file");
+		ASSERT_TRUE(parts.at(1).headers.isFile);
+		ASSERT_EQ(parts.at(1).headers.filename, "a;\"b\".txt");
+		ASSERT_EQ(parts.at(1).headers.contentType, "text/plain");
+		ASSERT_EQ(parts.at(1).data,
+			"line 1\r\nline 2 with \r\n------WebKitFormBoundary not matched");
+		ASSERT_EQ(parts.at(2).headers.name, "");
+		ASSERT_EQ(parts.at(2).data, "part without headers");
+	}
+}
+
+TEST(HttpMultipartParser, zeroCopy) {
+	cpv::SharedString body{std::string_view(Body)};
+	cpv::HttpMultipartParser parser(Boundary);
+	parser.feed(body.share());
+	parser.finish();
+	while (parser.next() != cpv::HttpMultipartEvent::PartData) { }
+	ASSERT_EQ(parser.data(), "value a");
+	ASSERT_TRUE(parser.data().data() >= body.data());
+	ASSERT_TRUE(parser.data().data() < body.data() + body.size());
+}
+
+TEST(HttpMultipartParser, getBoundary) {
+	ASSERT_EQ(cpv::HttpMultipartParser::getBoundary(
+		"multipart/form-data; boundary=abc"), "abc");
+	ASSERT_EQ(cpv::HttpMultipartParser::getBoundary(
+		"Multipart/Form-Data; charset=utf-8; boundary=\"a b;c\""), "a b;c");
+	ASSERT_EQ(cpv::HttpMultipartParser::getBoundary("multipart/form-data"), "");
+	ASSERT_EQ(cpv::HttpMultipartParser::getBoundary("text/plain; boundary=abc"), "");
+	ASSERT_EQ(cpv::HttpMultipartParser::getBoundary(cpv::SharedString(
+		"multipart/form-data; boundary=" + std::string(71, 'a'))), "");
+}
+
+TEST(HttpMultipartParser, errors) {
+	auto parseAll = [] (std::string_view body, std::size_t maxHeaderSize) {
+		cpv::HttpMultipartParser parser("abc", maxHeaderSize);
+		parser.feed(cpv::SharedString(body));
+		parser.finish();
+		while (parser.next() != cpv::HttpMultipartEvent::End) { }
+	};
+	ASSERT_THROWS_CONTAINS(cpv::DeserializeException,
+		parseAll("--abc\r\n\r\nvalue", 100), "incomplete multipart body");
+	ASSERT_THROWS_CONTAINS(cpv::DeserializeException,
+		parseAll("no delimiter", 100), "incomplete multipart body");
+	ASSERT_THROWS_CONTAINS(cpv::DeserializeException,
+		parseAll("--abcx\r\n\r\nvalue\r\n--abc--", 100), "invalid character after delimiter");
+	ASSERT_THROWS_CONTAINS(cpv::DeserializeException,
+		parseAll("--abc-x", 100), "invalid close delimiter");
+	ASSERT_THROWS_CONTAINS(cpv::DeserializeException,
+		parseAll("--abc\r\nName: " + std::string(100, 'a') + "\r\n\r\nvalue\r\n--abc--", 100),
+		"multipart headers too large");
+	ASSERT_THROWS_CONTAINS(cpv::DeserializeException,
+		cpv::HttpMultipartParser(""), "invalid size of multipart boundary");
+	parseAll("--abc\r\nName: " + std::string(50, 'a') + "\r\n\r\nvalue\r\n--abc--", 100);
+	parseAll("--abc--", 100);
+}
+
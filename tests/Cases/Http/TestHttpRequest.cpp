@@ -160,6 +160,25 @@ TEST(HttpRequest, headersAppendToHttp1Packet) {
 		"AdditionC: TestAdditionC");
 }
 
+TEST(HttpRequest, headersAppendAndSort) {
+	cpv::HttpRequest request;
+	auto& headers = request.getHeaders();
+	for (std::size_t i = 0; i < 10000; ++i) {
+		headers.appendHeader(cpv::SharedString("X-Header-" + std::to_string(10000 - i)),
+			cpv::SharedString(std::to_string(i)));
+	}
+	headers.appendHeader(cpv::constants::Host, "TestHost");
+	headers.appendHeader("X-Header-1", "last");
+	headers.sortHeaders();
+	ASSERT_EQ(headers.getHost(), "TestHost");
+	ASSERT_EQ(headers.getHeader("X-Header-10000"), "0");
+	ASSERT_EQ(headers.getHeader("X-Header-2"), "9998");
+	ASSERT_EQ(headers.getHeader("X-Header-1"), "last");
+	std::size_t count = 0;
+	headers.foreach([&count] (const auto&, const auto&) { ++count; });
+	ASSERT_EQ(count, 10001U);
+}
+
 TEST(HttpRequest, headersNotConstructible) {
 	ASSERT_FALSE(std::is_constructible_v<cpv::HttpRequestHeaders>);
 	ASSERT_FALSE(std::is_copy_constructible_v<cpv::HttpRequestHeaders>);
@@ -299,6 +318,19 @@ TEST(HttpRequest, getCookies) {
 	}
 }
 
+TEST(HttpRequest, getManyCookies) {
+	std::string cookieHeader;
+	for (std::size_t i = 0; i < 10000; ++i) {
+		cookieHeader.append("key").append(std::to_string(10000 - i)).append("=").append(std::to_string(i)).append("; ");
+	}
+	cookieHeader.append("key1=last");
+	cpv::HttpRequest request;
+	request.getHeaders().setCookie(cpv::SharedString(cookieHeader));
+	ASSERT_EQ(request.getCookies().getAll().size(), 10000U);
+	ASSERT_EQ(request.getCookies().get("key10000"), "0");
+	ASSERT_EQ(request.getCookies().get("key1"), "last");
+}
+
 TEST(HttpRequest, cookiesNotConstructible) {
 	ASSERT_FALSE(std::is_constructible_v<cpv::HttpRequestCookies>);
 	ASSERT_FALSE(std::is_copy_constructible_v<cpv::HttpRequestCookies>);
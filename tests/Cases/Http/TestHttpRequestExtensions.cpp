@@ -1,4 +1,5 @@
 #include <CPVFramework/Http/HttpRequestExtensions.hpp>
+#include <CPVFramework/Stream/PacketInputStream.hpp>
 #include <CPVFramework/Stream/StringInputStream.hpp>
 #include <CPVFramework/Testing/GTestUtils.hpp>
 
@@ -12,10 +13,46 @@ namespace {
 			return true;
 		}
 
+		bool loadMsgPack(const cpv::MsgPackValue& value) {
+			intValue << value["intValue"];
+			return true;
+		}
+
 		void loadForm(const cpv::HttpForm& form) {
 			intValue = form.get("intValue").toInt().value_or(0);
 		}
 	};
+
+	static const char MultipartBody[] =
+		"--abc\r\n"
+		"Content-Disposition: form-data; name=\"intValue\"\r\n"
+		"\r\n"
+		"123\r\n"
+		"--abc\r\n"
+		"Content-Disposition: form-data; name=\"first\"; filename=\"first.txt\"\r\n"
+		"Content-Type: text/plain\r\n"
+		"\r\n"
+		"contents of first file\r\n"
+		"--abc\r\n"
+		"Content-Disposition: form-data; name=\"second\"; filename=\"second.txt\"\r\n"
+		"\r\n"
+		"contents of second file, not read\r\n"
+		"--abc\r\n"
+		"Content-Disposition: form-data; name=\"text\"\r\n"
+		"\r\n"
+		"a\r\nb\r\n"
+		"--abc--\r\n";
+
+	/** Make request with multipart body splitted into chunks */
+	void setMultipartBody(cpv::HttpRequest& request, std::string_view body, std::size_t chunkSize) {
+		cpv::Packet packet;
+		for (std::size_t i = 0; i < body.size(); i += chunkSize) {
+			packet.append(cpv::SharedString(body.substr(i, chunkSize)));
+		}
+		request.getHeaders().setContentType("multipart/form-data; boundary=abc");
+		request.setBodyStream(cpv::makeReusable<cpv::PacketInputStream>(std::move(packet))
+			.cast<cpv::InputStreamBase>());
+	}
 }
 
 TEST_FUTURE(HttpRequestExtensions, readBodyStream) {
@@ -56,6 +93,59 @@ TEST_FUTURE(HttpRequestExtensions, readBodyStreamAsJson) {
 	});
 }
 
+TEST_FUTURE(HttpRequestExtensions, readBodyStreamAsModel) {
+	return seastar::do_with(cpv::HttpRequest(), [] (auto& request) {
+		// { "intValue": 123 }
+		cpv::SharedString msgpack(std::string_view("\x81\xa8intValue\x7b"));
+		request.getHeaders().setContentType("application/msgpack");
+		request.setBodyStream(
+			cpv::makeReusable<cpv::StringInputStream>(std::move(msgpack))
+			.cast<cpv::InputStreamBase>());
+		return cpv::extensions::readBodyStreamAsModel<MyModel>(request).then([] (auto model) {
+			ASSERT_EQ(model.intValue, 123);
+		}).then([&request] {
+			request.getHeaders().setContentType("application/json; charset=utf-8");
+			cpv::SharedString json(std::string_view("{ \"intValue\": 321 }"));
+			request.setBodyStream(
+				cpv::makeReusable<cpv::StringInputStream>(std::move(json))
+				.cast<cpv::InputStreamBase>());
+			return cpv::extensions::readBodyStreamAsModel<MyModel>(request);
+		}).then([] (auto model) {
+			ASSERT_EQ(model.intValue, 321);
+		}).then([&request] {
+			request.getHeaders().setContentType("application/x-msgpack");
+			request.setBodyStream(
+				cpv::makeReusable<cpv::StringInputStream>(cpv::SharedString("\x81"))
+				.cast<cpv::InputStreamBase>());
+			return cpv::extensions::readBodyStreamAsModel<MyModel>(request);
+		}).then_wrapped([] (seastar::future<MyModel> f) {
+			ASSERT_THROWS(cpv::DeserializeException, f.get());
+		});
+	});
+}
+
+TEST_FUTURE(HttpRequestExtensions, readBodyStreamAsJsonItems) {
+	return seastar::do_with(cpv::HttpRequest(), std::vector<int>(), [] (auto& request, auto& values) {
+		cpv::SharedString json("[ { \"intValue\": 123 }, { \"intValue\": 321 } ]");
+		request.setBodyStream(
+			cpv::makeReusable<cpv::StringInputStream>(std::move(json))
+			.cast<cpv::InputStreamBase>());
+		return cpv::extensions::readBodyStreamAsJsonItems<MyModel>(request, [&values] (MyModel&& model) {
+			values.emplace_back(model.intValue);
+			return seastar::make_ready_future<>();
+		}).then([&values] {
+			ASSERT_EQ(values, std::vector<int>({ 123, 321 }));
+		}).then([&request] {
+			request.setBodyStream(cpv::Reusable<cpv::InputStreamBase>());
+			return cpv::extensions::readBodyStreamAsJsonItems<MyModel>(request, [] (MyModel&&) {
+				return seastar::make_ready_future<>();
+			});
+		}).then_wrapped([] (seastar::future<> f) {
+			ASSERT_THROWS(cpv::DeserializeException, f.get());
+		});
+	});
+}
+
 TEST_FUTURE(HttpRequestExtensions, readBodyStreamAsForm) {
 	return seastar::do_with(cpv::HttpRequest(), [] (auto& request) {
 		cpv::SharedString formStr("intValue=123");
@@ -73,3 +163,82 @@ TEST_FUTURE(HttpRequestExtensions, readBodyStreamAsForm) {
 	});
 }
 
+TEST_FUTURE(HttpRequestExtensions, readBodyStreamAsForm_multipart) {
+	return seastar::do_with(cpv::HttpRequest(), [] (auto& request) {
+		setMultipartBody(request, MultipartBody, 7);
+		return cpv::extensions::readBodyStreamAsForm<MyModel>(request).then([] (auto model) {
+			ASSERT_EQ(model.intValue, 123);
+		});
+	});
+}
+
+TEST_FUTURE(HttpRequestExtensions, readBodyStreamAsMultipartForm) {
+	return seastar::do_with(
+		cpv::HttpRequest(),
+		cpv::HttpForm(),
+		std::vector<std::string>(),
+		[] (auto& request, auto& form, auto& files) {
+		setMultipartBody(request, MultipartBody, 5);
+		return cpv::extensions::readBodyStreamAsMultipartForm(request, form,
+			[&files] (const cpv::HttpMultipartPartHeaders& part, cpv::InputStreamBase& stream) {
+			files.emplace_back(part.filename.view());
+			if (part.filename != "first.txt") {
+				// not read, should be skipped
+				return seastar::make_ready_future<>();
+			}
+			return cpv::extensions::readAll(stream).then([&files] (cpv::SharedString str) {
+				files.emplace_back(str.view());
+			});
+		}).then([&form, &files] {
+			ASSERT_EQ(form.getAll().size(), 2U);
+			ASSERT_EQ(form.get("intValue"), "123");
+			ASSERT_EQ(form.get("text"), "a\r\nb");
+			ASSERT_EQ(files, std::vector<std::string>({
+				"first.txt", "contents of first file", "second.txt" }));
+		});
+	});
+}
+
+TEST_FUTURE(HttpRequestExtensions, readBodyStreamAsMultipartForm_errors) {
+	return seastar::do_with(cpv::HttpRequest(), cpv::HttpForm(), [] (auto& request, auto& form) {
+		// file exceeds limit
+		setMultipartBody(request, MultipartBody, 5);
+		return cpv::extensions::readBodyStreamAsMultipartForm(request, form,
+			[] (const cpv::HttpMultipartPartHeaders&, cpv::InputStreamBase& stream) {
+			return cpv::extensions::readAll(stream).discard_result();
+		}, 100, 10).then_wrapped([] (seastar::future<> f) {
+			ASSERT_THROWS_CONTAINS(cpv::DeserializeException, f.get(),
+				"size of multipart part exceeds limit");
+		}).then([&request, &form] {
+			// field exceeds limit
+			setMultipartBody(request, MultipartBody, 5);
+			return cpv::extensions::readBodyStreamAsMultipartForm(request, form,
+				[] (const cpv::HttpMultipartPartHeaders&, cpv::InputStreamBase&) {
+				return seastar::make_ready_future<>();
+			}, 2);
+		}).then_wrapped([] (seastar::future<> f) {
+			ASSERT_THROWS_CONTAINS(cpv::DeserializeException, f.get(),
+				"size of multipart part exceeds limit");
+		}).then([&request, &form] {
+			// incomplete body
+			setMultipartBody(request, std::string_view(MultipartBody, 50), 5);
+			return cpv::extensions::readBodyStreamAsMultipartForm(request, form,
+				[] (const cpv::HttpMultipartPartHeaders&, cpv::InputStreamBase&) {
+				return seastar::make_ready_future<>();
+			});
+		}).then_wrapped([] (seastar::future<> f) {
+			ASSERT_THROWS_CONTAINS(cpv::DeserializeException, f.get(),
+				"incomplete multipart body");
+		}).then([&request, &form] {
+			// not multipart
+			request.getHeaders().setContentType("application/x-www-form-urlencoded");
+			return cpv::extensions::readBodyStreamAsMultipartForm(request, form,
+				[] (const cpv::HttpMultipartPartHeaders&, cpv::InputStreamBase&) {
+				return seastar::make_ready_future<>();
+			});
+		}).then_wrapped([] (seastar::future<> f) {
+			ASSERT_THROWS_CONTAINS(cpv::DeserializeException, f.get(),
+				"isn't multipart/form-data");
+		});
+	});
+}
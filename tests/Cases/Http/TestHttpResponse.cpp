@@ -153,6 +153,73 @@ TEST(HttpResponse, headersAppendToHttp1Packet) {
 		"AdditionC: TestAdditionC");
 }
 
+TEST(HttpResponse, headersHttp1Block) {
+	cpv::SharedString block;
+	{
+		cpv::HttpResponse response;
+		auto& headers = response.getHeaders();
+		headers.setContentType("TestContentType");
+		headers.setServer("TestServer");
+		headers.setHeader("Access-Control-Allow-Origin", "*");
+		block = headers.toHttp1HeadersBlock();
+	}
+	ASSERT_EQ(block,
+		"\r\nContent-Type: TestContentType\r\n"
+		"Server: TestServer\r\n"
+		"Access-Control-Allow-Origin: *");
+	cpv::HttpResponse response;
+	auto& headers = response.getHeaders();
+	headers.setDate("TestDate");
+	headers.setHttp1HeadersBlock(block.share());
+	headers.setContentLength("123");
+	ASSERT_EQ(headers.getHttp1HeadersBlock(), block);
+	cpv::Packet packet;
+	headers.appendToHttp1Packet(packet.getOrConvertToMultiple());
+	ASSERT_EQ(packet.toString(),
+		"\r\nDate: TestDate\r\n"
+		"Content-Length: 123\r\n"
+		"Content-Type: TestContentType\r\n"
+		"Server: TestServer\r\n"
+		"Access-Control-Allow-Origin: *");
+	// the block is shared instead of copied
+	auto* fragments = packet.getIfMultiple();
+	ASSERT_TRUE(fragments != nullptr);
+	ASSERT_EQ(fragments->fragments.back().base, block.data());
+	headers.clear();
+	ASSERT_TRUE(headers.getHttp1HeadersBlock().empty());
+}
+
+TEST(HttpResponse, headersHttp1BlockTwice) {
+	cpv::HttpResponse response;
+	auto& headers = response.getHeaders();
+	headers.setServer("TestServer");
+	cpv::SharedString block = headers.toHttp1HeadersBlock();
+	ASSERT_EQ(block, "\r\nServer: TestServer");
+	ASSERT_EQ(headers.getHttp1HeadersBlock(), block);
+	ASSERT_TRUE(headers.getServer().empty());
+	// calling it again returns the same block
+	ASSERT_EQ(headers.toHttp1HeadersBlock(), block);
+	headers.setHttp1HeadersBlock(headers.toHttp1HeadersBlock());
+	ASSERT_EQ(headers.getHttp1HeadersBlock(), block);
+	// new headers are merged with the existing block
+	headers.setContentType("TestContentType");
+	headers.setHeader("Access-Control-Allow-Origin", "*");
+	block = headers.toHttp1HeadersBlock();
+	ASSERT_EQ(block,
+		"\r\nContent-Type: TestContentType\r\n"
+		"Access-Control-Allow-Origin: *\r\n"
+		"Server: TestServer");
+	ASSERT_EQ(headers.toHttp1HeadersBlock(), block);
+	headers.setDate("TestDate");
+	cpv::Packet packet;
+	headers.appendToHttp1Packet(packet.getOrConvertToMultiple());
+	ASSERT_EQ(packet.toString(),
+		"\r\nDate: TestDate\r\n"
+		"Content-Type: TestContentType\r\n"
+		"Access-Control-Allow-Origin: *\r\n"
+		"Server: TestServer");
+}
+
 TEST(HttpResponse, additionHeaders) {
 	cpv::HttpResponse response;
 	auto& headers = response.getHeaders();
@@ -1,3 +1,4 @@
+#include <CPVFramework/Http/HttpRequest.hpp>
 #include <CPVFramework/Http/HttpResponseExtensions.hpp>
 #include <CPVFramework/Stream/StringOutputStream.hpp>
 #include <CPVFramework/Testing/GTestUtils.hpp>
@@ -39,6 +40,56 @@ TEST_FUTURE(HttpResponseExtensions, replyWithMime) {
 	});
 }
 
+TEST_FUTURE(HttpResponseExtensions, replyJsonByChunks) {
+	return seastar::do_with(
+		cpv::HttpResponse(),
+		seastar::make_lw_shared<cpv::SharedStringBuilder>(),
+		std::vector<int>({ 1, 2, 3 }),
+		[] (auto& response, auto& str, auto& values) {
+		response.setBodyStream(
+			cpv::makeReusable<cpv::StringOutputStream>(str).template cast<cpv::OutputStreamBase>());
+		return cpv::extensions::replyJsonByChunks(response, values, 4)
+		.then([&response, &str] {
+			ASSERT_EQ(response.getStatusCode(), cpv::constants::_200);
+			ASSERT_EQ(response.getStatusMessage(), cpv::constants::OK);
+			auto& headers = response.getHeaders();
+			ASSERT_EQ(headers.getHeader(cpv::constants::ContentType), cpv::constants::ApplicationJsonUtf8);
+			ASSERT_EQ(headers.getHeader(cpv::constants::TransferEncoding), cpv::constants::Chunked);
+			ASSERT_EQ(headers.getHeader(cpv::constants::ContentLength), "");
+			ASSERT_EQ(str->view(), "4\r\n[1,2\r\n3\r\n,3]\r\n0\r\n\r\n");
+		});
+	});
+}
+
+TEST_FUTURE(HttpResponseExtensions, replyModel) {
+	return seastar::do_with(
+		cpv::HttpRequest(),
+		cpv::HttpResponse(),
+		seastar::make_lw_shared<cpv::SharedStringBuilder>(),
+		std::vector<int>({ 1, 2, 3 }),
+		[] (auto& request, auto& response, auto& str, auto& values) {
+		response.setBodyStream(
+			cpv::makeReusable<cpv::StringOutputStream>(str).template cast<cpv::OutputStreamBase>());
+		request.getHeaders().setAccept("application/json;q=0.5, application/msgpack");
+		return cpv::extensions::replyModel(request, response, values)
+		.then([&response, &str] {
+			auto& headers = response.getHeaders();
+			ASSERT_EQ(headers.getHeader(cpv::constants::ContentType), cpv::constants::ApplicationMsgPack);
+			ASSERT_EQ(headers.getHeader(cpv::constants::ContentLength), "4");
+			ASSERT_EQ(str->view(), "\x93\x01\x02\x03");
+		}).then([&request, &response, &str, &values] {
+			str->clear();
+			request.getHeaders().setAccept("*/*");
+			return cpv::extensions::replyModel(request, response, values);
+		}).then([&response, &str] {
+			auto& headers = response.getHeaders();
+			ASSERT_EQ(headers.getHeader(cpv::constants::ContentType), cpv::constants::ApplicationJsonUtf8);
+			ASSERT_EQ(headers.getHeader(cpv::constants::ContentLength), "7");
+			ASSERT_EQ(str->view(), "[1,2,3]");
+		});
+	});
+}
+
 TEST_FUTURE(HttpResponseExtensions, replyWithMimeAndStatusCode) {
 	return seastar::do_with(
 		cpv::HttpResponse(),
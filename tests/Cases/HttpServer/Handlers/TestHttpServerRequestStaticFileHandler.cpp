@@ -1,10 +1,22 @@
+#include <array>
+#include <cstdint>
 #include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <sys/stat.h>
+#include <zlib.h>
 #include <boost/range/irange.hpp>
 #include <seastar/core/future-util.hh>
+#include <seastar/core/sleep.hh>
 #include <CPVFramework/HttpServer/Handlers/HttpServerRequestStaticFileHandler.hpp>
 #include <CPVFramework/HttpServer/Handlers/HttpServerRequest404Handler.hpp>
 #include <CPVFramework/Http/HttpConstantStrings.hpp>
 #include <CPVFramework/Stream/StringOutputStream.hpp>
+#include <CPVFramework/Utility/StringUtils.hpp>
 #include <CPVFramework/Testing/GTestUtils.hpp>
 
 namespace {
@@ -21,7 +33,10 @@ namespace {
 				"echo -n qwertzxcvbasdfg > compress.txt && "
 				"echo -n 123 > compress.txt.gz && "
 				"touch -m --date=\"Fri Nov 29 21:02:02 UTC 2019\" compress.txt && "
-				"touch -m --date=\"Fri Nov 29 21:03:03 UTC 2019\" compress.txt.gz"
+				"touch -m --date=\"Fri Nov 29 21:03:03 UTC 2019\" compress.txt.gz && "
+				"echo -n plain > variant.txt && "
+				"echo -n br > variant.txt.br && "
+				"echo -n gz > variant.txt.gz"
 			);
 		}
 
@@ -123,6 +138,163 @@ namespace {
 		});
 	}
 
+	seastar::future<> testCompressVariants(
+		cpv::HttpServerRequestHandlerCollection& handlers,
+		cpv::HttpContext& context,
+		seastar::lw_shared_ptr<cpv::SharedStringBuilder>& str) {
+		static const std::vector<std::tuple<const char*, const char*, const char*, bool>> cases({
+			// accept encoding, expected content encoding, expected content, from cache
+			{ "gzip, br", "br", "br", false },
+			{ "gzip;q=1, br;q=0.5", "gzip", "gz", false },
+			{ "zstd", "", "plain", false },
+			{ "zstd", "", "plain", true },
+			{ "gzip, deflate, br", "br", "br", true },
+			{ "br;q=0, gzip", "gzip", "gz", true },
+			{ "", "", "plain", true },
+		});
+		prepareHandlers(handlers);
+		return seastar::do_for_each(cases, [&handlers, &context, &str] (const auto& item) {
+			prepareContext(context, str, "/static/child/variant.txt");
+			context.getRequest().getHeaders().setAcceptEncoding(
+				cpv::SharedString::fromStatic(std::get<0>(item)));
+			return handlers.at(0)->handle(context, handlers.begin() + 1).then([&context, &str, &item] {
+				auto& response = context.getResponse();
+				ASSERT_EQ(response.getStatusCode(), cpv::constants::_200);
+				auto& headers = response.getHeaders();
+				ASSERT_EQ(headers.getContentType(), "text/plain");
+				ASSERT_EQ(headers.getVary(), "Accept-Encoding");
+				ASSERT_EQ(headers.getContentEncoding(), std::get<1>(item));
+				ASSERT_EQ(str->view(), std::get<2>(item));
+				ASSERT_EQ(headers.getHeader("X-Cache"), std::get<3>(item) ? "HIT" : "");
+			});
+		});
+	}
+
+	/** Decompress gzip content, return empty string if failed */
+	std::string decompressGzip(std::string_view content) {
+		std::string result;
+		::z_stream stream = {};
+		if (::inflateInit2(&stream, 15 + 16) != Z_OK) {
+			return result;
+		}
+		std::array<char, 4096> buf;
+		stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(content.data()));
+		stream.avail_in = static_cast<uInt>(content.size());
+		int ret = Z_OK;
+		while (ret == Z_OK) {
+			stream.next_out = reinterpret_cast<Bytef*>(buf.data());
+			stream.avail_out = static_cast<uInt>(buf.size());
+			ret = ::inflate(&stream, Z_NO_FLUSH);
+			result.append(buf.data(), buf.size() - stream.avail_out);
+		}
+		::inflateEnd(&stream);
+		return ret == Z_STREAM_END ? result : std::string();
+	}
+
+	std::string makeCompressibleJson() {
+		std::string content;
+		for (std::size_t i = 0; i < 16; ++i) {
+			content.append("{\"name\":\"cpv-framework\",\"index\":").append(std::to_string(i)).append("}");
+		}
+		return content;
+	}
+
+	seastar::shared_ptr<cpv::HttpServerRequestHandlerBase> makeCompressOnTheFlyHandler() {
+		return seastar::make_shared<cpv::HttpServerRequestStaticFileHandler>(
+			"/static", "/tmp/cpv-framework-static-file-handler-test", "",
+			cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileEntities,
+			cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileSize,
+			cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileMetadataEntities,
+			cpv::HttpServerRequestStaticFileHandler::DefaultFileMetadataCacheTime,
+			false,
+			false,
+			6);
+	}
+
+	seastar::future<> testCompressOnTheFly(
+		cpv::HttpServerRequestHandlerCollection& handlers,
+		cpv::HttpContext& context,
+		seastar::lw_shared_ptr<cpv::SharedStringBuilder>& str) {
+		static const std::string jsonContent = makeCompressibleJson();
+		static const std::vector<std::tuple<const char*, const char*, const char*, std::string, bool>> cases({
+			// url, accept encoding, expected content encoding, expected content, from cache
+			{ "/static/child/compressible.json", "gzip", "gzip", jsonContent, false },
+			{ "/static/child/compressible.json", "gzip, br", "gzip", jsonContent, true },
+			{ "/static/child/compressible.json", "", "", jsonContent, true },
+			{ "/static/child/compressible.json", "br, gzip;q=0", "", jsonContent, false }, // check br
+			{ "/static/simple%3d.txt", "gzip", "", "abcde", false }, // too small to compress
+			{ "/static/simple%3d.txt", "gzip", "", "abcde", true },
+			{ "/static/child/variant.txt", "gzip", "gzip", "gz", false }, // pre-compressed is preferred
+		});
+		std::ofstream("/tmp/cpv-framework-static-file-handler-test/child/compressible.json") << jsonContent;
+		handlers.clear();
+		handlers.emplace_back(makeCompressOnTheFlyHandler());
+		handlers.emplace_back(seastar::make_shared<cpv::HttpServerRequest404Handler>());
+		return seastar::do_for_each(cases, [&handlers, &context, &str] (const auto& item) {
+			prepareContext(context, str, std::get<0>(item));
+			context.getRequest().getHeaders().setAcceptEncoding(
+				cpv::SharedString::fromStatic(std::get<1>(item)));
+			return handlers.at(0)->handle(context, handlers.begin() + 1).then([&context, &str, &item] {
+				auto& response = context.getResponse();
+				ASSERT_EQ(response.getStatusCode(), cpv::constants::_200);
+				auto& headers = response.getHeaders();
+				ASSERT_EQ(headers.getVary(), "Accept-Encoding");
+				ASSERT_EQ(headers.getContentEncoding(), std::get<2>(item));
+				ASSERT_EQ(headers.getHeader("X-Cache"), std::get<4>(item) ? "HIT" : "");
+				bool compressedOnTheFly = (std::get<2>(item) == std::string_view("gzip") &&
+					std::get<3>(item) == jsonContent);
+				ASSERT_EQ(cpv::endsWith(headers.getETag(), "-gzip\""), compressedOnTheFly);
+				if (compressedOnTheFly) {
+					ASSERT_EQ(decompressGzip(str->view()), std::get<3>(item));
+				} else {
+					ASSERT_EQ(str->view(), std::get<3>(item));
+				}
+			});
+		}).then([&handlers, &context, &str] {
+			// compressed content has it's own entity tag
+			prepareContext(context, str, "/static/child/compressible.json");
+			auto& headers = context.getRequest().getHeaders();
+			headers.setAcceptEncoding("gzip");
+			return handlers.at(0)->handle(context, handlers.begin() + 1);
+		}).then([&handlers, &context, &str] {
+			cpv::SharedString etag = context.getResponse().getHeaders().getETag().share();
+			prepareContext(context, str, "/static/child/compressible.json");
+			auto& headers = context.getRequest().getHeaders();
+			headers.setAcceptEncoding("gzip");
+			headers.setHeader(cpv::constants::IfNoneMatch, std::move(etag));
+			return handlers.at(0)->handle(context, handlers.begin() + 1);
+		}).then([&handlers, &context, &str] {
+			EXPECT_EQ(context.getResponse().getStatusCode(), cpv::constants::_304);
+			// If-None-Match is checked after compression when file is not cached
+			cpv::SharedString etag = context.getResponse().getHeaders().getETag().share();
+			handlers.at(0) = makeCompressOnTheFlyHandler();
+			prepareContext(context, str, "/static/child/compressible.json");
+			auto& headers = context.getRequest().getHeaders();
+			headers.setAcceptEncoding("gzip");
+			headers.setHeader(cpv::constants::IfNoneMatch, std::move(etag));
+			return handlers.at(0)->handle(context, handlers.begin() + 1);
+		}).then([&handlers, &context, &str] {
+			EXPECT_EQ(context.getResponse().getStatusCode(), cpv::constants::_304);
+			EXPECT_EQ(context.getResponse().getHeaders().getContentEncoding(), "");
+			// not compressible file uses entity tag of original file
+			prepareContext(context, str, "/static/simple%3d.txt");
+			context.getRequest().getHeaders().setAcceptEncoding("gzip");
+			return handlers.at(0)->handle(context, handlers.begin() + 1);
+		}).then([&handlers, &context, &str] {
+			cpv::SharedString etag = context.getResponse().getHeaders().getETag().share();
+			EXPECT_FALSE(cpv::endsWith(etag, "-gzip\""));
+			handlers.at(0) = makeCompressOnTheFlyHandler();
+			prepareContext(context, str, "/static/simple%3d.txt");
+			auto& headers = context.getRequest().getHeaders();
+			headers.setAcceptEncoding("gzip");
+			headers.setHeader(cpv::constants::IfNoneMatch, std::move(etag));
+			return handlers.at(0)->handle(context, handlers.begin() + 1);
+		}).then([&context] {
+			ASSERT_EQ(context.getResponse().getStatusCode(), cpv::constants::_304);
+			::system("rm -f /tmp/cpv-framework-static-file-handler-test/child/compressible.json");
+		});
+	}
+
 	seastar::future<> test404NotFound(
 		cpv::HttpServerRequestHandlerCollection& handlers,
 		cpv::HttpContext& context,
@@ -174,6 +346,70 @@ namespace {
 		});
 	}
 
+	seastar::future<> testETag(
+		cpv::HttpServerRequestHandlerCollection& handlers,
+		cpv::HttpContext& context,
+		seastar::lw_shared_ptr<cpv::SharedStringBuilder>& str) {
+		static const boost::integer_range<int> range(0, 8);
+		// expected etag is "inode-size-mtime" in hex
+		struct ::stat st = {};
+		::stat("/tmp/cpv-framework-static-file-handler-test/simple=.txt", &st);
+		std::ostringstream etagStream;
+		etagStream << std::hex << "\"" << st.st_ino << "-" << st.st_size << "-" <<
+			(static_cast<std::uint64_t>(st.st_mtim.tv_sec) * 1000000000ULL +
+			static_cast<std::uint64_t>(st.st_mtim.tv_nsec)) << "\"";
+		std::string etag = etagStream.str();
+		return seastar::do_for_each(range, [&handlers, &context, &str, etag] (auto i) {
+			// first and last time are from disk, others are from cache
+			if (i == 0 || i == 7) {
+				prepareHandlers(handlers);
+			}
+			prepareContext(context, str, "/static/simple%3d.txt");
+			auto& headers = context.getRequest().getHeaders();
+			if (i == 1) {
+				headers.setHeader(cpv::constants::IfNoneMatch,
+					cpv::SharedStringBuilder().append("\"other\", ").append(etag).build());
+			} else if (i == 2) {
+				headers.setHeader(cpv::constants::IfNoneMatch,
+					cpv::SharedStringBuilder().append("W/").append(etag).build());
+			} else if (i == 3) {
+				// If-Modified-Since should be ignored when If-None-Match presented
+				headers.setHeader(cpv::constants::IfNoneMatch, "\"other\"");
+				headers.setHeader(cpv::constants::IfModifiedSince, "Fri, 29 Nov 2019 21:01:01 GMT");
+			} else if (i == 4) {
+				headers.setHeader(cpv::constants::IfNoneMatch, "*");
+			} else if (i == 5) {
+				headers.setHeader(cpv::constants::Range, "bytes=1-2");
+				headers.setHeader(cpv::constants::IfRange, cpv::SharedString(etag));
+			} else if (i == 6) {
+				// weak entity tag never match for If-Range
+				headers.setHeader(cpv::constants::Range, "bytes=1-2");
+				headers.setHeader(cpv::constants::IfRange,
+					cpv::SharedStringBuilder().append("W/").append(etag).build());
+			} else if (i == 7) {
+				headers.setHeader(cpv::constants::IfNoneMatch, cpv::SharedString(etag));
+			}
+			return handlers.at(0)->handle(context, handlers.begin() + 1).then([&context, &str, i, etag] {
+				auto& response = context.getResponse();
+				auto& headers = response.getHeaders();
+				ASSERT_EQ(headers.getETag(), etag);
+				ASSERT_EQ(headers.getLastModified(), "Fri, 29 Nov 2019 21:01:01 GMT");
+				ASSERT_EQ(headers.getHeader("X-Cache"), (i == 0 || i == 7) ? "" : "HIT");
+				if (i == 1 || i == 2 || i == 4 || i == 7) {
+					ASSERT_EQ(response.getStatusCode(), cpv::constants::_304);
+					ASSERT_EQ(response.getStatusMessage(), cpv::constants::NotModified);
+					ASSERT_EQ(str->view(), "");
+				} else if (i == 5) {
+					ASSERT_EQ(response.getStatusCode(), cpv::constants::_206);
+					ASSERT_EQ(str->view(), "bc");
+				} else {
+					ASSERT_EQ(response.getStatusCode(), cpv::constants::_200);
+					ASSERT_EQ(str->view(), "abcde");
+				}
+			});
+		});
+	}
+
 	seastar::future<> testFullRange(
 		cpv::HttpServerRequestHandlerCollection& handlers,
 		cpv::HttpContext& context,
@@ -181,8 +417,8 @@ namespace {
 		static const boost::integer_range<int> range(0, 2);
 		prepareHandlers(handlers);
 		return seastar::do_for_each(range, [&handlers, &context, &str] (auto i) {
-			// second time is testing whether the handler could bypass cache and
-			// compressed file when range header present
+			// second time is testing whether the handler could reply range from cache
+			// and bypass compressed file when range header present
 			prepareContext(context, str, "/static/child/compress.txt");
 			if (i == 1) {
 				auto& headers = context.getRequest().getHeaders();
@@ -202,9 +438,9 @@ namespace {
 				ASSERT_EQ(headers.getContentLength(), "12");
 				ASSERT_EQ(headers.getCacheControl(), "max-age=84600, public");
 				ASSERT_EQ(headers.getContentEncoding(), "");
-				ASSERT_EQ(headers.getLastModified(), "");
+				ASSERT_EQ(headers.getLastModified(), "Fri, 29 Nov 2019 21:02:02 GMT");
 				ASSERT_EQ(headers.getHeader(cpv::constants::ContentRange), "bytes 1-12/15");
-				ASSERT_EQ(headers.getHeader("X-Cache"), "");
+				ASSERT_EQ(headers.getHeader("X-Cache"), "HIT");
 				ASSERT_EQ(str->view(), "wertzxcvbasd");
 			});
 		});
@@ -218,8 +454,8 @@ namespace {
 		static const boost::integer_range<int> range(0, 2);
 		prepareHandlers(handlers);
 		return seastar::do_for_each(range, [&handlers, &context, &str] (auto i) {
-			// second time is testing whether the handler could bypass cache and
-			// compressed file when range header present
+			// second time is testing whether the handler could reply range from cache
+			// and bypass compressed file when range header present
 			prepareContext(context, str, "/static/child/compress.txt");
 			if (i == 1) {
 				auto& headers = context.getRequest().getHeaders();
@@ -239,8 +475,8 @@ namespace {
 				ASSERT_EQ(headers.getContentLength(), "13");
 				ASSERT_EQ(headers.getCacheControl(), "max-age=84600, public");
 				ASSERT_EQ(headers.getContentEncoding(), "");
-				ASSERT_EQ(headers.getLastModified(), "");
-				ASSERT_EQ(headers.getHeader("X-Cache"), "");
+				ASSERT_EQ(headers.getLastModified(), "Fri, 29 Nov 2019 21:02:02 GMT");
+				ASSERT_EQ(headers.getHeader("X-Cache"), "HIT");
 				ASSERT_EQ(headers.getHeader(cpv::constants::ContentRange), "bytes 2-14/15");
 				ASSERT_EQ(str->view(), "ertzxcvbasdfg");
 			});
@@ -280,11 +516,358 @@ namespace {
 				ASSERT_EQ(headers.getCacheControl(), "max-age=84600, public");
 				ASSERT_EQ(headers.getContentEncoding(), "");
 				ASSERT_EQ(headers.getLastModified(), "Fri, 29 Nov 2019 21:01:01 GMT");
-				ASSERT_EQ(headers.getHeader("X-Cache"), "");
+				ASSERT_EQ(headers.getHeader("X-Cache"), i == 0 ? "" : "HIT");
 				ASSERT_EQ(str->view(), "abcde");
 			});
 		});
 	}
+
+	seastar::future<> testMultipleRanges(
+		cpv::HttpServerRequestHandlerCollection& handlers,
+		cpv::HttpContext& context,
+		seastar::lw_shared_ptr<cpv::SharedStringBuilder>& str) {
+		static const boost::integer_range<int> range(0, 4);
+		return seastar::do_for_each(range, [&handlers, &context, &str] (auto i) {
+			// handlers are recreated every two times, first time is from disk
+			// and second time is from cache
+			if (i % 2 == 0) {
+				prepareHandlers(handlers);
+			}
+			prepareContext(context, str, "/static/child/compress.txt");
+			auto& headers = context.getRequest().getHeaders();
+			headers.setAcceptEncoding("gzip, deflate");
+			headers.setHeader(cpv::constants::Range, "bytes=0-1, 4-5,-3");
+			return handlers.at(0)->handle(context, handlers.begin() + 1).then([&context, &str, i] {
+				auto& response = context.getResponse();
+				ASSERT_EQ(response.getStatusCode(), cpv::constants::_206);
+				ASSERT_EQ(response.getStatusMessage(), cpv::constants::PartialContent);
+				auto& headers = response.getHeaders();
+				ASSERT_EQ(headers.getContentType(),
+					"multipart/byteranges; boundary=CPVFrameworkByteRangesBoundary");
+				ASSERT_EQ(headers.getContentEncoding(), "");
+				ASSERT_EQ(headers.getHeader("X-Cache"), (i % 2 == 0) ? "" : "HIT");
+				ASSERT_EQ(str->view(),
+					"\r\n--CPVFrameworkByteRangesBoundary\r\n"
+					"Content-Type: text/plain\r\n"
+					"Content-Range: bytes 0-1/15\r\n\r\n"
+					"qw"
+					"\r\n--CPVFrameworkByteRangesBoundary\r\n"
+					"Content-Type: text/plain\r\n"
+					"Content-Range: bytes 4-5/15\r\n\r\n"
+					"tz"
+					"\r\n--CPVFrameworkByteRangesBoundary\r\n"
+					"Content-Type: text/plain\r\n"
+					"Content-Range: bytes 12-14/15\r\n\r\n"
+					"dfg"
+					"\r\n--CPVFrameworkByteRangesBoundary--\r\n");
+				ASSERT_EQ(headers.getContentLength(), cpv::SharedString::fromInt(str->size()));
+			});
+		});
+	}
+
+	seastar::future<> testMultipleRangesWithoutCache(
+		cpv::HttpServerRequestHandlerCollection& handlers,
+		cpv::HttpContext& context,
+		seastar::lw_shared_ptr<cpv::SharedStringBuilder>& str) {
+		handlers.clear();
+		handlers.emplace_back(
+			seastar::make_shared<cpv::HttpServerRequestStaticFileHandler>(
+			"/static", "/tmp/cpv-framework-static-file-handler-test", "", 0));
+		handlers.emplace_back(seastar::make_shared<cpv::HttpServerRequest404Handler>());
+		prepareContext(context, str, "/static/child/compress.txt");
+		auto& headers = context.getRequest().getHeaders();
+		headers.setHeader(cpv::constants::Range, "bytes=10-,2-3");
+		return handlers.at(0)->handle(context, handlers.begin() + 1).then([&context, &str] {
+			auto& response = context.getResponse();
+			ASSERT_EQ(response.getStatusCode(), cpv::constants::_206);
+			ASSERT_EQ(response.getStatusMessage(), cpv::constants::PartialContent);
+			auto& headers = response.getHeaders();
+			ASSERT_EQ(headers.getContentType(),
+				"multipart/byteranges; boundary=CPVFrameworkByteRangesBoundary");
+			ASSERT_EQ(headers.getHeader("X-Cache"), "");
+			ASSERT_EQ(str->view(),
+				"\r\n--CPVFrameworkByteRangesBoundary\r\n"
+				"Content-Type: text/plain\r\n"
+				"Content-Range: bytes 10-14/15\r\n\r\n"
+				"asdfg"
+				"\r\n--CPVFrameworkByteRangesBoundary\r\n"
+				"Content-Type: text/plain\r\n"
+				"Content-Range: bytes 2-3/15\r\n\r\n"
+				"er"
+				"\r\n--CPVFrameworkByteRangesBoundary--\r\n");
+			ASSERT_EQ(headers.getContentLength(), cpv::SharedString::fromInt(str->size()));
+		});
+	}
+
+	seastar::future<> testIfRange(
+		cpv::HttpServerRequestHandlerCollection& handlers,
+		cpv::HttpContext& context,
+		seastar::lw_shared_ptr<cpv::SharedStringBuilder>& str) {
+		static const boost::integer_range<int> range(0, 4);
+		prepareHandlers(handlers);
+		return seastar::do_for_each(range, [&handlers, &context, &str] (auto i) {
+			// first and third time validator matched, second and fourth time not matched
+			// first and second time are from disk, third and fourth time are from cache
+			if (i == 1) {
+				prepareHandlers(handlers);
+			}
+			prepareContext(context, str, "/static/child/compress.txt");
+			auto& headers = context.getRequest().getHeaders();
+			headers.setHeader(cpv::constants::Range, "bytes=-3");
+			headers.setHeader(cpv::constants::IfRange, (i % 2 == 0) ?
+				"Fri, 29 Nov 2019 21:02:02 GMT" : "Fri, 29 Nov 2019 00:00:00 GMT");
+			return handlers.at(0)->handle(context, handlers.begin() + 1).then([&context, &str, i] {
+				auto& response = context.getResponse();
+				auto& headers = response.getHeaders();
+				ASSERT_EQ(headers.getHeader("X-Cache"), (i < 2) ? "" : "HIT");
+				ASSERT_EQ(headers.getLastModified(), "Fri, 29 Nov 2019 21:02:02 GMT");
+				if (i % 2 == 0) {
+					ASSERT_EQ(response.getStatusCode(), cpv::constants::_206);
+					ASSERT_EQ(headers.getHeader(cpv::constants::ContentRange), "bytes 12-14/15");
+					ASSERT_EQ(headers.getContentLength(), "3");
+					ASSERT_EQ(str->view(), "dfg");
+				} else {
+					ASSERT_EQ(response.getStatusCode(), cpv::constants::_200);
+					ASSERT_EQ(headers.getHeader(cpv::constants::ContentRange), "");
+					ASSERT_EQ(headers.getContentLength(), "15");
+					ASSERT_EQ(str->view(), "qwertzxcvbasdfg");
+				}
+			});
+		});
+	}
+
+	/** Count memory mappings of given file in this process */
+	std::size_t countMemoryMappings(const std::string& path) {
+		std::ifstream maps("/proc/self/maps");
+		std::string line;
+		std::size_t count = 0;
+		while (std::getline(maps, line)) {
+			if (line.size() >= path.size() &&
+				line.compare(line.size() - path.size(), path.size(), path) == 0) {
+				++count;
+			}
+		}
+		return count;
+	}
+
+	seastar::future<> testMemoryMappedFiles(
+		cpv::HttpServerRequestHandlerCollection& handlers,
+		cpv::HttpContext& context,
+		seastar::lw_shared_ptr<cpv::SharedStringBuilder>& str) {
+		static const boost::integer_range<int> range(0, 4);
+		// only files without write permission are mapped
+		::system("chmod a-w /tmp/cpv-framework-static-file-handler-test/child/compress.txt");
+		// simulate handlers on two cpu cores, they should share the same mapping
+		handlers.clear();
+		for (std::size_t i = 0; i < 2; ++i) {
+			handlers.emplace_back(
+				seastar::make_shared<cpv::HttpServerRequestStaticFileHandler>(
+				"/static", "/tmp/cpv-framework-static-file-handler-test", "",
+				cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileEntities,
+				cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileSize,
+				cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileMetadataEntities,
+				cpv::HttpServerRequestStaticFileHandler::DefaultFileMetadataCacheTime,
+				false,
+				true));
+		}
+		handlers.emplace_back(seastar::make_shared<cpv::HttpServerRequest404Handler>());
+		return seastar::do_for_each(range, [&handlers, &context, &str] (auto i) {
+			// first and second time are from disk (by different handlers),
+			// third and fourth time are from cache
+			prepareContext(context, str, "/static/child/compress.txt");
+			if (i == 3) {
+				context.getRequest().getHeaders().setHeader(cpv::constants::Range, "bytes=1-3");
+			}
+			return handlers.at(i % 2)->handle(context, handlers.begin() + 2).then([&context, &str, i] {
+				auto& response = context.getResponse();
+				auto& headers = response.getHeaders();
+				ASSERT_EQ(headers.getHeader("X-Cache"), (i < 2) ? "" : "HIT");
+				if (i == 3) {
+					ASSERT_EQ(response.getStatusCode(), cpv::constants::_206);
+					ASSERT_EQ(str->view(), "wer");
+				} else {
+					ASSERT_EQ(response.getStatusCode(), cpv::constants::_200);
+					ASSERT_EQ(headers.getContentLength(), "15");
+					ASSERT_EQ(str->view(), "qwertzxcvbasdfg");
+				}
+				ASSERT_EQ(countMemoryMappings(
+					"/tmp/cpv-framework-static-file-handler-test/child/compress.txt"), 1U);
+			});
+		}).then([&handlers, &context, &str] {
+			// writable file should be read into memory instead of mapped
+			prepareContext(context, str, "/static/child/variant.txt");
+			return handlers.at(0)->handle(context, handlers.begin() + 2).then([&context, &str] {
+				auto& response = context.getResponse();
+				ASSERT_EQ(response.getStatusCode(), cpv::constants::_200);
+				ASSERT_EQ(str->view(), "plain");
+				ASSERT_EQ(countMemoryMappings(
+					"/tmp/cpv-framework-static-file-handler-test/child/variant.txt"), 0U);
+			});
+		}).then([&handlers] {
+			// the mapping should be released after all cached contents released
+			handlers.clear();
+			ASSERT_EQ(countMemoryMappings(
+				"/tmp/cpv-framework-static-file-handler-test/child/compress.txt"), 0U);
+			::system("chmod u+w /tmp/cpv-framework-static-file-handler-test/child/compress.txt");
+		});
+	}
+
+	seastar::future<> testMemoryMappedCompressedFiles(
+		cpv::HttpServerRequestHandlerCollection& handlers,
+		cpv::HttpContext& context,
+		seastar::lw_shared_ptr<cpv::SharedStringBuilder>& str) {
+		static const boost::integer_range<int> range(0, 2);
+		static const std::string jsonContent = makeCompressibleJson();
+		std::ofstream("/tmp/cpv-framework-static-file-handler-test/child/mapped.json") << jsonContent;
+		::system("chmod a-w /tmp/cpv-framework-static-file-handler-test/child/mapped.json");
+		// simulate handlers on two cpu cores, the mapping should be reused with compression enabled
+		handlers.clear();
+		for (std::size_t i = 0; i < 2; ++i) {
+			handlers.emplace_back(
+				seastar::make_shared<cpv::HttpServerRequestStaticFileHandler>(
+				"/static", "/tmp/cpv-framework-static-file-handler-test", "",
+				cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileEntities,
+				cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileSize,
+				cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileMetadataEntities,
+				cpv::HttpServerRequestStaticFileHandler::DefaultFileMetadataCacheTime,
+				false,
+				true,
+				6));
+		}
+		handlers.emplace_back(seastar::make_shared<cpv::HttpServerRequest404Handler>());
+		return seastar::do_for_each(range, [&handlers, &context, &str] (auto i) {
+			prepareContext(context, str, "/static/child/mapped.json");
+			context.getRequest().getHeaders().setAcceptEncoding("gzip");
+			return handlers.at(i)->handle(context, handlers.begin() + 2).then([&context, &str] {
+				auto& response = context.getResponse();
+				auto& headers = response.getHeaders();
+				ASSERT_EQ(response.getStatusCode(), cpv::constants::_200);
+				ASSERT_EQ(headers.getHeader("X-Cache"), "");
+				ASSERT_EQ(headers.getContentEncoding(), "gzip");
+				ASSERT_EQ(decompressGzip(str->view()), jsonContent);
+				ASSERT_EQ(countMemoryMappings(
+					"/tmp/cpv-framework-static-file-handler-test/child/mapped.json"), 1U);
+			});
+		}).then([&handlers] {
+			handlers.clear();
+			::system("rm -f /tmp/cpv-framework-static-file-handler-test/child/mapped.json");
+		});
+	}
+
+	seastar::future<> testFileMetadataCache(
+		cpv::HttpServerRequestHandlerCollection& handlers,
+		cpv::HttpContext& context,
+		seastar::lw_shared_ptr<cpv::SharedStringBuilder>& str) {
+		static const boost::integer_range<int> range(0, 4);
+		handlers.clear();
+		handlers.emplace_back(
+			seastar::make_shared<cpv::HttpServerRequestStaticFileHandler>(
+			"/static", "/tmp/cpv-framework-static-file-handler-test", "",
+			cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileEntities,
+			cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileSize,
+			cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileMetadataEntities,
+			std::chrono::milliseconds(200)));
+		handlers.emplace_back(seastar::make_shared<cpv::HttpServerRequest404Handler>());
+		return seastar::do_for_each(range, [&handlers, &context, &str] (auto i) {
+			// first time file not exists, and negative entry will be cached
+			// second time file created but negative entry not expired
+			// third time negative entry expired, fourth time metadata is from cache
+			seastar::future<> prepareFuture = seastar::make_ready_future<>();
+			if (i == 1) {
+				::system(
+					"cd /tmp/cpv-framework-static-file-handler-test && "
+					"echo -n qwert > metadata.txt");
+			} else if (i == 2) {
+				prepareFuture = seastar::sleep(std::chrono::milliseconds(300));
+			}
+			return prepareFuture.then([&handlers, &context, &str, i] {
+				prepareContext(context, str, "/static/metadata.txt");
+				return handlers.at(0)->handle(context, handlers.begin() + 1);
+			}).then([&context, &str, i] {
+				auto& response = context.getResponse();
+				if (i < 2) {
+					ASSERT_EQ(response.getStatusCode(), cpv::constants::_404);
+					ASSERT_EQ(response.getStatusMessage(), cpv::constants::NotFound);
+					return;
+				}
+				ASSERT_EQ(response.getStatusCode(), cpv::constants::_200);
+				ASSERT_EQ(response.getStatusMessage(), cpv::constants::OK);
+				auto& headers = response.getHeaders();
+				ASSERT_EQ(headers.getContentLength(), "5");
+				ASSERT_EQ(str->view(), "qwert");
+			});
+		}).then([] {
+			::system("rm -f /tmp/cpv-framework-static-file-handler-test/metadata.txt");
+		});
+	}
+
+	std::size_t countInotifyInstances() {
+		std::size_t count = 0;
+		std::error_code ec;
+		for (auto& entry : std::filesystem::directory_iterator("/proc/self/fd", ec)) {
+			if (std::filesystem::read_symlink(entry.path(), ec) == "anon_inode:inotify") {
+				++count;
+			}
+		}
+		return count;
+	}
+
+	seastar::future<> testWatchPathBase(
+		cpv::HttpServerRequestHandlerCollection& handlers,
+		cpv::HttpContext& context,
+		seastar::lw_shared_ptr<cpv::SharedStringBuilder>& str) {
+		static const boost::integer_range<int> range(0, 3);
+		::system(
+			"cd /tmp/cpv-framework-static-file-handler-test && "
+			"echo -n abcde > watch.txt");
+		handlers.clear();
+		// handlers with the same pathBase should share one inotify instance
+		std::size_t inotifyInstances = countInotifyInstances();
+		for (std::size_t i = 0; i < 2; ++i) {
+			handlers.emplace_back(
+				seastar::make_shared<cpv::HttpServerRequestStaticFileHandler>(
+				"/static", "/tmp/cpv-framework-static-file-handler-test", "",
+				cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileEntities,
+				cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileSize,
+				cpv::HttpServerRequestStaticFileHandler::DefaultMaxCacheFileMetadataEntities,
+				std::chrono::milliseconds(60000),
+				true));
+		}
+		handlers.emplace_back(seastar::make_shared<cpv::HttpServerRequest404Handler>());
+		EXPECT_EQ(countInotifyInstances(), inotifyInstances + 1);
+		return seastar::do_for_each(range, [&handlers, &context, &str] (auto i) {
+			// first time is from disk, second time is from cache
+			// third time file modified and cache evicted by watcher
+			seastar::future<> prepareFuture = seastar::make_ready_future<>();
+			if (i == 2) {
+				::system(
+					"cd /tmp/cpv-framework-static-file-handler-test && "
+					"echo -n qwertyu > watch.txt");
+				prepareFuture = seastar::sleep(std::chrono::milliseconds(300));
+			}
+			return prepareFuture.then([&handlers, &context, &str] {
+				prepareContext(context, str, "/static/watch.txt");
+				return handlers.at(0)->handle(context, handlers.begin() + 1);
+			}).then([&context, &str, i] {
+				auto& response = context.getResponse();
+				ASSERT_EQ(response.getStatusCode(), cpv::constants::_200);
+				ASSERT_EQ(response.getStatusMessage(), cpv::constants::OK);
+				auto& headers = response.getHeaders();
+				if (i == 1) {
+					ASSERT_EQ(headers.getHeader("X-Cache"), "HIT");
+					ASSERT_EQ(str->view(), "abcde");
+				} else if (i == 2) {
+					ASSERT_EQ(headers.getHeader("X-Cache"), "");
+					ASSERT_EQ(headers.getContentLength(), "7");
+					ASSERT_EQ(str->view(), "qwertyu");
+				}
+			});
+		}).then([&handlers] {
+			// destroy handler to stop watching
+			handlers.clear();
+			::system("rm -f /tmp/cpv-framework-static-file-handler-test/watch.txt");
+		});
+	}
 }
 
 TEST_FUTURE(HttpServerRequestStaticFileHandler, handle) {
@@ -296,16 +879,36 @@ TEST_FUTURE(HttpServerRequestStaticFileHandler, handle) {
 		[] (auto&, auto& handlers, auto& context, auto& str) {
 		return testSimpleTxt(handlers, context, str).then([&handlers, &context, &str] {
 			return testCompressTxt(handlers, context, str);
+		}).then([&handlers, &context, &str] {
+			return testCompressVariants(handlers, context, str);
+		}).then([&handlers, &context, &str] {
+			return testCompressOnTheFly(handlers, context, str);
 		}).then([&handlers, &context, &str] {
 			return test404NotFound(handlers, context, str);
 		}).then([&handlers, &context, &str] {
 			return test302NotModified(handlers, context, str);
+		}).then([&handlers, &context, &str] {
+			return testETag(handlers, context, str);
 		}).then([&handlers, &context, &str] {
 			return testFullRange(handlers, context, str);
 		}).then([&handlers, &context, &str] {
 			return testHalfRange(handlers, context, str);
 		}).then([&handlers, &context, &str] {
 			return testInvalidRange(handlers, context, str);
+		}).then([&handlers, &context, &str] {
+			return testMultipleRanges(handlers, context, str);
+		}).then([&handlers, &context, &str] {
+			return testMultipleRangesWithoutCache(handlers, context, str);
+		}).then([&handlers, &context, &str] {
+			return testIfRange(handlers, context, str);
+		}).then([&handlers, &context, &str] {
+			return testMemoryMappedFiles(handlers, context, str);
+		}).then([&handlers, &context, &str] {
+			return testMemoryMappedCompressedFiles(handlers, context, str);
+		}).then([&handlers, &context, &str] {
+			return testFileMetadataCache(handlers, context, str);
+		}).then([&handlers, &context, &str] {
+			return testWatchPathBase(handlers, context, str);
 		});
 	});
 }
@@ -1,5 +1,9 @@
+#include <algorithm>
+#include <random>
 #include <CPVFramework/Serialize/JsonDeserializer.hpp>
+#include <CPVFramework/Serialize/JsonStreamParser.hpp>
 #include <CPVFramework/Testing/GTestUtils.hpp>
+#include "../Utility/TestEscapeCharScanner.Base.hpp"
 
 namespace {
 	class MyModel {
@@ -93,6 +97,231 @@ namespace {
 	};
 }
 
+namespace {
+	/** Tree of json values, used to compare results of different parsers */
+	struct JsonNode {
+		char type = 'N';
+		std::string text;
+		std::vector<std::pair<std::string, JsonNode>> children;
+
+		/** Dump node as text, object members are sorted by key since sajson sorts them */
+		std::string dump() const {
+			std::string result(1, type);
+			result.append("(").append(text);
+			std::vector<std::string> dumpedChildren;
+			for (auto& child : children) {
+				dumpedChildren.emplace_back(child.first + ":" + child.second.dump());
+			}
+			if (type == '{') {
+				std::sort(dumpedChildren.begin(), dumpedChildren.end());
+			}
+			for (auto& dumpedChild : dumpedChildren) {
+				result.append(dumpedChild).append(",");
+			}
+			return result.append(")");
+		}
+
+		/** Format number in the same way for both parsers (sajson doesn't guarantee correct rounding) */
+		static std::string formatNumber(double value) {
+			char buf[32];
+			std::snprintf(buf, sizeof(buf), "%.12g", value);
+			return buf;
+		}
+
+		/** Build from sajson value */
+		static JsonNode fromSajson(const sajson::value& value) {
+			JsonNode node;
+			switch (value.get_type()) {
+			case cpv::JsonType::TYPE_OBJECT:
+				node.type = '{';
+				for (std::size_t i = 0; i < value.get_length(); ++i) {
+					node.children.emplace_back(value.get_object_key(i).as_string(),
+						fromSajson(value.get_object_value(i)));
+				}
+				break;
+			case cpv::JsonType::TYPE_ARRAY:
+				node.type = '[';
+				for (std::size_t i = 0; i < value.get_length(); ++i) {
+					node.children.emplace_back("", fromSajson(value.get_array_element(i)));
+				}
+				break;
+			case cpv::JsonType::TYPE_STRING:
+				node.type = 's';
+				node.text.assign(value.as_cstring(), value.get_string_length());
+				break;
+			case cpv::JsonType::TYPE_INTEGER:
+			case cpv::JsonType::TYPE_DOUBLE:
+				node.type = 'n';
+				node.text = formatNumber(value.get_number_value());
+				break;
+			case cpv::JsonType::TYPE_TRUE:
+				node.type = 'T';
+				break;
+			case cpv::JsonType::TYPE_FALSE:
+				node.type = 'F';
+				break;
+			default:
+				break;
+			}
+			return node;
+		}
+	};
+
+	/** Build JsonNode from the events of JsonStreamParser */
+	class JsonNodeBuilder : public cpv::JsonStreamHandler {
+	public:
+		JsonNode root;
+
+		void onStartObject() override { push('{'); }
+		void onEndObject() override { stack_.pop_back(); }
+		void onStartArray() override { push('['); }
+		void onEndArray() override { stack_.pop_back(); }
+		void onKey(cpv::SharedString&& key) override { key_ = key.view(); }
+		void onString(cpv::SharedString&& value) override { push('s').text = value.view(); }
+		void onNumber(cpv::SharedString&& value) override {
+			push('n').text = JsonNode::formatNumber(std::strtod(std::string(value.view()).c_str(), nullptr));
+		}
+		void onBool(bool value) override { push(value ? 'T' : 'F'); }
+		void onNull() override { push('N'); }
+
+		/** Add new node to current container, keep it on stack if it's a container */
+		JsonNode& push(char type) {
+			JsonNode* node = &root;
+			if (!stack_.empty()) {
+				stack_.back()->children.emplace_back(std::move(key_), JsonNode());
+				node = &stack_.back()->children.back().second;
+			}
+			node->type = type;
+			if (type == '{' || type == '[') {
+				stack_.emplace_back(node);
+			}
+			return *node;
+		}
+
+	private:
+		std::vector<JsonNode*> stack_;
+		std::string key_;
+	};
+
+	/** Generate random json with escapes, non ascii characters and whitespaces */
+	class RandomJsonGenerator {
+	public:
+		std::string generate(bool pretty) {
+			pretty_ = pretty;
+			std::string json;
+			appendWhitespace(json);
+			appendContainer(json, 0);
+			appendWhitespace(json);
+			return json;
+		}
+
+		explicit RandomJsonGenerator(std::uint32_t seed) : engine_(seed), pretty_(false) { }
+
+	private:
+		std::size_t random(std::size_t max) {
+			return std::uniform_int_distribution<std::size_t>(0, max)(engine_);
+		}
+
+		void appendWhitespace(std::string& json) {
+			if (!pretty_) {
+				return;
+			}
+			static const constexpr std::string_view chars(" \t\n\r");
+			for (std::size_t i = random(40); i > 0; --i) {
+				json.append(1, chars[random(chars.size() - 1)]);
+			}
+		}
+
+		void appendString(std::string& json) {
+			static const std::vector<std::string_view> pieces({
+				"\\\"", "\\\\", "\\/", "\\b", "\\f", "\\n", "\\r", "\\t",
+				"\\u0041", "\\u00e9", "\\u4E00", "\\ud83d\\ude00",
+				"\xC3\xA9", "\xE4\xB8\x80", "\xF0\x9F\x98\x80", "\x7f" });
+			json.append("\"");
+			for (std::size_t i = random(4); i > 0; --i) {
+				for (std::size_t j = random(48); j > 0; --j) {
+					json.append(1, static_cast<char>('a' + random(25)));
+				}
+				json.append(pieces[random(pieces.size() - 1)]);
+			}
+			for (std::size_t j = random(48); j > 0; --j) {
+				json.append(1, static_cast<char>('A' + random(25)));
+			}
+			json.append("\"");
+		}
+
+		void appendValue(std::string& json, std::size_t depth) {
+			switch (random(depth < 4 ? 6 : 4)) {
+			case 0:
+				appendString(json);
+				break;
+			case 1:
+				json.append(std::to_string(static_cast<int>(random(2000000)) - 1000000));
+				break;
+			case 2:
+				json.append(std::to_string(random(10000))).append(".").append(
+					std::to_string(random(10000))).append("e-").append(std::to_string(random(9)));
+				break;
+			case 3:
+				json.append(random(1) ? "true" : "false");
+				break;
+			case 4:
+				json.append("null");
+				break;
+			default:
+				appendContainer(json, depth + 1);
+				break;
+			}
+		}
+
+		void appendContainer(std::string& json, std::size_t depth) {
+			bool isObject = random(1);
+			json.append(isObject ? "{" : "[");
+			std::size_t count = random(6);
+			for (std::size_t i = 0; i < count; ++i) {
+				appendWhitespace(json);
+				if (i > 0) {
+					json.append(",");
+					appendWhitespace(json);
+				}
+				if (isObject) {
+					// unique keys, since the order of duplicated keys is unspecified
+					json.append("\"key").append(std::to_string(i)).append("\"");
+					appendWhitespace(json);
+					json.append(":");
+					appendWhitespace(json);
+				}
+				appendValue(json, depth);
+			}
+			appendWhitespace(json);
+			json.append(isObject ? "}" : "]");
+		}
+
+		std::mt19937 engine_;
+		bool pretty_;
+	};
+
+	/** Parse json with sajson and return the dumped tree, or the error message */
+	std::string parseWithSajson(std::string_view json) {
+		cpv::SharedString str(json);
+		std::optional<cpv::JsonDocument> document;
+		auto error = cpv::deserializeJson(document, str);
+		if (error.has_value()) {
+			return std::string("error: ") + error->what();
+		}
+		return JsonNode::fromSajson(document->get_root()).dump();
+	}
+
+	/** Parse json with JsonStreamParser and return the dumped tree */
+	std::string parseWithStreamParser(std::string_view json) {
+		JsonNodeBuilder builder;
+		cpv::JsonStreamParser parser(builder);
+		parser.feed(cpv::SharedString(json));
+		parser.finish();
+		return builder.root.dump();
+	}
+}
+
 template <>
 thread_local cpv::ReusableStorageType<MyPtrModel::ChildModel>
 	cpv::ReusableStorageInstance<MyPtrModel::ChildModel>;
@@ -178,6 +407,110 @@ TEST(JsonDeserializer, stackAllocatedVectorModel) {
 	ASSERT_EQ(models.at(2).requiredValue, 102);
 }
 
+TEST(JsonDeserializer, mapModel) {
+	{
+		cpv::SharedString json(std::string_view(R"(
+			{ "a": { "requiredValue": 100 }, "b\"": { "requiredValue": 101 } }
+		)"));
+		std::unordered_map<cpv::SharedString, MyModel> models;
+		auto error = cpv::deserializeJson(models, json);
+		ASSERT_FALSE(error.has_value());
+		ASSERT_EQ(models.size(), 2U);
+		ASSERT_EQ(models.at("a").requiredValue, 100);
+		ASSERT_EQ(models.at("b\"").requiredValue, 101);
+		for (auto& pair : models) {
+			// keys should share the storage of json string
+			ASSERT_TRUE(pair.first.data() >= json.data());
+			ASSERT_TRUE(pair.first.data() + pair.first.size() <= json.data() + json.size());
+		}
+	}
+	{
+		cpv::SharedString json(std::string_view(R"({ "a": [ 1, 2 ], "b": [ ] })"));
+		std::map<std::string, std::vector<int>> values;
+		auto error = cpv::deserializeJson(values, json);
+		ASSERT_FALSE(error.has_value());
+		ASSERT_EQ(values.size(), 2U);
+		ASSERT_EQ(values.at("a"), std::vector<int>({ 1, 2 }));
+		ASSERT_TRUE(values.at("b").empty());
+	}
+	{
+		cpv::SharedString json(std::string_view(R"({ "a": 1, "b": 2, "c": 3 })"));
+		cpv::StackAllocatedUnorderedMap<cpv::SharedString, int, 2> values;
+		auto error = cpv::deserializeJson(values, json);
+		ASSERT_FALSE(error.has_value());
+		ASSERT_EQ(values.size(), 3U);
+		ASSERT_EQ(values.at("c"), 3);
+	}
+	{
+		cpv::SharedString json(std::string_view(R"({ "a": 1, "b": 2 })"));
+		cpv::StackAllocatedMap<std::string, int, 2> values;
+		auto error = cpv::deserializeJson(values, json);
+		ASSERT_FALSE(error.has_value());
+		ASSERT_EQ(values.size(), 2U);
+		ASSERT_EQ(values.begin()->first, "a");
+		ASSERT_EQ(values.rbegin()->second, 2);
+	}
+}
+
+TEST(JsonDeserializer, mapModelWithDuplicateKeys) {
+	{
+		cpv::SharedString json(std::string_view(R"({ "a": [ 1, 2 ], "b": [ 3 ], "a": [ 4 ] })"));
+		std::map<std::string, std::vector<int>> values;
+		auto error = cpv::deserializeJson(values, json);
+		ASSERT_FALSE(error.has_value());
+		ASSERT_EQ(values.size(), 2U);
+		ASSERT_EQ(values.at("a"), std::vector<int>({ 4 }));
+		ASSERT_EQ(values.at("b"), std::vector<int>({ 3 }));
+	}
+	{
+		cpv::SharedString json(std::string_view(R"(
+			{ "a": { "requiredValue": 100, "intValue": 1 }, "a": { "requiredValue": 101 } }
+		)"));
+		std::unordered_map<cpv::SharedString, MyModel> models;
+		auto error = cpv::deserializeJson(models, json);
+		ASSERT_FALSE(error.has_value());
+		ASSERT_EQ(models.size(), 1U);
+		ASSERT_EQ(models.at("a").requiredValue, 101);
+		ASSERT_EQ(models.at("a").intValue, MyModel().intValue);
+	}
+}
+
+TEST(JsonDeserializer, mapModelWithTypeUnmatchedJson) {
+	{
+		cpv::SharedString json(std::string_view(R"([ 1, 2 ])"));
+		std::map<cpv::SharedString, int> values;
+		auto error = cpv::deserializeJson(values, json);
+		ASSERT_TRUE(error.has_value());
+		ASSERT_CONTAINS(std::string_view(error->what()), "convert failed");
+	}
+	{
+		cpv::SharedString json(std::string_view(R"({ "a": 1, "b": "2" })"));
+		std::map<cpv::SharedString, int> values;
+		auto error = cpv::deserializeJson(values, json);
+		ASSERT_TRUE(error.has_value());
+		ASSERT_CONTAINS(std::string_view(error->what()), "convert failed");
+	}
+}
+
+TEST(JsonDeserializer, variantModel) {
+	cpv::SharedString json(std::string_view(R"(
+		[ null, 1, 1.5, "abc", { "requiredValue": 100 }, { "intValue": 101 } ]
+	)"));
+	using VariantType = std::variant<std::monostate, int, double, cpv::SharedString, MyModel>;
+	std::vector<VariantType> values;
+	auto error = cpv::deserializeJson(values, json);
+	// the last item matches no alternative because MyModel requires requiredValue
+	ASSERT_TRUE(error.has_value());
+	ASSERT_CONTAINS(std::string_view(error->what()), "convert failed");
+	ASSERT_EQ(values.size(), 6U);
+	ASSERT_EQ(values.at(0).index(), 0U);
+	ASSERT_EQ(std::get<int>(values.at(1)), 1);
+	ASSERT_EQ(std::get<double>(values.at(2)), 1.5);
+	ASSERT_EQ(std::get<cpv::SharedString>(values.at(3)), "abc");
+	ASSERT_EQ(std::get<MyModel>(values.at(4)).requiredValue, 100);
+	ASSERT_EQ(values.at(5).index(), 0U);
+}
+
 TEST(JsonDeserializer, ptrModel) {
 	MyPtrModel model;
 	{
@@ -302,6 +635,35 @@ TEST(JsonDeserializer, modelWithTypeUnmatchedJson) {
 	ASSERT_CONTAINS(std::string_view(error->what()), "convert failed");
 }
 
+TEST(JsonDeserializer, reuseAstBuffer) {
+	std::size_t* data = nullptr;
+	{
+		auto astBuffer = cpv::makeReusable<cpv::JsonAstBuffer>(1);
+		ASSERT_GE(astBuffer->capacity(), cpv::JsonAstBuffer::MinCapacity);
+		data = astBuffer->data();
+	}
+	for (std::size_t i = 0; i < 3; ++i) {
+		cpv::SharedString json(std::string_view(R"({ "requiredValue": 1 })"));
+		MyModel model;
+		auto error = cpv::deserializeJson(model, json);
+		ASSERT_FALSE(error.has_value());
+		ASSERT_EQ(model.requiredValue, 1);
+		auto astBuffer = cpv::makeReusable<cpv::JsonAstBuffer>(1);
+		ASSERT_EQ(astBuffer->data(), data);
+	}
+	{
+		// large buffer won't be kept in free list
+		auto astBuffer = cpv::makeReusable<cpv::JsonAstBuffer>(
+			cpv::JsonAstBuffer::MaxReservedCapacity + 1);
+		ASSERT_GE(astBuffer->capacity(), cpv::JsonAstBuffer::MaxReservedCapacity + 1);
+	}
+	{
+		auto astBuffer = cpv::makeReusable<cpv::JsonAstBuffer>(1);
+		ASSERT_GE(astBuffer->capacity(), cpv::JsonAstBuffer::MinCapacity);
+		ASSERT_LE(astBuffer->capacity(), cpv::JsonAstBuffer::MaxReservedCapacity);
+	}
+}
+
 TEST(JsonDeserializer, jsonDocument) {
 	cpv::SharedString json(std::string_view(R"(
 		{
@@ -332,3 +694,53 @@ TEST(JsonDeserializer, jsonDocumentWithCorruptedJson) {
 	ASSERT_CONTAINS(std::string_view(error->what()), "unexpected end of input");
 }
 
+TEST(JsonDeserializer, differentialWithStreamParser) {
+	cpv::gtest::runWithEachEscapeCharScanner([&] {
+		RandomJsonGenerator generator(20191001);
+		for (std::size_t i = 0; i < 2000; ++i) {
+			std::string json = generator.generate(i % 2 == 0);
+			std::string expected = parseWithStreamParser(json);
+			std::string actual = parseWithSajson(json);
+			ASSERT_EQ(actual, expected) << json;
+		}
+	});
+}
+
+TEST(JsonDeserializer, specialCharAtEveryPosition) {
+	cpv::gtest::runWithEachEscapeCharScanner([&] {
+		// plain string may be scanned 16 or 32 bytes at a time, test all offsets inside and across blocks
+		for (std::size_t length = 0; length < 80; ++length) {
+			for (std::size_t position = 0; position <= length; ++position) {
+				std::string prefix(position, 'a');
+				std::string suffix(length - position, 'b');
+				ASSERT_EQ(parseWithSajson("[\"" + prefix + "\\n" + suffix + "\"]"),
+					"[(:s(" + prefix + "\n" + suffix + "),)");
+				ASSERT_EQ(parseWithSajson("[\"" + prefix + "\\n" + suffix + "\\t" + prefix + "\"]"),
+					"[(:s(" + prefix + "\n" + suffix + "\t" + prefix + "),)");
+				ASSERT_EQ(parseWithSajson("[\"" + prefix + "\xC3\xA9" + suffix + "\"]"),
+					"[(:s(" + prefix + "\xC3\xA9" + suffix + "),)");
+				ASSERT_EQ(parseWithSajson("[\"" + prefix + "\x7f" + suffix + "\"]"),
+					"[(:s(" + prefix + "\x7f" + suffix + "),)");
+				ASSERT_CONTAINS(parseWithSajson("[\"" + prefix + "\x01" + suffix + "\"]"),
+					"illegal unprintable codepoint in string");
+				ASSERT_CONTAINS(parseWithSajson("[\"" + prefix + "\\n" + suffix + "\x01\"]"),
+					"illegal unprintable codepoint in string");
+				ASSERT_CONTAINS(parseWithSajson("[\"" + prefix + suffix), "unexpected end of input");
+				ASSERT_CONTAINS(parseWithSajson("[\"" + prefix + "\\n" + suffix), "unexpected end of input");
+			}
+		}
+	});
+}
+
+TEST(JsonDeserializer, whitespacesOfEveryLength) {
+	for (std::size_t length = 0; length < 80; ++length) {
+		std::string whitespaces;
+		for (std::size_t i = 0; i < length; ++i) {
+			whitespaces.append(1, " \t\n\r"[i % 4]);
+		}
+		ASSERT_EQ(parseWithSajson(whitespaces + "[" + whitespaces + "1" + whitespaces +
+			"," + whitespaces + "true" + whitespaces + "]" + whitespaces), "[(:n(1),:T(),)");
+		ASSERT_CONTAINS(parseWithSajson(whitespaces), "missing root element");
+		ASSERT_CONTAINS(parseWithSajson("[" + whitespaces), "unexpected end of input");
+	}
+}
@@ -0,0 +1,186 @@
+#include <CPVFramework/Serialize/JsonFields.hpp>
+#include <CPVFramework/Testing/GTestUtils.hpp>
+
+namespace {
+	class MyModel {
+	public:
+		class ChildModel {
+		public:
+			int count = 0;
+			CPV_JSON_FIELDS(count)
+		};
+
+		int intValue = -1;
+		std::size_t sizeValue = 0;
+		double doubleValue = 0;
+		std::chrono::seconds durationValue;
+		std::string stringValue;
+		cpv::SharedString sharedStringValue;
+		ChildModel childValue;
+		std::vector<ChildModel> childValues;
+		std::vector<int> intValues;
+		std::optional<int> optionalValue;
+		CPV_JSON_FIELDS(
+			intValue, sizeValue, doubleValue, durationValue,
+			stringValue, sharedStringValue, childValue, childValues,
+			intValues, optionalValue)
+	};
+
+	class StringModel {
+	public:
+		cpv::SharedString a;
+		std::string b;
+		CPV_JSON_FIELDS(a, b)
+	};
+
+	class ManyFieldsModel {
+	public:
+		int f0 = 0, f1 = 0, f2 = 0, f3 = 0, f4 = 0, f5 = 0, f6 = 0, f7 = 0;
+		int f8 = 0, f9 = 0, f10 = 0, f11 = 0, f12 = 0, f13 = 0, f14 = 0, f15 = 0;
+		int f16 = 0, f17 = 0, f18 = 0, f19 = 0, f20 = 0, f21 = 0, f22 = 0, f23 = 0;
+		int f24 = 0, f25 = 0, f26 = 0, f27 = 0, f28 = 0, f29 = 0, f30 = 0, f31 = 0;
+		CPV_JSON_FIELDS(
+			f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15,
+			f16, f17, f18, f19, f20, f21, f22, f23, f24, f25, f26, f27, f28, f29, f30, f31)
+	};
+}
+
+TEST(JsonFields, makeKeys) {
+	static const constexpr auto keys = cpv::JsonFields<int, std::string, cpv::SharedString, int>::makeKeys(
+		"a", "bc", "d", "e");
+	static_assert(keys.get(0) == "{\"a\":");
+	static_assert(keys.get(1) == ",\"bc\":\"");
+	static_assert(keys.get(2) == "\",\"d\":\"");
+	static_assert(keys.get(3) == "\",\"e\":");
+	static_assert(keys.get(4) == "}");
+	static const constexpr auto stringKeys = cpv::JsonFields<std::string>::makeKeys("a");
+	static_assert(stringKeys.get(0) == "{\"a\":\"");
+	static_assert(stringKeys.get(1) == "\"}");
+}
+
+TEST(JsonFields, makeIndex) {
+	static const constexpr auto index = cpv::JsonFields<int, int, int, int>::makeIndex(
+		"a", "bc", "", "abc");
+	ASSERT_EQ(index.find("a"), 0U);
+	ASSERT_EQ(index.find("bc"), 1U);
+	ASSERT_EQ(index.find(""), 2U);
+	ASSERT_EQ(index.find("abc"), 3U);
+	ASSERT_EQ(index.find("b"), 4U);
+	ASSERT_EQ(index.find("ab"), 4U);
+	ASSERT_EQ(index.find("abcd"), 4U);
+}
+
+TEST(JsonFields, serialize) {
+	for (std::size_t sizeHint : { std::size_t(1), cpv::JsonSerializer<MyModel>::MaxContiguousBufferSizeHint + 1 }) {
+		MyModel model;
+		model.intValue = 101;
+		model.sizeValue = 102;
+		model.doubleValue = 103.1;
+		model.durationValue = std::chrono::seconds(321);
+		model.stringValue = "test\n一二三";
+		model.sharedStringValue = "一二三\"";
+		model.childValue.count = -1;
+		model.childValues.resize(2);
+		model.childValues.at(0).count = 1;
+		model.childValues.at(1).count = 2;
+		model.intValues = { 1, 2, 3 };
+		cpv::Packet packet = cpv::serializeJson(model, sizeHint);
+		ASSERT_EQ(packet.toString(),
+			"{\"intValue\":101,\"sizeValue\":102,\"doubleValue\":103.1,"
+			"\"durationValue\":321,"
+			"\"stringValue\":\"test\\n\xE4\xB8\x80\xE4\xBA\x8C\xE4\xB8\x89\","
+			"\"sharedStringValue\":\"\xE4\xB8\x80\xE4\xBA\x8C\xE4\xB8\x89\\\"\","
+			"\"childValue\":{\"count\":-1},"
+			"\"childValues\":[{\"count\":1},{\"count\":2}],"
+			"\"intValues\":[1,2,3],"
+			"\"optionalValue\":null}");
+	}
+}
+
+TEST(JsonFields, serializeStrings) {
+	StringModel model;
+	model.a = "\"a\"";
+	model.b = "b";
+	ASSERT_EQ(cpv::serializeJson(model).toString(), "{\"a\":\"\\\"a\\\"\",\"b\":\"b\"}");
+	std::vector<StringModel> models(2);
+	ASSERT_EQ(cpv::serializeJson(models).toString(),
+		"[{\"a\":\"\",\"b\":\"\"},{\"a\":\"\",\"b\":\"\"}]");
+}
+
+TEST(JsonFields, deserialize) {
+	cpv::SharedString json(std::string_view(R"(
+		{
+			"unknownValue": [ 1, 2 ],
+			"intValue": 101,
+			"sizeValue": 102,
+			"doubleValue": 103,
+			"durationValue": 321,
+			"stringValue": "test 一二三",
+			"sharedStringValue": "一二三",
+			"childValue": { "count": -1, "unknownValue": 1 },
+			"childValues": [ { "count": 1 }, { "count": 2 }, { } ],
+			"intValues": [ 1, 2, 3 ],
+			"optionalValue": 4
+		}
+	)"));
+	MyModel model;
+	auto error = cpv::deserializeJson(model, json);
+	ASSERT_FALSE(error.has_value());
+	ASSERT_EQ(model.intValue, 101);
+	ASSERT_EQ(model.sizeValue, 102U);
+	ASSERT_EQ((int)model.doubleValue, 103);
+	ASSERT_EQ(model.durationValue.count(), 321U);
+	ASSERT_EQ(model.stringValue, "test 一二三");
+	ASSERT_EQ(model.sharedStringValue, "一二三");
+	ASSERT_EQ(model.childValue.count, -1);
+	ASSERT_EQ(model.childValues.size(), 3U);
+	ASSERT_EQ(model.childValues.at(0).count, 1);
+	ASSERT_EQ(model.childValues.at(1).count, 2);
+	ASSERT_EQ(model.childValues.at(2).count, 0);
+	ASSERT_EQ(model.intValues.size(), 3U);
+	ASSERT_EQ(model.intValues.at(2), 3);
+	ASSERT_TRUE(model.optionalValue.has_value());
+	ASSERT_EQ(*model.optionalValue, 4);
+}
+
+TEST(JsonFields, deserializeMissingMembers) {
+	cpv::SharedString json(std::string_view(R"({ "sizeValue": 1 })"));
+	MyModel model;
+	auto error = cpv::deserializeJson(model, json);
+	ASSERT_FALSE(error.has_value());
+	ASSERT_EQ(model.intValue, -1);
+	ASSERT_EQ(model.sizeValue, 1U);
+	ASSERT_FALSE(model.optionalValue.has_value());
+}
+
+TEST(JsonFields, deserializeNotObject) {
+	cpv::SharedString json(std::string_view(R"([ 1, 2 ])"));
+	MyModel model;
+	auto error = cpv::deserializeJson(model, json);
+	ASSERT_TRUE(error.has_value());
+}
+
+TEST(JsonFields, manyFields) {
+	ManyFieldsModel model;
+	model.f0 = 100;
+	model.f31 = 131;
+	cpv::SharedString json = cpv::serializeJson(model).toString();
+	ASSERT_TRUE(json.view().find("\"f0\":100,") != std::string_view::npos);
+	ASSERT_TRUE(json.view().find(",\"f31\":131}") != std::string_view::npos);
+	std::string jsonStr(json.view());
+	for (std::size_t i = 1; i < 31; ++i) {
+		std::string from = "\"f" + std::to_string(i) + "\":0";
+		std::string to = "\"f" + std::to_string(i) + "\":" + std::to_string(100 + i);
+		jsonStr.replace(jsonStr.find(from), from.size(), to);
+	}
+	cpv::SharedString mutableJson(jsonStr);
+	ManyFieldsModel loaded;
+	auto error = cpv::deserializeJson(loaded, mutableJson);
+	ASSERT_FALSE(error.has_value());
+	ASSERT_EQ(loaded.f0, 100);
+	ASSERT_EQ(loaded.f1, 101);
+	ASSERT_EQ(loaded.f15, 115);
+	ASSERT_EQ(loaded.f30, 130);
+	ASSERT_EQ(loaded.f31, 131);
+}
+
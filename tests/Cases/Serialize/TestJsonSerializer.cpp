@@ -1,3 +1,4 @@
+#include <random>
 #include <CPVFramework/Serialize/JsonSerializer.hpp>
 #include <CPVFramework/Serialize/JsonDeserializer.hpp>
 #include <CPVFramework/Testing/GTestUtils.hpp>
@@ -182,6 +183,51 @@ TEST(JsonSerializer, stackAllocatedVectorModel) {
 	ASSERT_FALSE(error.has_value());
 }
 
+TEST(JsonSerializer, mapModel) {
+	{
+		std::map<cpv::SharedString, MyModel::ChildModel> models;
+		models["a"].count = 1;
+		models["b\""].count = 2;
+		cpv::Packet packet = cpv::serializeJson(models);
+		ASSERT_EQ(packet.toString(), "{\"a\":{\"count\":1},\"b\\\"\":{\"count\":2}}");
+	}
+	{
+		std::map<std::string, std::vector<int>> values;
+		values["a"] = { 1, 2 };
+		values["b"] = { };
+		cpv::Packet packet = cpv::serializeJson(values);
+		ASSERT_EQ(packet.toString(), "{\"a\":[1,2],\"b\":[]}");
+	}
+	{
+		std::unordered_map<cpv::SharedString, int> values;
+		values.emplace("a", 1);
+		cpv::Packet packet = cpv::serializeJson(values);
+		ASSERT_EQ(packet.toString(), "{\"a\":1}");
+		values.clear();
+		ASSERT_EQ(cpv::serializeJson(values).toString(), "{}");
+	}
+	{
+		cpv::StackAllocatedMap<std::string, int, 2> values({ { "a", 1 }, { "b", 2 } });
+		cpv::Packet packet = cpv::serializeJson(values);
+		ASSERT_EQ(packet.toString(), "{\"a\":1,\"b\":2}");
+	}
+	{
+		cpv::StackAllocatedUnorderedMap<std::string, int, 2> values({ { "a", 1 } });
+		cpv::Packet packet = cpv::serializeJson(values);
+		ASSERT_EQ(packet.toString(), "{\"a\":1}");
+	}
+}
+
+TEST(JsonSerializer, variantModel) {
+	using VariantType = std::variant<std::monostate, int, cpv::SharedString, MyModel::ChildModel>;
+	std::vector<VariantType> values(4);
+	values.at(1) = 123;
+	values.at(2) = cpv::SharedString("abc\"");
+	values.at(3) = MyModel::ChildModel();
+	cpv::Packet packet = cpv::serializeJson(values);
+	ASSERT_EQ(packet.toString(), "[null,123,\"abc\\\"\",{\"count\":0}]");
+}
+
 TEST(JsonSerializer, ptrModel) {
 	{
 		MyPtrModel model;
@@ -232,3 +278,132 @@ TEST(JsonSerializer, ptrWrappedModel) {
 	}
 }
 
+
+TEST(JsonSerializer, contiguousBufferMode) {
+	{
+		MyModel model;
+		model.intValue = 101;
+		model.intValues = { 1, 2, 3 };
+		cpv::Packet packet = cpv::serializeJson(model);
+		ASSERT_EQ(packet.segments(), 1U);
+		ASSERT_EQ(packet.toString(),
+			"{\"intValue\":101,\"sizeValue\":0,\"doubleValue\":0,\"durationValue\":0,"
+			"\"stringValue\":\"\",\"sharedStringValue\":\"\","
+			"\"childValue\":{\"count\":0},\"childValues\":[],"
+			"\"intValues\":[1,2,3],\"intValuesOnStack\":[]}");
+	}
+	{
+		// large string will be appended as a separate fragment without copying
+		MyModel model;
+		std::string largeString(cpv::JsonBuilder::LargeStringThreshold, 'x');
+		model.sharedStringValue = cpv::SharedString(largeString);
+		cpv::Packet packet = cpv::serializeJson(model);
+		ASSERT_EQ(packet.segments(), 3U);
+		auto* fragments = packet.getIfMultiple();
+		ASSERT_TRUE(fragments != nullptr);
+		ASSERT_EQ(fragments->fragments.at(1).base, model.sharedStringValue.data());
+		ASSERT_EQ(packet.toString(),
+			"{\"intValue\":0,\"sizeValue\":0,\"doubleValue\":0,\"durationValue\":0,"
+			"\"stringValue\":\"\",\"sharedStringValue\":\"" + largeString + "\","
+			"\"childValue\":{\"count\":0},\"childValues\":[],"
+			"\"intValues\":[],\"intValuesOnStack\":[]}");
+	}
+	{
+		// use fragments mode for very large size hint
+		MyModel model;
+		cpv::Packet packet = cpv::serializeJson(model,
+			cpv::JsonSerializer<MyModel>::MaxContiguousBufferSizeHint + 1);
+		ASSERT_TRUE(packet.getIfMultiple() != nullptr);
+		ASSERT_EQ(packet.toString(),
+			"{\"intValue\":0,\"sizeValue\":0,\"doubleValue\":0,\"durationValue\":0,"
+			"\"stringValue\":\"\",\"sharedStringValue\":\"\","
+			"\"childValue\":{\"count\":0},\"childValues\":[],"
+			"\"intValues\":[],\"intValuesOnStack\":[]}");
+	}
+}
+
+TEST(JsonSerializer, builderModes) {
+	for (auto mode : { cpv::JsonBuilderMode::Fragments, cpv::JsonBuilderMode::ContiguousBuffer }) {
+		cpv::JsonBuilder builder(mode, 16);
+		builder.startObject()
+			.addMember("a", 1)
+			.addMember(CPV_JSONKEY("b"), std::vector<int>({ 2, 3 }))
+			.addMember("c", cpv::SharedString("\"d\""))
+			.endObject();
+		cpv::Packet packet = std::move(builder).toPacket();
+		ASSERT_EQ(packet.toString(), "{\"a\":1,\"b\":[2,3],\"c\":\"\\\"d\\\"\"}");
+		if (mode == cpv::JsonBuilderMode::ContiguousBuffer) {
+			ASSERT_EQ(packet.segments(), 1U);
+		}
+	}
+}
+
+TEST(JsonSerializer, numbers) {
+	for (auto mode : { cpv::JsonBuilderMode::Fragments, cpv::JsonBuilderMode::ContiguousBuffer }) {
+		cpv::JsonBuilder builder(mode, 16);
+		builder.startArray()
+			.addItem(0)
+			.addItem(12345678)
+			.addItem(-9223372036854775807LL - 1)
+			.addItem(18446744073709551615ULL)
+			.addItem(0.5)
+			.addItem(-103.1)
+			.addItem(100.0)
+			.addItem(std::chrono::seconds(-3))
+			.endArray();
+		cpv::Packet packet = std::move(builder).toPacket();
+		ASSERT_EQ(packet.toString(),
+			"[0,12345678,-9223372036854775808,18446744073709551615,0.5,-103.1,100,-3]");
+		if (mode == cpv::JsonBuilderMode::ContiguousBuffer) {
+			ASSERT_EQ(packet.segments(), 1U);
+		}
+	}
+}
+
+TEST(JsonSerializer, jsonEncode) {
+	ASSERT_EQ(cpv::jsonEncode("abc"), "abc");
+	ASSERT_EQ(cpv::jsonEncode("\"a\\b\"\r\n\x01\x1f\x7f"), "\\\"a\\\\b\\\"\\r\\n\\u0001\\u001f\x7f");
+	// check with escape chars at every position of strings with different size
+	auto reference = [] (const std::string& str) {
+		static const char digits[] = "0123456789abcdef";
+		std::string result;
+		for (char c : str) {
+			switch (c) {
+				case '"': result.append("\\\""); break;
+				case '\\': result.append("\\\\"); break;
+				case '\b': result.append("\\b"); break;
+				case '\f': result.append("\\f"); break;
+				case '\n': result.append("\\n"); break;
+				case '\r': result.append("\\r"); break;
+				case '\t': result.append("\\t"); break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20) {
+						result.append("\\u00").append(1, digits[c >> 4]).append(1, digits[c & 0xf]);
+					} else {
+						result.append(1, c);
+					}
+			}
+		}
+		return result;
+	};
+	static const std::string_view specialChars("\"\\\n\x00\x1f\x20\x7f\x80", 8);
+	for (std::size_t size = 0; size < 70; ++size) {
+		std::string str(size, 'a');
+		ASSERT_EQ(cpv::jsonEncode(cpv::SharedString(str)), reference(str));
+		for (std::size_t pos = 0; pos < size; ++pos) {
+			for (char c : specialChars) {
+				str[pos] = c;
+				ASSERT_EQ(cpv::jsonEncode(cpv::SharedString(str)), reference(str));
+				str[pos] = 'a';
+			}
+		}
+	}
+	std::mt19937 generator(12345);
+	for (std::size_t i = 0; i < 1000; ++i) {
+		std::string str(generator() % 100, 'a');
+		for (char& c : str) {
+			c = static_cast<char>(generator() % 256);
+		}
+		ASSERT_EQ(cpv::jsonEncode(cpv::SharedString(str)), reference(str));
+	}
+}
@@ -0,0 +1,234 @@
+#include <seastar/core/future-util.hh>
+#include <CPVFramework/Serialize/JsonStreamParser.hpp>
+#include <CPVFramework/Stream/PacketInputStream.hpp>
+#include <CPVFramework/Testing/GTestUtils.hpp>
+
+namespace {
+	/** Handler that records events as text */
+	class RecordingHandler : public cpv::JsonStreamHandler {
+	public:
+		std::string events;
+		std::vector<cpv::SharedString> strings;
+
+		void onStartObject() override { events.append("{"); }
+		void onEndObject() override { events.append("}"); }
+		void onStartArray() override { events.append("["); }
+		void onEndArray() override { events.append("]"); }
+		void onKey(cpv::SharedString&& key) override {
+			events.append("k(").append(key.view()).append(")");
+		}
+		void onString(cpv::SharedString&& value) override {
+			events.append("s(").append(value.view()).append(")");
+			strings.emplace_back(std::move(value));
+		}
+		void onNumber(cpv::SharedString&& value) override {
+			events.append("n(").append(value.view()).append(")");
+		}
+		void onBool(bool value) override { events.append(value ? "T" : "F"); }
+		void onNull() override { events.append("N"); }
+	};
+
+	/** Parse json with given chunk sizes and return recorded events */
+	std::string parseByChunks(std::string_view json, std::size_t chunkSize) {
+		RecordingHandler handler;
+		cpv::JsonStreamParser parser(handler);
+		for (std::size_t i = 0; i < json.size(); i += chunkSize) {
+			parser.feed(cpv::SharedString(json.substr(i, chunkSize)));
+		}
+		parser.finish();
+		return handler.events;
+	}
+
+	/** Parse json at once and return the exception message if failed */
+	std::string parseError(std::string_view json,
+		std::size_t maxDepth = cpv::JsonStreamParser::DefaultMaxDepth,
+		std::size_t maxTokenSize = cpv::JsonStreamParser::DefaultMaxTokenSize,
+		std::size_t maxSize = std::numeric_limits<std::size_t>::max()) {
+		RecordingHandler handler;
+		cpv::JsonStreamParser parser(handler, maxDepth, maxTokenSize, maxSize);
+		try {
+			parser.feed(cpv::SharedString(json));
+			parser.finish();
+		} catch (const cpv::DeserializeException& ex) {
+			return ex.what();
+		}
+		return "";
+	}
+
+	class ItemModel {
+	public:
+		int id = 0;
+		std::string name;
+
+		bool loadJson(const cpv::JsonValue& value) {
+			id << value["id"];
+			name << value["name"];
+			return true;
+		}
+	};
+
+	/** Make packet input stream that returns json by given chunk size */
+	cpv::Reusable<cpv::InputStreamBase> makeStream(std::string_view json, std::size_t chunkSize) {
+		cpv::Packet packet;
+		for (std::size_t i = 0; i < json.size(); i += chunkSize) {
+			packet.append(cpv::SharedString(json.substr(i, chunkSize)));
+		}
+		return cpv::makeReusable<cpv::PacketInputStream>(std::move(packet))
+			.cast<cpv::InputStreamBase>();
+	}
+}
+
+TEST(JsonStreamParser, parse) {
+	std::string_view json(R"( {
+		"a": 1, "b": -12.5e+3, "c": "text",
+		"d": [ true, false, null, [], {}, [ 0, "" ] ],
+		"e\"": { "f": "\\\"\/\b\f\n\r\t\u0041\u00e9\u4e00\ud83d\ude00" }
+	} )");
+	std::string expected =
+		"{k(a)n(1)k(b)n(-12.5e+3)k(c)s(text)"
+		"k(d)[TFN[]{}[n(0)s()]]"
+		"k(e\")"
+		"{k(f)s(\\\"/\b\f\n\r\t" "A\xC3\xA9\xE4\xB8\x80\xF0\x9F\x98\x80)}}";
+	for (std::size_t chunkSize = 1; chunkSize <= json.size(); ++chunkSize) {
+		ASSERT_EQ(parseByChunks(json, chunkSize), expected) << "chunkSize: " << chunkSize;
+	}
+}
+
+TEST(JsonStreamParser, parseRootValue) {
+	ASSERT_EQ(parseByChunks("123", 1), "n(123)");
+	ASSERT_EQ(parseByChunks(" \"abc\" ", 2), "s(abc)");
+	ASSERT_EQ(parseByChunks("true", 3), "T");
+	ASSERT_EQ(parseByChunks("[]", 1), "[]");
+}
+
+TEST(JsonStreamParser, zeroCopy) {
+	RecordingHandler handler;
+	cpv::JsonStreamParser parser(handler);
+	cpv::SharedString chunk("[\"abc\",\"de");
+	parser.feed(chunk);
+	parser.feed(cpv::SharedString("f\"]"));
+	parser.finish();
+	ASSERT_EQ(handler.strings.size(), 2U);
+	ASSERT_EQ(handler.strings.at(0), "abc");
+	ASSERT_EQ(handler.strings.at(0).data(), chunk.data() + 2);
+	ASSERT_EQ(handler.strings.at(1), "def");
+	ASSERT_EQ(parser.parsedSize(), 13U);
+}
+
+TEST(JsonStreamParser, errors) {
+	ASSERT_CONTAINS(parseError(""), "unexpected end of json");
+	ASSERT_CONTAINS(parseError("[1,2"), "unexpected end of json");
+	ASSERT_CONTAINS(parseError("{\"a\""), "unexpected end of json");
+	ASSERT_CONTAINS(parseError("[1,]"), "unexpected character at position 3");
+	ASSERT_CONTAINS(parseError("[1 2]"), "expect ',' or end of container");
+	ASSERT_CONTAINS(parseError("[1}"), "expect ',' or end of container");
+	ASSERT_CONTAINS(parseError("{a:1}"), "expect object key");
+	ASSERT_CONTAINS(parseError("{\"a\",1}"), "expect ':'");
+	ASSERT_CONTAINS(parseError("{\"a\":1,}"), "expect object key");
+	ASSERT_CONTAINS(parseError("[] []"), "unexpected character after root element");
+	ASSERT_CONTAINS(parseError("[tru]"), "invalid literal");
+	ASSERT_CONTAINS(parseError("[nul"), "unexpected end of json");
+	ASSERT_CONTAINS(parseError("[01]"), "invalid number");
+	ASSERT_CONTAINS(parseError("[1.]"), "invalid number");
+	ASSERT_CONTAINS(parseError("[1e]"), "invalid number");
+	ASSERT_CONTAINS(parseError("-"), "invalid number");
+	ASSERT_CONTAINS(parseError("[\"\\x\"]"), "invalid escape character");
+	ASSERT_CONTAINS(parseError("[\"\\u00g0\"]"), "invalid unicode escape");
+	ASSERT_CONTAINS(parseError("[\"\\ud83d\"]"), "invalid surrogate pair");
+	ASSERT_CONTAINS(parseError("[\"\\ud83d\\u0041\"]"), "invalid surrogate pair");
+	ASSERT_CONTAINS(parseError("[\"\\ude00\"]"), "invalid surrogate pair");
+	ASSERT_CONTAINS(parseError("[\"a\nb\"]"), "control character in string");
+	ASSERT_EQ(parseError("[[[]]]", 3), "");
+	ASSERT_CONTAINS(parseError("[[[[]]]]", 3), "json depth exceeds limit");
+	ASSERT_CONTAINS(parseError("[\"abcd\\n\"]", 64, 4), "json token size exceeds limit");
+	ASSERT_CONTAINS(parseError("[1,2,3]", 64, 4, 6), "json size exceeds limit");
+}
+
+TEST(JsonStreamParser, tokenLimitAcrossChunks) {
+	RecordingHandler handler;
+	cpv::JsonStreamParser parser(handler, cpv::JsonStreamParser::DefaultMaxDepth, 4);
+	parser.feed(cpv::SharedString("[\"ab"));
+	parser.feed(cpv::SharedString("cd"));
+	ASSERT_THROWS_CONTAINS(cpv::DeserializeException,
+		parser.feed(cpv::SharedString("e\"]")), "json token size exceeds limit");
+}
+
+TEST(JsonStreamParser, tokenLimitInsideChunk) {
+	ASSERT_EQ(parseError("[\"abcd\",1234]", 64, 4), "");
+	ASSERT_CONTAINS(parseError("[\"abcde\"]", 64, 4), "json token size exceeds limit");
+	ASSERT_CONTAINS(parseError("{\"abcde\":1}", 64, 4), "json token size exceeds limit");
+	ASSERT_CONTAINS(parseError("[12345]", 64, 4), "json token size exceeds limit");
+}
+
+TEST_FUTURE(JsonStreamParser, parseJsonFromStream) {
+	return seastar::do_with(
+		RecordingHandler(),
+		makeStream("{\"a\":[1,2,\"b\"]}", 3),
+		[] (auto& handler, auto& stream) {
+		return seastar::do_with(cpv::JsonStreamParser(handler), [&handler, &stream] (auto& parser) {
+			return cpv::parseJsonFromStream(*stream, parser).then([&handler] {
+				ASSERT_EQ(handler.events, "{k(a)[n(1)n(2)s(b)]}");
+			});
+		});
+	});
+}
+
+TEST_FUTURE(JsonStreamParser, deserializeJsonItemsFromStream) {
+	return seastar::do_with(
+		std::vector<ItemModel>(),
+		makeStream(R"([
+			{ "id": 1, "name": "a\"b", "extra": [ { "x": null }, true, 1.5 ] },
+			{ "id": 2, "name": "\u4e00" },
+			{ }
+		])", 7),
+		[] (auto& models, auto& stream) {
+		return cpv::deserializeJsonItemsFromStream<ItemModel>(*stream, [&models] (ItemModel&& model) {
+			models.emplace_back(std::move(model));
+			return seastar::make_ready_future<>();
+		}).then([&models] {
+			ASSERT_EQ(models.size(), 3U);
+			ASSERT_EQ(models.at(0).id, 1);
+			ASSERT_EQ(models.at(0).name, "a\"b");
+			ASSERT_EQ(models.at(1).id, 2);
+			ASSERT_EQ(models.at(1).name, "\xE4\xB8\x80");
+			ASSERT_EQ(models.at(2).id, 0);
+		});
+	});
+}
+
+TEST_FUTURE(JsonStreamParser, deserializeJsonItemsFromStreamScalars) {
+	return seastar::do_with(
+		std::vector<int>(),
+		makeStream("[1, 2, 3]", 1),
+		[] (auto& values, auto& stream) {
+		return cpv::deserializeJsonItemsFromStream<int>(*stream, [&values] (int value) {
+			values.emplace_back(value);
+			return seastar::make_ready_future<>();
+		}).then([&values] {
+			ASSERT_EQ(values, std::vector<int>({ 1, 2, 3 }));
+		});
+	});
+}
+
+TEST_FUTURE(JsonStreamParser, deserializeJsonItemsFromStreamErrors) {
+	return seastar::do_with(
+		makeStream("{\"id\":1}", 3),
+		makeStream("[{\"id\":1},{\"id\":\"abcdefgh\"}]", 3),
+		makeStream("[1,\"a\"]", 3),
+		[] (auto& notArray, auto& tooLarge, auto& notConvertible) {
+		auto func = [] (auto&&) { return seastar::make_ready_future<>(); };
+		return cpv::deserializeJsonItemsFromStream<ItemModel>(*notArray, func)
+		.then_wrapped([] (seastar::future<> f) {
+			ASSERT_THROWS_CONTAINS(cpv::DeserializeException, f.get(), "root element must be array");
+		}).then([&tooLarge, func] {
+			return cpv::deserializeJsonItemsFromStream<ItemModel>(*tooLarge, func, 16);
+		}).then_wrapped([] (seastar::future<> f) {
+			ASSERT_THROWS_CONTAINS(cpv::DeserializeException, f.get(), "json item size exceeds limit");
+		}).then([&notConvertible, func] {
+			return cpv::deserializeJsonItemsFromStream<int>(*notConvertible, func);
+		}).then_wrapped([] (seastar::future<> f) {
+			ASSERT_THROWS_CONTAINS(cpv::DeserializeException, f.get(), "convert failed");
+		});
+	});
+}
+
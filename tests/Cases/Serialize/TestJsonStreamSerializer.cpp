@@ -0,0 +1,81 @@
+#include <seastar/core/future-util.hh>
+#include <CPVFramework/Serialize/JsonStreamSerializer.hpp>
+#include <CPVFramework/Testing/GTestUtils.hpp>
+
+namespace {
+	/** Output stream that records each write */
+	class RecordingOutputStream : public cpv::OutputStreamBase {
+	public:
+		std::vector<std::string> writes;
+
+		seastar::future<> write(cpv::Packet&& data) override {
+			writes.emplace_back(data.toString().view());
+			return seastar::make_ready_future<>();
+		}
+	};
+
+	class ItemModel {
+	public:
+		int id = 0;
+		cpv::SharedString name;
+
+		void dumpJson(cpv::JsonBuilder& builder) const {
+			builder.startObject()
+				.addMember(CPV_JSONKEY("id"), id)
+				.addMember(CPV_JSONKEY("name"), name)
+				.endObject();
+		}
+	};
+}
+
+TEST_FUTURE(JsonStreamSerializer, collection) {
+	return seastar::do_with(
+		RecordingOutputStream(),
+		std::vector<ItemModel>(100),
+		[] (auto& stream, auto& items) {
+		for (std::size_t i = 0; i < items.size(); ++i) {
+			items[i].id = static_cast<int>(i);
+			items[i].name = cpv::SharedString(std::string(i % 3 == 0 ? 300 : 10, 'a'));
+		}
+		return cpv::serializeJsonToStream(stream, items, 1024).then([&stream, &items] {
+			// flushed by parts, and each part (except the last one) is not smaller than threshold
+			ASSERT_GT(stream.writes.size(), 10U);
+			std::string json;
+			for (std::size_t i = 0; i < stream.writes.size(); ++i) {
+				if (i + 1 < stream.writes.size()) {
+					ASSERT_GE(stream.writes[i].size(), 1024U);
+					ASSERT_LT(stream.writes[i].size(), 1024U + 400U);
+				}
+				json.append(stream.writes[i]);
+			}
+			ASSERT_EQ(json, cpv::serializeJson(items).toString().view());
+		});
+	});
+}
+
+TEST_FUTURE(JsonStreamSerializer, emptyCollection) {
+	return seastar::do_with(
+		RecordingOutputStream(),
+		std::vector<int>(),
+		[] (auto& stream, auto& items) {
+		return cpv::serializeJsonToStream(stream, items).then([&stream] {
+			ASSERT_EQ(stream.writes.size(), 1U);
+			ASSERT_EQ(stream.writes.at(0), "[]");
+		});
+	});
+}
+
+TEST_FUTURE(JsonStreamSerializer, model) {
+	return seastar::do_with(
+		RecordingOutputStream(),
+		ItemModel(),
+		[] (auto& stream, auto& item) {
+		item.id = 1;
+		item.name = "abc";
+		return cpv::serializeJsonToStream(stream, item).then([&stream] {
+			ASSERT_EQ(stream.writes.size(), 1U);
+			ASSERT_EQ(stream.writes.at(0), "{\"id\":1,\"name\":\"abc\"}");
+		});
+	});
+}
+
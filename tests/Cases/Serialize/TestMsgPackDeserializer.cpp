@@ -0,0 +1,236 @@
+#include <CPVFramework/Serialize/MsgPackDeserializer.hpp>
+#include <CPVFramework/Serialize/MsgPackSerializer.hpp>
+#include <CPVFramework/Testing/GTestUtils.hpp>
+
+namespace {
+	class MyModel {
+	public:
+		class ChildModel {
+		public:
+			int count = 0;
+
+			void dumpMsgPack(cpv::MsgPackBuilder& builder) const {
+				builder.startMap(1)
+					.addMember("count", count);
+			}
+
+			bool loadMsgPack(const cpv::MsgPackValue& value) {
+				count << value["count"];
+				return true;
+			}
+		};
+
+		int requiredValue = -1;
+		std::size_t sizeValue = 0;
+		double doubleValue = 0;
+		std::chrono::seconds durationValue;
+		std::string stringValue;
+		cpv::SharedString sharedStringValue;
+		ChildModel childValue;
+		std::vector<ChildModel> childValues;
+		std::unordered_map<cpv::SharedString, int> mapValue;
+		std::optional<int> optionalValue;
+
+		void dumpMsgPack(cpv::MsgPackBuilder& builder) const {
+			builder.startMap(10)
+				.addMember("requiredValue", requiredValue)
+				.addMember("sizeValue", sizeValue)
+				.addMember("doubleValue", doubleValue)
+				.addMember("durationValue", durationValue)
+				.addMember("stringValue", stringValue)
+				.addMember("sharedStringValue", sharedStringValue)
+				.addMember("childValue", childValue)
+				.addMember("childValues", childValues)
+				.addMember("mapValue", mapValue)
+				.addMember("optionalValue", optionalValue);
+		}
+
+		bool loadMsgPack(const cpv::MsgPackValue& value) {
+			if (!cpv::convertMsgPackValue(requiredValue, value["requiredValue"])) {
+				return false;
+			}
+			value.forEachMember([this] (const cpv::MsgPackValue& key, const cpv::MsgPackValue& child) {
+				std::string_view name = key.getStringView();
+				if (name == "sizeValue") {
+					sizeValue << child;
+				} else if (name == "doubleValue") {
+					doubleValue << child;
+				} else if (name == "durationValue") {
+					durationValue << child;
+				} else if (name == "stringValue") {
+					stringValue << child;
+				} else if (name == "sharedStringValue") {
+					sharedStringValue << child;
+				} else if (name == "childValue") {
+					childValue << child;
+				} else if (name == "childValues") {
+					childValues << child;
+				} else if (name == "mapValue") {
+					mapValue << child;
+				} else if (name == "optionalValue") {
+					optionalValue << child;
+				}
+			});
+			return true;
+		}
+	};
+
+	/** Make msgpack buffer from hex string */
+	cpv::SharedString fromHex(std::string_view hex) {
+		cpv::SharedStringBuilder builder;
+		for (std::size_t i = 0; i + 1 < hex.size(); i += 2) {
+			builder.append(1, static_cast<char>(std::stoi(std::string(hex.substr(i, 2)), nullptr, 16)));
+		}
+		return builder.build();
+	}
+}
+
+TEST(MsgPackDeserializer, model) {
+	MyModel source;
+	source.requiredValue = 100;
+	source.sizeValue = 101;
+	source.doubleValue = 0.25;
+	source.durationValue = std::chrono::seconds(102);
+	source.stringValue = "test 一二三";
+	source.sharedStringValue = cpv::SharedString(std::string(300, 'a'));
+	source.childValue.count = -1;
+	source.childValues.resize(2);
+	source.childValues.at(1).count = 2;
+	source.mapValue.emplace("a", 1);
+	source.optionalValue = 3;
+	cpv::SharedString str = cpv::serializeMsgPack(source).toString();
+	MyModel model;
+	auto error = cpv::deserializeMsgPack(model, str);
+	ASSERT_FALSE(error.has_value());
+	ASSERT_EQ(model.requiredValue, 100);
+	ASSERT_EQ(model.sizeValue, 101U);
+	ASSERT_EQ(model.doubleValue, 0.25);
+	ASSERT_EQ(model.durationValue.count(), 102);
+	ASSERT_EQ(model.stringValue, "test 一二三");
+	ASSERT_EQ(model.sharedStringValue, source.sharedStringValue);
+	ASSERT_EQ(model.childValue.count, -1);
+	ASSERT_EQ(model.childValues.size(), 2U);
+	ASSERT_EQ(model.childValues.at(1).count, 2);
+	ASSERT_EQ(model.mapValue.size(), 1U);
+	ASSERT_EQ(model.mapValue.at("a"), 1);
+	ASSERT_TRUE(model.optionalValue.has_value());
+	ASSERT_EQ(*model.optionalValue, 3);
+	// strings share the storage of msgpack buffer
+	ASSERT_TRUE(model.sharedStringValue.data() >= str.data());
+	ASSERT_TRUE(model.sharedStringValue.data() < str.data() + str.size());
+}
+
+TEST(MsgPackDeserializer, scalars) {
+	{
+		cpv::SharedString str = fromHex(
+			"99" "00" "7f" "ff" "e0" "cc80" "d0df" "cd0100" "d2ffff7fff" "cfffffffffffffffff");
+		std::vector<std::int64_t> values;
+		auto error = cpv::deserializeMsgPack(values, str);
+		ASSERT_FALSE(error.has_value());
+		ASSERT_EQ(values, std::vector<std::int64_t>({ 0, 127, -1, -32, 128, -33, 256, -32769, -1 }));
+	}
+	{
+		cpv::SharedString str = fromHex("93" "ca3fc00000" "cb3ff8000000000000" "05");
+		std::vector<double> values;
+		auto error = cpv::deserializeMsgPack(values, str);
+		ASSERT_FALSE(error.has_value());
+		ASSERT_EQ(values, std::vector<double>({ 1.5, 1.5, 5 }));
+	}
+	{
+		cpv::SharedString str = fromHex("94" "c3" "c2" "a3616263" "c403616263");
+		std::tuple<bool, bool, std::string, cpv::SharedString> values;
+		cpv::MsgPackValue root(str.data(), str);
+		std::size_t position = 0;
+		ASSERT_EQ(cpv::validateMsgPack(str.view(), position), nullptr);
+		ASSERT_EQ(root.getType(), cpv::MsgPackType::Array);
+		ASSERT_EQ(root.getLength(), 4U);
+		ASSERT_TRUE(cpv::convertMsgPackValue(std::get<0>(values), root[std::size_t(0)]));
+		ASSERT_TRUE(cpv::convertMsgPackValue(std::get<1>(values), root[std::size_t(1)]));
+		ASSERT_TRUE(cpv::convertMsgPackValue(std::get<2>(values), root[std::size_t(2)]));
+		ASSERT_TRUE(cpv::convertMsgPackValue(std::get<3>(values), root[std::size_t(3)]));
+		ASSERT_EQ(root[std::size_t(4)].getType(), cpv::MsgPackType::NoKey);
+		ASSERT_TRUE(std::get<0>(values));
+		ASSERT_FALSE(std::get<1>(values));
+		ASSERT_EQ(std::get<2>(values), "abc");
+		ASSERT_EQ(std::get<3>(values), "abc");
+	}
+}
+
+TEST(MsgPackDeserializer, skipUnknownValues) {
+	// { "x": [ { "y": ext }, bin ], "count": 1 }
+	cpv::SharedString str = fromHex(
+		"82" "a178" "92" "81" "a179" "d40100" "c4020102" "a5636f756e74" "01");
+	MyModel::ChildModel model;
+	auto error = cpv::deserializeMsgPack(model, str);
+	ASSERT_FALSE(error.has_value());
+	ASSERT_EQ(model.count, 1);
+}
+
+TEST(MsgPackDeserializer, variant) {
+	cpv::SharedString str = fromHex("94" "c0" "01" "a161" "81a5636f756e7402");
+	using VariantType = std::variant<std::monostate, int, cpv::SharedString, MyModel::ChildModel>;
+	std::vector<VariantType> values;
+	auto error = cpv::deserializeMsgPack(values, str);
+	ASSERT_FALSE(error.has_value());
+	ASSERT_EQ(values.size(), 4U);
+	ASSERT_EQ(values.at(0).index(), 0U);
+	ASSERT_EQ(std::get<int>(values.at(1)), 1);
+	ASSERT_EQ(std::get<cpv::SharedString>(values.at(2)), "a");
+	ASSERT_EQ(std::get<MyModel::ChildModel>(values.at(3)).count, 2);
+}
+
+TEST(MsgPackDeserializer, mapWithDuplicateKeys) {
+	// { "a": [ 1, 2 ], "b": [ 3 ], "a": [ 4 ] }
+	cpv::SharedString str = fromHex("83" "a161" "920102" "a162" "9103" "a161" "9104");
+	std::map<std::string, std::vector<int>> values;
+	auto error = cpv::deserializeMsgPack(values, str);
+	ASSERT_FALSE(error.has_value());
+	ASSERT_EQ(values.size(), 2U);
+	ASSERT_EQ(values.at("a"), std::vector<int>({ 4 }));
+	ASSERT_EQ(values.at("b"), std::vector<int>({ 3 }));
+}
+
+TEST(MsgPackDeserializer, corrupted) {
+	for (std::string_view hex : { "", "92" "01", "a3" "6162", "c1", "cd01", "81a161", "9101" "02" }) {
+		cpv::SharedString str = fromHex(hex);
+		std::vector<int> values;
+		auto error = cpv::deserializeMsgPack(values, str);
+		ASSERT_TRUE(error.has_value());
+	}
+	cpv::SharedString str = fromHex("9201c1");
+	std::vector<int> values;
+	auto error = cpv::deserializeMsgPack(values, str);
+	ASSERT_TRUE(error.has_value());
+	ASSERT_CONTAINS(std::string_view(error->what()), "invalid type at position 2");
+}
+
+TEST(MsgPackDeserializer, typeUnmatched) {
+	{
+		cpv::SharedString str = fromHex("81" "ad726571756972656456616c7565" "a131");
+		MyModel model;
+		auto error = cpv::deserializeMsgPack(model, str);
+		ASSERT_TRUE(error.has_value());
+		ASSERT_CONTAINS(std::string_view(error->what()), "convert failed");
+	}
+	{
+		cpv::SharedString str = fromHex("01");
+		MyModel model;
+		auto error = cpv::deserializeMsgPack(model, str);
+		ASSERT_TRUE(error.has_value());
+		ASSERT_CONTAINS(std::string_view(error->what()), "convert failed");
+	}
+}
+
+TEST(MsgPackDeserializer, deeplyNested) {
+	// validation doesn't use recursion
+	std::string hex;
+	for (std::size_t i = 0; i < 100000; ++i) {
+		hex.append("91");
+	}
+	hex.append("c0");
+	cpv::SharedString str = fromHex(hex);
+	std::size_t position = 0;
+	ASSERT_EQ(cpv::validateMsgPack(str.view(), position), nullptr);
+	ASSERT_EQ(position, str.size());
+}
+
@@ -0,0 +1,83 @@
+#include <CPVFramework/Serialize/MsgPackFields.hpp>
+#include <CPVFramework/Testing/GTestUtils.hpp>
+
+namespace {
+	class MyModel {
+	public:
+		class ChildModel {
+		public:
+			int count = 0;
+			CPV_JSON_FIELDS(count)
+			CPV_MSGPACK_FIELDS(count)
+		};
+
+		int intValue = -1;
+		double doubleValue = 0;
+		std::string stringValue;
+		cpv::SharedString sharedStringValue;
+		ChildModel childValue;
+		std::vector<ChildModel> childValues;
+		std::optional<int> optionalValue;
+		CPV_JSON_FIELDS(
+			intValue, doubleValue, stringValue, sharedStringValue,
+			childValue, childValues, optionalValue)
+		CPV_MSGPACK_FIELDS(
+			intValue, doubleValue, stringValue, sharedStringValue,
+			childValue, childValues, optionalValue)
+	};
+
+	class ManyFieldsModel {
+	public:
+		int f0 = 0, f1 = 0, f2 = 0, f3 = 0, f4 = 0, f5 = 0, f6 = 0, f7 = 0;
+		int f8 = 0, f9 = 0, f10 = 0, f11 = 0, f12 = 0, f13 = 0, f14 = 0, f15 = 0;
+		CPV_MSGPACK_FIELDS(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15)
+	};
+}
+
+TEST(MsgPackFields, makeKeys) {
+	static const constexpr auto keys = cpv::MsgPackFields<int, std::string>::makeKeys("a", "bc");
+	static_assert(keys.get(0) == "\x82\xa1" "a");
+	static_assert(keys.get(1) == "\xa2" "bc");
+	static_assert(keys.get(2) == "");
+}
+
+TEST(MsgPackFields, serializeAndDeserialize) {
+	MyModel source;
+	source.intValue = 101;
+	source.doubleValue = 0.5;
+	source.stringValue = "test 一二三";
+	source.sharedStringValue = "abc";
+	source.childValue.count = -1;
+	source.childValues.resize(2);
+	source.childValues.at(1).count = 2;
+	cpv::SharedString str = cpv::serializeMsgPack(source).toString();
+	MyModel model;
+	model.optionalValue = 1;
+	auto error = cpv::deserializeMsgPack(model, str);
+	ASSERT_FALSE(error.has_value());
+	ASSERT_EQ(model.intValue, 101);
+	ASSERT_EQ(model.doubleValue, 0.5);
+	ASSERT_EQ(model.stringValue, "test 一二三");
+	ASSERT_EQ(model.sharedStringValue, "abc");
+	ASSERT_EQ(model.childValue.count, -1);
+	ASSERT_EQ(model.childValues.size(), 2U);
+	ASSERT_EQ(model.childValues.at(1).count, 2);
+	ASSERT_FALSE(model.optionalValue.has_value());
+	// the same fields also generate json
+	ASSERT_EQ(cpv::serializeJson(model.childValue).toString(), "{\"count\":-1}");
+}
+
+TEST(MsgPackFields, manyFields) {
+	ManyFieldsModel model;
+	model.f0 = 100;
+	model.f15 = 115;
+	cpv::SharedString str = cpv::serializeMsgPack(model).toString();
+	// map 16 header
+	ASSERT_EQ(static_cast<std::uint8_t>(str.data()[0]), 0xdeU);
+	ManyFieldsModel loaded;
+	auto error = cpv::deserializeMsgPack(loaded, str);
+	ASSERT_FALSE(error.has_value());
+	ASSERT_EQ(loaded.f0, 100);
+	ASSERT_EQ(loaded.f15, 115);
+}
+
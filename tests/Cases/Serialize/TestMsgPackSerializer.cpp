@@ -0,0 +1,131 @@
+#include <CPVFramework/Serialize/MsgPackSerializer.hpp>
+#include <CPVFramework/Testing/GTestUtils.hpp>
+
+namespace {
+	class MyModel {
+	public:
+		class ChildModel {
+		public:
+			int count = 0;
+
+			void dumpMsgPack(cpv::MsgPackBuilder& builder) const {
+				builder.startMap(1)
+					.addMember("count", count);
+			}
+		};
+
+		int intValue = 0;
+		double doubleValue = 0;
+		bool boolValue = false;
+		std::string stringValue;
+		cpv::SharedString sharedStringValue;
+		ChildModel childValue;
+		std::vector<int> intValues;
+		std::optional<int> optionalValue;
+
+		void dumpMsgPack(cpv::MsgPackBuilder& builder) const {
+			builder.startMap(8)
+				.addMember("intValue", intValue)
+				.addMember("doubleValue", doubleValue)
+				.addMember("boolValue", boolValue)
+				.addMember("stringValue", stringValue)
+				.addMember("sharedStringValue", sharedStringValue)
+				.addMember("childValue", childValue)
+				.addMember("intValues", intValues)
+				.addMember("optionalValue", optionalValue);
+		}
+	};
+
+	/** Serialize value and return the hex string of msgpack */
+	template <class T>
+	std::string toHex(const T& value) {
+		static const char Digits[] = "0123456789abcdef";
+		cpv::SharedString str = cpv::serializeMsgPack(value).toString();
+		std::string result;
+		for (char c : str) {
+			std::uint8_t byte = static_cast<std::uint8_t>(c);
+			result.append(1, Digits[byte >> 4]).append(1, Digits[byte & 0xf]);
+		}
+		return result;
+	}
+}
+
+TEST(MsgPackSerializer, integers) {
+	ASSERT_EQ(toHex(std::vector<int>({ 0, 1, 127, -1, -32 })), "950001" "7f" "ff" "e0");
+	ASSERT_EQ(toHex(std::vector<int>({ 128, 255, 256, 65535, 65536 })),
+		"95" "cc80" "ccff" "cd0100" "cdffff" "ce00010000");
+	ASSERT_EQ(toHex(std::vector<std::int64_t>({ -33, -128, -129, -32768, -32769, 4294967296 })),
+		"96" "d0df" "d080" "d1ff7f" "d18000" "d2ffff7fff" "cf0000000100000000");
+	ASSERT_EQ(toHex(std::vector<std::int64_t>({ std::numeric_limits<std::int64_t>::min() })),
+		"91" "d38000000000000000");
+	ASSERT_EQ(toHex(std::vector<std::uint64_t>({ std::numeric_limits<std::uint64_t>::max() })),
+		"91" "cfffffffffffffffff");
+}
+
+TEST(MsgPackSerializer, scalars) {
+	ASSERT_EQ(toHex(std::vector<double>({ 1.5 })), "91" "cb3ff8000000000000");
+	ASSERT_EQ(toHex(std::vector<bool>({ true, false })), "92" "c3" "c2");
+	ASSERT_EQ(toHex(std::vector<std::optional<int>>({ std::nullopt, 1 })), "92" "c0" "01");
+	ASSERT_EQ(toHex(std::vector<std::chrono::seconds>({ std::chrono::seconds(3) })), "91" "03");
+}
+
+TEST(MsgPackSerializer, strings) {
+	std::vector<cpv::SharedString> sharedStrings;
+	sharedStrings.emplace_back("");
+	sharedStrings.emplace_back("abc");
+	ASSERT_EQ(toHex(sharedStrings), "92" "a0" "a3616263");
+	ASSERT_EQ(toHex(std::vector<std::string>({ std::string(32, 'a') })).substr(0, 6), "91d920");
+	ASSERT_EQ(toHex(std::vector<std::string>({ std::string(256, 'a') })).substr(0, 8), "91da0100");
+	ASSERT_EQ(toHex(std::vector<std::string>({ std::string(65536, 'a') })).substr(0, 12), "91db00010000");
+}
+
+TEST(MsgPackSerializer, largeStringNotCopied) {
+	cpv::SharedString large(std::string(cpv::MsgPackBuilder::LargeStringThreshold, 'a'));
+	std::vector<cpv::SharedString> values;
+	values.emplace_back("abc");
+	values.emplace_back(large.share());
+	values.emplace_back("def");
+	cpv::Packet packet = cpv::serializeMsgPack(values);
+	ASSERT_EQ(packet.segments(), 3U);
+	auto* fragments = packet.getIfMultiple();
+	ASSERT_TRUE(fragments != nullptr);
+	ASSERT_EQ(fragments->fragments.at(1).base, large.data());
+	ASSERT_EQ(packet.size(), 1 + 4 + 3 + large.size() + 4);
+}
+
+TEST(MsgPackSerializer, containers) {
+	ASSERT_EQ(toHex(std::vector<int>(16, 1)).substr(0, 6), "dc0010");
+	ASSERT_EQ(toHex(std::map<std::string, int>({ { "a", 1 }, { "b", 2 } })), "82" "a161" "01" "a162" "02");
+	std::map<std::string, int> largeMap;
+	for (std::size_t i = 0; i < 16; ++i) {
+		largeMap.emplace(std::to_string(i), 0);
+	}
+	ASSERT_EQ(toHex(largeMap).substr(0, 6), "de0010");
+	using VariantType = std::variant<std::monostate, int, cpv::SharedString>;
+	std::vector<VariantType> variants(3);
+	variants.at(1) = 1;
+	variants.at(2) = cpv::SharedString("a");
+	ASSERT_EQ(toHex(variants), "93" "c0" "01" "a161");
+}
+
+TEST(MsgPackSerializer, model) {
+	MyModel model;
+	model.intValue = 1;
+	model.doubleValue = 0.5;
+	model.boolValue = true;
+	model.stringValue = "a";
+	model.sharedStringValue = "b";
+	model.childValue.count = 2;
+	model.intValues = { 3 };
+	ASSERT_EQ(toHex(model),
+		"88"
+		"a8696e7456616c7565" "01"
+		"ab646f75626c6556616c7565" "cb3fe0000000000000"
+		"a9626f6f6c56616c7565" "c3"
+		"ab737472696e6756616c7565" "a161"
+		"b1736861726564537472696e6756616c7565" "a162"
+		"aa6368696c6456616c7565" "81" "a5636f756e74" "02"
+		"a9696e7456616c756573" "91" "03"
+		"ad6f7074696f6e616c56616c7565" "c0");
+}
+
@@ -0,0 +1,38 @@
+#include <seastar/core/future-util.hh>
+#include <CPVFramework/Stream/ChunkedOutputStream.hpp>
+#include <CPVFramework/Stream/StringOutputStream.hpp>
+#include <CPVFramework/Testing/GTestUtils.hpp>
+
+TEST_FUTURE(ChunkedOutputStream, all) {
+	return seastar::do_with(
+		cpv::StringOutputStream(),
+		cpv::ChunkedOutputStream(),
+		seastar::make_lw_shared<cpv::SharedStringBuilder>(),
+		[] (auto& stringStream, auto& stream, auto& str) {
+		stringStream.reset(str);
+		stream.reset(&stringStream);
+		return stream.write(cpv::Packet("first")).then([&stream] {
+			return stream.write(cpv::Packet());
+		}).then([&stream] {
+			cpv::Packet p;
+			p.append(" second").append(cpv::SharedString(std::string(20, 'a')));
+			return stream.write(std::move(p));
+		}).then([&stream] {
+			return stream.writeEnd();
+		}).then([&str] {
+			ASSERT_EQ(str->view(),
+				"5\r\nfirst\r\n"
+				"1b\r\n second" + std::string(20, 'a') + "\r\n"
+				"0\r\n\r\n");
+		});
+	});
+}
+
+TEST_FUTURE(ChunkedOutputStream, nullStream) {
+	return seastar::do_with(cpv::ChunkedOutputStream(), [] (auto& stream) {
+		return stream.write(cpv::Packet("abc")).then_wrapped([] (auto&& f) {
+			ASSERT_THROWS_CONTAINS(cpv::LogicException, f.get(), "write to null stream");
+		});
+	});
+}
+
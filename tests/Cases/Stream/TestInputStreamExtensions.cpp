@@ -1,7 +1,9 @@
+#include <unistd.h>
 #include <seastar/core/future-util.hh>
 #include <CPVFramework/Stream/InputStreamExtensions.hpp>
 #include <CPVFramework/Stream/PacketInputStream.hpp>
 #include <CPVFramework/Stream/StringInputStream.hpp>
+#include <CPVFramework/Utility/FileUtils.hpp>
 #include <CPVFramework/Utility/Reusable.hpp>
 #include <CPVFramework/Testing/GTestUtils.hpp>
 
@@ -48,3 +50,25 @@ TEST_FUTURE(InputStreamExtensions, readAll_multipleSegments) {
 	});
 }
 
+TEST_FUTURE(InputStreamExtensions, writeAllToFile) {
+	static const std::string path("/tmp/cpv-framework-test-write-all-to-file.txt");
+	return seastar::do_with(
+		cpv::PacketInputStream(),
+		std::string(),
+		[] (auto& stream, auto& source) {
+		// larger than the dma buffer and not aligned
+		cpv::Packet p;
+		for (std::size_t i = 0; i < 300; ++i) {
+			std::string part(1000 + i, static_cast<char>('a' + i % 26));
+			source.append(part);
+			p.append(cpv::SharedString(std::move(part)));
+		}
+		stream.reset(std::move(p));
+		return cpv::extensions::writeAllToFile(stream, cpv::SharedString(path))
+		.then([&source] (std::size_t size) {
+			ASSERT_EQ(size, source.size());
+			ASSERT_EQ(cpv::readFile(path), source);
+			::unlink(path.c_str());
+		});
+	});
+}
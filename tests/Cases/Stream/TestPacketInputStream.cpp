@@ -8,23 +8,26 @@ TEST_FUTURE(PacketInputStream, all) {
 	return seastar::do_with (
 		cpv::PacketInputStream(),
 		[] (auto& stream) {
+		// short strings are merged into one fragment, long strings are kept as separate fragments
+		std::string second(cpv::Packet::MultipleFragments::InlineThreshold, 'b');
 		cpv::Packet p;
-		p.append("first").append("second").append("").append("third");
+		p.append("first").append(cpv::SharedString(std::string_view(second)))
+			.append("").append("third").append("!");
 		stream.reset(std::move(p));
 		return stream.read().then([&stream] (auto&& result) {
 			ASSERT_TRUE(stream.sizeHint().has_value());
-			ASSERT_EQ(*stream.sizeHint(), 16U);
+			ASSERT_EQ(*stream.sizeHint(), 75U);
 			ASSERT_EQ(result.data, "first");
 			ASSERT_FALSE(result.isEnd);
 		}).then([&stream] {
 			return stream.read();
-		}).then([&stream] (auto&& result) {
-			ASSERT_EQ(result.data, "second");
+		}).then([&stream, second] (auto&& result) {
+			ASSERT_EQ(result.data, second);
 			ASSERT_FALSE(result.isEnd);
 		}).then([&stream] {
 			return stream.read();
 		}).then([&stream] (auto&& result) {
-			ASSERT_EQ(result.data, "third");
+			ASSERT_EQ(result.data, "third!");
 			ASSERT_TRUE(result.isEnd);
 		}).then([&stream] {
 			return stream.read();
@@ -40,7 +43,7 @@ TEST_FUTURE(PacketInputStream, empty) {
 		cpv::PacketInputStream(),
 		[] (auto& stream) {
 		cpv::Packet p;
-		p.append("first").append("");
+		p.append("first").getOrConvertToMultiple().fragments.push_back({ nullptr, 0 });
 		stream.reset(std::move(p));
 		return stream.read().then([&stream] (auto&& result) {
 			// result.isEnd is false because PacketInputStream won't check
@@ -0,0 +1,23 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "Utility/EscapeCharScanner.hpp"
+
+namespace cpv::gtest {
+	/** Run func with sse2 scanner and avx2 scanner (if supported by cpu) */
+	template <class Func>
+	void runWithEachEscapeCharScanner(Func&& func) {
+		bool avx2Supported = cpv::EscapeCharScannerUseAvx2;
+		for (bool useAvx2 : { false, true }) {
+			if (useAvx2 && !avx2Supported) {
+				continue;
+			}
+			SCOPED_TRACE(useAvx2 ? "avx2" : "sse2");
+			cpv::EscapeCharScannerUseAvx2 = useAvx2;
+			func();
+			cpv::EscapeCharScannerUseAvx2 = avx2Supported;
+			if (::testing::Test::HasFatalFailure()) {
+				break;
+			}
+		}
+	}
+}
@@ -0,0 +1,178 @@
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <CPVFramework/Utility/FlatHashMap.hpp>
+#include <CPVFramework/Utility/ObjectTrait.hpp>
+#include <CPVFramework/Utility/SharedString.hpp>
+#include <CPVFramework/Testing/GTestUtils.hpp>
+
+TEST(FlatHashMap, insertAndFind) {
+	cpv::FlatHashMap<cpv::SharedString, cpv::SharedString> map;
+	ASSERT_TRUE(map.empty());
+	ASSERT_EQ(map.capacity(), 0U);
+	ASSERT_TRUE(map.find("a") == map.end());
+	ASSERT_TRUE(map.insert_or_assign("a", "1").second);
+	ASSERT_TRUE(map.try_emplace("b", "2").second);
+	ASSERT_TRUE(map.emplace("c", "3").second);
+	ASSERT_FALSE(map.try_emplace("a", "x").second);
+	ASSERT_FALSE(map.insert_or_assign("c", "33").second);
+	ASSERT_EQ(map.size(), 3U);
+	ASSERT_EQ(map.find("a")->second, "1");
+	ASSERT_EQ(map.at("b"), "2");
+	ASSERT_EQ(map.at("c"), "33");
+	ASSERT_EQ(map.count("d"), 0U);
+	ASSERT_THROWS(std::out_of_range, map.at("d"));
+	map["d"] = "4";
+	ASSERT_EQ(map.size(), 4U);
+	std::size_t count = 0;
+	for (const auto& pair : std::as_const(map)) {
+		ASSERT_EQ(map.at(pair.first), pair.second);
+		++count;
+	}
+	ASSERT_EQ(count, 4U);
+}
+
+TEST(FlatHashMap, compareWithStdMap) {
+	// random operations with keys collide in low bits, compare results with std::map
+	cpv::FlatHashMap<std::uintptr_t, std::string> map;
+	std::map<std::uintptr_t, std::string> expected;
+	std::mt19937 engine(12345);
+	std::uniform_int_distribution<std::uintptr_t> keyDistribution(0, 300);
+	std::uniform_int_distribution<int> opDistribution(0, 3);
+	for (std::size_t i = 0; i < 20000; ++i) {
+		std::uintptr_t key = keyDistribution(engine) << 12;
+		int op = opDistribution(engine);
+		if (op == 0 || op == 1) {
+			map.insert_or_assign(key, std::to_string(i));
+			expected.insert_or_assign(key, std::to_string(i));
+		} else if (op == 2) {
+			ASSERT_EQ(map.erase(key), expected.erase(key));
+		} else {
+			auto it = map.find(key);
+			auto expectedIt = expected.find(key);
+			ASSERT_EQ(it == map.end(), expectedIt == expected.end());
+			if (it != map.end()) {
+				ASSERT_EQ(it->second, expectedIt->second);
+			}
+		}
+		ASSERT_EQ(map.size(), expected.size());
+	}
+	std::map<std::uintptr_t, std::string> actual(map.begin(), map.end());
+	ASSERT_EQ(actual, expected);
+}
+
+TEST(FlatHashMap, eraseWhileIterating) {
+	cpv::FlatHashMap<int, int> map;
+	for (int i = 0; i < 100; ++i) {
+		map.try_emplace(i, i);
+	}
+	for (auto it = map.begin(); it != map.end();) {
+		if (it->first % 2 == 0) {
+			it = map.erase(it);
+		} else {
+			++it;
+		}
+	}
+	ASSERT_EQ(map.size(), 50U);
+	for (int i = 0; i < 100; ++i) {
+		ASSERT_EQ(map.count(i), static_cast<std::size_t>(i % 2));
+	}
+}
+
+TEST(FlatHashMap, clearKeepsMemory) {
+	cpv::FlatHashMap<int, std::shared_ptr<int>> map;
+	auto value = std::make_shared<int>(1);
+	for (int i = 0; i < 10; ++i) {
+		map.try_emplace(i, value);
+	}
+	ASSERT_EQ(value.use_count(), 11);
+	std::size_t capacity = map.capacity();
+	map.clear();
+	ASSERT_TRUE(map.empty());
+	ASSERT_TRUE(map.begin() == map.end());
+	ASSERT_EQ(value.use_count(), 1);
+	ASSERT_EQ(map.capacity(), capacity);
+	map.reserve(1000);
+	ASSERT_GE(map.capacity(), 1000U);
+}
+
+TEST(FlatHashMap, copyAndMove) {
+	cpv::FlatHashMap<int, std::string> map({ { 1, "a" }, { 2, "b" }, { 1, "c" } });
+	ASSERT_EQ(map.size(), 2U);
+	ASSERT_EQ(map.at(1), "a");
+	auto copy = map;
+	ASSERT_EQ(copy.size(), 2U);
+	ASSERT_EQ(copy.at(2), "b");
+	auto moved = std::move(copy);
+	ASSERT_EQ(moved.size(), 2U);
+	ASSERT_TRUE(copy.empty());
+	copy = std::move(moved);
+	ASSERT_EQ(copy.at(1), "a");
+	map = copy;
+	ASSERT_EQ(map.size(), 2U);
+}
+
+TEST(FlatHashMap, insertReferToSelfWhileGrowing) {
+	cpv::FlatHashMap<std::string, std::string> map;
+	auto fillToGrowthLimit = [&map] {
+		for (std::size_t i = 0; map.size() < map.capacity() - map.capacity() / 8; ++i) {
+			map.try_emplace(std::string(32, 'k') + std::to_string(i), std::string(32, 'v') + std::to_string(i));
+		}
+	};
+	map.try_emplace(std::string(32, 'k') + "0", std::string(32, 'v') + "0");
+	fillToGrowthLimit();
+	std::size_t capacity = map.capacity();
+	// key and value refer to entries that will be moved by rehash
+	auto [it, inserted] = map.try_emplace(map.at(std::string(32, 'k') + "0"), map.at(std::string(32, 'k') + "1"));
+	ASSERT_TRUE(inserted);
+	ASSERT_GT(map.capacity(), capacity);
+	ASSERT_EQ(it->first, std::string(32, 'v') + "0");
+	ASSERT_EQ(map.at(std::string(32, 'v') + "0"), std::string(32, 'v') + "1");
+	fillToGrowthLimit();
+	capacity = map.capacity();
+	ASSERT_TRUE(map.insert_or_assign(map.at(std::string(32, 'k') + "2"), map.at(std::string(32, 'k') + "3")).second);
+	ASSERT_GT(map.capacity(), capacity);
+	ASSERT_EQ(map.at(std::string(32, 'v') + "2"), std::string(32, 'v') + "3");
+}
+
+TEST(FlatHashMap, insertThrowsWhileConstructing) {
+	struct ThrowOnConstruct {
+		int value;
+		explicit ThrowOnConstruct(int v) : value(v) {
+			if (v < 0) {
+				throw std::runtime_error("test");
+			}
+		}
+	};
+	cpv::FlatHashMap<int, ThrowOnConstruct> map;
+	// throws on the first insert (allocate memory) and on later inserts
+	ASSERT_THROW(map.try_emplace(0, -1), std::runtime_error);
+	ASSERT_TRUE(map.empty());
+	for (int i = 0; i < 100; ++i) {
+		ASSERT_TRUE(map.try_emplace(i, i).second);
+		ASSERT_THROW(map.try_emplace(i + 1000, -1), std::runtime_error);
+		ASSERT_EQ(map.size(), static_cast<std::size_t>(i + 1));
+		ASSERT_TRUE(map.find(i + 1000) == map.end());
+	}
+	std::size_t count = 0;
+	for (auto& entry : map) {
+		ASSERT_EQ(entry.first, entry.second.value);
+		++count;
+	}
+	ASSERT_EQ(count, 100U);
+	map.clear();
+	ASSERT_TRUE(map.empty());
+}
+
+TEST(FlatHashMap, objectTrait) {
+	using Map = cpv::FlatHashMap<int, int>;
+	using Trait = cpv::ObjectTrait<Map>;
+	static_assert(Trait::IsMapLike);
+	Map value = Trait::create();
+	Trait::add(value, 1) = 10;
+	ASSERT_EQ(Trait::size(value), 1U);
+	ASSERT_EQ(value.at(1), 10);
+	Trait::reset(value);
+	ASSERT_EQ(Trait::size(value), 0U);
+}
@@ -1,5 +1,43 @@
+#include <random>
+#include <string>
 #include <CPVFramework/Utility/HttpUtils.hpp>
 #include <CPVFramework/Testing/GTestUtils.hpp>
+#include "./TestEscapeCharScanner.Base.hpp"
+
+namespace {
+	/** Check encode function against simple per char implementation, with escape chars at every position */
+	template <class Encode, class EncodeChar>
+	void testEncodeAtEveryPosition(Encode&& encode, EncodeChar&& encodeChar, std::string_view specialChars) {
+		auto reference = [&encodeChar] (const std::string& str) {
+			std::string result;
+			for (char c : str) {
+				result.append(encodeChar(static_cast<unsigned char>(c)));
+			}
+			return result;
+		};
+		cpv::gtest::runWithEachEscapeCharScanner([&] {
+			for (std::size_t size = 0; size < 70; ++size) {
+				std::string str(size, 'a');
+				ASSERT_EQ(encode(cpv::SharedString(str)), reference(str));
+				for (std::size_t pos = 0; pos < size; ++pos) {
+					for (char c : specialChars) {
+						str[pos] = c;
+						ASSERT_EQ(encode(cpv::SharedString(str)), reference(str));
+						str[pos] = 'a';
+					}
+				}
+			}
+			std::mt19937 generator(12345);
+			for (std::size_t i = 0; i < 1000; ++i) {
+				std::string str(generator() % 100, 'a');
+				for (char& c : str) {
+					c = static_cast<char>(generator() % 256);
+				}
+				ASSERT_EQ(encode(cpv::SharedString(str)), reference(str));
+			}
+		});
+	}
+}
 
 TEST(HttpUtils, urlEncode) {
 	{
@@ -12,6 +50,18 @@ TEST(HttpUtils, urlEncode) {
 	}
 }
 
+TEST(HttpUtils, urlEncodeAtEveryPosition) {
+	testEncodeAtEveryPosition([] (auto&& str) { return cpv::urlEncode(std::move(str)); },
+		[] (unsigned char c) {
+			if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+				c == '-' || c == '.' || c == '/' || c == '_' || c == '~') {
+				return std::string(1, static_cast<char>(c));
+			}
+			static const char digits[] = "0123456789ABCDEF";
+			return std::string({ '%', digits[c >> 4], digits[c & 0xf] });
+		}, std::string_view(" %/~\x00\x7f\x80\xff", 8));
+}
+
 TEST(HttpUtils, urlDecode) {
 	{
 		auto result = cpv::urlDecode("%E4%B8%80abc%E4%BA%8Cdef%E4%B8%89%20~-_%0D%0A");
@@ -54,6 +104,20 @@ TEST(HttpUtils, htmlEncode) {
 	}
 }
 
+TEST(HttpUtils, htmlEncodeAtEveryPosition) {
+	testEncodeAtEveryPosition([] (auto&& str) { return cpv::htmlEncode(std::move(str)); },
+		[] (unsigned char c) {
+			switch (c) {
+				case '&': return std::string("&amp;");
+				case '<': return std::string("&lt;");
+				case '>': return std::string("&gt;");
+				case '"': return std::string("&quot;");
+				case '\'': return std::string("&#x27;");
+				default: return std::string(1, static_cast<char>(c));
+			}
+		}, std::string_view("&<>\"'\x00\x80", 7));
+}
+
 // Notice: cases with incorrect format are for ASAN checking, their results are not guaranteed
 TEST(HttpUtils, htmlDecode) {
 	{
@@ -124,3 +188,49 @@ TEST(HttpUtils, getMimeType) {
 	ASSERT_EQ(cpv::getMimeType("filename.unknown"), "application/octet-stream");
 }
 
+TEST(HttpUtils, isCompressibleMimeType) {
+	ASSERT_TRUE(cpv::isCompressibleMimeType("text/plain"));
+	ASSERT_TRUE(cpv::isCompressibleMimeType("text/html; charset=utf-8"));
+	ASSERT_TRUE(cpv::isCompressibleMimeType("application/json"));
+	ASSERT_TRUE(cpv::isCompressibleMimeType("Application/JavaScript"));
+	ASSERT_TRUE(cpv::isCompressibleMimeType("image/svg+xml"));
+	ASSERT_FALSE(cpv::isCompressibleMimeType("image/png"));
+	ASSERT_FALSE(cpv::isCompressibleMimeType("application/zip"));
+	ASSERT_FALSE(cpv::isCompressibleMimeType("application/octet-stream"));
+	ASSERT_FALSE(cpv::isCompressibleMimeType(""));
+}
+
+TEST(HttpUtils, getAcceptEncodingQuality) {
+	ASSERT_EQ(cpv::getAcceptEncodingQuality("gzip, deflate, br", "br"), 1000U);
+	ASSERT_EQ(cpv::getAcceptEncodingQuality("gzip, deflate, br", "zstd"), 0U);
+	ASSERT_EQ(cpv::getAcceptEncodingQuality("", "gzip"), 0U);
+	ASSERT_EQ(cpv::getAcceptEncodingQuality("GZIP", "gzip"), 1000U);
+	ASSERT_EQ(cpv::getAcceptEncodingQuality("br;q=0.8, gzip;q=0.9", "br"), 800U);
+	ASSERT_EQ(cpv::getAcceptEncodingQuality("br;q=0.8, gzip;q=0.9", "gzip"), 900U);
+	ASSERT_EQ(cpv::getAcceptEncodingQuality("br ; Q=0.125 ,gzip", "br"), 125U);
+	ASSERT_EQ(cpv::getAcceptEncodingQuality("br;q=1.0", "br"), 1000U);
+	ASSERT_EQ(cpv::getAcceptEncodingQuality("br;q=0", "br"), 0U);
+	ASSERT_EQ(cpv::getAcceptEncodingQuality("br;q=1.5", "br"), 1000U);
+	ASSERT_EQ(cpv::getAcceptEncodingQuality("br;q=abc", "br"), 0U);
+	ASSERT_EQ(cpv::getAcceptEncodingQuality("br;q=0.1234", "br"), 0U);
+	ASSERT_EQ(cpv::getAcceptEncodingQuality("*;q=0.5, gzip", "br"), 500U);
+	ASSERT_EQ(cpv::getAcceptEncodingQuality("*;q=0.5, gzip;q=0", "gzip"), 0U);
+	ASSERT_EQ(cpv::getAcceptEncodingQuality("gzip;q=0, *", "gzip"), 0U);
+}
+
+TEST(HttpUtils, getAcceptMimeTypeQuality) {
+	ASSERT_EQ(cpv::getAcceptMimeTypeQuality("application/json", "application/json"), 1000U);
+	ASSERT_EQ(cpv::getAcceptMimeTypeQuality("application/json", "application/msgpack"), 0U);
+	ASSERT_EQ(cpv::getAcceptMimeTypeQuality("", "application/json"), 0U);
+	ASSERT_EQ(cpv::getAcceptMimeTypeQuality("*/*", "application/msgpack"), 1000U);
+	ASSERT_EQ(cpv::getAcceptMimeTypeQuality("Application/MsgPack", "application/msgpack"), 1000U);
+	ASSERT_EQ(cpv::getAcceptMimeTypeQuality(
+		"application/json;q=0.9, application/msgpack", "application/json"), 900U);
+	ASSERT_EQ(cpv::getAcceptMimeTypeQuality(
+		"text/html, application/*;q=0.2, */*;q=0.1", "application/msgpack"), 200U);
+	ASSERT_EQ(cpv::getAcceptMimeTypeQuality(
+		"*/*;q=0.1, application/msgpack;q=0, application/*", "application/msgpack"), 0U);
+	ASSERT_EQ(cpv::getAcceptMimeTypeQuality(
+		"application/json; charset=utf-8; q=0.5", "application/json"), 500U);
+	ASSERT_EQ(cpv::getAcceptMimeTypeQuality("app/*", "application/json"), 0U);
+}
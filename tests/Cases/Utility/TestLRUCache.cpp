@@ -1,5 +1,6 @@
 #include <string>
 #include <CPVFramework/Utility/LRUCache.hpp>
+#include <CPVFramework/Utility/SharedString.hpp>
 #include <CPVFramework/Testing/GTestUtils.hpp>
 
 TEST(LRUCache, all) {
@@ -68,3 +69,71 @@ TEST(LRUCache, all) {
 	}
 }
 
+
+TEST(LRUCache, heterogeneousLookup) {
+	cpv::LRUCache<cpv::SharedString, int> cache(2);
+	cache.set(cpv::SharedString("a"), cpv::SharedString("a"), 1);
+	cache.set(cpv::SharedString("b"), cpv::SharedString("b"), 2);
+	{
+		int* result = cache.get(std::string_view("a"));
+		ASSERT_TRUE(result != nullptr);
+		ASSERT_EQ(*result, 1);
+		result = cache.get(std::string("b"));
+		ASSERT_TRUE(result != nullptr);
+		ASSERT_EQ(*result, 2);
+		result = cache.get(std::string_view("c"));
+		ASSERT_FALSE(result != nullptr);
+		// list: b, a
+	}
+	{
+		// overwrite keeps the original key and moves it to front
+		cache.set(cpv::SharedString("a"), cpv::SharedString("a"), 3);
+		int* result = cache.get(cpv::SharedString::fromStatic("a"));
+		ASSERT_TRUE(result != nullptr);
+		ASSERT_EQ(*result, 3);
+		// list: a, b
+	}
+	{
+		cache.set(cpv::SharedString("c"), cpv::SharedString("c"), 4);
+		ASSERT_FALSE(cache.get(std::string_view("b")) != nullptr);
+		ASSERT_TRUE(cache.erase(std::string_view("a")));
+		ASSERT_FALSE(cache.erase(std::string_view("a")));
+		ASSERT_EQ(cache.size(), 1U);
+		// list: c
+	}
+}
+
+TEST(LRUCache, reuseEntries) {
+	cpv::LRUCache<int, int> cache(8);
+	for (int i = 0; i < 1000; ++i) {
+		cache.set(i, i * 2);
+		if (i % 3 == 0) {
+			ASSERT_TRUE(cache.erase(i));
+		}
+		ASSERT_LE(cache.size(), 8U);
+	}
+	for (int i = 990; i < 1000; ++i) {
+		int* result = cache.get(i);
+		if (i % 3 == 0) {
+			ASSERT_FALSE(result != nullptr);
+		} else {
+			ASSERT_TRUE(result != nullptr);
+			ASSERT_EQ(*result, i * 2);
+		}
+	}
+}
+
+TEST(LRUCache, zeroSize) {
+	cpv::LRUCache<int, int> cache(0);
+	cache.set(1, 1);
+	ASSERT_TRUE(cache.empty());
+	ASSERT_FALSE(cache.get(1) != nullptr);
+	ASSERT_FALSE(cache.erase(1));
+}
+
+TEST(LRUCache, implicitConstruct) {
+	cpv::LRUCache<int, int> cache = 2;
+	cache.set(1, 100);
+	ASSERT_EQ(cache.maxSize(), 2U);
+	ASSERT_TRUE(cache.get(1) != nullptr);
+}
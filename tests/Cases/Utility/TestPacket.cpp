@@ -170,10 +170,53 @@ TEST(Packet, release) {
 		seastar::net::packet p_ = ptr->release();
 		ASSERT_EQ(p_.len(), 9U);
 		auto vec = p_.release();
-		ASSERT_EQ(vec.size(), 3U);
+		ASSERT_EQ(vec.size(), 2U);
 		ASSERT_EQ(std::string_view(vec.at(0).get(), vec.at(0).size()), "abc");
-		ASSERT_EQ(std::string_view(vec.at(1).get(), vec.at(1).size()), "123");
-		ASSERT_EQ(std::string_view(vec.at(2).get(), vec.at(2).size()), "def");
+		ASSERT_EQ(std::string_view(vec.at(1).get(), vec.at(1).size()), "123def");
+	}
+}
+
+TEST(Packet, inlineSmallFragments) {
+	using MultipleFragments = cpv::Packet::MultipleFragments;
+	cpv::SharedString large(std::string(MultipleFragments::InlineThreshold, 'a'));
+	cpv::Packet p;
+	auto& f = p.getOrConvertToMultiple();
+	f.append("static string without scratch block");
+	f.append(cpv::SharedString::fromInt(123));
+	f.append(": ");
+	f.append(cpv::SharedString(std::string_view("abc")));
+	f.append(cpv::SharedString());
+	f.append(large.share());
+	f.append("\r\n");
+	f.append(cpv::SharedString::fromInt(456));
+	ASSERT_EQ(f.fragments.size(), 4U);
+	ASSERT_EQ(std::string_view(f.fragments.at(1).base, f.fragments.at(1).size), "123: abc");
+	ASSERT_EQ(f.fragments.at(2).base, large.data());
+	ASSERT_EQ(std::string_view(f.fragments.at(3).base, f.fragments.at(3).size), "\r\n456");
+	{
+		// fill more than one scratch block
+		cpv::Packet q;
+		std::string expected;
+		for (std::size_t i = 0; i < MultipleFragments::ScratchBlockSize; ++i) {
+			q.append(cpv::SharedString::fromInt(i));
+			expected.append(std::to_string(i));
+		}
+		ASSERT_EQ(q.toString(), expected);
+		ASSERT_LE(q.segments(), expected.size() /
+			(MultipleFragments::ScratchBlockSize - MultipleFragments::InlineThreshold) + 1);
+	}
+	{
+		// the scratch block moved with deleter should not be reused
+		std::size_t sizeBefore = p.size();
+		cpv::Packet q;
+		q.append(cpv::SharedString::fromInt(1)).append(cpv::SharedString::fromInt(2));
+		p.append(std::move(q));
+		f.append("3");
+		auto released = f.release();
+		f.append("4");
+		f.append(cpv::SharedString::fromInt(5));
+		ASSERT_EQ(released.len(), sizeBefore + 3);
+		ASSERT_EQ(p.toString(), "45");
 	}
 }
 
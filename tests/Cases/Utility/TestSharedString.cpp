@@ -169,6 +169,9 @@ TEST(SharedString, fromDouble) {
 	ASSERT_EQ(cpv::SharedString::fromDouble(-1.1), "-1.1");
 	ASSERT_EQ(cpv::SharedString::fromDouble(-123.1L), "-123.1");
 	ASSERT_EQ(cpv::SharedString::fromDouble(-123.0), "-123");
+	ASSERT_EQ(cpv::SharedString::fromDouble(0.0), "0");
+	ASSERT_EQ(cpv::SharedString::fromDouble(-0.0), "-0");
+	ASSERT_EQ(cpv::SharedString::fromDouble(-0.0L), "-0");
 }
 
 TEST(SharedString, mapKey) {
@@ -1,3 +1,8 @@
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
 #include <CPVFramework/Utility/SharedStringBuilder.hpp>
 #include <CPVFramework/Testing/GTestUtils.hpp>
 
@@ -39,6 +44,52 @@ TEST(SharedStringBuilder, append) {
 	ASSERT_EQ(str, "test|aaa|abc|123|12345678|-123|1|10.2|100");
 }
 
+TEST(SharedStringBuilder, appendInteger) {
+	std::vector<std::intmax_t> values = {
+		std::numeric_limits<std::intmax_t>::min(),
+		std::numeric_limits<std::intmax_t>::max(),
+	};
+	for (std::intmax_t i = 0, base = 1; i < 18; ++i, base *= 10) {
+		for (std::intmax_t value : { base - 1, base, base + 1 }) {
+			values.emplace_back(value);
+			values.emplace_back(-value);
+		}
+	}
+	std::mt19937_64 generator(12345);
+	for (std::size_t i = 0; i < 1000; ++i) {
+		values.emplace_back(static_cast<std::intmax_t>(generator()) >> (generator() % 64));
+	}
+	for (std::intmax_t value : values) {
+		cpv::SharedStringBuilder builder;
+		builder.append("|").append(value).append("|").append(static_cast<std::uintmax_t>(value));
+		ASSERT_EQ(builder.view(), "|" + std::to_string(value) + "|" +
+			std::to_string(static_cast<std::uintmax_t>(value)));
+	}
+}
+
+TEST(SharedStringBuilder, appendDouble) {
+	cpv::SharedStringBuilder builder;
+	builder.append(0.1).append("|")
+		.append(-0.0).append("|")
+		.append(123.456).append("|")
+		.append(1e20).append("|")
+		.append(1e-7);
+	ASSERT_EQ(builder.build(), "0.1|-0|123.456|1e+20|1e-07");
+	// the result should round trip
+	std::mt19937_64 generator(12345);
+	for (std::size_t i = 0; i < 10000; ++i) {
+		std::uint64_t bits = generator();
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+		if (std::isnan(value)) {
+			continue;
+		}
+		builder.append(value);
+		ASSERT_EQ(std::strtod(std::string(builder.view()).c_str(), nullptr), value);
+		builder.clear();
+	}
+}
+
 TEST(SharedStringBuilder, resize) {
 	cpv::SharedStringBuilder builder;
 	builder.append("test|").append("abc|").append("def|");
@@ -0,0 +1,100 @@
+#include <map>
+#include <random>
+#include <CPVFramework/Utility/ObjectTrait.hpp>
+#include <CPVFramework/Utility/SharedString.hpp>
+#include <CPVFramework/Utility/SmallFlatMap.hpp>
+#include <CPVFramework/Testing/GTestUtils.hpp>
+
+TEST(SmallFlatMap, insertAndFind) {
+	cpv::SmallFlatMap<cpv::SharedString, cpv::SharedString, 3> map;
+	ASSERT_TRUE(map.empty());
+	ASSERT_TRUE(map.insert_or_assign("b", "2").second);
+	ASSERT_TRUE(map.try_emplace("c", "3").second);
+	ASSERT_TRUE(map.emplace("a", "1").second);
+	ASSERT_FALSE(map.try_emplace("a", "x").second);
+	ASSERT_FALSE(map.insert_or_assign("c", "33").second);
+	ASSERT_EQ(map.size(), 3U);
+	ASSERT_EQ(map.find("a")->second, "1");
+	ASSERT_EQ(map.find("b")->second, "2");
+	ASSERT_EQ(map.at("c"), "33");
+	ASSERT_TRUE(map.find("d") == map.end());
+	ASSERT_EQ(map.count("a"), 1U);
+	ASSERT_EQ(map.count("d"), 0U);
+	ASSERT_THROWS(std::out_of_range, map.at("d"));
+	map["d"] = "4";
+	ASSERT_EQ(map.size(), 4U);
+	// iterate in key order
+	std::string keys;
+	for (const auto& pair : map) {
+		keys.append(pair.first.view());
+	}
+	ASSERT_EQ(keys, "abcd");
+}
+
+TEST(SmallFlatMap, erase) {
+	cpv::SmallFlatMap<int, int, 3> map({ { 3, 30 }, { 1, 10 }, { 2, 20 }, { 1, 11 } });
+	ASSERT_EQ(map.size(), 3U);
+	ASSERT_EQ(map.at(1), 10);
+	ASSERT_EQ(map.erase(2), 1U);
+	ASSERT_EQ(map.erase(2), 0U);
+	ASSERT_EQ(map.size(), 2U);
+	auto it = map.erase(map.find(1));
+	ASSERT_EQ(it->first, 3);
+	ASSERT_EQ(map.size(), 1U);
+	map.clear();
+	ASSERT_TRUE(map.empty());
+}
+
+TEST(SmallFlatMap, copyAndMove) {
+	cpv::SmallFlatMap<int, std::string, 2> map;
+	for (int i = 0; i < 10; ++i) {
+		map.try_emplace(9 - i, std::to_string(i));
+	}
+	auto copy = map;
+	ASSERT_EQ(copy.size(), 10U);
+	ASSERT_EQ(copy.at(0), "9");
+	auto moved = std::move(copy);
+	ASSERT_EQ(moved.size(), 10U);
+	ASSERT_EQ(moved.at(9), "0");
+	map = moved;
+	ASSERT_EQ(map.size(), 10U);
+}
+
+TEST(SmallFlatMap, appendUnsortedAndSort) {
+	std::mt19937 generator(20191012);
+	// sizes below and above the threshold of insertion sort
+	for (std::size_t size : { 0, 1, 2, 5, 31, 32, 33, 100, 20000 }) {
+		cpv::SmallFlatMap<int, int, 3> map;
+		std::map<int, int> expected;
+		map.insert_or_assign(-1, -1);
+		expected.insert_or_assign(-1, -1);
+		for (std::size_t i = 0; i < size; ++i) {
+			// keys are duplicated, the last value should be kept
+			int key = static_cast<int>(generator() % (size / 2 + 1));
+			map.appendUnsorted(key, static_cast<int>(i));
+			expected.insert_or_assign(key, static_cast<int>(i));
+		}
+		map.appendUnsorted(-1, -2);
+		expected.insert_or_assign(-1, -2);
+		map.sortAndDeduplicate();
+		ASSERT_EQ(map.size(), expected.size());
+		ASSERT_TRUE(std::equal(map.begin(), map.end(), expected.begin(),
+			[] (const auto& a, const auto& b) { return a.first == b.first && a.second == b.second; }));
+		ASSERT_EQ(map.at(-1), -2);
+	}
+}
+
+TEST(SmallFlatMap, objectTrait) {
+	using Map = cpv::SmallFlatMap<int, int, 3>;
+	using Trait = cpv::ObjectTrait<Map>;
+	static_assert(Trait::IsMapLike);
+	Map value = Trait::create();
+	Trait::add(value, 2) = 20;
+	Trait::add(value, 1) = 10;
+	ASSERT_EQ(Trait::size(value), 2U);
+	std::vector<int> keys;
+	Trait::apply(value, [&keys] (int key, int) { keys.emplace_back(key); });
+	ASSERT_EQ(keys, std::vector<int>({ 1, 2 }));
+	Trait::reset(value);
+	ASSERT_EQ(Trait::size(value), 0U);
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <CPVFramework/Utility/Uri.hpp>
 #include <CPVFramework/Utility/StringUtils.hpp>
 #include <CPVFramework/Testing/GTestUtils.hpp>
@@ -392,6 +393,23 @@ TEST(Uri, parse) {
 	}
 }
 
+TEST(Uri, parseManyQueryParameters) {
+	// parameters are sorted at once after parsing, not inserted one by one
+	std::string uriString("/path?");
+	for (std::size_t i = 0; i < 50000; ++i) {
+		uriString.append("key").append(std::to_string(50000 - i)).append("=").append(std::to_string(i)).append("&");
+	}
+	uriString.append("key1=last");
+	cpv::Uri uri((cpv::SharedString(uriString)));
+	ASSERT_EQ(uri.getPath(), "/path");
+	ASSERT_EQ(uri.getQueryParameters().size(), 50000U);
+	ASSERT_EQ(uri.getQueryParameter("key50000"), "0");
+	ASSERT_EQ(uri.getQueryParameter("key2"), "49998");
+	ASSERT_EQ(uri.getQueryParameter("key1"), "last");
+	ASSERT_TRUE(std::is_sorted(uri.getQueryParameters().begin(), uri.getQueryParameters().end(),
+		[] (const auto& a, const auto& b) { return a.first < b.first; }));
+}
+
 TEST(Uri, build) {
 	{
 		cpv::Uri uri;
@@ -17,7 +17,7 @@ Command=$(cat <<"EOF"
   add-apt-repository -y ppa:compiv/cpv-project
   add-apt-repository -y ppa:ubuntu-toolchain-r/test
   apt-get update
-  apt-get install -y seastar libgtest-dev g++-9
+  apt-get install -y seastar libgtest-dev g++-9 zlib1g-dev
   cd /project/tests && \
   sh run_tests.sh
 EOF
@@ -0,0 +1,5 @@
+#!/usr/bin/env bash
+# Generate pre-compressed brotli files of static files for HttpServerRequestStaticFileHandler
+set -e
+find . -type f -not -name '*.gz' -not -name '*.br' -not -name '*.zst' | xargs brotli -fk
+
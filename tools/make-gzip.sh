@@ -1,5 +1,5 @@
 #!/usr/bin/env bash
 # Generate pre-compressed gzip files of static files for HttpServerRequestStaticFileHandler
 set -e
-find . -type f -not -name '*.gz' | xargs gzip -fkn
+find . -type f -not -name '*.gz' -not -name '*.br' -not -name '*.zst' | xargs gzip -fkn
 